@@ -0,0 +1,244 @@
+//! The replay benchmark: real match recordings as the load, so a
+//! regression shows up in exactly the shapes of frame players make.
+//! `scenarios.rs` times the loads we thought of; this times the ones
+//! we recorded.
+//!
+//! `cargo bench -p box3d-sys --bench replay [-- PATH...]` plays every
+//! `.b3rec` under each path (file or directory; `PM_REPLAY_CORPUS`, or
+//! `tests/data` without one) `PM_BENCH_REPS` times (default 5) on
+//! `PM_BENCH_WORKERS` workers (default 1). Playback is in timing mode
+//! ([`Replay::set_timing`]): recorded queries and state hashes are
+//! skipped, so each frame costs only its step. The JSON on stdout has
+//! the p50 and p99 of `b3Profile` step time, each the median over reps
+//! of that rep's percentile (one rep with a preempted frame moves it
+//! less than pooling would), the max over every frame, each rep's
+//! p50/p99, the median of every stage and the counters of the busiest
+//! frame.
+//!
+//! `PM_REPLAY_BASELINE=FILE` compares against a stored baseline: a
+//! recording whose p50 or p99 grew past `PM_REPLAY_TOLERANCE` (default
+//! 0.10) fails the run with exit code 1. Max is reported, not gated;
+//! one frame is too noisy to fail on. `PM_REPLAY_BLESS=1` writes the
+//! baseline instead. It is one line per recording, tab-separated:
+//! name, frames, p50, p99, max µs. A recording whose frame count
+//! changed is a different recording and is reported, not compared.
+//! Release only, like the scenarios.
+
+use box3d_sys::*;
+use std::fmt::Write as _;
+use std::path::{Path, PathBuf};
+
+struct Run {
+    name: String,
+    frames: usize,
+    /// Step time of every frame of every rep, µs
+    steps: Vec<f64>,
+    rep_p50: Vec<f64>,
+    rep_p99: Vec<f64>,
+    profiles: Vec<[f32; STEP_PROFILE.len()]>,
+    /// Counters of the frame with the most contacts
+    counters: [i32; COUNTERS.len()],
+}
+
+struct Stats {
+    p50: f64,
+    p99: f64,
+    max: f64,
+}
+
+fn percentile(xs: &mut [f64], p: f64) -> f64 {
+    if xs.is_empty() {
+        return 0.0;
+    }
+    xs.sort_by(f64::total_cmp);
+    xs[((xs.len() - 1) as f64 * p).round() as usize]
+}
+
+fn env_or<T: std::str::FromStr>(key: &str, default: T) -> T {
+    std::env::var(key).ok().and_then(|s| s.parse().ok()).unwrap_or(default)
+}
+
+fn corpus(paths: &[String]) -> Vec<PathBuf> {
+    let roots: Vec<PathBuf> = match (paths.is_empty(), std::env::var("PM_REPLAY_CORPUS")) {
+        (false, _) => paths.iter().map(PathBuf::from).collect(),
+        (true, Ok(dir)) => vec![PathBuf::from(dir)],
+        (true, Err(_)) => vec![Path::new(env!("CARGO_MANIFEST_DIR")).join("tests/data")],
+    };
+    let mut files = Vec::new();
+    for root in roots {
+        if root.is_dir() {
+            let entries = std::fs::read_dir(&root).unwrap_or_else(|e| panic!("reading {}: {e}", root.display()));
+            files.extend(entries.map(|e| e.unwrap().path()).filter(|p| p.extension().is_some_and(|x| x == "b3rec")));
+        } else {
+            files.push(root);
+        }
+    }
+    files.sort();
+    files
+}
+
+fn play(path: &Path, reps: usize, workers: usize) -> Run {
+    let bytes = std::fs::read(path).unwrap_or_else(|e| panic!("reading {}: {e}", path.display()));
+    let name = path.file_stem().unwrap().to_string_lossy().into_owned();
+    let mut run = Run { name, frames: 0, steps: Vec::new(), rep_p50: Vec::new(), rep_p99: Vec::new(), profiles: Vec::new(), counters: [0; COUNTERS.len()] };
+    let mut busiest = -1;
+    for _ in 0..reps {
+        let mut replay = Replay::new(&bytes).unwrap_or_else(|| panic!("{} is not a recording this build plays", path.display()));
+        replay.set_workers(workers);
+        replay.set_timing(true);
+        let start = run.steps.len();
+        while replay.step() {
+            let profile = replay.profile();
+            run.steps.push(profile[0] as f64 * 1000.0);
+            run.profiles.push(profile);
+            let counters = replay.counters();
+            if counters[2] > busiest {
+                busiest = counters[2];
+                run.counters = counters;
+            }
+        }
+        run.frames = run.steps.len() - start;
+        let mut rep = run.steps[start..].to_vec();
+        run.rep_p50.push(percentile(&mut rep, 0.5));
+        run.rep_p99.push(percentile(&mut rep, 0.99));
+    }
+    run
+}
+
+fn stats(run: &Run) -> Stats {
+    Stats {
+        p50: percentile(&mut run.rep_p50.clone(), 0.5),
+        p99: percentile(&mut run.rep_p99.clone(), 0.5),
+        max: run.steps.iter().copied().fold(0.0, f64::max),
+    }
+}
+
+/// name -> (frames, p50, p99, max)
+fn read_baseline(path: &str) -> Vec<(String, usize, Stats)> {
+    let text = std::fs::read_to_string(path).unwrap_or_else(|e| panic!("reading baseline {path}: {e}"));
+    text.lines()
+        .filter(|l| !l.is_empty() && !l.starts_with('#'))
+        .map(|l| {
+            let f: Vec<&str> = l.split('\t').collect();
+            assert_eq!(f.len(), 5, "baseline {path}: bad line {l:?}");
+            let n = |i: usize| f[i].parse::<f64>().unwrap_or_else(|_| panic!("baseline {path}: bad number in {l:?}"));
+            (f[0].to_string(), n(1) as usize, Stats { p50: n(2), p99: n(3), max: n(4) })
+        })
+        .collect()
+}
+
+fn json_number(out: &mut String, x: f64) {
+    if x.is_finite() {
+        write!(out, "{x:.3}").unwrap();
+    } else {
+        out.push_str("null");
+    }
+}
+
+fn report(out: &mut String, run: &Run, s: &Stats, base: Option<&Stats>, regressed: bool) {
+    write!(out, "    {{\n      \"name\": \"{}\",\n      \"frames\": {},\n      \"step_us\": {{\"p50\": ", run.name, run.frames).unwrap();
+    json_number(out, s.p50);
+    out.push_str(", \"p99\": ");
+    json_number(out, s.p99);
+    out.push_str(", \"max\": ");
+    json_number(out, s.max);
+    out.push_str("},\n      \"rep_p50_us\": [");
+    for (i, x) in run.rep_p50.iter().enumerate() {
+        out.push_str(if i == 0 { "" } else { ", " });
+        json_number(out, *x);
+    }
+    out.push_str("],\n      \"rep_p99_us\": [");
+    for (i, x) in run.rep_p99.iter().enumerate() {
+        out.push_str(if i == 0 { "" } else { ", " });
+        json_number(out, *x);
+    }
+    out.push_str("],\n      \"profile_ms\": {");
+    for (j, stage) in STEP_PROFILE.iter().enumerate() {
+        let mut xs: Vec<f64> = run.profiles.iter().map(|p| p[j] as f64).collect();
+        write!(out, "{}\"{stage}\": ", if j == 0 { "" } else { ", " }).unwrap();
+        json_number(out, percentile(&mut xs, 0.5));
+    }
+    out.push_str("},\n      \"counters\": {");
+    for (j, counter) in COUNTERS.iter().enumerate() {
+        write!(out, "{}\"{counter}\": {}", if j == 0 { "" } else { ", " }, run.counters[j]).unwrap();
+    }
+    out.push('}');
+    if let Some(b) = base {
+        out.push_str(",\n      \"baseline_us\": {\"p50\": ");
+        json_number(out, b.p50);
+        out.push_str(", \"p99\": ");
+        json_number(out, b.p99);
+        out.push_str(", \"max\": ");
+        json_number(out, b.max);
+        write!(out, "}},\n      \"regressed\": {regressed}").unwrap();
+    }
+    out.push_str("\n    }");
+
+    let delta = |now: f64, was: f64| if was > 0.0 { format!(" ({:+.1}%)", (now / was - 1.0) * 100.0) } else { String::new() };
+    let (d50, d99, dmax) = match base {
+        Some(b) => (delta(s.p50, b.p50), delta(s.p99, b.p99), delta(s.max, b.max)),
+        None => Default::default(),
+    };
+    eprintln!(
+        "{:<24} {:>6} frames  p50 {:>8.1} µs{d50}  p99 {:>8.1} µs{d99}  max {:>8.1} µs{dmax}{}",
+        run.name,
+        run.frames,
+        s.p50,
+        s.p99,
+        s.max,
+        if regressed { "  REGRESSED" } else { "" }
+    );
+}
+
+fn main() {
+    if cfg!(debug_assertions) {
+        eprintln!("replay: release only, run `cargo bench -p box3d-sys --bench replay`");
+        std::process::exit(2);
+    }
+    // cargo bench passes `--bench`; anything else is a recording path
+    let paths: Vec<String> = std::env::args().skip(1).filter(|a| !a.starts_with('-')).collect();
+    let reps: usize = env_or("PM_BENCH_REPS", 5usize).max(1);
+    let workers: usize = env_or("PM_BENCH_WORKERS", 1usize).max(1);
+    let tolerance: f64 = env_or("PM_REPLAY_TOLERANCE", 0.10);
+    let baseline_path = std::env::var("PM_REPLAY_BASELINE").ok();
+    let bless = std::env::var_os("PM_REPLAY_BLESS").is_some();
+    let baseline = match (&baseline_path, bless) {
+        (Some(path), false) => read_baseline(path),
+        _ => Vec::new(),
+    };
+
+    let files = corpus(&paths);
+    assert!(!files.is_empty(), "no .b3rec recordings in {paths:?}");
+    let mut out = String::new();
+    write!(out, "{{\n  \"reps\": {reps},\n  \"workers\": {workers},\n  \"tolerance\": {tolerance},\n  \"recordings\": [\n").unwrap();
+    let mut blessed = String::from("# name\tframes\tp50_us\tp99_us\tmax_us\n");
+    let mut regressions = 0;
+    for (i, path) in files.iter().enumerate() {
+        let run = play(path, reps, workers);
+        let s = stats(&run);
+        let base = baseline.iter().find(|(name, _, _)| *name == run.name);
+        let base = match base {
+            Some((_, frames, _)) if *frames != run.frames => {
+                eprintln!("{}: {} frames, baseline has {frames}; not compared", run.name, run.frames);
+                None
+            }
+            other => other.map(|(_, _, b)| b),
+        };
+        let regressed = base.is_some_and(|b| s.p50 > b.p50 * (1.0 + tolerance) || s.p99 > b.p99 * (1.0 + tolerance));
+        regressions += regressed as usize;
+        out.push_str(if i == 0 { "" } else { ",\n" });
+        report(&mut out, &run, &s, base, regressed);
+        writeln!(blessed, "{}\t{}\t{:.3}\t{:.3}\t{:.3}", run.name, run.frames, s.p50, s.p99, s.max).unwrap();
+    }
+    out.push_str("\n  ]\n}\n");
+    print!("{out}");
+
+    if let (Some(path), true) = (&baseline_path, bless) {
+        std::fs::write(path, &blessed).unwrap_or_else(|e| panic!("writing baseline {path}: {e}"));
+        eprintln!("replay: baseline written to {path}");
+    }
+    if regressions > 0 {
+        eprintln!("replay: {regressions} recording(s) regressed past {:.0}%", tolerance * 100.0);
+        std::process::exit(1);
+    }
+}
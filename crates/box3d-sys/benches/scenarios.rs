@@ -0,0 +1,429 @@
+//! The physics benchmark: our production scenarios as numbers, so a
+//! vendor bump that costs time shows up as a diff, not as feel.
+//! `horde.rs` prints one µs/step under debug-safe ceilings; this is
+//! the measured version of the same question, over every shape of
+//! load the game puts on the solver.
+//!
+//! `cargo bench -p box3d-sys --bench scenarios [-- FILTER...]` runs
+//! every scenario whose name contains a filter (all without one) and
+//! prints one JSON document on stdout, a summary table on stderr.
+//! Each scenario builds a fresh world `PM_BENCH_REPS` times (default
+//! 5), warms it up, and times each tick of its measured window. The
+//! JSON has the tick-time distribution over all reps, each rep's
+//! median (the run-to-run spread), the median of every `b3Profile`
+//! stage and the counters of the last measured step.
+//! `PM_BENCH_WORKERS` (default 1) steps on Box3D's own pool;
+//! `PM_BENCH_OUT` also writes the JSON to a file.
+//!
+//! A tick is whatever the scenario's game loop does per frame — the
+//! spawn, the casts, the rollback — so profile stages cover only the
+//! step inside it. Release only: a debug build's numbers mean nothing.
+
+use box3d_sys::*;
+use std::fmt::Write as _;
+use std::time::Instant;
+
+fn v(x: f32, y: f32, z: f32) -> Vec3 {
+    Vec3 { x, y, z }
+}
+
+const DT: f32 = 1.0 / 60.0;
+const SUBSTEPS: i32 = 4;
+
+/// The hog of horde.rs: an upright capsule, rotation locked, ~150 kg.
+const HOG_HALF_H: f32 = 0.3;
+const HOG_R: f32 = 0.4;
+
+/// The truck of truck_feel.rs.
+const TRUCK_HALF: Vec3 = Vec3 { x: 0.9, y: 0.7, z: 1.6 };
+const TRUCK_DENSITY: f32 = 3.0;
+const TRUCK_MU: f32 = 0.05;
+const TRUCK_ACCEL: f32 = 14.0;
+const TRUCK_DRAG: f32 = 1.2;
+
+/// One scenario's run: builds its world, then hands each timed tick to
+/// the recorder. Called once per rep.
+type Scenario = fn(&mut Recorder, usize);
+
+const SCENARIOS: [(&str, Scenario); 7] = [
+    ("settled_horde", settled_horde),
+    ("awake_horde", awake_horde),
+    ("truck_plow", truck_plow),
+    ("trucks_on_height_field", trucks_on_height_field),
+    ("spawn_wave", spawn_wave),
+    ("hitscan_burst", hitscan_burst),
+    ("rollback_10", rollback_10),
+];
+
+struct Recorder {
+    /// Tick times of every rep, µs
+    ticks: Vec<f64>,
+    rep_medians: Vec<f64>,
+    rep_start: usize,
+    profiles: Vec<[f32; STEP_PROFILE.len()]>,
+    counters: [i32; COUNTERS.len()],
+}
+
+impl Recorder {
+    fn tick(&mut self, w: &mut World, f: impl FnOnce(&mut World)) {
+        let t = Instant::now();
+        f(w);
+        self.ticks.push(t.elapsed().as_secs_f64() * 1e6);
+        self.profiles.push(w.profile());
+        self.counters = w.counters();
+    }
+
+    fn end_rep(&mut self) {
+        let mut rep = self.ticks[self.rep_start..].to_vec();
+        self.rep_medians.push(percentile(&mut rep, 0.5));
+        self.rep_start = self.ticks.len();
+    }
+}
+
+fn percentile(xs: &mut [f64], p: f64) -> f64 {
+    if xs.is_empty() {
+        return 0.0;
+    }
+    xs.sort_by(f64::total_cmp);
+    xs[((xs.len() - 1) as f64 * p).round() as usize]
+}
+
+fn workers() -> usize {
+    std::env::var("PM_BENCH_WORKERS").ok().and_then(|s| s.parse().ok()).unwrap_or(1)
+}
+
+fn world() -> World {
+    match workers() {
+        0 | 1 => World::new(v(0.0, -9.81, 0.0)),
+        n => World::with_workers(v(0.0, -9.81, 0.0), n),
+    }
+}
+
+fn ground(w: &mut World) {
+    w.body_box(STATIC, v(0.0, -0.5, 0.0), Quat::default(), v(150.0, 0.5, 150.0), 1.0, 0.6);
+}
+
+fn hog_grid(w: &mut World, n: usize, cols: usize, spacing: (f32, f32), origin: (f32, f32)) -> Vec<BodyId> {
+    let pos: Vec<Vec3> = (0..n)
+        .map(|i| {
+            let (x, z) = ((i % cols) as f32 * spacing.0 + origin.0, (i / cols) as f32 * spacing.1 + origin.1);
+            v(x, HOG_HALF_H + HOG_R + 0.01, z)
+        })
+        .collect();
+    let hogs = w.bodies_capsule(DYNAMIC, &pos, HOG_HALF_H, HOG_R, 2.0, 0.3, false);
+    for &h in &hogs {
+        w.lock_rotation(h);
+    }
+    hogs
+}
+
+/// horde.rs's deterministic wander, set every half second.
+fn wander(w: &mut World, hogs: &[BodyId], tick: u32) {
+    if tick % 30 != 0 {
+        return;
+    }
+    let vs: Vec<Vec3> = (0..hogs.len())
+        .map(|i| {
+            let seed = (i as u32).wrapping_mul(2654435761).wrapping_add(tick / 30);
+            let a = (seed % 6283) as f32 / 1000.0;
+            v(a.sin() * 4.5, w.velocity(hogs[i]).y, a.cos() * 4.5)
+        })
+        .collect();
+    w.set_velocities(hogs, &vs);
+}
+
+fn truck(w: &mut World, pos: Vec3) -> (BodyId, f32) {
+    let t = w.body_box(DYNAMIC, pos, Quat::default(), TRUCK_HALF, TRUCK_DENSITY, TRUCK_MU);
+    (t, TRUCK_DENSITY * 8.0 * TRUCK_HALF.x * TRUCK_HALF.y * TRUCK_HALF.z)
+}
+
+/// 300 hogs that wandered, then stopped and fell asleep: the cost of a
+/// quiet map, which sleeping islands should make nearly free.
+fn settled_horde(rec: &mut Recorder, steps: usize) {
+    let mut w = world();
+    ground(&mut w);
+    let hogs = hog_grid(&mut w, 300, 20, (2.0, 2.0), (-19.0, -14.0));
+    for tick in 0..300 {
+        wander(&mut w, &hogs, tick);
+        w.step(DT, SUBSTEPS);
+    }
+    let still: Vec<Vec3> = hogs.iter().map(|&h| v(0.0, w.velocity(h).y, 0.0)).collect();
+    w.set_velocities(&hogs, &still);
+    for _ in 0..300 {
+        w.step(DT, SUBSTEPS);
+    }
+    for _ in 0..steps {
+        rec.tick(&mut w, |w| w.step(DT, SUBSTEPS));
+    }
+}
+
+/// The same 300 hogs wandering and colliding the whole time.
+fn awake_horde(rec: &mut Recorder, steps: usize) {
+    let mut w = world();
+    ground(&mut w);
+    let hogs = hog_grid(&mut w, 300, 20, (2.0, 2.0), (-19.0, -14.0));
+    for tick in 0..60 {
+        wander(&mut w, &hogs, tick);
+        w.step(DT, SUBSTEPS);
+    }
+    for tick in 60..60 + steps as u32 {
+        rec.tick(&mut w, |w| {
+            wander(w, &hogs, tick);
+            w.step(DT, SUBSTEPS);
+        });
+    }
+}
+
+/// The truck_feel truck driven through 200 hogs packed shoulder to
+/// shoulder across its path: the densest contact load we make.
+fn truck_plow(rec: &mut Recorder, steps: usize) {
+    let mut w = world();
+    ground(&mut w);
+    let (truck, mass) = truck(&mut w, v(0.0, 0.8, -12.0));
+    w.lock_rotation(truck);
+    w.set_damping(truck, TRUCK_DRAG);
+    hog_grid(&mut w, 200, 13, (1.1, 0.9), (-6.6, 0.0));
+    let drive = v(0.0, 0.0, mass * TRUCK_DRAG * TRUCK_ACCEL);
+    for _ in 0..30 {
+        w.force(truck, drive);
+        w.step(DT, SUBSTEPS);
+    }
+    for _ in 0..steps {
+        rec.tick(&mut w, |w| {
+            w.force(truck, drive);
+            w.step(DT, SUBSTEPS);
+        });
+    }
+}
+
+/// 32 trucks circling over rolling height field terrain, rotation free
+/// so they pitch and roll with the ground.
+fn trucks_on_height_field(rec: &mut Recorder, steps: usize) {
+    let mut w = world();
+    let (tiles, cells) = (4, 32);
+    let width = 32.0;
+    let mut terrain = Terrain::new(&mut w, v(-64.0, 0.0, -64.0), (width, width), (tiles, tiles), 0.6);
+    for tz in 0..tiles {
+        for tx in 0..tiles {
+            let n = cells + 1;
+            let heights: Vec<f32> = (0..n * n)
+                .map(|k| {
+                    let (x, z) = ((tx * cells + k % n) as f32, (tz * cells + k / n) as f32);
+                    1.5 * (x * 0.15).sin() * (z * 0.11).cos()
+                })
+                .collect();
+            let scale = v(width / cells as f32, 1.0, width / cells as f32);
+            terrain.set_tile(&mut w, tx, tz, Some(HeightField::new(&heights, n, n, scale)));
+        }
+    }
+    let trucks: Vec<(BodyId, f32)> = (0..32)
+        .map(|i| {
+            let a = i as f32 * std::f32::consts::TAU / 32.0;
+            let r = 20.0 + (i % 4) as f32 * 8.0;
+            truck(&mut w, v(a.cos() * r, 3.5, a.sin() * r))
+        })
+        .collect();
+    let bodies: Vec<BodyId> = trucks.iter().map(|t| t.0).collect();
+    for &(t, _) in &trucks {
+        w.set_damping(t, TRUCK_DRAG);
+    }
+    // Drive each truck along its circle
+    let drive = |w: &mut World| {
+        let fs: Vec<Vec3> = trucks
+            .iter()
+            .map(|&(t, mass)| {
+                let (p, _) = w.pose(t);
+                let r = (p.x * p.x + p.z * p.z).sqrt().max(1.0);
+                let f = mass * TRUCK_DRAG * TRUCK_ACCEL;
+                v(-p.z / r * f, 0.0, p.x / r * f)
+            })
+            .collect();
+        w.forces(&bodies, &fs);
+    };
+    for _ in 0..60 {
+        drive(&mut w);
+        w.step(DT, SUBSTEPS);
+    }
+    for _ in 0..steps {
+        rec.tick(&mut w, |w| {
+            drive(w);
+            w.step(DT, SUBSTEPS);
+        });
+    }
+    terrain.destroy(&mut w);
+}
+
+/// A wave of 100 hogs dropped every tick beside a horde, each wave on
+/// its own patch: batch creation and the first steps of fresh contacts
+/// while the earlier waves land and settle.
+fn spawn_wave(rec: &mut Recorder, steps: usize) {
+    let mut w = world();
+    ground(&mut w);
+    hog_grid(&mut w, 300, 20, (2.0, 2.0), (-19.0, -14.0));
+    for _ in 0..60 {
+        w.step(DT, SUBSTEPS);
+    }
+    for wave in 0..steps {
+        let patch = v((wave % 6) as f32 * 22.0 - 66.0, 0.0, (wave / 6 % 5) as f32 * 22.0 + 20.0);
+        let pos: Vec<Vec3> = (0..100)
+            .map(|i| v(patch.x + (i % 10) as f32 * 2.0, 3.0, patch.z + (i / 10) as f32 * 2.0))
+            .collect();
+        rec.tick(&mut w, |w| {
+            let hogs = w.bodies_capsule(DYNAMIC, &pos, HOG_HALF_H, HOG_R, 2.0, 0.3, false);
+            for &h in &hogs {
+                w.lock_rotation(h);
+            }
+            w.step(DT, SUBSTEPS);
+        });
+    }
+}
+
+/// Lag compensation under fire: 300 wandering hogs in a 32 tick pose
+/// history, and per tick 64 shots judged 6 ticks in the past.
+fn hitscan_burst(rec: &mut Recorder, steps: usize) {
+    let mut w = world();
+    ground(&mut w);
+    let hogs = hog_grid(&mut w, 300, 20, (2.0, 2.0), (-19.0, -14.0));
+    w.enable_history(32);
+    for &h in &hogs {
+        w.set_history(h, true);
+    }
+    let mut tick = 0u32;
+    for _ in 0..40 {
+        wander(&mut w, &hogs, tick);
+        w.step(DT, SUBSTEPS);
+        w.record_history(tick);
+        tick += 1;
+    }
+    for _ in 0..steps {
+        rec.tick(&mut w, |w| {
+            wander(w, &hogs, tick);
+            w.step(DT, SUBSTEPS);
+            w.record_history(tick);
+            for shot in 0..64u32 {
+                let a = (shot.wrapping_mul(2654435761) % 6283) as f32 / 1000.0;
+                let origin = v(a.cos() * 40.0, 1.0, a.sin() * 40.0);
+                let translation = v(-origin.x * 2.0, 0.0, -origin.z * 2.0);
+                std::hint::black_box(w.cast_at_tick(tick - 6, origin, 0.0, translation, !0));
+            }
+        });
+        tick += 1;
+    }
+}
+
+/// The client's misprediction path: rewind 10 ticks to the acked
+/// snapshot and re-simulate them, once per tick, over an awake horde.
+fn rollback_10(rec: &mut Recorder, steps: usize) {
+    let mut w = world();
+    ground(&mut w);
+    let hogs = hog_grid(&mut w, 300, 20, (2.0, 2.0), (-19.0, -14.0));
+    for tick in 0..60 {
+        wander(&mut w, &hogs, tick);
+        w.step(DT, SUBSTEPS);
+    }
+    let mut acked = Snapshot::new();
+    for k in 0..steps as u32 {
+        let base = 60 + k * 10;
+        w.capture(&mut acked);
+        for tick in base..base + 10 {
+            wander(&mut w, &hogs, tick);
+            w.step(DT, SUBSTEPS);
+        }
+        rec.tick(&mut w, |w| {
+            assert!(w.restore(&acked), "topology is frozen");
+            for tick in base..base + 10 {
+                wander(w, &hogs, tick);
+                w.step(DT, SUBSTEPS);
+            }
+        });
+    }
+}
+
+fn json_number(out: &mut String, x: f64) {
+    if x.is_finite() {
+        write!(out, "{x:.3}").unwrap();
+    } else {
+        out.push_str("null");
+    }
+}
+
+fn report(out: &mut String, name: &str, rec: &Recorder) {
+    let mut ticks = rec.ticks.clone();
+    let n = ticks.len() as f64;
+    let mean = ticks.iter().sum::<f64>() / n;
+    let stddev = (ticks.iter().map(|t| (t - mean) * (t - mean)).sum::<f64>() / n).sqrt();
+    let median = percentile(&mut ticks, 0.5);
+    let fields = [
+        ("min", ticks[0]),
+        ("median", median),
+        ("mean", mean),
+        ("p90", percentile(&mut ticks, 0.9)),
+        ("max", ticks[ticks.len() - 1]),
+        ("stddev", stddev),
+    ];
+    write!(out, "    {{\n      \"name\": \"{name}\",\n      \"ticks\": {},\n      \"tick_us\": {{", ticks.len()).unwrap();
+    for (i, (k, x)) in fields.iter().enumerate() {
+        write!(out, "{}\"{k}\": ", if i == 0 { "" } else { ", " }).unwrap();
+        json_number(out, *x);
+    }
+    out.push_str("},\n      \"rep_median_us\": [");
+    for (i, x) in rec.rep_medians.iter().enumerate() {
+        out.push_str(if i == 0 { "" } else { ", " });
+        json_number(out, *x);
+    }
+    out.push_str("],\n      \"profile_ms\": {");
+    for (j, stage) in STEP_PROFILE.iter().enumerate() {
+        let mut xs: Vec<f64> = rec.profiles.iter().map(|p| p[j] as f64).collect();
+        write!(out, "{}\"{stage}\": ", if j == 0 { "" } else { ", " }).unwrap();
+        json_number(out, percentile(&mut xs, 0.5));
+    }
+    out.push_str("},\n      \"counters\": {");
+    for (j, counter) in COUNTERS.iter().enumerate() {
+        write!(out, "{}\"{counter}\": {}", if j == 0 { "" } else { ", " }, rec.counters[j]).unwrap();
+    }
+    out.push_str("}\n    }");
+    eprintln!(
+        "{name:<24} median {median:>9.1} µs  p90 {:>9.1} µs  step {:>7.3} ms",
+        fields[3].1,
+        rec.profiles.iter().map(|p| p[0] as f64).sum::<f64>() / n
+    );
+}
+
+fn main() {
+    if cfg!(debug_assertions) {
+        eprintln!("scenarios: release only, run `cargo bench -p box3d-sys --bench scenarios`");
+        std::process::exit(2);
+    }
+    // cargo bench passes `--bench`; anything else is a name filter
+    let filters: Vec<String> = std::env::args().skip(1).filter(|a| !a.starts_with('-')).collect();
+    let reps: usize = std::env::var("PM_BENCH_REPS").ok().and_then(|s| s.parse().ok()).unwrap_or(5).max(1);
+
+    let mut out = String::new();
+    write!(out, "{{\n  \"reps\": {reps},\n  \"workers\": {},\n  \"scenarios\": [\n", workers()).unwrap();
+    let mut first = true;
+    for (name, scenario) in SCENARIOS {
+        if !filters.is_empty() && !filters.iter().any(|f| name.contains(f.as_str())) {
+            continue;
+        }
+        // Rollback ticks are ten steps and waves grow the world, so
+        // those take fewer ticks per rep
+        let steps = match name {
+            "rollback_10" | "spawn_wave" => 30,
+            _ => 240,
+        };
+        let mut rec = Recorder { ticks: Vec::new(), rep_medians: Vec::new(), rep_start: 0, profiles: Vec::new(), counters: [0; COUNTERS.len()] };
+        for _ in 0..reps {
+            scenario(&mut rec, steps);
+            rec.end_rep();
+        }
+        out.push_str(if first { "" } else { ",\n" });
+        first = false;
+        report(&mut out, name, &rec);
+    }
+    out.push_str("\n  ]\n}\n");
+
+    print!("{out}");
+    if let Ok(path) = std::env::var("PM_BENCH_OUT") {
+        std::fs::write(&path, &out).unwrap_or_else(|e| panic!("writing {path}: {e}"));
+    }
+}
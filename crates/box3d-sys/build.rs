@@ -3,17 +3,84 @@
 //! ever sees the shim's primitive-typed functions, so there is no
 //! struct layout to generate — and no libclang requirement on any
 //! machine that builds pm (Linux, native Windows, windows-gnu cross).
+//!
+//! The exception on x86: `contact_solver_avx2.c` and
+//! `contact_solver_avx512.c` are the convex contact solver again at 8
+//! and 16 lanes and need AVX2 / AVX-512 codegen, which the rest must
+//! not get (the same binary still runs on SSE2-only hosts). Each is
+//! compiled on its own and its object linked into the same archive;
+//! the engine picks one per world after a CPUID check.
+//!
+//! Every unit is compiled with one float policy so a Linux server and a
+//! Windows client round alike: no contraction into FMA (Clang and
+//! MSVC ARM64 contract by default), and SSE2 rather than x87 on 32-bit
+//! x86. The `strict-determinism` feature also pins the contact solver
+//! to 4 lanes on every CPU (`BOX3D_STRICT_DETERMINISM`).
+
+fn float_policy(build: &mut cc::Build, target_arch: &str) {
+    if build.get_compiler().is_like_msvc() {
+        build.flag("/fp:precise");
+    } else {
+        build.flag("-ffp-contract=off");
+        if target_arch == "x86" {
+            build.flag("-msse2").flag("-mfpmath=sse");
+        }
+    }
+}
 
 fn main() {
+    let target_arch = std::env::var("CARGO_CFG_TARGET_ARCH").unwrap();
+    let x86 = target_arch == "x86_64" || target_arch == "x86";
+    let strict = std::env::var_os("CARGO_FEATURE_STRICT_DETERMINISM").is_some();
+
     let mut build = cc::Build::new();
+    float_policy(&mut build, &target_arch);
+    if strict {
+        build.define("BOX3D_STRICT_DETERMINISM", None);
+    }
     for entry in std::fs::read_dir("vendor/box3d/src").unwrap() {
         let path = entry.unwrap().path();
-        if path.extension().is_some_and(|e| e == "c") {
+        let name = path.to_string_lossy();
+        if path.extension().is_some_and(|e| e == "c") && !name.ends_with("_avx2.c") && !name.ends_with("_avx512.c") {
             build.file(path);
         }
     }
+    // (file, MSVC flag, GCC/Clang flags, define for the rest). No
+    // contraction into FMA: a wide lane must round exactly like a
+    // 4-wide one, or peers of different widths disagree on the hash.
+    // (AVX-512F implies FMA in GCC, so there it is fp-contract alone.)
+    let wide_builds: [(&str, &str, &[&str], &str); 2] = [
+        ("contact_solver_avx2.c", "/arch:AVX2", &["-mavx2", "-mno-fma", "-ffp-contract=off"], "BOX3D_ENABLE_AVX2"),
+        ("contact_solver_avx512.c", "/arch:AVX512", &["-mavx512f", "-ffp-contract=off"], "BOX3D_ENABLE_AVX512"),
+    ];
+    for (file, msvc, gnu, define) in if x86 { &wide_builds[..] } else { &[] } {
+        let mut wide = cc::Build::new();
+        wide.file(format!("vendor/box3d/src/{file}"))
+            .include("vendor/box3d/include")
+            .include("vendor/box3d/src")
+            .std("c17")
+            .warnings(false);
+        float_policy(&mut wide, &target_arch);
+        if strict {
+            wide.define("BOX3D_STRICT_DETERMINISM", None);
+        }
+        if wide.get_compiler().is_like_msvc() {
+            wide.flag(msvc);
+        } else {
+            for flag in gnu.iter() {
+                wide.flag(flag);
+            }
+        }
+        for object in wide.compile_intermediates() {
+            build.object(object);
+        }
+        build.define(define, None);
+    }
     build
         .file("src/pmb3.c")
+        .file("src/pmb3_snapshot.c")
+        .file("src/pmb3_hash.c")
+        .file("src/pmb3_step.c")
         .include("vendor/box3d/include")
         .include("vendor/box3d/src")
         .std("c17")
@@ -22,5 +89,9 @@ fn main() {
         .warnings(false)
         .compile("box3d");
     println!("cargo:rerun-if-changed=src/pmb3.c");
+    println!("cargo:rerun-if-changed=src/pmb3_snapshot.c");
+    println!("cargo:rerun-if-changed=src/pmb3_hash.c");
+    println!("cargo:rerun-if-changed=src/pmb3_step.c");
+    println!("cargo:rerun-if-changed=src/pmb3.h");
     println!("cargo:rerun-if-changed=vendor/box3d");
 }
@@ -2,7 +2,7 @@
 //! (pin + policy in `vendor/box3d/VENDOR.md`) behind the `pmb3` C shim.
 //!
 //! THE SEAM RULE: pm code never sees a `b3*` type. The shim
-//! (`src/pmb3.c`, the only file that includes Box3D headers) exposes
+//! (`src/pmb3*.c`, the only files that include Box3D headers) exposes
 //! primitive-typed calls; this crate wraps them in a minimal safe API
 //! (`World`, `BodyId`). Box3D is alpha — upstream churn lands in the
 //! shim, not in game code. Spike 1 surface (2026-07-23): worlds, box
@@ -36,6 +36,24 @@ impl Default for Quat {
 unsafe extern "C" {
     fn pmb3_world_create(gx: f32, gy: f32, gz: f32) -> u32;
     fn pmb3_world_destroy(w: u32);
+    fn pmb3_world_start_flight_recording(w: u32, ring_bytes: i32, keyframe_interval: i32);
+    fn pmb3_world_stop_recording(w: u32) -> *mut std::ffi::c_void;
+    fn pmb3_recording_bytes(recording: *const std::ffi::c_void, data: *mut *const u8) -> i32;
+    fn pmb3_recording_destroy(recording: *mut std::ffi::c_void);
+    fn pmb3_recording_compress(recording: *mut std::ffi::c_void) -> i32;
+    fn pmb3_validate_replay(data: *const u8, size: i32, workers: i32) -> i32;
+    fn pmb3_world_start_recording(w: u32, keyframe_interval: i32);
+    fn pmb3_replay_create(data: *const u8, size: i32) -> *mut std::ffi::c_void;
+    fn pmb3_replay_destroy(player: *mut std::ffi::c_void);
+    fn pmb3_replay_seek(player: *mut std::ffi::c_void, frame: i32);
+    fn pmb3_replay_step(player: *mut std::ffi::c_void) -> i32;
+    fn pmb3_replay_frame(player: *const std::ffi::c_void) -> i32;
+    fn pmb3_replay_frame_count(player: *const std::ffi::c_void) -> i32;
+    fn pmb3_replay_diverged(player: *const std::ffi::c_void) -> i32;
+    fn pmb3_replay_keyframe_bytes(player: *const std::ffi::c_void) -> u64;
+    fn pmb3_replay_set_timing(player: *mut std::ffi::c_void, on: i32);
+    fn pmb3_replay_set_workers(player: *mut std::ffi::c_void, count: i32);
+    fn pmb3_replay_world(player: *const std::ffi::c_void) -> u32;
     fn pmb3_world_step(w: u32, dt: f32, substeps: i32);
     fn pmb3_body_box(
         w: u32,
@@ -55,7 +73,21 @@ unsafe extern "C" {
         density: f32,
         friction: f32,
         lock_upright: i32,
+        name_id: u32,
     ) -> u64;
+    fn pmb3_bodies_capsule(
+        w: u32,
+        kind: i32,
+        pos: *const Vec3,
+        n: i32,
+        half_h: f32,
+        radius: f32,
+        density: f32,
+        friction: f32,
+        lock_upright: i32,
+        name_id: u32,
+        out: *mut u64,
+    );
     fn pmb3_body_hull(
         w: u32,
         kind: i32,
@@ -67,12 +99,21 @@ unsafe extern "C" {
         friction: f32,
     ) -> u64;
     fn pmb3_body_destroy(body: u64);
+    fn pmb3_bodies_destroy(bodies: *const u64, n: i32);
+    fn pmb3_bodies_retire(bodies: *const u64, n: i32, kind: i32, category: u64, mask: u64);
     fn pmb3_body_set_pose(body: u64, pos: Vec3, rot: Quat);
+    fn pmb3_body_query_box(w: u32, pos: Vec3, rot: Quat, half: Vec3, category: u64, mask: u64) -> u64;
+    fn pmb3_bodies_set_query_pose(bodies: *const u64, pos: *const Vec3, rot: *const Quat, n: i32);
     fn pmb3_body_sphere(w: u32, kind: i32, pos: Vec3, radius: f32, density: f32, friction: f32) -> u64;
+    fn pmb3_world_intern_name(w: u32, name: *const std::ffi::c_char) -> u32;
+    fn pmb3_body_name(body: u64) -> *const std::ffi::c_char;
     fn pmb3_body_set_velocity(body: u64, v: Vec3);
     fn pmb3_body_force(body: u64, f: Vec3);
     fn pmb3_body_set_damping(body: u64, linear: f32);
     fn pmb3_body_lock_rotation(body: u64);
+    fn pmb3_body_set_substep_hint(body: u64, hint: i32);
+    fn pmb3_body_set_step_period(body: u64, period: i32);
+    fn pmb3_world_set_region_step_period(w: u32, lower: Vec3, upper: Vec3, period: i32) -> i32;
     fn pmb3_body_set_angular_velocity(body: u64, v: Vec3);
     fn pmb3_body_angular_velocity(body: u64, v: *mut Vec3);
     fn pmb3_wheel_joint(
@@ -84,13 +125,47 @@ unsafe extern "C" {
         damping: f32,
         max_torque: f32,
     ) -> u64;
+    fn pmb3_vehicle_wheel_joint(
+        w: u32,
+        chassis: u64,
+        wheel: u64,
+        mount: Vec3,
+        hertz: f32,
+        damping: f32,
+        max_torque: f32,
+    ) -> u64;
     fn pmb3_wheel_spin(joint: u64, speed: f32);
     fn pmb3_body_pose(body: u64, pos: *mut Vec3, rot: *mut Quat);
     fn pmb3_body_velocity(body: u64, vel: *mut Vec3);
     fn pmb3_body_awake(body: u64) -> i32;
     fn pmb3_body_set_friction(body: u64, mu: f32);
+    fn pmb3_body_set_material(body: u64, material: u64);
     fn pmb3_body_set_filter(body: u64, category: u64, mask: u64);
+    fn pmb3_body_set_filter_group(body: u64, group: i32);
     fn pmb3_body_set_type(body: u64, kind: i32);
+    fn pmb3_body_sensor_box(w: u32, pos: Vec3, half: Vec3) -> u64;
+    fn pmb3_body_set_sensor_events(body: u64, on: bool);
+    fn pmb3_body_sensor_visitors(body: u64, out: *mut u64, cap: i32) -> i32;
+    fn pmb3_world_skipped_sensors(w: u32) -> i32;
+    fn pmb3_world_explode(w: u32, blasts: *const Explosion, n: i32);
+    fn pmb3_world_set_force_fields(w: u32, fields: *const ForceField, n: i32);
+    fn pmb3_world_debug_geometry(
+        w: u32,
+        origin: Vec3,
+        planes: *const f32,
+        plane_count: i32,
+        lower: Vec3,
+        upper: Vec3,
+        faces: bool,
+        lines: *mut DebugVertex,
+        line_capacity: i32,
+        triangles: *mut DebugVertex,
+        triangle_capacity: i32,
+        counts: *mut i32,
+    ) -> i32;
+    fn pmb3_world_shift_origin(w: u32, origin: Vec3);
+    fn pmb3_world_begin_queries(w: u32);
+    fn pmb3_world_end_queries(w: u32);
     fn pmb3_world_cast_ray(
         w: u32,
         origin: Vec3,
@@ -99,6 +174,29 @@ unsafe extern "C" {
         point: *mut Vec3,
         frac: *mut f32,
     ) -> i32;
+    fn pmb3_world_cast_rays(
+        w: u32,
+        origins: *const Vec3,
+        translations: *const Vec3,
+        n: i32,
+        mask: u64,
+        points: *mut Vec3,
+        fracs: *mut f32,
+    ) -> i32;
+    fn pmb3_world_enable_history(w: u32, depth: i32);
+    fn pmb3_world_record_history(w: u32, tick: u32);
+    fn pmb3_body_enable_history(body: u64, flag: i32);
+    fn pmb3_world_cast_at_tick(
+        w: u32,
+        tick: u32,
+        origin: Vec3,
+        radius: f32,
+        translation: Vec3,
+        mask: u64,
+        body: *mut u64,
+        point: *mut Vec3,
+        frac: *mut f32,
+    ) -> i32;
     fn pmb3_body_cast_sphere(
         body: u64,
         tpos: Vec3,
@@ -118,349 +216,6100 @@ unsafe extern "C" {
         out: *mut u64,
         cap: i32,
     ) -> i32;
+    fn pmb3_world_query_nearest(
+        w: u32,
+        p: Vec3,
+        range: f32,
+        mask: u64,
+        out: *mut u64,
+        dist: *mut f32,
+        cap: i32,
+    ) -> i32;
+    fn pmb3_bodies_read_poses(
+        w: u32,
+        ids: *const u64,
+        n: i32,
+        pos: *mut Vec3,
+        rot: *mut Quat,
+        vel: *mut Vec3,
+        awake: *mut u8,
+    ) -> i32;
+    fn pmb3_bodies_set_velocity(w: u32, ids: *const u64, vs: *const Vec3, n: i32);
+    fn pmb3_bodies_force(w: u32, ids: *const u64, fs: *const Vec3, n: i32);
+    fn pmb3_bodies_update_lod(
+        w: u32,
+        ids: *const u64,
+        levels: *mut u8,
+        n: i32,
+        viewers: *const Vec3,
+        viewer_count: i32,
+        near: f32,
+        far: f32,
+        margin: f32,
+    ) -> i32;
+    fn pmb3_world_move_events(w: u32, count: *mut i32) -> *const MoveEvent;
+    fn pmb3_world_set_contact_events(w: u32, touch: u64, hit: u64);
+    fn pmb3_world_contact_events(
+        w: u32,
+        begins: *mut *const ContactTouch,
+        begin_count: *mut i32,
+        ends: *mut *const ContactTouch,
+        end_count: *mut i32,
+        hits: *mut *const ContactHit,
+        hit_count: *mut i32,
+    );
+    fn pmb3_shape_body(shape: u64) -> u64;
+    fn pmb3_body_enable_impacts(body: u64, flag: i32);
+    fn pmb3_world_body_impacts(w: u32, count: *mut i32) -> *const BodyImpact;
+    fn pmb3_world_set_state_quantization(w: u32, cell: f32, pos_res: f32, max_lin: f32, max_ang: f32, vel_res: f32, rot_bits: i32);
+    fn pmb3_world_packed_states(w: u32, stride: *mut i32, count: *mut i32) -> *const u8;
+    fn pmb3_world_unpack_state(w: u32, record: *const u8, pos: *mut Vec3, rot: *mut Quat, vel: *mut Vec3, ang_vel: *mut Vec3) -> bool;
+    fn pmb3_world_snapshot_size(w: u32, exclude_static: bool) -> i32;
+    fn pmb3_world_save_snapshot(w: u32, buffer: *mut u8, capacity: i32, exclude_static: bool) -> i32;
+    fn pmb3_world_load_snapshot(w: u32, data: *const u8, size: i32) -> bool;
+    fn pmb3_world_clone(w: u32, workers: i32) -> u32;
+    fn pmb3_world_begin_snapshot_stream(w: u32, exclude_static: bool) -> *mut std::ffi::c_void;
+    fn pmb3_snapshot_stream_read(stream: *mut std::ffi::c_void, buffer: *mut u8, capacity: i32, remaining: *mut i32) -> i32;
+    fn pmb3_snapshot_stream_size(stream: *const std::ffi::c_void) -> i32;
+    fn pmb3_snapshot_stream_destroy(stream: *mut std::ffi::c_void);
+    fn pmb3_ray_cache_create() -> *mut std::ffi::c_void;
+    fn pmb3_ray_cache_destroy(c: *mut std::ffi::c_void);
+    fn pmb3_ray_cache_walks(c: *const std::ffi::c_void) -> i32;
+    fn pmb3_world_cast_ray_cached(
+        w: u32,
+        c: *mut std::ffi::c_void,
+        origin: Vec3,
+        translation: Vec3,
+        mask: u64,
+        point: *mut Vec3,
+        frac: *mut f32,
+    ) -> i32;
+    fn pmb3_snapshot_create() -> *mut std::ffi::c_void;
+    fn pmb3_snapshot_destroy(s: *mut std::ffi::c_void);
+    fn pmb3_snapshot_capture(w: u32, s: *mut std::ffi::c_void) -> i32;
+    fn pmb3_snapshot_restore(w: u32, s: *const std::ffi::c_void) -> i32;
+    fn pmb3_world_create_threaded(gx: f32, gy: f32, gz: f32, workers: i32) -> u32;
+    fn pmb3_world_create_pinned(gx: f32, gy: f32, gz: f32, workers: i32, cpus: u64, base: i32) -> u32;
+    fn pmb3_world_create_hosted(
+        gx: f32,
+        gy: f32,
+        gz: f32,
+        workers: i32,
+        enqueue: EnqueueFn,
+        finish: FinishFn,
+        host: *mut std::ffi::c_void,
+    ) -> u32;
+    fn pmb3_world_create_simd(gx: f32, gy: f32, gz: f32, simd_width: i32) -> u32;
+    fn pmb3_world_simd_width(w: u32) -> i32;
+    fn pmb3_world_create_grid(gx: f32, gy: f32, gz: f32, workers: i32, cell_size: f32) -> u32;
+    fn pmb3_world_solver_paths(w: u32, wide: *mut i32, scalar: *mut i32, overflow: *mut i32, groups: *mut i32);
+    fn pmb3_world_reserve(w: u32, static_shapes: i32, dynamic_shapes: i32);
+    fn pmb3_world_tree_capacity(w: u32, body_type: i32) -> i32;
+    fn pmb3_world_scratch_demand(w: u32, arena_bytes: *mut i32, world_arena_bytes: *mut i32);
+    fn pmb3_world_set_scratch_reserve(w: u32, arena_bytes: i32, world_arena_bytes: i32);
+    fn pmb3_world_step_heap_count(w: u32) -> i32;
+    fn pmb3_world_memory_stats(w: u32, out: *mut MemoryStats);
+    fn pmb3_world_compact(w: u32, byte_budget: i32) -> bool;
+    fn pmb3_world_set_sleep_packing(w: u32, flag: bool);
+    fn pmb3_world_set_body_reorder(w: u32, interval: i32);
+    fn pmb3_world_set_graph_balance(w: u32, interval: i32);
+    fn pmb3_world_set_contact_rest(w: u32, distance: f32);
+    fn pmb3_world_set_relax(w: u32, max: i32, tolerance: f32);
+    fn pmb3_world_set_filter_rule(w: u32, a: i32, b: i32, rule: i32);
+    fn pmb3_world_set_group_material(w: u32, group: i32, friction: f32, restitution: f32);
+    fn pmb3_world_set_material_mix(w: u32, a: u64, b: u64, friction: f32, restitution: f32);
+    fn pmb3_world_contact_reuse(w: u32, recycled: *mut i32, rested: *mut i32);
+    fn pmb3_world_sat_cache(w: u32, calls: *mut i32, hits: *mut i32);
+    fn pmb3_world_color_counts(w: u32, out: *mut i32) -> i32;
+    fn pmb3_world_set_detailed_profile(w: u32, on: bool);
+    fn pmb3_world_detailed_profile(w: u32, busy: *mut f32, wait: *mut f32, blocks: *mut i32, spin: *mut f32) -> i32;
+    fn pmb3_world_profile(w: u32, out: *mut f32);
+    fn pmb3_world_set_trace(w: u32, begin: Option<TraceFn>, end: Option<TraceFn>, ctx: *mut std::ffi::c_void);
+    fn pmb3_world_counters(w: u32, out: *mut i32) -> i32;
+    fn pmb3_world_enable_profile_history(w: u32, frames: i32);
+    fn pmb3_world_profile_history(w: u32, steps: *mut u64, profiles: *mut f32, counters: *mut i32, capacity: i32) -> i32;
+    fn pmb3_world_profile_summary(w: u32, out: *mut f32) -> i32;
+    fn pmb3_world_set_hitch_threshold(w: u32, ms: f32);
+    fn pmb3_world_hitch(w: u32, step: *mut u64, profile: *mut f32, dt: *mut f32, substeps: *mut i32) -> i32;
+    fn pmb3_world_copy_hitch(w: u32, buf: *mut u8, cap: i32) -> i32;
+    fn pmb3_world_set_grain_tuning(w: u32, on: bool);
+    fn pmb3_world_grain_tuning(
+        w: u32,
+        names: *mut *const std::ffi::c_char,
+        levels: *mut i32,
+        exploring: *mut bool,
+        costs: *mut f32,
+        cap: i32,
+    ) -> i32;
+    fn pmb3_world_rebuild_static_tree(w: u32);
+    fn pmb3_world_set_wide_static_tree(w: u32, on: bool);
+    fn pmb3_world_set_static_rebuild_budget(w: u32, budget: i32);
+    fn pmb3_world_set_continuous_budget(w: u32, budget: i32);
+    fn pmb3_world_continuous(
+        w: u32,
+        fast: *mut i32,
+        skipped: *mut i32,
+        bullets: *mut i32,
+        impacts: *mut i32,
+        candidates: *mut i32,
+        rejected: *mut i32,
+        ms: *mut f32,
+    );
+    fn pmb3_world_set_wake_budget(w: u32, budget: i32);
+    fn pmb3_world_wakes(w: u32, woken: *mut i32, deferred: *mut i32);
+    fn pmb3_world_set_contact_revive(w: u32, steps: i32);
+    fn pmb3_world_revived_contacts(w: u32) -> i32;
+    fn pmb3_world_set_island_split_budget(w: u32, budget: i32);
+    fn pmb3_world_split_islands(w: u32) -> i32;
+    fn pmb3_world_static_tree(w: u32, area_ratio: *mut f32) -> i32;
+    fn pmb3_world_pair_set(w: u32, capacity: *mut i32) -> i32;
+    fn pmb3_stepper_create(threads: i32) -> *mut std::ffi::c_void;
+    fn pmb3_stepper_destroy(s: *mut std::ffi::c_void);
+    fn pmb3_worlds_step(s: *mut std::ffi::c_void, ws: *const u32, n: i32, dt: f32, substeps: i32);
+    fn pmb3_worlds_step_begin(s: *mut std::ffi::c_void, ws: *const u32, n: i32, dt: f32, substeps: i32);
+    fn pmb3_worlds_step_wait(s: *mut std::ffi::c_void);
+    fn pmb3_world_hash(w: u32) -> u64;
+    fn pmb3_world_hash_full(w: u32) -> u64;
+    fn pmb3_island_bodies(w: u32, seeds: *const u64, n: i32, out: *mut u64, cap: i32) -> i32;
+    fn pmb3_world_move_capsules(w: u32, movers: *const Mover, n: i32, mask: u64, out: *mut MoverResult);
+    fn pmb3_bodies_capture(w: u32, ids: *const u64, n: i32, out: *mut BodyState);
+    fn pmb3_bodies_restore(w: u32, ids: *const u64, n: i32, rows: *const BodyState);
+    fn pmb3_mesh_cook(
+        verts: *const Vec3,
+        vertex_count: i32,
+        indices: *const i32,
+        triangle_count: i32,
+        weld: f32,
+        quantize: bool,
+        workers: i32,
+        progress: Option<unsafe extern "C" fn(f32, *mut std::ffi::c_void) -> bool>,
+        context: *mut std::ffi::c_void,
+    ) -> *mut std::ffi::c_void;
+    fn pmb3_mesh_destroy(m: *mut std::ffi::c_void);
+    fn pmb3_mesh_hash(m: *const std::ffi::c_void) -> u32;
+    fn pmb3_mesh_triangle_count(m: *const std::ffi::c_void) -> i32;
+    fn pmb3_mesh_cast_ray(m: *const std::ffi::c_void, origin: Vec3, translation: Vec3, frac: *mut f32) -> i32;
+    fn pmb3_mesh_bytes(m: *const std::ffi::c_void, count: *mut i32) -> *const u8;
+    fn pmb3_mesh_view(bytes: *const u8, count: i32, verify: bool) -> *const std::ffi::c_void;
+    fn pmb3_height_field_create(heights: *const f32, count_x: i32, count_z: i32, scale: Vec3) -> *mut std::ffi::c_void;
+    fn pmb3_height_field_destroy(h: *mut std::ffi::c_void);
+    fn pmb3_height_field_cast(
+        h: *const std::ffi::c_void,
+        origin: Vec3,
+        translation: Vec3,
+        radius: f32,
+        frac: *mut f32,
+    ) -> i32;
+    fn pmb3_height_field_mover(
+        h: *const std::ffi::c_void,
+        c1: Vec3,
+        c2: Vec3,
+        radius: f32,
+        out: *mut f32,
+        cap: i32,
+    ) -> i32;
+    fn pmb3_height_field_query(h: *const std::ffi::c_void, lower: Vec3, upper: Vec3, out: *mut i32, cap: i32) -> i32;
+    fn pmb3_terrain_create(
+        w: u32,
+        origin: Vec3,
+        width_x: f32,
+        width_z: f32,
+        count_x: i32,
+        count_z: i32,
+        friction: f32,
+    ) -> *mut std::ffi::c_void;
+    fn pmb3_terrain_destroy(t: *mut std::ffi::c_void);
+    fn pmb3_terrain_set_tile(t: *mut std::ffi::c_void, x: i32, z: i32, h: *const std::ffi::c_void) -> *const std::ffi::c_void;
+    fn pmb3_terrain_loaded(t: *const std::ffi::c_void) -> i32;
+    fn pmb3_compound_boxes(boxes: *const Vec3, n: i32, friction: f32) -> *mut std::ffi::c_void;
+    fn pmb3_compound_destroy(c: *mut std::ffi::c_void);
+    fn pmb3_compound_standing(c: *const std::ffi::c_void) -> i32;
+    fn pmb3_body_compound(w: u32, pos: Vec3, c: *const std::ffi::c_void) -> u64;
+    fn pmb3_body_shed_child(body: u64, child: i32);
+    fn pmb3_hull_share(pts: *const Vec3, n: i32) -> *const std::ffi::c_void;
+    fn pmb3_geometry_release(shared: *const std::ffi::c_void);
+    fn pmb3_geometry_count(bytes: *mut i32) -> i32;
+    fn pmb3_hull_cache_count(hits: *mut i32) -> i32;
+    fn pmb3_bench_pair_set(shapes: i32, neighbours: i32, rounds: i32) -> u64;
+    fn pmb3_bench_hull_map(hulls: i32, rounds: i32) -> u64;
+    fn pmb3_snapshot_size(s: *const std::ffi::c_void) -> i32;
+    fn pmb3_snapshot_delta(
+        base: *const std::ffi::c_void,
+        full: *const std::ffi::c_void,
+        delta: *mut std::ffi::c_void,
+    ) -> i32;
+    fn pmb3_snapshot_apply(
+        base: *const std::ffi::c_void,
+        delta: *const std::ffi::c_void,
+        out: *mut std::ffi::c_void,
+    ) -> i32;
 }
 
 /// Opaque Box3D body handle (packed id — Copy, pod-friendly, 8 bytes).
+/// `repr(transparent)` so id slices cross the FFI as `u64` arrays.
 #[derive(Clone, Copy, Debug, PartialEq, Eq, Hash)]
+#[repr(transparent)]
 pub struct BodyId(u64);
 
 /// Opaque Box3D joint handle, packed like [`BodyId`].
 #[derive(Clone, Copy, Debug, PartialEq, Eq, Hash)]
 pub struct JointId(u64);
 
-/// One Box3D world. Owns its handle; drop destroys it. The intended
-/// pm shape is exactly one of these inside a server task (pods in,
-/// poses out) — nothing here is thread-aware because pm tasks aren't.
-pub struct World(u32);
+/// A body name interned once per world by [`World::intern_name`].
+/// Spawns carry the id, so naming every body hashes no string per
+/// spawn; the text is only looked up for debug draw and recordings.
+#[derive(Clone, Copy, Debug, Default, PartialEq, Eq, Hash)]
+pub struct NameId(u32);
 
-/// Box3D's world table is a process-global array scanned WITHOUT locks
-/// (`b3_worlds` in b3CreateWorld) — two threads creating worlds at
-/// once can claim the same slot. Serialize create/destroy here so
-/// multi-threaded TESTS can't race it; game code runs one world on one
-/// thread and never contends. (Stepping/querying different worlds
-/// concurrently remains unsupported — pm tasks aren't threaded.)
-static WORLD_GATE: std::sync::Mutex<()> = std::sync::Mutex::new(());
+impl NameId {
+    /// Unnamed.
+    pub const NONE: NameId = NameId(0);
+}
 
-impl World {
-    pub fn new(gravity: Vec3) -> World {
-        let _gate = WORLD_GATE.lock().unwrap();
-        World(unsafe { pmb3_world_create(gravity.x, gravity.y, gravity.z) })
+/// Batched readback rows, parallel to the id slice handed to
+/// [`World::read_poses`]. Keep one around and reuse it — the vectors
+/// only grow, so steady-state readback allocates nothing.
+#[derive(Clone, Debug, Default)]
+pub struct Poses {
+    pub pos: Vec<Vec3>,
+    pub rot: Vec<Quat>,
+    pub vel: Vec<Vec3>,
+    pub awake: Vec<bool>,
+}
+
+/// One body the last step moved — a row of Box3D's own move-event
+/// buffer, borrowed zero-copy (layout asserted against
+/// `b3BodyMoveEvent` in the shim). Sleeping islands produce no rows,
+/// so a replication walk over [`World::move_events`] costs CPU and
+/// wire in proportion to what is AWAKE, not to what exists.
+#[repr(C)]
+#[derive(Clone, Copy, Debug)]
+pub struct MoveEvent {
+    _user: *mut std::ffi::c_void,
+    pub pos: Vec3,
+    pub rot: Quat,
+    // The packed BodyId, split: it sits 4-byte aligned in the event.
+    body: [u32; 2],
+    /// The body went to sleep this step — its final pose; no rows
+    /// follow until something wakes it.
+    pub fell_asleep: bool,
+}
+
+const _: () = assert!(std::mem::size_of::<MoveEvent>() == 48 && std::mem::offset_of!(MoveEvent, body) == 36);
+
+impl MoveEvent {
+    pub fn body(&self) -> BodyId {
+        BodyId(self.body[0] as u64 | (self.body[1] as u64) << 32)
     }
+}
 
-    /// Advance the world. Box3D wants a FIXED dt (its docs and our
-    /// determinism story agree); substeps 4 is upstream's default.
-    pub fn step(&mut self, dt: f32, substeps: i32) {
-        unsafe { pmb3_world_step(self.0, dt, substeps) }
+/// A shape named by a contact event (packed id, like [`BodyId`]);
+/// [`World::shape_body`] finds its body.
+#[derive(Clone, Copy, Debug, PartialEq, Eq, Hash)]
+pub struct ShapeId(u64);
+
+/// Two shapes that started or stopped touching — a row of Box3D's own
+/// begin/end event buffer, borrowed zero-copy like [`MoveEvent`].
+#[repr(C)]
+#[derive(Clone, Copy, Debug)]
+pub struct ContactTouch {
+    shape_a: [u32; 2],
+    shape_b: [u32; 2],
+    _contact: [u32; 3],
+}
+
+const _: () = assert!(std::mem::size_of::<ContactTouch>() == 28);
+
+impl ContactTouch {
+    pub fn shape_a(&self) -> ShapeId {
+        ShapeId(self.shape_a[0] as u64 | (self.shape_a[1] as u64) << 32)
     }
 
-    /// A box body. `kind`: [`STATIC`], [`KINEMATIC`], or [`DYNAMIC`].
-    pub fn body_box(
-        &mut self,
-        kind: i32,
-        pos: Vec3,
-        rot: Quat,
-        half: Vec3,
-        density: f32,
-        friction: f32,
-    ) -> BodyId {
-        BodyId(unsafe { pmb3_body_box(self.0, kind, pos, rot, half, density, friction) })
+    pub fn shape_b(&self) -> ShapeId {
+        ShapeId(self.shape_b[0] as u64 | (self.shape_b[1] as u64) << 32)
     }
+}
 
-    /// An upright capsule (hemisphere centers at local ±half_h on y) —
-    /// the character/critter shape. `lock_upright` freezes angular x/z
-    /// so it jostles and yaws but never tips over.
-    #[allow(clippy::too_many_arguments)]
-    pub fn body_capsule(
-        &mut self,
-        kind: i32,
-        pos: Vec3,
-        half_h: f32,
-        radius: f32,
-        density: f32,
-        friction: f32,
-        lock_upright: bool,
-    ) -> BodyId {
-        BodyId(unsafe {
-            pmb3_body_capsule(self.0, kind, pos, half_h, radius, density, friction, lock_upright as i32)
-        })
+/// Two shapes that hit faster than the world's hit threshold this step
+/// — the damage/impact-sound row, borrowed zero-copy.
+#[repr(C)]
+#[derive(Clone, Copy, Debug)]
+pub struct ContactHit {
+    shape_a: [u32; 2],
+    shape_b: [u32; 2],
+    _contact: [u32; 3],
+    pub point: Vec3,
+    /// From shape A to shape B.
+    pub normal: Vec3,
+    pub approach_speed: f32,
+    pub material_a: u64,
+    pub material_b: u64,
+}
+
+const _: () = assert!(std::mem::size_of::<ContactHit>() == 72 && std::mem::offset_of!(ContactHit, point) == 28);
+
+impl ContactHit {
+    pub fn shape_a(&self) -> ShapeId {
+        ShapeId(self.shape_a[0] as u64 | (self.shape_a[1] as u64) << 32)
     }
 
-    /// Hard-set the linear velocity (the AI-drive verb for spikes: a
-    /// wander brain writes velocities; the solver makes them contend).
-    pub fn set_velocity(&mut self, body: BodyId, v: Vec3) {
-        unsafe { pmb3_body_set_velocity(body.0, v) }
+    pub fn shape_b(&self) -> ShapeId {
+        ShapeId(self.shape_b[0] as u64 | (self.shape_b[1] as u64) << 32)
     }
+}
 
-    /// Accumulate a force through the center of mass for this step.
-    pub fn force(&mut self, body: BodyId, f: Vec3) {
-        unsafe { pmb3_body_force(body.0, f) }
+/// The contact impulses one opted-in body took in the last step, all
+/// its contacts summed — a row of Box3D's own buffer, borrowed zero-copy.
+#[repr(C)]
+#[derive(Clone, Copy, Debug)]
+pub struct BodyImpact {
+    body: [u32; 2],
+    /// Summed solver normal impulse (N·s). It counts every sub-step's
+    /// solve and relax pass, so it reads about twice the momentum change,
+    /// but it scales with mass and speed: a loaded truck hits harder
+    /// than an empty one at the same speed.
+    pub normal_impulse: f32,
+    /// Fastest approach among the points that pushed, unthresholded.
+    pub max_approach_speed: f32,
+}
+
+const _: () = assert!(std::mem::size_of::<BodyImpact>() == 16);
+
+impl BodyImpact {
+    pub fn body(&self) -> BodyId {
+        BodyId(self.body[0] as u64 | (self.body[1] as u64) << 32)
     }
+}
 
-    /// Linear damping — Box3D worlds have no air, so anything driven
-    /// by a constant force needs damping to reach a steady speed.
-    pub fn set_damping(&mut self, body: BodyId, linear: f32) {
-        unsafe { pmb3_body_set_damping(body.0, linear) }
+/// The last step's contact events, see [`World::contact_events`].
+#[derive(Clone, Copy, Debug)]
+pub struct ContactEvents<'a> {
+    pub begin: &'a [ContactTouch],
+    pub end: &'a [ContactTouch],
+    pub hit: &'a [ContactHit],
+}
+
+/// An event span from the world's buffers; empty buffers may be null.
+unsafe fn borrow_events<'a, T>(p: *const T, n: i32) -> &'a [T] {
+    if n <= 0 || p.is_null() {
+        return &[];
     }
+    unsafe { std::slice::from_raw_parts(p, n as usize) }
+}
 
-    /// Freeze all rotation (controlled-measurement bodies, kinematic
-    /// stand-ins for pm-posed vehicles).
-    pub fn lock_rotation(&mut self, body: BodyId) {
-        unsafe { pmb3_body_lock_rotation(body.0) }
+/// Wire precision of [`World::packed_states`]: positions as a 16-bit
+/// grid cell plus an offset at `position_resolution`, smallest-three
+/// rotation at `rotation_bits` per component, velocity components
+/// clamped to the max speeds at `velocity_resolution`. Errors stay
+/// within half a step. Both ends must use the same one.
+#[derive(Clone, Copy, Debug, PartialEq)]
+pub struct StateQuantization {
+    pub cell_size: f32,
+    pub position_resolution: f32,
+    pub max_linear_speed: f32,
+    pub max_angular_speed: f32,
+    pub velocity_resolution: f32,
+    pub rotation_bits: u32,
+}
+
+impl Default for StateQuantization {
+    /// `b3DefaultStateQuantization`: 64 m cells, ~2 mm, 1/64 m/s.
+    fn default() -> Self {
+        StateQuantization {
+            cell_size: 64.0,
+            position_resolution: 1.0 / 512.0,
+            max_linear_speed: 64.0,
+            max_angular_speed: 32.0,
+            velocity_resolution: 1.0 / 64.0,
+            rotation_bits: 12,
+        }
     }
+}
 
-    /// A convex hull body from up to 64 points in the body's local
-    /// space (statics usually sit at the origin and pass world-space
-    /// points directly). Ramps, chunks, anything authored-convex.
-    pub fn body_hull(
-        &mut self,
-        kind: i32,
-        pos: Vec3,
-        rot: Quat,
-        pts: &[Vec3],
-        density: f32,
-        friction: f32,
-    ) -> BodyId {
-        BodyId(unsafe {
-            pmb3_body_hull(self.0, kind, pos, rot, pts.as_ptr(), pts.len() as i32, density, friction)
-        })
+/// One decoded [`World::packed_states`] record.
+#[derive(Clone, Copy, Debug, Default, PartialEq)]
+pub struct PackedState {
+    pub pos: Vec3,
+    pub rot: Quat,
+    pub vel: Vec3,
+    pub ang_vel: Vec3,
+    pub fell_asleep: bool,
+}
+
+/// A rollback image of one world's simulation state
+/// ([`World::capture`] / [`World::restore`]). Opaque and reusable: the
+/// buffer only grows, so a client capturing every tick allocates
+/// nothing once it has seen its largest frame.
+pub struct Snapshot(*mut std::ffi::c_void);
+
+impl Snapshot {
+    pub fn new() -> Snapshot {
+        Snapshot(unsafe { pmb3_snapshot_create() })
     }
 
-    /// Remove a body (and its shapes) from the world.
-    pub fn destroy(&mut self, body: BodyId) {
-        unsafe { pmb3_body_destroy(body.0) }
+    /// Bytes held — a full image, or a delta's op stream.
+    pub fn len(&self) -> usize {
+        unsafe { pmb3_snapshot_size(self.0) as usize }
     }
 
-    /// Teleport — kinematic mirrors and respawn resets only; regular
-    /// motion should be velocities and forces.
-    pub fn set_pose(&mut self, body: BodyId, pos: Vec3, rot: Quat) {
-        unsafe { pmb3_body_set_pose(body.0, pos, rot) }
+    pub fn is_empty(&self) -> bool {
+        self.len() == 0
     }
 
-    pub fn body_sphere(
-        &mut self,
-        kind: i32,
-        pos: Vec3,
-        radius: f32,
-        density: f32,
-        friction: f32,
-    ) -> BodyId {
-        BodyId(unsafe { pmb3_body_sphere(self.0, kind, pos, radius, density, friction) })
+    /// Re-encode `full` as a delta against the keyframe `base` (bytes
+    /// written; 0 if the two are not captures of the same world and
+    /// topology). The rollback ring keeps one keyframe plus a delta
+    /// per tick: statics, sleepers and the static tree cost nothing
+    /// past the keyframe. A delta cannot be restored directly — see
+    /// [`Snapshot::apply`].
+    pub fn delta(&mut self, base: &Snapshot, full: &Snapshot) -> usize {
+        unsafe { pmb3_snapshot_delta(base.0, full.0, self.0) as usize }
     }
 
-    pub fn set_angular_velocity(&mut self, body: BodyId, v: Vec3) {
-        unsafe { pmb3_body_set_angular_velocity(body.0, v) }
+    /// Expand `delta` against the keyframe it was taken from into a
+    /// full image in `self`, ready for [`World::restore`]. False (and
+    /// `self` untouched) if `base` is not that keyframe.
+    pub fn apply(&mut self, base: &Snapshot, delta: &Snapshot) -> bool {
+        unsafe { pmb3_snapshot_apply(base.0, delta.0, self.0) != 0 }
     }
+}
 
-    pub fn angular_velocity(&self, body: BodyId) -> Vec3 {
-        let mut v = Vec3::default();
-        unsafe { pmb3_body_angular_velocity(body.0, &mut v) };
-        v
+impl Default for Snapshot {
+    fn default() -> Snapshot {
+        Snapshot::new()
     }
+}
 
-    /// A car wheel for a y-up, +z-forward vehicle (axle on x):
-    /// suspension spring toward `mount` on the chassis, spin motor
-    /// capped at `max_torque`. Frame conventions live in the shim.
-    pub fn wheel_joint(
-        &mut self,
-        chassis: BodyId,
-        wheel: BodyId,
-        mount: Vec3,
-        hertz: f32,
-        damping: f32,
-        max_torque: f32,
-    ) -> JointId {
-        JointId(unsafe { pmb3_wheel_joint(self.0, chassis.0, wheel.0, mount, hertz, damping, max_torque) })
+impl Drop for Snapshot {
+    fn drop(&mut self) {
+        unsafe { pmb3_snapshot_destroy(self.0) }
     }
+}
 
-    /// Command the wheel's spin motor speed, rad/s (the throttle verb).
-    pub fn wheel_spin(&mut self, joint: JointId, speed: f32) {
-        unsafe { pmb3_wheel_spin(joint.0, speed) }
+/// One blast for [`World::explode`]: full impulse within `radius`,
+/// fading to nothing `falloff` beyond it. `impulse_per_area` scales
+/// with the shape's area facing the center; negative pulls inward.
+#[repr(C)]
+#[derive(Clone, Copy, Debug, Default, PartialEq)]
+pub struct Explosion {
+    pub position: Vec3,
+    pub radius: f32,
+    pub falloff: f32,
+    pub impulse_per_area: f32,
+}
+
+/// One wind volume for [`World::set_force_fields`]: a world-aligned
+/// box of `extents` half widths around `center`. A dynamic body whose
+/// center of mass is inside is dragged toward the flow, `speed` along
+/// `direction` ([`FIELD_DIRECTIONAL`]), away from the center
+/// ([`FIELD_RADIAL`]) or around `direction` as an axis
+/// ([`FIELD_VORTEX`]), with a force of `drag` times the velocity
+/// difference, so heavy bodies lag the flow.
+#[repr(C)]
+#[derive(Clone, Copy, Debug, Default, PartialEq)]
+pub struct ForceField {
+    pub kind: i32,
+    pub center: Vec3,
+    pub extents: Vec3,
+    pub direction: Vec3,
+    pub speed: f32,
+    pub drag: f32,
+}
+
+/// One vertex of [`World::debug_geometry`], relative to the view
+/// origin. `color` is 0xRRGGBB with a material preset in the high byte.
+#[repr(C)]
+#[derive(Clone, Copy, Debug, Default, PartialEq)]
+pub struct DebugVertex {
+    pub position: Vec3,
+    pub color: u32,
+}
+
+/// One repeated ray's memory for [`World::cast_ray_cached`]: the
+/// shapes near it, so the next cast along nearly the same ray skips the
+/// tree walk while nothing near it moved. Keep one per line of sight.
+pub struct RayCache(*mut std::ffi::c_void);
+
+impl RayCache {
+    pub fn new() -> RayCache {
+        RayCache(unsafe { pmb3_ray_cache_create() })
     }
 
-    pub fn pose(&self, body: BodyId) -> (Vec3, Quat) {
-        let (mut p, mut q) = (Vec3::default(), Quat::default());
-        unsafe { pmb3_body_pose(body.0, &mut p, &mut q) };
-        (p, q)
+    /// Casts so far that walked the broadphase trees rather than
+    /// answering from the cache.
+    pub fn walks(&self) -> usize {
+        unsafe { pmb3_ray_cache_walks(self.0) as usize }
     }
+}
 
-    pub fn velocity(&self, body: BodyId) -> Vec3 {
-        let mut v = Vec3::default();
-        unsafe { pmb3_body_velocity(body.0, &mut v) };
-        v
+impl Default for RayCache {
+    fn default() -> Self {
+        Self::new()
     }
+}
 
-    /// Asleep bodies are the free-bandwidth seam: an entry that stops
-    /// changing stops replicating (pm's change-tick doctrine).
-    pub fn awake(&self, body: BodyId) -> bool {
-        unsafe { pmb3_body_awake(body.0) != 0 }
+impl Drop for RayCache {
+    fn drop(&mut self) {
+        unsafe { pmb3_ray_cache_destroy(self.0) }
     }
+}
 
-    /// Set contact friction on every shape of a body, live (wakes it —
-    /// only contacts formed after the change feel the new value).
-    pub fn set_friction(&mut self, body: BodyId, mu: f32) {
-        unsafe { pmb3_body_set_friction(body.0, mu) }
+/// A join snapshot captured at one tick ([`World::begin_snapshot_stream`])
+/// and handed out in pieces, so the server spreads a big world over
+/// several ticks of bandwidth. The world keeps stepping meanwhile.
+pub struct SnapshotStream(*mut std::ffi::c_void);
+
+impl SnapshotStream {
+    /// Total bytes of the snapshot.
+    pub fn len(&self) -> usize {
+        unsafe { pmb3_snapshot_stream_size(self.0) as usize }
     }
 
-    /// Category/mask bits on every shape of a body. Contact and query
-    /// tests both require the match in BOTH directions: `a.category &
-    /// b.mask` and `b.category & a.mask`.
+    pub fn is_empty(&self) -> bool {
+        self.len() == 0
+    }
+
+    /// Copy the next piece into `buf` (bytes copied, 0 when done) and
+    /// report how much is left.
+    pub fn read(&mut self, buf: &mut [u8]) -> (usize, usize) {
+        let mut remaining = 0;
+        let n = unsafe { pmb3_snapshot_stream_read(self.0, buf.as_mut_ptr(), buf.len() as i32, &mut remaining) };
+        (n as usize, remaining as usize)
+    }
+}
+
+impl Drop for SnapshotStream {
+    fn drop(&mut self) {
+        unsafe { pmb3_snapshot_stream_destroy(self.0) }
+    }
+}
+
+/// A cooked triangle mesh (BVH, welded vertices, edge flags). Cooking
+/// touches no world, so terrain chunks cook on loader threads while
+/// the world steps, and a chunk can spread its own cook over `workers`
+/// threads. The result is the same for any worker count.
+pub struct Mesh(*mut std::ffi::c_void);
+
+unsafe impl Send for Mesh {}
+unsafe impl Sync for Mesh {}
+
+unsafe extern "C" fn mesh_progress(fraction: f32, context: *mut std::ffi::c_void) -> bool {
+    let progress = unsafe { &mut *(context as *mut &mut dyn FnMut(f32) -> bool) };
+    progress(fraction)
+}
+
+impl Mesh {
+    /// Cook `indices` (three per triangle, CCW) over `verts`, welding
+    /// vertices closer than `weld` (0 keeps them all). None if nothing
+    /// survives the degenerate filter.
+    pub fn cook(verts: &[Vec3], indices: &[i32], weld: f32, workers: usize) -> Option<Mesh> {
+        Mesh::cook_with_progress(verts, indices, weld, workers, &mut |_| true)
+    }
+
+    /// [`Mesh::cook`] with the BVH quantized to half-size nodes. Node
+    /// boxes only ever grow, so queries see the same triangles as the
+    /// full-precision mesh for a smaller, more cache-friendly tree —
+    /// the choice for big static terrain.
+    pub fn cook_quantized(verts: &[Vec3], indices: &[i32], weld: f32, workers: usize) -> Option<Mesh> {
+        Mesh::cook_inner(verts, indices, weld, true, workers, &mut |_| true)
+    }
+
+    /// [`Mesh::cook`] reporting progress in [0, 1] between stages, on
+    /// the calling thread. Returning false abandons the cook (None) —
+    /// a streamer drops chunks the player has already left behind.
+    pub fn cook_with_progress(
+        verts: &[Vec3],
+        indices: &[i32],
+        weld: f32,
+        workers: usize,
+        progress: &mut dyn FnMut(f32) -> bool,
+    ) -> Option<Mesh> {
+        Mesh::cook_inner(verts, indices, weld, false, workers, progress)
+    }
+
+    fn cook_inner(
+        verts: &[Vec3],
+        indices: &[i32],
+        weld: f32,
+        quantize: bool,
+        workers: usize,
+        progress: &mut dyn FnMut(f32) -> bool,
+    ) -> Option<Mesh> {
+        let mut progress = progress;
+        let m = unsafe {
+            pmb3_mesh_cook(
+                verts.as_ptr(),
+                verts.len() as i32,
+                indices.as_ptr(),
+                (indices.len() / 3) as i32,
+                weld,
+                quantize,
+                workers as i32,
+                Some(mesh_progress),
+                &mut progress as *mut &mut dyn FnMut(f32) -> bool as *mut std::ffi::c_void,
+            )
+        };
+        if m.is_null() {
+            None
+        } else {
+            Some(Mesh(m))
+        }
+    }
+
+    /// Content hash of the cooked bytes.
+    pub fn hash(&self) -> u32 {
+        unsafe { pmb3_mesh_hash(self.0) }
+    }
+
+    /// Triangles kept after degenerates are dropped.
+    pub fn triangles(&self) -> usize {
+        unsafe { pmb3_mesh_triangle_count(self.0) as usize }
+    }
+
+    /// Closest hit of a ray in the mesh's own frame: (triangle, fraction).
+    pub fn cast_ray(&self, origin: Vec3, translation: Vec3) -> Option<(usize, f32)> {
+        let mut frac = 0.0f32;
+        let triangle = unsafe { pmb3_mesh_cast_ray(self.0, origin, translation, &mut frac) };
+        (triangle >= 0).then_some((triangle as usize, frac))
+    }
+
+    /// The cooked mesh as position-independent bytes — write them out
+    /// at build time and [`MeshView::new`] them back at boot.
+    pub fn bytes(&self) -> &[u8] {
+        let mut count = 0;
+        unsafe {
+            let p = pmb3_mesh_bytes(self.0, &mut count);
+            std::slice::from_raw_parts(p, count as usize)
+        }
+    }
+}
+
+/// A precooked mesh read in place from borrowed bytes (typically a
+/// read-only mmap every match process shares): no parse, no copy, no
+/// allocation. The bytes must be 8-byte aligned.
+pub struct MeshView<'a>(*const std::ffi::c_void, std::marker::PhantomData<&'a [u8]>);
+
+unsafe impl Send for MeshView<'_> {}
+unsafe impl Sync for MeshView<'_> {}
+
+impl<'a> MeshView<'a> {
+    /// None if `bytes` are not a mesh of this build's format (version,
+    /// size, array layout). `verify` also checks the content hash,
+    /// which reads every page.
+    pub fn new(bytes: &'a [u8], verify: bool) -> Option<MeshView<'a>> {
+        let m = unsafe { pmb3_mesh_view(bytes.as_ptr(), bytes.len() as i32, verify) };
+        if m.is_null() {
+            None
+        } else {
+            Some(MeshView(m, std::marker::PhantomData))
+        }
+    }
+
+    pub fn hash(&self) -> u32 {
+        unsafe { pmb3_mesh_hash(self.0) }
+    }
+
+    pub fn triangles(&self) -> usize {
+        unsafe { pmb3_mesh_triangle_count(self.0) as usize }
+    }
+}
+
+impl Drop for Mesh {
+    fn drop(&mut self) {
+        unsafe { pmb3_mesh_destroy(self.0) }
+    }
+}
+
+/// A height field terrain tile: `count_x * count_z` grid points,
+/// row-major along x, spaced by `scale.x` and `scale.z`, heights
+/// multiplied by `scale.y`. Casts walk the grid and skip whole 8x8
+/// cell tiles they pass above or below, so a long hitscan over a
+/// mountain range decodes only the cells near its path.
+pub struct HeightField(*mut std::ffi::c_void);
+
+unsafe impl Send for HeightField {}
+unsafe impl Sync for HeightField {}
+
+impl HeightField {
+    pub fn new(heights: &[f32], count_x: usize, count_z: usize, scale: Vec3) -> HeightField {
+        assert!(count_x >= 2 && count_z >= 2, "at least one cell");
+        assert_eq!(heights.len(), count_x * count_z, "one height per grid point");
+        HeightField(unsafe { pmb3_height_field_create(heights.as_ptr(), count_x as i32, count_z as i32, scale) })
+    }
+
+    /// Closest hit of a sphere (`radius` 0 = a ray) in the height
+    /// field's own frame: (triangle, fraction).
+    pub fn cast(&self, origin: Vec3, translation: Vec3, radius: f32) -> Option<(usize, f32)> {
+        let mut frac = 0.0f32;
+        let triangle = unsafe { pmb3_height_field_cast(self.0, origin, translation, radius, &mut frac) };
+        (triangle >= 0).then_some((triangle as usize, frac))
+    }
+
+    /// Planes pushing a capsule mover (centers `c1`, `c2`) out of the
+    /// terrain: (outward normal, penetration). A flat tile the capsule
+    /// is wholly over gives one plane instead of one per triangle.
+    pub fn mover_planes(&self, c1: Vec3, c2: Vec3, radius: f32) -> Vec<(Vec3, f32)> {
+        let mut out = [0.0f32; 4 * 64];
+        let n = unsafe { pmb3_height_field_mover(self.0, c1, c2, radius, out.as_mut_ptr(), 64) };
+        out[..4 * n as usize].chunks(4).map(|p| (Vec3 { x: p[0], y: p[1], z: p[2] }, p[3])).collect()
+    }
+
+    /// Triangles under a local box, in increasing index order. Tiles
+    /// wholly above or below the box are skipped.
+    pub fn query(&self, lower: Vec3, upper: Vec3) -> Vec<usize> {
+        let mut out = vec![0i32; 256];
+        let mut n = unsafe { pmb3_height_field_query(self.0, lower, upper, out.as_mut_ptr(), 256) };
+        if n > 256 {
+            out.resize(n as usize, 0);
+            n = unsafe { pmb3_height_field_query(self.0, lower, upper, out.as_mut_ptr(), n) };
+        }
+        out[..n as usize].iter().map(|&t| t as usize).collect()
+    }
+}
+
+impl Drop for HeightField {
+    fn drop(&mut self) {
+        unsafe { pmb3_height_field_destroy(self.0) }
+    }
+}
+
+/// Terrain paged in height field tiles around the players. Tile
+/// `(x, z)` spans `width` from `origin + (x * width.0, 0, z * width.1)`;
+/// each loaded tile is one static body, so loading, swapping or
+/// evicting one never touches the rest of the map. The terrain holds
+/// the tiles it shows. Tile changes create and destroy bodies, so they
+/// take the world mutably like every other body door; end it with
+/// [`Terrain::destroy`]. A terrain merely dropped leaks its tiles
+/// rather than reach into a world it cannot borrow.
+pub struct Terrain {
+    ptr: *mut std::ffi::c_void,
+    tiles: Vec<Option<HeightField>>,
+    count_x: usize,
+    world: u32,
+}
+
+unsafe impl Send for Terrain {}
+
+impl Terrain {
+    pub fn new(world: &mut World, origin: Vec3, width: (f32, f32), count: (usize, usize), friction: f32) -> Terrain {
+        let (count_x, count_z) = count;
+        let ptr = unsafe {
+            pmb3_terrain_create(world.0, origin, width.0, width.1, count_x as i32, count_z as i32, friction)
+        };
+        Terrain { ptr, tiles: (0..count_x * count_z).map(|_| None).collect(), count_x, world: world.0 }
+    }
+
+    /// Load, replace or (None) evict tile `(x, z)`, handing back the
+    /// one it showed. A replaced tile keeps its shape; bodies on it wake.
+    pub fn set_tile(&mut self, world: &mut World, x: usize, z: usize, tile: Option<HeightField>) -> Option<HeightField> {
+        assert_eq!(world.0, self.world, "terrain of another world");
+        assert!(x < self.count_x && z < self.tiles.len() / self.count_x, "tile outside the terrain");
+        let data = tile.as_ref().map_or(std::ptr::null(), |h| h.0 as *const std::ffi::c_void);
+        unsafe { pmb3_terrain_set_tile(self.ptr, x as i32, z as i32, data) };
+        std::mem::replace(&mut self.tiles[z * self.count_x + x], tile)
+    }
+
+    pub fn loaded(&self) -> usize {
+        unsafe { pmb3_terrain_loaded(self.ptr) as usize }
+    }
+
+    /// Evict every tile from `world` and free the terrain.
+    pub fn destroy(mut self, world: &mut World) {
+        for i in 0..self.tiles.len() {
+            if self.tiles[i].is_some() {
+                self.set_tile(world, i % self.count_x, i / self.count_x, None);
+            }
+        }
+        unsafe { pmb3_terrain_destroy(self.ptr) };
+        self.ptr = std::ptr::null_mut();
+    }
+}
+
+impl Drop for Terrain {
+    fn drop(&mut self) {
+        // Not destroyed: loaded tile bodies still read their data
+        if !self.ptr.is_null() {
+            std::mem::take(&mut self.tiles).into_iter().for_each(std::mem::forget);
+        }
+    }
+}
+
+/// A destructible prop: box chunks baked into one compound shape, so a
+/// building is one static proxy however many pieces it has. Chunks
+/// shed in place ([`World::shed`]) without a re-cook. Shedding changes
+/// the compound, so each world needs its own; drop it after its body.
+pub struct Compound(*mut std::ffi::c_void);
+
+unsafe impl Send for Compound {}
+
+impl Compound {
+    /// One chunk per `[center, half extents]`, in the prop's space.
+    pub fn boxes(chunks: &[[Vec3; 2]], friction: f32) -> Compound {
+        Compound(unsafe { pmb3_compound_boxes(chunks.as_ptr() as *const Vec3, chunks.len() as i32, friction) })
+    }
+
+    /// Chunks not shed yet.
+    pub fn standing(&self) -> usize {
+        unsafe { pmb3_compound_standing(self.0) as usize }
+    }
+}
+
+impl Drop for Compound {
+    fn drop(&mut self) {
+        unsafe { pmb3_compound_destroy(self.0) }
+    }
+}
+
+/// A convex hull held once for the whole process. Hull bodies built
+/// from the same points in any world ([`World::body_hull`]) borrow
+/// this copy instead of cloning their own, so fifty matches on one
+/// map hold its hulls once. Dropping the handle while worlds still use
+/// the hull is fine; the last user frees it.
+pub struct SharedHull(*const std::ffi::c_void);
+
+unsafe impl Send for SharedHull {}
+unsafe impl Sync for SharedHull {}
+
+impl SharedHull {
+    /// None if the points do not make a hull.
+    pub fn new(pts: &[Vec3]) -> Option<SharedHull> {
+        let h = unsafe { pmb3_hull_share(pts.as_ptr(), pts.len() as i32) };
+        if h.is_null() {
+            None
+        } else {
+            Some(SharedHull(h))
+        }
+    }
+}
+
+impl Drop for SharedHull {
+    fn drop(&mut self) {
+        unsafe { pmb3_geometry_release(self.0) }
+    }
+}
+
+/// Entries and bytes in the process-wide geometry library.
+pub fn shared_geometry() -> (usize, usize) {
+    let mut bytes = 0;
+    let count = unsafe { pmb3_geometry_count(&mut bytes) };
+    (count as usize, bytes as usize)
+}
+
+/// Hulls in the process-wide hull cache and how many hull builds it
+/// has skipped. [`World::body_hull`] and [`SharedHull::new`] go
+/// through it, so respawning the same chunk costs a copy.
+pub fn hull_cache() -> (usize, usize) {
+    let mut hits = 0;
+    let count = unsafe { pmb3_hull_cache_count(&mut hits) };
+    (count as usize, hits as usize)
+}
+
+/// Table benchmark: `shapes` shapes each paired with the next
+/// `neighbours` in the broad-phase pair set, then `rounds` of probing
+/// every candidate with a tenth of the pairs churned. Returns the probe
+/// hits, `rounds * shapes * neighbours`.
+pub fn bench_pair_set(shapes: usize, neighbours: usize, rounds: usize) -> u64 {
+    unsafe { pmb3_bench_pair_set(shapes as i32, neighbours as i32, rounds as i32) }
+}
+
+/// Table benchmark: `hulls` distinct boxes in a hull map, each looked
+/// up `rounds` times. Returns the hits, `hulls * rounds`.
+pub fn bench_hull_map(hulls: usize, rounds: usize) -> u64 {
+    unsafe { pmb3_bench_hull_map(hulls as i32, rounds as i32) }
+}
+
+/// Replays a recording from [`World::stop_recording`] in a fresh world
+/// and checks it reproduces every recorded state hash.
+pub fn replay_is_valid(recording: &[u8]) -> bool {
+    replay_is_valid_with_workers(recording, 1)
+}
+
+/// [`replay_is_valid`] on `workers` threads. Steps split as they do in
+/// a threaded world, and each run of recorded queries is re-checked
+/// across the workers at once — the full-match determinism check.
+pub fn replay_is_valid_with_workers(recording: &[u8], workers: usize) -> bool {
+    let _gate = WORLD_GATE.lock().unwrap();
+    let size = recording.len().min(i32::MAX as usize) as i32;
+    unsafe { pmb3_validate_replay(recording.as_ptr(), size, workers.clamp(1, 32) as i32) != 0 }
+}
+
+/// A recording loaded for playback in a world of its own, to scrub to
+/// the frame where a desync shows up.
+pub struct Replay(*mut std::ffi::c_void);
+
+impl Replay {
+    /// None when the bytes are not a recording this build can play.
+    pub fn new(recording: &[u8]) -> Option<Replay> {
+        let _gate = WORLD_GATE.lock().unwrap();
+        let player = unsafe { pmb3_replay_create(recording.as_ptr(), recording.len().min(i32::MAX as usize) as i32) };
+        (!player.is_null()).then(|| Replay(player))
+    }
+
+    /// Frames played so far.
+    pub fn frame(&self) -> usize {
+        unsafe { pmb3_replay_frame(self.0) as usize }
+    }
+
+    pub fn frame_count(&self) -> usize {
+        unsafe { pmb3_replay_frame_count(self.0) as usize }
+    }
+
+    /// Jumps to `frame` from the nearest keyframe before it. With the
+    /// keyframes of [`World::start_recording`] that replays at most one
+    /// keyframe interval, in either direction.
+    pub fn seek(&mut self, frame: usize) {
+        unsafe { pmb3_replay_seek(self.0, frame.min(i32::MAX as usize) as i32) }
+    }
+
+    /// Plays one frame; false once the recording has ended.
+    pub fn step(&mut self) -> bool {
+        unsafe { pmb3_replay_step(self.0) != 0 }
+    }
+
+    /// Whether a replayed frame missed its recorded state hash.
+    pub fn has_diverged(&self) -> bool {
+        unsafe { pmb3_replay_diverged(self.0) != 0 }
+    }
+
+    /// Bytes of keyframes the player captured itself while playing.
+    pub fn keyframe_bytes(&self) -> usize {
+        unsafe { pmb3_replay_keyframe_bytes(self.0) as usize }
+    }
+
+    /// Play for step timing: recorded queries and state hashes are
+    /// skipped, so [`Replay::profile`] reads what the live step cost and
+    /// [`Replay::has_diverged`] stays false whatever happens.
+    pub fn set_timing(&mut self, on: bool) {
+        unsafe { pmb3_replay_set_timing(self.0, on as i32) }
+    }
+
+    /// Threads for the replay world (1 at creation), clamped to 1..=32.
+    pub fn set_workers(&mut self, workers: usize) {
+        unsafe { pmb3_replay_set_workers(self.0, workers.clamp(1, 32) as i32) }
+    }
+
+    /// The last played frame's stage times, as [`World::profile`].
+    pub fn profile(&self) -> [f32; STEP_PROFILE.len()] {
+        let mut out = [0f32; STEP_PROFILE.len()];
+        unsafe { pmb3_world_profile(pmb3_replay_world(self.0), out.as_mut_ptr()) };
+        out
+    }
+
+    /// The last played frame's counters, as [`World::counters`].
+    pub fn counters(&self) -> [i32; COUNTERS.len()] {
+        let mut out = [0i32; COUNTERS.len()];
+        let n = unsafe { pmb3_world_counters(pmb3_replay_world(self.0), out.as_mut_ptr()) };
+        assert_eq!(n as usize, COUNTERS.len(), "COUNTERS is out of step with pmb3_world_counters");
+        out
+    }
+}
+
+impl Drop for Replay {
+    fn drop(&mut self) {
+        let _gate = WORLD_GATE.lock().unwrap();
+        unsafe { pmb3_replay_destroy(self.0) }
+    }
+}
+
+/// A worker pool that steps many worlds in one call — a world per
+/// match plus rollback scratch worlds, packed onto one machine. Each
+/// world still steps single-threaded and bit-identically to
+/// [`World::step`]; the pool spreads WHOLE worlds over cores with one
+/// wake per batch, instead of every small world paying per-stage
+/// thread wake/join latency inside its own step.
+pub struct Stepper(*mut std::ffi::c_void, Vec<u32>);
+
+impl Stepper {
+    /// `threads` background workers; the caller of [`Stepper::step`]
+    /// works too, so `threads + 1` worlds step at once.
+    pub fn new(threads: usize) -> Stepper {
+        Stepper(unsafe { pmb3_stepper_create(threads as i32) }, Vec::new())
+    }
+
+    pub fn step(&mut self, worlds: &mut [&mut World], dt: f32, substeps: i32) {
+        // `&mut` makes the worlds distinct — the pool's one precondition.
+        self.1.clear();
+        self.1.extend(worlds.iter().map(|w| w.0));
+        unsafe { pmb3_worlds_step(self.0, self.1.as_ptr(), self.1.len() as i32, dt, substeps) }
+    }
+
+    /// Step `worlds` on the background threads WHILE `host_work` runs
+    /// on this one (replication encoding for the last tick, say), and
+    /// return its result once both are done. The mid-step rule is the
+    /// borrow: the stepping worlds are `&mut`-held for the whole call,
+    /// so nothing can query them; everything else is free. With no
+    /// background threads this degrades to step-then-work.
+    pub fn step_while<R>(
+        &mut self,
+        worlds: &mut [&mut World],
+        dt: f32,
+        substeps: i32,
+        host_work: impl FnOnce() -> R,
+    ) -> R {
+        self.1.clear();
+        self.1.extend(worlds.iter().map(|w| w.0));
+        unsafe { pmb3_worlds_step_begin(self.0, self.1.as_ptr(), self.1.len() as i32, dt, substeps) };
+        // Joined on unwind too: the ids and worlds must outlive the step.
+        struct Join(*mut std::ffi::c_void);
+        impl Drop for Join {
+            fn drop(&mut self) {
+                unsafe { pmb3_worlds_step_wait(self.0) }
+            }
+        }
+        let _join = Join(self.0);
+        host_work()
+    }
+}
+
+impl Drop for Stepper {
+    fn drop(&mut self) {
+        unsafe { pmb3_stepper_destroy(self.0) }
+    }
+}
+
+/// Heap bytes a world holds, by subsystem ([`World::memory_stats`]).
+/// Container capacities, so allocated rather than used; containers only
+/// grow, so most fields are their own peak. `b3MemoryStats` exactly.
+#[repr(C)]
+#[derive(Clone, Copy, Debug, Default, PartialEq)]
+pub struct MemoryStats {
+    pub bodies: u64,
+    pub shapes: u64,
+    pub sensors: u64,
+    pub contacts: u64,
+    pub joints: u64,
+    pub islands: u64,
+    pub constraint_graph: u64,
+    pub broad_phase_trees: u64,
+    pub pair_set: u64,
+    /// Scratch arenas, the world's and one per worker.
+    pub arenas: u64,
+    pub manifold_blocks: u64,
+    /// Hulls this world owns; library hulls belong to no world.
+    pub hulls: u64,
+    /// Zero unless recording.
+    pub recording: u64,
+    /// Id pools, task contexts, events, debug draw sets.
+    pub other: u64,
+    pub total: u64,
+    /// Largest `total` measured on this world so far.
+    pub peak_total: u64,
+    /// All-time peak scratch demand over the arenas, overflow included.
+    pub peak_arenas: u64,
+}
+
+/// One body's rewindable state for the island-scoped rollback
+/// ([`World::capture_bodies`]). Velocities read zero while asleep.
+#[repr(C)]
+#[derive(Clone, Copy, Debug, Default, PartialEq)]
+pub struct BodyState {
+    pub pos: Vec3,
+    pub rot: Quat,
+    pub vel: Vec3,
+    pub spin: Vec3,
+}
+
+/// A capsule character for [`World::move_capsules`]: hemisphere
+/// centers `c1`, `c2` relative to `pos`, wanting to move `delta` this
+/// tick. `vel` comes back clipped by whatever stopped it.
+#[repr(C)]
+#[derive(Clone, Copy, Debug, Default, PartialEq)]
+pub struct Mover {
+    pub pos: Vec3,
+    pub c1: Vec3,
+    pub c2: Vec3,
+    pub radius: f32,
+    pub delta: Vec3,
+    pub vel: Vec3,
+}
+
+/// Where a [`Mover`] ended up, its clipped velocity, and how many
+/// collision planes touch it there (0 = airborne).
+#[repr(C)]
+#[derive(Clone, Copy, Debug, Default, PartialEq)]
+pub struct MoverResult {
+    pub pos: Vec3,
+    pub vel: Vec3,
+    pub planes: i32,
+}
+
+/// Touching contacts by solver path ([`World::solver_paths`]).
+#[derive(Clone, Copy, Debug, Default, PartialEq, Eq)]
+pub struct SolverPaths {
+    /// SIMD convex path, 4/8/16 contacts per wide constraint.
+    pub wide: usize,
+    /// Scalar manifold path inside the graph colors (mesh and
+    /// height-field contacts; pm makes none).
+    pub scalar: usize,
+    /// Overflow color: scalar, one thread per independent group.
+    pub overflow: usize,
+    /// Groups the overflow split into (no shared body between them);
+    /// 1 means it ran on one thread.
+    pub overflow_groups: usize,
+}
+
+/// The last step's continuous collision ([`World::continuous`]).
+#[derive(Clone, Copy, Debug, Default, PartialEq)]
+pub struct Continuous {
+    /// Fast non-bullet bodies, swept against statics.
+    pub fast: usize,
+    /// Of those, left unswept by [`World::set_continuous_budget`].
+    pub skipped: usize,
+    /// Fast bullets, swept against everything after the others.
+    pub bullets: usize,
+    /// Sweeps that moved a body back to its time of impact.
+    pub impacts: usize,
+    /// Static shapes the sweeps' boxes overlapped.
+    pub candidates: usize,
+    /// Of those, turned away by the swept sphere test before the time
+    /// of impact solver ran.
+    pub rejected: usize,
+    /// Time the non-bullet sweeps took.
+    pub ms: f32,
+}
+
+/// The solver stages [`World::detailed_profile`] breaks out, in solver
+/// order; [`WorkerProfile::stages`] is indexed the same way.
+pub const PROFILE_STAGES: [&str; 15] = [
+    "prepare_joints",
+    "prepare_wide_contacts",
+    "prepare_contacts",
+    "integrate_velocities",
+    "warm_start",
+    "solve",
+    "integrate_positions",
+    "relax",
+    "restitution",
+    "store_wide_impulses",
+    "store_impulses",
+    "overflow_warm_start",
+    "overflow_solve",
+    "overflow_relax",
+    "overflow_restitution",
+];
+
+/// The step stages [`World::profile`] times, in `b3Profile` field
+/// order. Nested: `solve` contains `constraints`, which contains the
+/// solver passes, so the entries do not sum to `step`.
+pub const STEP_PROFILE: [&str; 24] = [
+    "step",
+    "pairs",
+    "collide",
+    "solve",
+    "solver_setup",
+    "constraints",
+    "prepare_constraints",
+    "integrate_velocities",
+    "warm_start",
+    "solve_impulses",
+    "integrate_positions",
+    "relax_impulses",
+    "apply_restitution",
+    "store_impulses",
+    "split_islands",
+    "transforms",
+    "sensor_hits",
+    "joint_events",
+    "hit_events",
+    "refit",
+    "bullets",
+    "continuous",
+    "sleep_islands",
+    "sensors",
+];
+
+/// The scalar `b3Counters` [`World::counters`] reads, in order.
+pub const COUNTERS: [&str; 33] = [
+    "bodies",
+    "shapes",
+    "contacts",
+    "joints",
+    "islands",
+    "stack_used",
+    "arena_capacity",
+    "static_tree_height",
+    "tree_height",
+    "sat_calls",
+    "sat_cache_hits",
+    "bytes",
+    "tasks",
+    "awake_contacts",
+    "recycled_contacts",
+    "rested_contacts",
+    "overflow_groups",
+    "continuous_bodies",
+    "continuous_skips",
+    "bullet_bodies",
+    "time_of_impacts",
+    "continuous_candidates",
+    "continuous_rejects",
+    "woken_bodies",
+    "deferred_wakes",
+    "revived_contacts",
+    "split_islands",
+    "skipped_sensors",
+    "step_heap_allocations",
+    "distance_iterations",
+    "push_back_iterations",
+    "root_iterations",
+    "relax_iterations",
+];
+
+/// One kept step of [`World::profile_history`].
+#[derive(Clone, Debug, PartialEq)]
+pub struct ProfileFrame {
+    /// The world's step index after the step.
+    pub step: u64,
+    /// Indexed like [`STEP_PROFILE`].
+    pub profile: [f32; STEP_PROFILE.len()],
+    /// Indexed like [`COUNTERS`].
+    pub counters: [i32; COUNTERS.len()],
+}
+
+/// Nearest-rank percentiles of every [`STEP_PROFILE`] stage over the
+/// kept frames ([`World::profile_summary`]), each stage ranked on its
+/// own: the p99 of `solve` need not come from the p99 `step`.
+#[derive(Clone, Debug, Default, PartialEq)]
+pub struct ProfileSummary {
+    pub frames: usize,
+    pub p50: [f32; STEP_PROFILE.len()],
+    pub p95: [f32; STEP_PROFILE.len()],
+    pub p99: [f32; STEP_PROFILE.len()],
+    pub max: [f32; STEP_PROFILE.len()],
+}
+
+/// One partitioned step stage's granularity ([`World::grain_tuning`]).
+#[derive(Clone, Debug, PartialEq)]
+pub struct GrainStage {
+    /// The stage's parallel-for name, or `solver` for the solver's blocks.
+    pub name: String,
+    /// Block sizes scale by 2^level from the built-in ones.
+    pub level: i32,
+    /// Still timing the levels in turn.
+    pub exploring: bool,
+    /// Median ns per item at levels -2..=2, 0 where not measured.
+    pub cost: [f32; 5],
+}
+
+/// The slowest step over the hitch threshold ([`World::hitch`]).
+#[derive(Clone, Debug, PartialEq)]
+pub struct Hitch {
+    /// The world's step index after the slow step.
+    pub step: u64,
+    pub profile: [f32; STEP_PROFILE.len()],
+    pub dt: f32,
+    pub substeps: i32,
+    /// A join snapshot taken just before the slow step: load it with
+    /// [`World::load_snapshot`] and step `dt`, `substeps` to run the
+    /// hitch again under a profiler.
+    pub snapshot: Vec<u8>,
+}
+
+/// One worker's share of one solver stage over a step, summed over its
+/// colors, iterations and substeps.
+#[derive(Clone, Copy, Debug, Default, PartialEq)]
+pub struct StageTiming {
+    /// Sweeping the stage's blocks and running the claimed ones.
+    pub busy_ms: f32,
+    /// Idle at the stage's barrier: worker 0 waiting for the others to
+    /// finish, the others waiting for worker 0 to publish the next stage.
+    pub wait_ms: f32,
+    pub blocks: usize,
+}
+
+/// One solver worker's last step ([`World::detailed_profile`]).
+#[derive(Clone, Debug, Default, PartialEq)]
+pub struct WorkerProfile {
+    pub stages: [StageTiming; PROFILE_STAGES.len()],
+    /// All spinning for work, including before the first stage.
+    pub spin_wait_ms: f32,
+}
+
+type TaskFn = unsafe extern "C" fn(*mut std::ffi::c_void);
+type EnqueueFn = unsafe extern "C" fn(
+    TaskFn,
+    *mut std::ffi::c_void,
+    *mut std::ffi::c_void,
+    *const std::ffi::c_char,
+) -> *mut std::ffi::c_void;
+type FinishFn = unsafe extern "C" fn(*mut std::ffi::c_void, *mut std::ffi::c_void);
+
+/// One Box3D stage slice, handed to a [`TaskHost`] to run exactly once
+/// on any thread.
+pub struct Job {
+    task: TaskFn,
+    ctx: *mut std::ffi::c_void,
+}
+
+// The context is Box3D's per-task block, built for another thread to run.
+unsafe impl Send for Job {}
+
+impl Job {
+    pub fn run(self) {
+        unsafe { (self.task)(self.ctx) }
+    }
+}
+
+/// A host job system that runs a world's stages ([`World::hosted`]),
+/// so physics is jobs in the host's pool — overlapping whatever else
+/// the pool runs (replication encoding) — instead of a second pool of
+/// Box3D threads fighting it for cores.
+pub trait TaskHost: Send + Sync {
+    /// Queue `job`; the returned ticket goes back to [`TaskHost::wait`].
+    fn spawn(&self, job: Job) -> u64;
+    /// Block until the ticket's job has run. The stepping thread waits
+    /// here on jobs it spawned, so a pool that parks the waiter without
+    /// running other jobs can deadlock — help, don't just block.
+    fn wait(&self, ticket: u64);
+}
+
+unsafe extern "C" fn host_enqueue(
+    task: TaskFn,
+    ctx: *mut std::ffi::c_void,
+    host: *mut std::ffi::c_void,
+    _name: *const std::ffi::c_char,
+) -> *mut std::ffi::c_void {
+    let host = unsafe { &*(host as *const std::sync::Arc<dyn TaskHost>) };
+    // Ticket + 1: a null task tells Box3D the job already ran.
+    (host.spawn(Job { task, ctx }) as usize + 1) as *mut std::ffi::c_void
+}
+
+unsafe extern "C" fn host_finish(ticket: *mut std::ffi::c_void, host: *mut std::ffi::c_void) {
+    let host = unsafe { &*(host as *const std::sync::Arc<dyn TaskHost>) };
+    host.wait(ticket as u64 - 1);
+}
+
+type TraceFn = unsafe extern "C" fn(*const std::ffi::c_char, i32, *mut std::ffi::c_void);
+
+/// A profiler's view of the step ([`World::set_tracer`]). Box3D calls
+/// `begin` and `end` around each step stage (`"collide"`, `"refit"`),
+/// each worker's sweep of a solver stage (`"warm start"`), each
+/// parallel-for block (under the parallel-for's name) and, on a
+/// [`World::with_workers`] pool, each task. Both run on the thread
+/// doing the work and nest per thread; `worker` is Box3D's worker
+/// index, 0 on the stepping thread. Keep them cheap: a solver stage
+/// fires once per worker per sub-step.
+pub trait Tracer: Send + Sync {
+    fn begin(&self, zone: &'static str, worker: usize);
+    fn end(&self, zone: &'static str, worker: usize);
+}
+
+// Zone names are string literals in the vendored C (the scheduler
+// keeps them past the enqueue, so they have to be), hence 'static.
+unsafe fn zone_name(name: *const std::ffi::c_char) -> &'static str {
+    let name = unsafe { std::ffi::CStr::from_ptr(name) }.to_str().unwrap_or("?");
+    unsafe { &*(name as *const str) }
+}
+
+unsafe extern "C" fn trace_begin(name: *const std::ffi::c_char, worker: i32, tracer: *mut std::ffi::c_void) {
+    let tracer = unsafe { &*(tracer as *const std::sync::Arc<dyn Tracer>) };
+    tracer.begin(unsafe { zone_name(name) }, worker as usize);
+}
+
+unsafe extern "C" fn trace_end(name: *const std::ffi::c_char, worker: i32, tracer: *mut std::ffi::c_void) {
+    let tracer = unsafe { &*(tracer as *const std::sync::Arc<dyn Tracer>) };
+    tracer.end(unsafe { zone_name(name) }, worker as usize);
+}
+
+/// One [`TraceLog`] entry: a zone opening or closing.
+#[derive(Clone, Copy, Debug, PartialEq)]
+pub struct TraceEvent {
+    pub zone: &'static str,
+    pub worker: usize,
+    /// Small per-process thread number, in order of first event.
+    pub thread: u32,
+    pub begin: bool,
+    /// Since the log was created.
+    pub micros: f64,
+}
+
+/// A [`Tracer`] that timestamps every zone into memory, for a tick
+/// trace in Perfetto or chrome://tracing ([`TraceLog::chrome_json`]).
+/// The game's own scopes can go in the same log through the trait, so
+/// physics stages land interleaved with the rest of the tick. One lock
+/// per event: a diagnostic, not something to leave on.
+pub struct TraceLog {
+    start: std::time::Instant,
+    events: std::sync::Mutex<Vec<TraceEvent>>,
+}
+
+impl TraceLog {
+    pub fn new() -> TraceLog {
+        TraceLog { start: std::time::Instant::now(), events: std::sync::Mutex::new(Vec::new()) }
+    }
+
+    fn push(&self, zone: &'static str, worker: usize, begin: bool) {
+        static NEXT_THREAD: std::sync::atomic::AtomicU32 = std::sync::atomic::AtomicU32::new(1);
+        thread_local! {
+            static THREAD: u32 = NEXT_THREAD.fetch_add(1, std::sync::atomic::Ordering::Relaxed);
+        }
+        let micros = self.start.elapsed().as_secs_f64() * 1e6;
+        let thread = THREAD.with(|t| *t);
+        self.events.lock().unwrap().push(TraceEvent { zone, worker, thread, begin, micros });
+    }
+
+    /// Takes the events so far, in the order they were logged.
+    pub fn drain(&self) -> Vec<TraceEvent> {
+        std::mem::take(&mut *self.events.lock().unwrap())
+    }
+
+    /// Takes the events as a Trace Event Format document (`B`/`E`
+    /// pairs, one track per thread), which Perfetto opens as is.
+    pub fn chrome_json(&self) -> String {
+        use std::fmt::Write as _;
+        let mut out = String::from("{\"traceEvents\":[");
+        for (i, e) in self.drain().iter().enumerate() {
+            write!(
+                out,
+                "{}\n{{\"name\":\"{}\",\"ph\":\"{}\",\"ts\":{:.3},\"pid\":1,\"tid\":{},\"args\":{{\"worker\":{}}}}}",
+                if i == 0 { "" } else { "," },
+                e.zone,
+                if e.begin { "B" } else { "E" },
+                e.micros,
+                e.thread,
+                e.worker
+            )
+            .unwrap();
+        }
+        out.push_str("\n]}\n");
+        out
+    }
+}
+
+impl Default for TraceLog {
+    fn default() -> TraceLog {
+        TraceLog::new()
+    }
+}
+
+impl Tracer for TraceLog {
+    fn begin(&self, zone: &'static str, worker: usize) {
+        self.push(zone, worker, true);
+    }
+
+    fn end(&self, zone: &'static str, worker: usize) {
+        self.push(zone, worker, false);
+    }
+}
+
+/// The CPUs of NUMA node `node` as `(cpus, first_cpu)` for
+/// [`World::pinned`], read from Linux sysfs. Keeps the node's first 64
+/// CPUs counting from its lowest; None off Linux or for a missing node.
+pub fn numa_node_cpus(node: usize) -> Option<(u64, usize)> {
+    let list = std::fs::read_to_string(format!("/sys/devices/system/node/node{node}/cpulist")).ok()?;
+    let mut cpus = Vec::new();
+    for range in list.trim().split(',').filter(|r| !r.is_empty()) {
+        let (lo, hi) = range.split_once('-').unwrap_or((range, range));
+        cpus.extend(lo.parse::<usize>().ok()?..=hi.parse::<usize>().ok()?);
+    }
+    let first = *cpus.iter().min()?;
+    let mask = cpus.iter().filter(|&&c| c - first < 64).fold(0u64, |m, &c| m | 1 << (c - first));
+    Some((mask, first))
+}
+
+/// One Box3D world. Owns its handle; drop destroys it. The intended
+/// pm shape is exactly one of these inside a server task (pods in,
+/// poses out) — nothing here is thread-aware because pm tasks aren't.
+/// A [`World::hosted`] world also owns its task host, which Box3D
+/// calls back into from every step.
+pub struct World(
+    u32,
+    // Never read here — held so the host outlives Box3D's pointer to it.
+    #[allow(dead_code)] Option<Box<std::sync::Arc<dyn TaskHost>>>,
+    // Likewise the tracer, swapped by set_tracer.
+    Option<Box<std::sync::Arc<dyn Tracer>>>,
+);
+
+/// Box3D's world table is a process-global array scanned WITHOUT locks
+/// (`b3_worlds` in b3CreateWorld) — two threads creating worlds at
+/// once can claim the same slot. Serialize create/destroy here so
+/// multi-threaded TESTS can't race it; game code runs one world on one
+/// thread and never contends. Stepping DIFFERENT worlds concurrently is
+/// fine (they share no mutable engine state) — that is [`Stepper`].
+static WORLD_GATE: std::sync::Mutex<()> = std::sync::Mutex::new(());
+
+impl World {
+    pub fn new(gravity: Vec3) -> World {
+        let _gate = WORLD_GATE.lock().unwrap();
+        World(unsafe { pmb3_world_create(gravity.x, gravity.y, gravity.z) }, None, None)
+    }
+
+    /// A world that steps on Box3D's own worker pool (`workers` threads
+    /// counting the caller) — for one large world. Results match a
+    /// serial world bit for bit.
+    pub fn with_workers(gravity: Vec3, workers: usize) -> World {
+        let _gate = WORLD_GATE.lock().unwrap();
+        World(unsafe { pmb3_world_create_threaded(gravity.x, gravity.y, gravity.z, workers as i32) }, None, None)
+    }
+
+    /// A threaded world bound to CPU `first_cpu + i` for each set bit i
+    /// of `cpus` (see [`numa_node_cpus`]): its workers run there and its
+    /// memory is allocated there, so a multi-match host keeps each world
+    /// on one NUMA node. Step it from a thread on that node too. Linux
+    /// and Windows; elsewhere this is [`World::with_workers`].
+    pub fn pinned(gravity: Vec3, workers: usize, cpus: u64, first_cpu: usize) -> World {
+        let _gate = WORLD_GATE.lock().unwrap();
+        let id = unsafe { pmb3_world_create_pinned(gravity.x, gravity.y, gravity.z, workers as i32, cpus, first_cpu as i32) };
+        World(id, None, None)
+    }
+
+    /// A world whose stages run as jobs on `host`, split `workers` ways.
+    /// Results match a serial world bit for bit.
+    pub fn hosted(gravity: Vec3, workers: usize, host: std::sync::Arc<dyn TaskHost>) -> World {
+        let _gate = WORLD_GATE.lock().unwrap();
+        // Boxed so the address Box3D holds stays put when World moves.
+        let host = Box::new(host);
+        let ctx = &*host as *const std::sync::Arc<dyn TaskHost> as *mut std::ffi::c_void;
+        let id = unsafe {
+            pmb3_world_create_hosted(gravity.x, gravity.y, gravity.z, workers as i32, host_enqueue, host_finish, ctx)
+        };
+        World(id, Some(host), None)
+    }
+
+    /// A world whose contact solver runs at most `simd_width` lanes (0:
+    /// 8 with AVX2; 16: AVX-512 too, opt-in; 4: the SSE2/NEON path).
+    /// Results match a default world bit for bit at any width.
+    pub fn with_simd_width(gravity: Vec3, simd_width: usize) -> World {
+        let _gate = WORLD_GATE.lock().unwrap();
+        World(unsafe { pmb3_world_create_simd(gravity.x, gravity.y, gravity.z, simd_width as i32) }, None, None)
+    }
+
+    /// A world that keeps its dynamic bodies in a uniform grid of
+    /// `cell_size` cells (0: 2 m) rather than a tree — for crowds of
+    /// similar sized bodies. Statics and kinematics stay in trees.
+    pub fn with_grid(gravity: Vec3, workers: usize, cell_size: f32) -> World {
+        let _gate = WORLD_GATE.lock().unwrap();
+        World(unsafe { pmb3_world_create_grid(gravity.x, gravity.y, gravity.z, workers as i32, cell_size) }, None, None)
+    }
+
+    /// Lanes the contact solver picked for this world actually runs.
+    pub fn simd_width(&self) -> usize {
+        unsafe { pmb3_world_simd_width(self.0) as usize }
+    }
+
+    /// How the last step's touching contacts split across the solver's
+    /// paths — the check that a scene stays on the wide one.
+    pub fn solver_paths(&self) -> SolverPaths {
+        let (mut wide, mut scalar, mut overflow, mut groups) = (0, 0, 0, 0);
+        unsafe { pmb3_world_solver_paths(self.0, &mut wide, &mut scalar, &mut overflow, &mut groups) };
+        SolverPaths {
+            wide: wide as usize,
+            scalar: scalar as usize,
+            overflow: overflow as usize,
+            overflow_groups: groups as usize,
+        }
+    }
+
+    /// Grow the broad-phase ahead of a spawn wave so adding this many
+    /// shapes does not reallocate it mid-wave.
+    pub fn reserve(&mut self, static_shapes: usize, dynamic_shapes: usize) {
+        unsafe { pmb3_world_reserve(self.0, static_shapes as i32, dynamic_shapes as i32) }
+    }
+
+    /// Node capacity of the broad-phase tree for one body type.
+    pub fn tree_capacity(&self, kind: i32) -> usize {
+        unsafe { pmb3_world_tree_capacity(self.0, kind) as usize }
+    }
+
+    /// Peak step scratch since creation or the last `set_scratch_reserve`:
+    /// `(bytes of the busiest worker's contact arena, bytes of the world arena)`.
+    pub fn scratch_demand(&self) -> (usize, usize) {
+        let (mut arena, mut world) = (0, 0);
+        unsafe { pmb3_world_scratch_demand(self.0, &mut arena, &mut world) };
+        (arena as usize, world as usize)
+    }
+
+    /// Resize the step scratch to exactly these bytes (0 leaves one as is).
+    /// Feed back `scratch_demand` from a representative run and the step
+    /// stays off the heap.
+    pub fn set_scratch_reserve(&mut self, arena_bytes: usize, world_arena_bytes: usize) {
+        unsafe { pmb3_world_set_scratch_reserve(self.0, arena_bytes as i32, world_arena_bytes as i32) }
+    }
+
+    /// Heap allocations the last step's scratch allocators made. Zero in
+    /// steady state once the reserve covers the demand.
+    pub fn step_heap_count(&self) -> usize {
+        unsafe { pmb3_world_step_heap_count(self.0) as usize }
+    }
+
+    /// Heap bytes the world holds, by subsystem. Walks islands, sensors
+    /// and hulls: sample it on a timer, not every step.
+    pub fn memory_stats(&self) -> MemoryStats {
+        let mut stats = MemoryStats::default();
+        unsafe { pmb3_world_memory_stats(self.0, &mut stats) };
+        stats
+    }
+
+    /// Give the heap back what a larger past left behind: arrays shrink
+    /// to fit, free id tails go, empty manifold blocks go, trees shrink,
+    /// worker arenas drop to their reserve. Copies about `byte_budget` bytes per call (0: no limit)
+    /// and returns true once a whole pass is done; call it between
+    /// rounds until it does. Peers must compact on the same steps.
+    pub fn compact(&mut self, byte_budget: usize) -> bool {
+        unsafe { pmb3_world_compact(self.0, byte_budget.min(i32::MAX as usize) as i32) }
+    }
+
+    /// Keep the contact manifolds of sleeping islands compressed, one
+    /// block per island, restored when it wakes. Bodies and joints stay
+    /// put, so queries on settled props cost the same. Reading a sleeping
+    /// contact unpacks its island until the next step. Results are
+    /// bit-identical, so peers may differ; [`World::compact`] returns the
+    /// freed manifold blocks to the heap.
+    pub fn set_sleep_packing(&mut self, on: bool) {
+        unsafe { pmb3_world_set_sleep_packing(self.0, on) }
+    }
+
+    /// Regroup the awake bodies by island and position every `interval`
+    /// steps (0: never, the default) so the contact solver reads them
+    /// mostly in order. Deterministic, and snapshots replay it exactly,
+    /// but it does change the trajectory: every peer must agree on it.
+    pub fn set_body_reorder_interval(&mut self, interval: usize) {
+        unsafe { pmb3_world_set_body_reorder(self.0, interval.min(i32::MAX as usize) as i32) }
+    }
+
+    /// Re-color the constraint graph every `interval` steps (0: never,
+    /// the default) so the colors come out even and the single-threaded
+    /// overflow small. Changes solve order, so every peer must agree.
+    pub fn set_graph_balance_interval(&mut self, interval: usize) {
+        unsafe { pmb3_world_set_graph_balance(self.0, interval.min(i32::MAX as usize) as i32) }
+    }
+
+    /// Motion (meters, over both bodies) under which a touching contact
+    /// keeps last step's manifold without an update; 0 always updates.
+    /// Defaults to a tenth of the linear slop. Changes the trajectory
+    /// within the slop, so every peer must agree.
+    pub fn set_contact_rest_distance(&mut self, distance: f32) {
+        unsafe { pmb3_world_set_contact_rest(self.0, distance) }
+    }
+
+    /// Allow up to `max` relax iterations per sub-step (1 to 8, default
+    /// 1), ending early once a pass changed no contact's normal speed by
+    /// more than `tolerance` m/s; 0 runs all `max`. A settled pile stops
+    /// after one, an active one spends the rest. `relax_iterations` in
+    /// [`World::counters`] shows what ran. Changes the trajectory, so
+    /// every peer must agree; snapshots and recordings carry it.
+    pub fn set_relax_iterations(&mut self, max: usize, tolerance: f32) {
+        unsafe { pmb3_world_set_relax(self.0, max.min(i32::MAX as usize) as i32, tolerance) }
+    }
+
+    /// Last step's touching contacts that took a shortcut: recycled
+    /// (manifold shifted by the relative motion) and rested (kept as is).
+    pub fn contact_reuse(&self) -> (usize, usize) {
+        let (mut recycled, mut rested) = (0, 0);
+        unsafe { pmb3_world_contact_reuse(self.0, &mut recycled, &mut rested) };
+        (recycled as usize, rested as usize)
+    }
+
+    /// Last step's hull pair separating axis queries and how many the
+    /// cached feature answered without a full query.
+    pub fn sat_cache(&self) -> (usize, usize) {
+        let (mut calls, mut hits) = (0, 0);
+        unsafe { pmb3_world_sat_cache(self.0, &mut calls, &mut hits) };
+        (calls as usize, hits as usize)
+    }
+
+    /// Constraints in each graph color as of the last step, overflow
+    /// last.
+    pub fn color_counts(&self) -> Vec<usize> {
+        let mut out = [0i32; 32];
+        let n = unsafe { pmb3_world_color_counts(self.0, out.as_mut_ptr()) } as usize;
+        out[..n].iter().map(|&c| c as usize).collect()
+    }
+
+    /// The last step's stage times in milliseconds, indexed like
+    /// [`STEP_PROFILE`]. Always on, unlike the detailed profile.
+    pub fn profile(&self) -> [f32; STEP_PROFILE.len()] {
+        let mut out = [0f32; STEP_PROFILE.len()];
+        unsafe { pmb3_world_profile(self.0, out.as_mut_ptr()) };
+        out
+    }
+
+    /// The last step's counters, indexed like [`COUNTERS`].
+    pub fn counters(&self) -> [i32; COUNTERS.len()] {
+        let mut out = [0i32; COUNTERS.len()];
+        let n = unsafe { pmb3_world_counters(self.0, out.as_mut_ptr()) };
+        assert_eq!(n as usize, COUNTERS.len(), "COUNTERS is out of step with pmb3_world_counters");
+        out
+    }
+
+    /// Keep the profile and counters of the last `frames` steps (0
+    /// turns it off); resizing drops what was kept. Costs a copy per
+    /// step, cheap next to the step.
+    pub fn keep_profile_history(&mut self, frames: usize) {
+        unsafe { pmb3_world_enable_profile_history(self.0, frames as i32) }
+    }
+
+    /// The kept frames, oldest first.
+    pub fn profile_history(&self) -> Vec<ProfileFrame> {
+        let cap = unsafe { pmb3_world_profile_history(self.0, std::ptr::null_mut(), std::ptr::null_mut(), std::ptr::null_mut(), 0) }
+            as usize;
+        let mut steps = vec![0u64; cap];
+        let mut profiles = vec![[0f32; STEP_PROFILE.len()]; cap];
+        let mut counters = vec![[0i32; COUNTERS.len()]; cap];
+        let n = unsafe {
+            pmb3_world_profile_history(
+                self.0,
+                steps.as_mut_ptr(),
+                profiles.as_mut_ptr().cast(),
+                counters.as_mut_ptr().cast(),
+                cap as i32,
+            )
+        } as usize;
+        (0..n).map(|i| ProfileFrame { step: steps[i], profile: profiles[i], counters: counters[i] }).collect()
+    }
+
+    /// p50/p95/p99/max of each stage over the kept frames; all zero
+    /// before the first kept step.
+    pub fn profile_summary(&self) -> ProfileSummary {
+        let mut out = [0f32; 4 * STEP_PROFILE.len()];
+        let frames = unsafe { pmb3_world_profile_summary(self.0, out.as_mut_ptr()) } as usize;
+        let part = |i: usize| out[i * STEP_PROFILE.len()..(i + 1) * STEP_PROFILE.len()].try_into().unwrap();
+        ProfileSummary { frames, p50: part(0), p95: part(1), p99: part(2), max: part(3) }
+    }
+
+    /// Arm the hitch capture for steps slower than `ms` (0 disarms and
+    /// frees it); re-arming forgets the kept hitch. While armed every
+    /// step first writes a join snapshot into a reused buffer, so it
+    /// costs [`World::save_snapshot`] per step: arm it to hunt a hitch,
+    /// not in a shipping build.
+    pub fn set_hitch_threshold(&mut self, ms: f32) {
+        unsafe { pmb3_world_set_hitch_threshold(self.0, ms) }
+    }
+
+    /// The slowest step over the threshold since it was armed.
+    pub fn hitch(&self) -> Option<Hitch> {
+        let mut h = Hitch { step: 0, profile: [0.0; STEP_PROFILE.len()], dt: 0.0, substeps: 0, snapshot: Vec::new() };
+        let size = unsafe { pmb3_world_hitch(self.0, &mut h.step, h.profile.as_mut_ptr(), &mut h.dt, &mut h.substeps) };
+        if size <= 0 {
+            return None;
+        }
+        h.snapshot = vec![0u8; size as usize];
+        let n = unsafe { pmb3_world_copy_hitch(self.0, h.snapshot.as_mut_ptr(), size) };
+        (n == size).then_some(h)
+    }
+
+    /// Let each partitioned stage time its block sizes and keep the
+    /// cheapest on this machine; the step stays bit-identical, only the
+    /// partitioning changes. Needs two or more workers. Toggling it
+    /// forgets what was measured.
+    pub fn set_grain_tuning(&mut self, on: bool) {
+        unsafe { pmb3_world_set_grain_tuning(self.0, on) }
+    }
+
+    /// Each stage tuned so far, in the order the step first ran them.
+    pub fn grain_tuning(&self) -> Vec<GrainStage> {
+        let mut names = [std::ptr::null(); 16];
+        let (mut levels, mut exploring, mut costs) = ([0i32; 16], [false; 16], [[0f32; 5]; 16]);
+        let n = unsafe {
+            pmb3_world_grain_tuning(self.0, names.as_mut_ptr(), levels.as_mut_ptr(), exploring.as_mut_ptr(), costs.as_mut_ptr().cast(), 16)
+        } as usize;
+        (0..n)
+            .map(|i| GrainStage {
+                name: unsafe { std::ffi::CStr::from_ptr(names[i]) }.to_string_lossy().into_owned(),
+                level: levels[i],
+                exploring: exploring[i],
+                cost: costs[i],
+            })
+            .collect()
+    }
+
+    /// Send the step's zones to `tracer` from the next step on; None
+    /// stops them. A [`World::hosted`] world's tasks go to its host,
+    /// which names its own jobs; the rest is traced the same.
+    pub fn set_tracer(&mut self, tracer: Option<std::sync::Arc<dyn Tracer>>) {
+        match tracer {
+            Some(tracer) => {
+                // Boxed so the address Box3D holds stays put when World moves.
+                let tracer = Box::new(tracer);
+                let ctx = &*tracer as *const std::sync::Arc<dyn Tracer> as *mut std::ffi::c_void;
+                unsafe { pmb3_world_set_trace(self.0, Some(trace_begin), Some(trace_end), ctx) };
+                self.2 = Some(tracer);
+            }
+            None => {
+                unsafe { pmb3_world_set_trace(self.0, None, None, std::ptr::null_mut()) };
+                self.2 = None;
+            }
+        }
+    }
+
+    /// Time every solver stage per worker from the next step on (off by
+    /// default; it reads the clock around each stage). Tells a step
+    /// bound by work from one bound by the barriers between stages.
+    pub fn set_detailed_profile(&mut self, on: bool) {
+        unsafe { pmb3_world_set_detailed_profile(self.0, on) }
+    }
+
+    /// The last step's per-worker stage timing, one entry per solver
+    /// worker; empty unless [`World::set_detailed_profile`] is on.
+    pub fn detailed_profile(&self) -> Vec<WorkerProfile> {
+        const STAGES: usize = PROFILE_STAGES.len();
+        const SLOTS: usize = 32 * STAGES;
+        let (mut busy, mut wait, mut blocks, mut spin) = ([0f32; SLOTS], [0f32; SLOTS], [0i32; SLOTS], [0f32; 32]);
+        let n = unsafe {
+            pmb3_world_detailed_profile(self.0, busy.as_mut_ptr(), wait.as_mut_ptr(), blocks.as_mut_ptr(), spin.as_mut_ptr())
+        } as usize;
+        (0..n)
+            .map(|i| WorkerProfile {
+                stages: std::array::from_fn(|j| {
+                    let k = i * STAGES + j;
+                    StageTiming { busy_ms: busy[k], wait_ms: wait[k], blocks: blocks[k] as usize }
+                }),
+                spin_wait_ms: spin[i],
+            })
+            .collect()
+    }
+
+    /// Rebuild the static tree for query quality once the level's statics
+    /// are placed, and flatten it into the 4-wide tree that pair finding,
+    /// CCD, sensors, ray casts and overlaps walk for statics.
+    pub fn rebuild_static_tree(&mut self) {
+        unsafe { pmb3_world_rebuild_static_tree(self.0) }
+    }
+
+    /// Re-sort up to `budget` boxes of the static tree per step, only
+    /// where statics created or moved since the last build grew it badly
+    /// (0, the default: never). Spreads streaming a level in over steps
+    /// instead of one [`World::rebuild_static_tree`] hitch. Re-sorting
+    /// changes pair order, so every peer must agree on the budget.
+    pub fn set_static_rebuild_budget(&mut self, budget: usize) {
+        unsafe { pmb3_world_set_static_rebuild_budget(self.0, budget.min(i32::MAX as usize) as i32) }
+    }
+
+    /// Sweep at most `budget` fast non-bullet bodies per step (0, the
+    /// default: all). A hit that flings a crowd at once would otherwise
+    /// sweep every one of them; over the budget the bodies that moved
+    /// farthest for their size keep their sweep and the rest move to
+    /// their end pose, caught by speculative contacts as with continuous
+    /// collision off. A count rather than a time limit so the result
+    /// does not depend on the machine, but it changes trajectories, so
+    /// every peer must agree on it.
+    pub fn set_continuous_budget(&mut self, budget: usize) {
+        unsafe { pmb3_world_set_continuous_budget(self.0, budget.min(i32::MAX as usize) as i32) }
+    }
+
+    /// The last step's continuous collision counts and time.
+    pub fn continuous(&self) -> Continuous {
+        let (mut fast, mut skipped, mut bullets, mut impacts) = (0, 0, 0, 0);
+        let (mut candidates, mut rejected, mut ms) = (0, 0, 0.0f32);
+        unsafe {
+            pmb3_world_continuous(
+                self.0,
+                &mut fast,
+                &mut skipped,
+                &mut bullets,
+                &mut impacts,
+                &mut candidates,
+                &mut rejected,
+                &mut ms,
+            )
+        };
+        Continuous {
+            fast: fast as usize,
+            skipped: skipped as usize,
+            bullets: bullets as usize,
+            impacts: impacts as usize,
+            candidates: candidates as usize,
+            rejected: rejected as usize,
+            ms,
+        }
+    }
+
+    /// Caps the sleeping bodies that new contacts wake per step, 0 for
+    /// no cap. Over the cap, the sleeping islands hit deepest wake first
+    /// and the rest stay asleep, their contacts retrying next step, so
+    /// an impact into a large sleeping pile spreads its wake over a few
+    /// steps. The first island always wakes. Deterministic, but it
+    /// changes trajectories, so every peer must agree on it.
+    pub fn set_wake_budget(&mut self, budget: usize) {
+        unsafe { pmb3_world_set_wake_budget(self.0, budget.min(i32::MAX as usize) as i32) }
+    }
+
+    /// Last step's contact wakes: sleeping bodies woken, and sleeping
+    /// islands the wake budget held back.
+    pub fn wakes(&self) -> (usize, usize) {
+        let (mut woken, mut deferred) = (0, 0);
+        unsafe { pmb3_world_wakes(self.0, &mut woken, &mut deferred) };
+        (woken as usize, deferred as usize)
+    }
+
+    /// Steps a contact whose shapes drifted apart is kept, 0 for none
+    /// (the default). A contact between the same shapes within that many
+    /// steps starts from the old one's collision cache and warm-start
+    /// impulses, so crowd edges that flicker in and out of contact settle
+    /// faster. Not part of snapshots. Deterministic, but it changes
+    /// trajectories, so every peer must agree on it.
+    pub fn set_contact_revive(&mut self, steps: usize) {
+        unsafe { pmb3_world_set_contact_revive(self.0, steps.min(i32::MAX as usize) as i32) }
+    }
+
+    /// Contacts revived in the last step.
+    pub fn revived_contacts(&self) -> usize {
+        unsafe { pmb3_world_revived_contacts(self.0) as usize }
+    }
+
+    /// Islands split per step when they keep bodies from sleeping, at
+    /// least 1 (the default). The sleepiest goes first, then the others
+    /// in island order. Deterministic, but it changes when islands fall
+    /// asleep, so every peer must agree on it.
+    pub fn set_island_split_budget(&mut self, budget: usize) {
+        unsafe { pmb3_world_set_island_split_budget(self.0, budget.min(i32::MAX as usize) as i32) }
+    }
+
+    /// Islands split in the last step.
+    pub fn split_islands(&self) -> usize {
+        unsafe { pmb3_world_split_islands(self.0) as usize }
+    }
+
+    /// The static tree's height and area ratio (internal node area over
+    /// the root's, lower queries faster).
+    pub fn static_tree(&self) -> (usize, f32) {
+        let mut ratio = 0.0f32;
+        let height = unsafe { pmb3_world_static_tree(self.0, &mut ratio) };
+        (height as usize, ratio)
+    }
+
+    /// Shape pairs with a contact and the slots of the set tracking them.
+    /// The set grows with a spawn wave and shrinks once it is gone.
+    pub fn pair_set(&self) -> (usize, usize) {
+        let mut capacity = 0;
+        let count = unsafe { pmb3_world_pair_set(self.0, &mut capacity) };
+        (count as usize, capacity as usize)
+    }
+
+    /// Walk statics through the wide tree (the default) or the binary
+    /// one. Results match either way; this exists to compare the two.
+    pub fn set_wide_static_tree(&mut self, on: bool) {
+        unsafe { pmb3_world_set_wide_static_tree(self.0, on) }
+    }
+
+    /// Advance the world. Box3D wants a FIXED dt (its docs and our
+    /// determinism story agree); substeps 4 is upstream's default.
+    pub fn step(&mut self, dt: f32, substeps: i32) {
+        unsafe { pmb3_world_step(self.0, dt, substeps) }
+    }
+
+    /// A box body. `kind`: [`STATIC`], [`KINEMATIC`], or [`DYNAMIC`].
+    pub fn body_box(
+        &mut self,
+        kind: i32,
+        pos: Vec3,
+        rot: Quat,
+        half: Vec3,
+        density: f32,
+        friction: f32,
+    ) -> BodyId {
+        BodyId(unsafe { pmb3_body_box(self.0, kind, pos, rot, half, density, friction) })
+    }
+
+    /// An upright capsule (hemisphere centers at local ±half_h on y) —
+    /// the character/critter shape. `lock_upright` freezes angular x/z
+    /// so it jostles and yaws but never tips over.
+    #[allow(clippy::too_many_arguments)]
+    pub fn body_capsule(
+        &mut self,
+        kind: i32,
+        pos: Vec3,
+        half_h: f32,
+        radius: f32,
+        density: f32,
+        friction: f32,
+        lock_upright: bool,
+    ) -> BodyId {
+        BodyId(unsafe {
+            pmb3_body_capsule(self.0, kind, pos, half_h, radius, density, friction, lock_upright as i32, 0)
+        })
+    }
+
+    /// A wave of [`body_capsule`](Self::body_capsule)s, one per position,
+    /// created as one batch: the broad-phase tree is built once for the
+    /// whole wave instead of once per body. Ids come back in `pos` order.
+    #[allow(clippy::too_many_arguments)]
+    pub fn bodies_capsule(
+        &mut self,
+        kind: i32,
+        pos: &[Vec3],
+        half_h: f32,
+        radius: f32,
+        density: f32,
+        friction: f32,
+        lock_upright: bool,
+    ) -> Vec<BodyId> {
+        self.bodies_capsule_named(NameId::NONE, kind, pos, half_h, radius, density, friction, lock_upright)
+    }
+
+    /// [`bodies_capsule`](Self::bodies_capsule) with every body named
+    /// `name` — the debug-build hog wave.
+    #[allow(clippy::too_many_arguments)]
+    pub fn bodies_capsule_named(
+        &mut self,
+        name: NameId,
+        kind: i32,
+        pos: &[Vec3],
+        half_h: f32,
+        radius: f32,
+        density: f32,
+        friction: f32,
+        lock_upright: bool,
+    ) -> Vec<BodyId> {
+        let mut out = vec![0u64; pos.len()];
+        unsafe {
+            pmb3_bodies_capsule(
+                self.0,
+                kind,
+                pos.as_ptr(),
+                pos.len() as i32,
+                half_h,
+                radius,
+                density,
+                friction,
+                lock_upright as i32,
+                name.0,
+                out.as_mut_ptr(),
+            )
+        }
+        out.into_iter().map(BodyId).collect()
+    }
+
+    /// Intern `name` for [`bodies_capsule_named`](Self::bodies_capsule_named):
+    /// the string is hashed and copied once here, not per spawn. The id
+    /// is only valid on this world; empty or NUL-containing names give
+    /// [`NameId::NONE`].
+    pub fn intern_name(&mut self, name: &str) -> NameId {
+        let Ok(c) = std::ffi::CString::new(name) else {
+            return NameId::NONE;
+        };
+        NameId(unsafe { pmb3_world_intern_name(self.0, c.as_ptr()) })
+    }
+
+    /// The body's name, "" when unnamed. Debug tooling only — it looks
+    /// the interned string up and copies it.
+    pub fn body_name(&self, body: BodyId) -> String {
+        let p = unsafe { pmb3_body_name(body.0) };
+        if p.is_null() {
+            return String::new();
+        }
+        unsafe { std::ffi::CStr::from_ptr(p) }.to_string_lossy().into_owned()
+    }
+
+    /// Hard-set the linear velocity (the AI-drive verb for spikes: a
+    /// wander brain writes velocities; the solver makes them contend).
+    pub fn set_velocity(&mut self, body: BodyId, v: Vec3) {
+        unsafe { pmb3_body_set_velocity(body.0, v) }
+    }
+
+    /// Accumulate a force through the center of mass for this step.
+    pub fn force(&mut self, body: BodyId, f: Vec3) {
+        unsafe { pmb3_body_force(body.0, f) }
+    }
+
+    /// Linear damping — Box3D worlds have no air, so anything driven
+    /// by a constant force needs damping to reach a steady speed.
+    pub fn set_damping(&mut self, body: BodyId, linear: f32) {
+        unsafe { pmb3_body_set_damping(body.0, linear) }
+    }
+
+    /// Freeze all rotation (controlled-measurement bodies, kinematic
+    /// stand-ins for pm-posed vehicles).
+    pub fn lock_rotation(&mut self, body: BodyId) {
+        unsafe { pmb3_body_lock_rotation(body.0) }
+    }
+
+    /// Sub-steps this body needs per step, 0 for all of them. A body's
+    /// island runs on every n-th sub-step with an n times longer one,
+    /// n sized for the island's most demanding body, so a field of
+    /// settled props can take 1 while the trucks take 4.
+    pub fn set_substep_hint(&mut self, body: BodyId, hint: usize) {
+        unsafe { pmb3_body_set_substep_hint(body.0, hint as i32) }
+    }
+
+    /// Step this body's island only every `period`-th step (up to 8),
+    /// with a `period` times longer step; 0 or 1 for every step. The
+    /// island takes its shortest period, so anything touching a body on
+    /// a faster one is stepped with it, and islands on a period take
+    /// turns so their cost spreads over the steps.
+    pub fn set_step_period(&mut self, body: BodyId, period: usize) {
+        unsafe { pmb3_body_set_step_period(body.0, period as i32) }
+    }
+
+    /// [`set_step_period`](Self::set_step_period) for every dynamic body
+    /// touching the box `lower..upper` — a far region of the map.
+    /// Returns how many changed.
+    pub fn set_region_step_period(&mut self, lower: Vec3, upper: Vec3, period: usize) -> usize {
+        unsafe { pmb3_world_set_region_step_period(self.0, lower, upper, period as i32) as usize }
+    }
+
+    /// A convex hull body from up to 64 points in the body's local
+    /// space (statics usually sit at the origin and pass world-space
+    /// points directly). Ramps, chunks, anything authored-convex.
+    pub fn body_hull(
+        &mut self,
+        kind: i32,
+        pos: Vec3,
+        rot: Quat,
+        pts: &[Vec3],
+        density: f32,
+        friction: f32,
+    ) -> BodyId {
+        BodyId(unsafe {
+            pmb3_body_hull(self.0, kind, pos, rot, pts.as_ptr(), pts.len() as i32, density, friction)
+        })
+    }
+
+    /// Remove a body (and its shapes) from the world.
+    pub fn destroy(&mut self, body: BodyId) {
+        unsafe { pmb3_body_destroy(body.0) }
+    }
+
+    /// [`destroy`](Self::destroy) for a batch — corpse cleanup. Contacts
+    /// between two of them wake neither and the proxies leave the trees
+    /// together.
+    pub fn destroy_many(&mut self, bodies: &[BodyId]) {
+        unsafe { pmb3_bodies_destroy(bodies.as_ptr() as *const u64, bodies.len() as i32) }
+    }
+
+    /// Teleport — kinematic mirrors and respawn resets only; regular
+    /// motion should be velocities and forces.
+    pub fn set_pose(&mut self, body: BodyId, pos: Vec3, rot: Quat) {
+        unsafe { pmb3_body_set_pose(body.0, pos, rot) }
+    }
+
+    /// A cast-only hitbox: a box only queries see. It never contacts
+    /// anything or trips a sensor and costs the solver nothing per
+    /// step. Keeps its kind for life (no [`set_type`](Self::set_type));
+    /// move it with [`set_query_poses`](Self::set_query_poses).
+    pub fn body_query_box(&mut self, pos: Vec3, rot: Quat, half: Vec3, category: u64, mask: u64) -> BodyId {
+        BodyId(unsafe { pmb3_body_query_box(self.0, pos, rot, half, category, mask) })
+    }
+
+    /// Pose a batch of [`body_query_box`](Self::body_query_box) mirrors
+    /// in one call: a tree leaf update each at most, with no wake, no
+    /// contact touched and no pair search.
+    pub fn set_query_poses(&mut self, bodies: &[BodyId], positions: &[Vec3], rotations: &[Quat]) {
+        assert!(bodies.len() == positions.len() && bodies.len() == rotations.len(), "one pose per body");
+        unsafe {
+            pmb3_bodies_set_query_pose(
+                bodies.as_ptr() as *const u64,
+                positions.as_ptr(),
+                rotations.as_ptr(),
+                bodies.len() as i32,
+            )
+        }
+    }
+
+    /// Keep the last `depth` recorded ticks of every body opted in with
+    /// [`set_history`](Self::set_history), for casts at a past tick
+    /// (lag compensation). 0 drops the history; a new depth starts it
+    /// empty.
+    pub fn enable_history(&mut self, depth: usize) {
+        unsafe { pmb3_world_enable_history(self.0, depth as i32) }
+    }
+
+    /// Record the history bodies' poses as of `tick` (the game's clock).
+    /// Call once per tick after the step.
+    pub fn record_history(&mut self, tick: u32) {
+        unsafe { pmb3_world_record_history(self.0, tick) }
+    }
+
+    /// Opt `body` in or out of the pose history. Opting out keeps its
+    /// recorded poses castable until the ring has moved past them.
+    pub fn set_history(&mut self, body: BodyId, flag: bool) {
+        unsafe { pmb3_body_enable_history(body.0, flag as i32) }
+    }
+
+    /// Cast a sphere (`radius` 0: a ray) against the history bodies as
+    /// they stood at the newest recorded tick at or before `tick`. None
+    /// on a miss or when `tick` is older than the ring.
+    pub fn cast_at_tick(
+        &self,
+        tick: u32,
+        origin: Vec3,
+        radius: f32,
+        translation: Vec3,
+        mask: u64,
+    ) -> Option<(BodyId, Vec3, f32)> {
+        let (mut body, mut point, mut frac) = (0u64, Vec3::default(), 0f32);
+        let hit = unsafe {
+            pmb3_world_cast_at_tick(self.0, tick, origin, radius, translation, mask, &mut body, &mut point, &mut frac)
+        };
+        (hit != 0).then_some((BodyId(body), point, frac))
+    }
+
+    pub fn body_sphere(
+        &mut self,
+        kind: i32,
+        pos: Vec3,
+        radius: f32,
+        density: f32,
+        friction: f32,
+    ) -> BodyId {
+        BodyId(unsafe { pmb3_body_sphere(self.0, kind, pos, radius, density, friction) })
+    }
+
+    pub fn set_angular_velocity(&mut self, body: BodyId, v: Vec3) {
+        unsafe { pmb3_body_set_angular_velocity(body.0, v) }
+    }
+
+    pub fn angular_velocity(&self, body: BodyId) -> Vec3 {
+        let mut v = Vec3::default();
+        unsafe { pmb3_body_angular_velocity(body.0, &mut v) };
+        v
+    }
+
+    /// A car wheel for a y-up, +z-forward vehicle (axle on x):
+    /// suspension spring toward `mount` on the chassis, spin motor
+    /// capped at `max_torque`. Frame conventions live in the shim.
+    pub fn wheel_joint(
+        &mut self,
+        chassis: BodyId,
+        wheel: BodyId,
+        mount: Vec3,
+        hertz: f32,
+        damping: f32,
+        max_torque: f32,
+    ) -> JointId {
+        JointId(unsafe { pmb3_wheel_joint(self.0, chassis.0, wheel.0, mount, hertz, damping, max_torque) })
+    }
+
+    /// [`World::wheel_joint`] for a vehicle: all of a chassis's vehicle
+    /// wheels are solved together as one block instead of fighting each
+    /// other over the chassis, so a truck holds together at fewer substeps.
+    pub fn vehicle_wheel_joint(
+        &mut self,
+        chassis: BodyId,
+        wheel: BodyId,
+        mount: Vec3,
+        hertz: f32,
+        damping: f32,
+        max_torque: f32,
+    ) -> JointId {
+        JointId(unsafe { pmb3_vehicle_wheel_joint(self.0, chassis.0, wheel.0, mount, hertz, damping, max_torque) })
+    }
+
+    /// Command the wheel's spin motor speed, rad/s (the throttle verb).
+    pub fn wheel_spin(&mut self, joint: JointId, speed: f32) {
+        unsafe { pmb3_wheel_spin(joint.0, speed) }
+    }
+
+    pub fn pose(&self, body: BodyId) -> (Vec3, Quat) {
+        let (mut p, mut q) = (Vec3::default(), Quat::default());
+        unsafe { pmb3_body_pose(body.0, &mut p, &mut q) };
+        (p, q)
+    }
+
+    pub fn velocity(&self, body: BodyId) -> Vec3 {
+        let mut v = Vec3::default();
+        unsafe { pmb3_body_velocity(body.0, &mut v) };
+        v
+    }
+
+    /// Asleep bodies are the free-bandwidth seam: an entry that stops
+    /// changing stops replicating (pm's change-tick doctrine).
+    pub fn awake(&self, body: BodyId) -> bool {
+        unsafe { pmb3_body_awake(body.0) != 0 }
+    }
+
+    /// Pose, velocity, and awake flag for every body in `bodies`, in ONE
+    /// FFI crossing (the per-tick solver→pod readback). Rows align with
+    /// `bodies`; a stale id reads as identity/zero/asleep rather than
+    /// panicking. Returns how many ids were live.
+    pub fn read_poses(&self, bodies: &[BodyId], out: &mut Poses) -> usize {
+        let n = bodies.len();
+        out.pos.resize(n, Vec3::default());
+        out.rot.resize(n, Quat::default());
+        out.vel.resize(n, Vec3::default());
+        out.awake.resize(n, false);
+        // BodyId is a transparent u64 newtype in memory; bool rows are
+        // written as 0/1 bytes only, which is a valid Rust bool.
+        unsafe {
+            pmb3_bodies_read_poses(
+                self.0,
+                bodies.as_ptr() as *const u64,
+                n as i32,
+                out.pos.as_mut_ptr(),
+                out.rot.as_mut_ptr(),
+                out.vel.as_mut_ptr(),
+                out.awake.as_mut_ptr() as *mut u8,
+            ) as usize
+        }
+    }
+
+    /// Hard-set linear velocity on every body in `bodies` (rows of `vs`)
+    /// in one crossing — the crowd-AI write-in. Each sleeping island a
+    /// nonzero row touches wakes once; all-zero rows never wake.
+    pub fn set_velocities(&mut self, bodies: &[BodyId], vs: &[Vec3]) {
+        assert_eq!(bodies.len(), vs.len(), "one velocity per body");
+        unsafe {
+            pmb3_bodies_set_velocity(self.0, bodies.as_ptr() as *const u64, vs.as_ptr(), bodies.len() as i32)
+        }
+    }
+
+    /// Accumulate a center force on every body in `bodies` for the next
+    /// step, in one crossing. Same wake rule as [`World::set_velocities`].
+    pub fn forces(&mut self, bodies: &[BodyId], fs: &[Vec3]) {
+        assert_eq!(bodies.len(), fs.len(), "one force per body");
+        unsafe { pmb3_bodies_force(self.0, bodies.as_ptr() as *const u64, fs.as_ptr(), bodies.len() as i32) }
+    }
+
+    /// Re-pick each body's simulation level of detail from its distance
+    /// to the nearest of `viewers`: [`LOD_FULL`] inside `near`,
+    /// [`LOD_REDUCED`] (one sub-step, frictionless contacts) out to
+    /// `far`, [`LOD_DEAD_RECKONED`] (kinematic, coasting) beyond. A
+    /// level only coarsens `margin` past its edge, so a body pacing
+    /// along one doesn't flip every tick. `levels` is the caller's row
+    /// per body, all `LOD_FULL` for fresh bodies; a sleeping body goes
+    /// no coarser than reduced. Returns how many changed.
+    pub fn update_lod(
+        &mut self,
+        bodies: &[BodyId],
+        levels: &mut [u8],
+        viewers: &[Vec3],
+        near: f32,
+        far: f32,
+        margin: f32,
+    ) -> usize {
+        assert_eq!(bodies.len(), levels.len(), "one level per body");
+        unsafe {
+            pmb3_bodies_update_lod(
+                self.0,
+                bodies.as_ptr() as *const u64,
+                levels.as_mut_ptr(),
+                bodies.len() as i32,
+                viewers.as_ptr(),
+                viewers.len() as i32,
+                near,
+                far,
+                margin,
+            ) as usize
+        }
+    }
+
+    /// Every body the last [`World::step`] moved, with its new pose —
+    /// the dirty-only readback/replication stream. Borrowed from the
+    /// world's event buffer (no copy); the borrow ends before anything
+    /// that could rewrite it (step, destroy) can run.
+    pub fn move_events(&self) -> &[MoveEvent] {
+        let mut n = 0i32;
+        let p = unsafe { pmb3_world_move_events(self.0, &mut n) };
+        if n == 0 || p.is_null() {
+            return &[];
+        }
+        unsafe { std::slice::from_raw_parts(p, n as usize) }
+    }
+
+    /// Have the step report begin/end touch events for contacts with a
+    /// shape in `touch` categories and hit events for those with a shape
+    /// in `hit` categories. Off (0, 0) by default, so a crowd's contacts
+    /// cost nothing in events until the categories that matter opt in.
+    /// A contact takes its touch setting when it is created. Shapes left
+    /// on the default category (every bit) match any categories.
+    pub fn set_contact_events(&mut self, touch: u64, hit: u64) {
+        unsafe { pmb3_world_set_contact_events(self.0, touch, hit) }
+    }
+
+    /// The last step's contact events, borrowed from the world's event
+    /// buffers (no copy) like [`World::move_events`].
+    pub fn contact_events(&self) -> ContactEvents<'_> {
+        let (mut begins, mut ends, mut hits) = (std::ptr::null(), std::ptr::null(), std::ptr::null());
+        let (mut nb, mut ne, mut nh) = (0i32, 0i32, 0i32);
+        unsafe {
+            pmb3_world_contact_events(self.0, &mut begins, &mut nb, &mut ends, &mut ne, &mut hits, &mut nh);
+            ContactEvents { begin: borrow_events(begins, nb), end: borrow_events(ends, ne), hit: borrow_events(hits, nh) }
+        }
+    }
+
+    /// Sum the contact impulses on `body` each step into one
+    /// [`BodyImpact`], for damage without per-contact events.
+    pub fn set_impacts(&mut self, body: BodyId, flag: bool) {
+        unsafe { pmb3_body_enable_impacts(body.0, flag as i32) }
+    }
+
+    /// The last step's impacts, one per opted-in body something pushed,
+    /// borrowed like [`World::move_events`].
+    pub fn body_impacts(&self) -> &[BodyImpact] {
+        let mut n = 0i32;
+        unsafe { borrow_events(pmb3_world_body_impacts(self.0, &mut n), n) }
+    }
+
+    /// The body of an event's shape; None once the shape is destroyed.
+    pub fn shape_body(&self, shape: ShapeId) -> Option<BodyId> {
+        let body = unsafe { pmb3_shape_body(shape.0) };
+        (body != 0).then_some(BodyId(body))
+    }
+
+    /// Pack every moved body into a fixed-size wire record during the
+    /// step itself (see [`StateQuantization`]); `None` stops packing.
+    pub fn set_state_quantization(&mut self, q: Option<&StateQuantization>) {
+        let q = q.copied().unwrap_or(StateQuantization { cell_size: 0.0, ..Default::default() });
+        unsafe {
+            pmb3_world_set_state_quantization(
+                self.0,
+                q.cell_size,
+                q.position_resolution,
+                q.max_linear_speed,
+                q.max_angular_speed,
+                q.velocity_resolution,
+                q.rotation_bits.min(i32::MAX as u32) as i32,
+            )
+        }
+    }
+
+    /// The last step's packed records and their stride: record `i`
+    /// (bytes `i * stride..`) is [`World::move_events`] row `i`, ready
+    /// to send. Borrowed like the move events.
+    pub fn packed_states(&self) -> (&[u8], usize) {
+        let (mut stride, mut n) = (0i32, 0i32);
+        let p = unsafe { pmb3_world_packed_states(self.0, &mut stride, &mut n) };
+        if n == 0 || p.is_null() {
+            return (&[], stride as usize);
+        }
+        (unsafe { std::slice::from_raw_parts(p, (n * stride) as usize) }, stride as usize)
+    }
+
+    /// Decode one record with this world's quantization.
+    pub fn unpack_state(&self, record: &[u8]) -> PackedState {
+        let (_, stride) = self.packed_states();
+        assert!(stride > 0 && record.len() >= stride, "a whole record under an active quantization");
+        let mut s = PackedState::default();
+        s.fell_asleep =
+            unsafe { pmb3_world_unpack_state(self.0, record.as_ptr(), &mut s.pos, &mut s.rot, &mut s.vel, &mut s.ang_vel) };
+        s
+    }
+
+    /// Bytes [`World::save_snapshot`] needs right now, counted without
+    /// writing. `exclude_static` leaves out the geometry of static
+    /// bodies, which a client that loaded the same map already has.
+    pub fn snapshot_size(&self, exclude_static: bool) -> usize {
+        unsafe { pmb3_world_snapshot_size(self.0, exclude_static) as usize }
+    }
+
+    /// Write a join snapshot into `buf` without allocating: the whole
+    /// simulation for a client joining mid-game. None if it does not
+    /// fit — size it with [`World::snapshot_size`].
+    pub fn save_snapshot(&self, buf: &mut [u8], exclude_static: bool) -> Option<usize> {
+        let n = unsafe { pmb3_world_save_snapshot(self.0, buf.as_mut_ptr(), buf.len() as i32, exclude_static) };
+        (n > 0).then_some(n as usize)
+    }
+
+    /// Capture a join snapshot to send over several ticks.
+    pub fn begin_snapshot_stream(&self, exclude_static: bool) -> SnapshotStream {
+        SnapshotStream(unsafe { pmb3_world_begin_snapshot_stream(self.0, exclude_static) })
+    }
+
+    /// Replace this world's simulation with a join snapshot; stepping
+    /// then continues exactly as on the server. A snapshot without
+    /// static geometry needs this world to have built the same static
+    /// bodies and shapes in the same order first. False on a corrupt
+    /// or mismatched snapshot — the world may be half loaded, drop it.
+    pub fn load_snapshot(&mut self, data: &[u8]) -> bool {
+        unsafe { pmb3_world_load_snapshot(self.0, data.as_ptr(), data.len() as i32) }
+    }
+
+    /// A copy of this world stepping on `workers` threads, for a match
+    /// started from a prebuilt arena: the static tree and everything
+    /// else comes over in bulk, meshes and height fields are shared
+    /// (keep them alive for the clone too), compounds are copied so
+    /// each match sheds its own. It steps exactly as this world would.
+    pub fn clone_world(&self, workers: usize) -> World {
+        let _gate = WORLD_GATE.lock().unwrap();
+        let id = unsafe { pmb3_world_clone(self.0, workers as i32) };
+        assert!(id != 0, "world is mid-step");
+        World(id, None, None)
+    }
+
+    /// `body` from a world this one was cloned or loaded from: the
+    /// same body here, since those keep the source's ids.
+    pub fn rehome(&self, body: BodyId) -> BodyId {
+        let world = (self.0 & 0xFFFF) as u64 - 1;
+        BodyId(body.0 & !(0xFFFF << 32) | world << 32)
+    }
+
+    /// Copy this world's simulation state into `snap` (bytes written).
+    /// The rollback predictor's save point: capture the acked tick,
+    /// step ahead, [`World::restore`] on a misprediction.
+    pub fn capture(&self, snap: &mut Snapshot) -> usize {
+        unsafe { pmb3_snapshot_capture(self.0, snap.0) as usize }
+    }
+
+    /// Rewind to `snap` in place — re-stepping from here reproduces the
+    /// captured timeline bit for bit. Topology must be FROZEN since the
+    /// capture (no body/shape/joint created or destroyed); if it was
+    /// not, or `snap` is another world's, or a recording is attached,
+    /// nothing changes and this returns false — re-capture after
+    /// spawning. Deltas are refused too; expand them first with
+    /// [`Snapshot::apply`]. Host wiring (user data) is never rewound.
+    pub fn restore(&mut self, snap: &Snapshot) -> bool {
+        unsafe { pmb3_snapshot_restore(self.0, snap.0) != 0 }
+    }
+
+    /// Leaves a flight recorder running for crash repro. Ops go to a
+    /// fixed ring of `ring_bytes` without locks or allocation, and every
+    /// `keyframe_interval` steps the world is snapshotted into one of two
+    /// alternating keyframes. Size the ring for twice that many steps of
+    /// ops. Does nothing while already recording.
+    pub fn start_flight_recording(&mut self, ring_bytes: usize, keyframe_interval: usize) {
+        let ring = ring_bytes.min(1 << 30) as i32;
+        let interval = keyframe_interval.min(i32::MAX as usize) as i32;
+        unsafe { pmb3_world_start_flight_recording(self.0, ring, interval) }
+    }
+
+    /// Records the whole session from here, embedding a world keyframe
+    /// every `keyframe_interval` steps (0: none) so a [`Replay`] seeks
+    /// anywhere by replaying at most that many. Does nothing while
+    /// already recording.
+    pub fn start_recording(&mut self, keyframe_interval: usize) {
+        unsafe { pmb3_world_start_recording(self.0, keyframe_interval.min(i32::MAX as usize) as i32) }
+    }
+
+    /// Stops recording and returns a self-contained recording. A flight
+    /// recorder's starts at the older keyframe the ring still covers,
+    /// so it replays between one and two keyframe intervals. Empty when
+    /// nothing was recording.
+    pub fn stop_recording(&mut self) -> Vec<u8> {
+        self.finish_recording(false)
+    }
+
+    /// [`World::stop_recording`], compressed. Repeated setters XOR down
+    /// to mostly zero bytes before an LZ pass; [`replay_is_valid`] and
+    /// the player decode it as is.
+    pub fn stop_recording_compressed(&mut self) -> Vec<u8> {
+        self.finish_recording(true)
+    }
+
+    fn finish_recording(&mut self, compress: bool) -> Vec<u8> {
+        let recording = unsafe { pmb3_world_stop_recording(self.0) };
+        if recording.is_null() {
+            return Vec::new();
+        }
+        if compress {
+            unsafe { pmb3_recording_compress(recording) };
+        }
+        let mut data = std::ptr::null();
+        let n = unsafe { pmb3_recording_bytes(recording, &mut data) };
+        let bytes = if n > 0 { unsafe { std::slice::from_raw_parts(data, n as usize) }.to_vec() } else { Vec::new() };
+        unsafe { pmb3_recording_destroy(recording) };
+        bytes
+    }
+
+    /// Physics checksum of every body's pose, maintained incrementally
+    /// (the step folds in only the bodies it moved), so stamping every
+    /// snapshot with it is free. Peers that agree on it agree on the
+    /// world; the first tick it differs is the desync.
+    pub fn hash(&self) -> u64 {
+        unsafe { pmb3_world_hash(self.0) }
+    }
+
+    /// [`World::hash`] recomputed by walking every body — the check on
+    /// the running value; O(bodies), not for every tick.
+    pub fn hash_full(&self) -> u64 {
+        unsafe { pmb3_world_hash_full(self.0) }
+    }
+
+    /// Every body sharing an island with one of `seeds` — the closure a
+    /// client misprediction can have touched (its truck, the crate it
+    /// hit, whatever that crate rests on). Replaces `out`'s contents.
+    pub fn island_bodies(&self, seeds: &[BodyId], out: &mut Vec<BodyId>) {
+        let ids = seeds.as_ptr() as *const u64;
+        out.clear();
+        let n = unsafe { pmb3_island_bodies(self.0, ids, seeds.len() as i32, std::ptr::null_mut(), 0) };
+        out.resize(n as usize, BodyId(0));
+        unsafe { pmb3_island_bodies(self.0, ids, seeds.len() as i32, out.as_mut_ptr() as *mut u64, n) };
+    }
+
+    /// Pose and velocities of `bodies`, parallel rows into `out`.
+    pub fn capture_bodies(&self, bodies: &[BodyId], out: &mut Vec<BodyState>) {
+        out.resize(bodies.len(), BodyState::default());
+        unsafe {
+            pmb3_bodies_capture(self.0, bodies.as_ptr() as *const u64, bodies.len() as i32, out.as_mut_ptr())
+        }
+    }
+
+    /// Put `bodies` back to captured rows, leaving the rest of the world
+    /// alone. Unlike [`World::restore`] this goes through the engine's
+    /// setters: contacts re-form next step, so a re-simulation is close
+    /// to the original, not bit-identical. Restored bodies wake.
+    pub fn restore_bodies(&mut self, bodies: &[BodyId], rows: &[BodyState]) {
+        assert_eq!(bodies.len(), rows.len(), "one row per body");
+        unsafe { pmb3_bodies_restore(self.0, bodies.as_ptr() as *const u64, bodies.len() as i32, rows.as_ptr()) }
+    }
+
+    /// Set contact friction on every shape of a body, live: touching
+    /// contacts take it at once and the body wakes to feel it.
+    pub fn set_friction(&mut self, body: BodyId, mu: f32) {
+        unsafe { pmb3_body_set_friction(body.0, mu) }
+    }
+
+    /// Give every shape of a body material id `material` (below
+    /// `MATERIAL_TABLE`), its row in [`set_material_mix`](Self::set_material_mix).
+    pub fn set_material(&mut self, body: BodyId, material: u64) {
+        unsafe { pmb3_body_set_material(body.0, material) }
+    }
+
+    /// Category/mask bits on every shape of a body. Contact and query
+    /// tests both require the match in BOTH directions: `a.category &
+    /// b.mask` and `b.category & a.mask`.
     pub fn set_filter(&mut self, body: BodyId, category: u64, mask: u64) {
         unsafe { pmb3_body_set_filter(body.0, category, mask) }
     }
 
-    /// Change a body's kind (`STATIC`/`KINEMATIC`/`DYNAMIC`) in place —
-    /// the corpse-ghost verb (a dead unit parks as a castable kinematic
-    /// until its history frames expire).
-    pub fn set_type(&mut self, body: BodyId, kind: i32) {
-        unsafe { pmb3_body_set_type(body.0, kind) }
+    /// Put every shape of a body in filter group `group` (0..32), a row
+    /// of the world's [`set_filter_rule`](Self::set_filter_rule) table.
+    /// Group 0 by default.
+    pub fn set_filter_group(&mut self, body: BodyId, group: usize) {
+        unsafe { pmb3_body_set_filter_group(body.0, group.min(FILTER_GROUPS - 1) as i32) }
+    }
+
+    /// What groups `a` and `b` do with each other, both ways:
+    /// `FILTER_COLLIDE` (the default), `FILTER_SENSOR_ONLY` (no
+    /// contacts, sensors still see) or `FILTER_IGNORE`. Checked as a bit
+    /// lookup with the category/mask filter, so a pair must pass both.
+    /// Contacts the rule forbids go now.
+    pub fn set_filter_rule(&mut self, a: usize, b: usize, rule: i32) {
+        let (a, b) = (a.min(FILTER_GROUPS - 1) as i32, b.min(FILTER_GROUPS - 1) as i32);
+        unsafe { pmb3_world_set_filter_rule(self.0, a, b, rule) }
+    }
+
+    /// Friction and restitution of every contact between materials `a`
+    /// and `b` (set with [`set_material`](Self::set_material)), looked
+    /// up instead of mixed from the shapes' values; `None` mixes again.
+    pub fn set_material_mix(&mut self, a: u64, b: u64, friction: Option<f32>, restitution: Option<f32>) {
+        assert!(a < MATERIAL_TABLE as u64 && b < MATERIAL_TABLE as u64, "material ids are below {MATERIAL_TABLE}");
+        unsafe { pmb3_world_set_material_mix(self.0, a, b, friction.unwrap_or(-1.0), restitution.unwrap_or(-1.0)) }
+    }
+
+    /// Friction and restitution standing in for every shape of `group`
+    /// before the pair is mixed; `None` keeps the shapes' own.
+    pub fn set_group_material(&mut self, group: usize, friction: Option<f32>, restitution: Option<f32>) {
+        let group = group.min(FILTER_GROUPS - 1) as i32;
+        unsafe { pmb3_world_set_group_material(self.0, group, friction.unwrap_or(-1.0), restitution.unwrap_or(-1.0)) }
+    }
+
+    /// Change a body's kind (`STATIC`/`KINEMATIC`/`DYNAMIC`) in place —
+    /// the corpse-ghost verb (a dead unit parks as a castable kinematic
+    /// until its history frames expire).
+    pub fn set_type(&mut self, body: BodyId, kind: i32) {
+        unsafe { pmb3_body_set_type(body.0, kind) }
+    }
+
+    /// [`set_type`](Self::set_type) and [`set_filter`](Self::set_filter)
+    /// for a batch of dead units in one call, the proxies rebuilt once.
+    pub fn retire(&mut self, bodies: &[BodyId], kind: i32, category: u64, mask: u64) {
+        unsafe { pmb3_bodies_retire(bodies.as_ptr() as *const u64, bodies.len() as i32, kind, category, mask) }
+    }
+
+    /// A static body whose one shape is `compound`.
+    pub fn body_compound(&mut self, pos: Vec3, compound: &Compound) -> BodyId {
+        BodyId(unsafe { pmb3_body_compound(self.0, pos, compound.0) })
+    }
+
+    /// Knock chunk `child` off a compound body. Only that chunk's
+    /// contacts go, and whatever rested on it wakes and falls.
+    pub fn shed(&mut self, body: BodyId, child: usize) {
+        unsafe { pmb3_body_shed_child(body.0, child as i32) }
+    }
+
+    /// A static box trigger volume — capture zones, pickups. It sees
+    /// the bodies with sensor events on, as of the last step.
+    pub fn sensor_box(&mut self, pos: Vec3, half: Vec3) -> BodyId {
+        BodyId(unsafe { pmb3_body_sensor_box(self.0, pos, half) })
+    }
+
+    /// Whether sensors see this body. Off by default.
+    pub fn set_sensor_events(&mut self, body: BodyId, on: bool) {
+        unsafe { pmb3_body_set_sensor_events(body.0, on) }
+    }
+
+    /// The bodies (at most 64) inside a `sensor_box` as of the last step.
+    pub fn sensor_visitors(&self, sensor: BodyId) -> Vec<BodyId> {
+        let mut out = [0u64; 64];
+        let n = unsafe { pmb3_body_sensor_visitors(sensor.0, out.as_mut_ptr(), 64) };
+        out[..n as usize].iter().map(|&b| BodyId(b)).collect()
+    }
+
+    /// Static sensors the last step left alone: no awake shape came near
+    /// them, so their visitors stood still.
+    pub fn skipped_sensors(&self) -> usize {
+        unsafe { pmb3_world_skipped_sensors(self.0) as usize }
+    }
+
+    /// Set off `blasts` together against every dynamic shape. Bodies
+    /// in reach wake once and take the same velocities as from the
+    /// blasts one at a time, on any worker count; the shapes are
+    /// weighed in parallel, so a volley of grenades costs one pass.
+    pub fn explode(&mut self, blasts: &[Explosion]) {
+        if !blasts.is_empty() {
+            unsafe { pmb3_world_explode(self.0, blasts.as_ptr(), blasts.len() as i32) }
+        }
+    }
+
+    /// Replace the world's wind volumes with `fields`, at most
+    /// [`MAX_FORCE_FIELDS`]; an empty slice removes them. They act in
+    /// the velocity pass of every step until replaced, so a rotor's
+    /// downwash costs one call per tick however many bodies sit under
+    /// it. Setting wakes the sleeping bodies inside; a body that
+    /// settles in a still field may sleep again.
+    pub fn set_force_fields(&mut self, fields: &[ForceField]) {
+        assert!(fields.len() <= MAX_FORCE_FIELDS, "at most {MAX_FORCE_FIELDS} force fields");
+        unsafe { pmb3_world_set_force_fields(self.0, fields.as_ptr(), fields.len() as i32) }
+    }
+
+    /// Wireframes of the shapes in view for a debug overlay, as a line
+    /// list and, with `faces`, a triangle list of hull faces, both
+    /// relative to `origin` (the camera) and ready for one upload each.
+    /// The broadphase finds the shapes within `bounds`; each plane
+    /// `[x, y, z, offset]` keeps what is in front of it, at most six, so
+    /// a view frustum culls the rest. Workers build the vertices. The
+    /// vectors are refilled, growing only when the view needs more.
+    /// Returns the shapes drawn.
+    pub fn debug_geometry(
+        &self,
+        origin: Vec3,
+        planes: &[[f32; 4]],
+        bounds: (Vec3, Vec3),
+        faces: bool,
+        lines: &mut Vec<DebugVertex>,
+        triangles: &mut Vec<DebugVertex>,
+    ) -> usize {
+        assert!(planes.len() <= 6, "at most six culling planes");
+        lines.clear();
+        triangles.clear();
+        loop {
+            let mut counts = [0i32; 4];
+            let line_capacity = lines.capacity().min(i32::MAX as usize);
+            let triangle_capacity = triangles.capacity().min(i32::MAX as usize);
+            let shapes = unsafe {
+                pmb3_world_debug_geometry(
+                    self.0,
+                    origin,
+                    planes.as_ptr().cast(),
+                    planes.len() as i32,
+                    bounds.0,
+                    bounds.1,
+                    faces,
+                    lines.as_mut_ptr(),
+                    line_capacity as i32,
+                    triangles.as_mut_ptr(),
+                    triangle_capacity as i32,
+                    counts.as_mut_ptr(),
+                )
+            };
+            let (needed_lines, needed_triangles) = (counts[2] as usize, counts[3] as usize);
+            if needed_lines <= line_capacity && needed_triangles <= triangle_capacity {
+                unsafe {
+                    lines.set_len(counts[0] as usize);
+                    triangles.set_len(counts[1] as usize);
+                }
+                return shapes as usize;
+            }
+            lines.reserve(needed_lines);
+            triangles.reserve(needed_triangles);
+        }
+    }
+
+    /// Move the origin to `origin`, so everything in the world sits
+    /// `origin` closer to zero and float keeps its precision around a
+    /// player far out. Contacts and caches carry over; poses held
+    /// outside the world, cached rays included, must shift too.
+    pub fn shift_origin(&mut self, origin: Vec3) {
+        unsafe { pmb3_world_shift_origin(self.0, origin) }
+    }
+
+    /// The world locked for reading until the guard drops, so bullet,
+    /// targeting and bite tasks can query it from many threads at once
+    /// between steps. Batches run on the calling thread meanwhile.
+    pub fn queries(&mut self) -> Queries<'_> {
+        unsafe { pmb3_world_begin_queries(self.0) };
+        Queries(self)
+    }
+
+    /// Closest ray hit in the live world against shapes whose category
+    /// is in `mask` — `(hit point, fraction of the translation)`.
+    pub fn cast_ray(&self, origin: Vec3, translation: Vec3, mask: u64) -> Option<(Vec3, f32)> {
+        let (mut p, mut f) = (Vec3::default(), 0.0f32);
+        (unsafe { pmb3_world_cast_ray(self.0, origin, translation, mask, &mut p, &mut f) } != 0)
+            .then_some((p, f))
+    }
+
+    /// [`World::cast_ray`] remembering the shapes near the ray in
+    /// `cache`. While both ends stay within half a meter of the ray the
+    /// cache was filled for and no shape's broadphase box changed near
+    /// it, only those shapes are tested: an AI's every-tick line of
+    /// sight in a still crowd costs no tree walk.
+    pub fn cast_ray_cached(&self, cache: &mut RayCache, origin: Vec3, translation: Vec3, mask: u64) -> Option<(Vec3, f32)> {
+        let (mut p, mut f) = (Vec3::default(), 0.0f32);
+        (unsafe { pmb3_world_cast_ray_cached(self.0, cache.0, origin, translation, mask, &mut p, &mut f) } != 0)
+            .then_some((p, f))
+    }
+
+    /// [`World::cast_ray`] for a batch, ray `i` from `origins[i]` along
+    /// `translations[i]`. Consecutive rays walk the broadphase together,
+    /// so keep one shooter's rays adjacent; a threaded world spreads a
+    /// large batch over its workers. Same hits as ray-by-ray casts.
+    pub fn cast_rays(&self, origins: &[Vec3], translations: &[Vec3], mask: u64) -> Vec<Option<(Vec3, f32)>> {
+        assert_eq!(origins.len(), translations.len(), "one translation per origin");
+        let n = origins.len();
+        let (mut points, mut fracs) = (vec![Vec3::default(); n], vec![0.0f32; n]);
+        unsafe {
+            pmb3_world_cast_rays(
+                self.0,
+                origins.as_ptr(),
+                translations.as_ptr(),
+                n.min(i32::MAX as usize) as i32,
+                mask,
+                points.as_mut_ptr(),
+                fracs.as_mut_ptr(),
+            )
+        };
+        points.into_iter().zip(fracs).map(|(p, f)| (f >= 0.0).then_some((p, f))).collect()
+    }
+
+    /// Cast a sphere (`radius` 0 = a ray) at ONE body posed at an
+    /// arbitrary transform — the lag-comp verb: the caller supplies a
+    /// rewound pose, Box3D judges the same geometry that collides.
+    pub fn body_cast_sphere(
+        &self,
+        body: BodyId,
+        pose: (Vec3, Quat),
+        origin: Vec3,
+        radius: f32,
+        translation: Vec3,
+    ) -> Option<(Vec3, f32)> {
+        let (mut p, mut f) = (Vec3::default(), 0.0f32);
+        (unsafe {
+            pmb3_body_cast_sphere(body.0, pose.0, pose.1, origin, radius, translation, &mut p, &mut f)
+        } != 0)
+            .then_some((p, f))
+    }
+
+    /// Every body (category in `mask`) overlapping the capsule
+    /// `p1..p2` at `radius` — the touch/bite verb, live world.
+    pub fn overlap_capsule(&self, p1: Vec3, p2: Vec3, radius: f32, mask: u64) -> Vec<BodyId> {
+        let mut out = [0u64; 64];
+        let n = unsafe {
+            pmb3_world_overlap_capsule(self.0, p1, p2, radius, mask, out.as_mut_ptr(), 64)
+        };
+        out[..n as usize].iter().map(|&b| BodyId(b)).collect()
+    }
+
+    /// Slide every capsule in `movers` through the world (shapes whose
+    /// category is in `mask`) — collide, solve planes, cast, a few
+    /// passes each, spread over the world's workers. Movers see the
+    /// world as of the call, not each other's new positions.
+    pub fn move_capsules(&self, movers: &[Mover], mask: u64, out: &mut Vec<MoverResult>) {
+        out.resize(movers.len(), MoverResult::default());
+        unsafe { pmb3_world_move_capsules(self.0, movers.as_ptr(), movers.len() as i32, mask, out.as_mut_ptr()) }
+    }
+
+    /// The `k` (at most 64) bodies nearest `p` within `range`, nearest
+    /// first with their distances — the AI target pick.
+    pub fn nearest(&self, p: Vec3, range: f32, mask: u64, k: usize) -> Vec<(BodyId, f32)> {
+        let (mut out, mut dist) = ([0u64; 64], [0f32; 64]);
+        let n = unsafe {
+            pmb3_world_query_nearest(self.0, p, range, mask, out.as_mut_ptr(), dist.as_mut_ptr(), k.min(64) as i32)
+        };
+        (0..n as usize).map(|i| (BodyId(out[i]), dist[i])).collect()
+    }
+}
+
+/// A world in its query phase ([`World::queries`]): shared by
+/// reference across threads, it offers only the queries, which read
+/// the world and write nothing in it.
+pub struct Queries<'a>(&'a mut World);
+
+unsafe impl Sync for Queries<'_> {}
+
+impl Queries<'_> {
+    pub fn cast_ray(&self, origin: Vec3, translation: Vec3, mask: u64) -> Option<(Vec3, f32)> {
+        self.0.cast_ray(origin, translation, mask)
+    }
+
+    /// One cache per thread, as outside the phase.
+    pub fn cast_ray_cached(&self, cache: &mut RayCache, origin: Vec3, translation: Vec3, mask: u64) -> Option<(Vec3, f32)> {
+        self.0.cast_ray_cached(cache, origin, translation, mask)
+    }
+
+    pub fn cast_rays(&self, origins: &[Vec3], translations: &[Vec3], mask: u64) -> Vec<Option<(Vec3, f32)>> {
+        self.0.cast_rays(origins, translations, mask)
+    }
+
+    pub fn body_cast_sphere(&self, body: BodyId, pose: (Vec3, Quat), origin: Vec3, radius: f32, translation: Vec3) -> Option<(Vec3, f32)> {
+        self.0.body_cast_sphere(body, pose, origin, radius, translation)
+    }
+
+    pub fn cast_at_tick(&self, tick: u32, origin: Vec3, radius: f32, translation: Vec3, mask: u64) -> Option<(BodyId, Vec3, f32)> {
+        self.0.cast_at_tick(tick, origin, radius, translation, mask)
+    }
+
+    pub fn overlap_capsule(&self, p1: Vec3, p2: Vec3, radius: f32, mask: u64) -> Vec<BodyId> {
+        self.0.overlap_capsule(p1, p2, radius, mask)
+    }
+
+    pub fn move_capsules(&self, movers: &[Mover], mask: u64, out: &mut Vec<MoverResult>) {
+        self.0.move_capsules(movers, mask, out)
+    }
+
+    pub fn nearest(&self, p: Vec3, range: f32, mask: u64, k: usize) -> Vec<(BodyId, f32)> {
+        self.0.nearest(p, range, mask, k)
+    }
+
+    pub fn pose(&self, body: BodyId) -> (Vec3, Quat) {
+        self.0.pose(body)
+    }
+}
+
+impl Drop for Queries<'_> {
+    fn drop(&mut self) {
+        unsafe { pmb3_world_end_queries(self.0 .0) }
+    }
+}
+
+impl Drop for World {
+    fn drop(&mut self) {
+        let _gate = WORLD_GATE.lock().unwrap();
+        unsafe { pmb3_world_destroy(self.0) }
+    }
+}
+
+pub const STATIC: i32 = 0;
+pub const KINEMATIC: i32 = 1;
+pub const DYNAMIC: i32 = 2;
+
+/// [`World::set_filter_rule`] rules and group count.
+pub const FILTER_COLLIDE: i32 = 0;
+pub const FILTER_SENSOR_ONLY: i32 = 1;
+pub const FILTER_IGNORE: i32 = 2;
+pub const FILTER_GROUPS: usize = 32;
+
+/// [`ForceField`] kinds and the most a world holds.
+pub const FIELD_DIRECTIONAL: i32 = 0;
+pub const FIELD_RADIAL: i32 = 1;
+pub const FIELD_VORTEX: i32 = 2;
+pub const MAX_FORCE_FIELDS: usize = 64;
+
+/// Material ids [`World::set_material_mix`] has rows for.
+pub const MATERIAL_TABLE: usize = 16;
+
+/// [`World::update_lod`] levels.
+pub const LOD_FULL: u8 = 0;
+pub const LOD_REDUCED: u8 = 1;
+pub const LOD_DEAD_RECKONED: u8 = 2;
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn v(x: f32, y: f32, z: f32) -> Vec3 {
+        Vec3 { x, y, z }
+    }
+
+    /// Build the spike-1 scene: a ground slab and a rain of boxes.
+    fn drop_boxes(n: usize) -> (World, Vec<BodyId>) {
+        let mut w = World::new(v(0.0, -9.81, 0.0));
+        w.body_box(STATIC, v(0.0, -0.5, 0.0), Quat::default(), v(50.0, 0.5, 50.0), 1.0, 0.6);
+        let bodies: Vec<BodyId> = (0..n)
+            .map(|i| {
+                // A loose grid with a deterministic jitter so stacks
+                // topple instead of balancing perfectly.
+                let (ix, iz) = ((i % 8) as f32, (i / 8) as f32);
+                w.body_box(
+                    DYNAMIC,
+                    v(
+                        ix * 1.1 - 4.0 + (i as f32 * 0.37).sin() * 0.05,
+                        2.0 + (i / 8) as f32 * 1.5,
+                        iz * 1.1 - 4.0 + (i as f32 * 0.61).cos() * 0.05,
+                    ),
+                    Quat::default(),
+                    v(0.4, 0.4, 0.4),
+                    1.0,
+                    0.6,
+                )
+            })
+            .collect();
+        (w, bodies)
+    }
+
+    #[test]
+    fn boxes_fall_settle_and_sleep() {
+        let (mut w, bodies) = drop_boxes(50);
+        for _ in 0..600 {
+            w.step(1.0 / 60.0, 4);
+        }
+        let mut asleep = 0;
+        for &b in &bodies {
+            let (p, _) = w.pose(b);
+            assert!(p.y > -0.01, "no box fell through the ground, y {}", p.y);
+            assert!(p.y < 10.0, "no box exploded upward, y {}", p.y);
+            assert!(w.velocity(b).y.abs() < 0.05, "settled, vy {}", w.velocity(b).y);
+            asleep += (!w.awake(b)) as u32;
+        }
+        // Island sleeping is the free-bandwidth win — most of a settled
+        // pile must actually be ASLEEP, not merely slow.
+        assert!(asleep >= 40, "sleeping engaged on a settled pile, asleep {asleep}/50");
+    }
+
+    /// The query surface the collisions slice leans on: world ray
+    /// casts respect the category mask, per-body sphere casts judge
+    /// the body at a SUPPLIED transform (the lag-comp rewind), radius
+    /// grows the query, and the capsule overlap finds live bodies.
+    #[test]
+    fn casts_filter_rewind_and_pad() {
+        let mut w = World::new(v(0.0, -9.81, 0.0));
+        // Ground as category 1, a box "unit" at x=5 as category 2.
+        // NOTE the default category is ALL BITS (B3_DEFAULT_CATEGORY_BITS
+        // = u64::MAX) — anyone using masked queries must categorize
+        // every body explicitly, statics included.
+        let ground =
+            w.body_box(STATIC, v(0.0, -0.5, 0.0), Quat::default(), v(50.0, 0.5, 50.0), 1.0, 0.6);
+        w.set_filter(ground, 1, !0);
+        let unit = w.body_box(STATIC, v(5.0, 1.0, 0.0), Quat::default(), v(1.0, 1.0, 1.0), 1.0, 0.6);
+        w.set_filter(unit, 2, !0);
+
+        // A flat ray down +x at y=1: masked to category 1 it passes the
+        // unit and flies off (no wall in range); masked to everything
+        // it stops on the unit's near face.
+        let (o, t) = (v(0.0, 1.0, 0.0), v(20.0, 0.0, 0.0));
+        assert!(w.cast_ray(o, t, 1).is_none(), "category mask must exclude the unit");
+        let (p, f) = w.cast_ray(o, t, !0).expect("unmasked ray hits the unit");
+        assert!((p.x - 4.0).abs() < 1e-3 && (f - 0.2).abs() < 1e-3, "near face at x=4, got {p:?}");
+
+        // The lag-comp verb: cast at the body as if it were at x=-5
+        // (a rewound frame) — the live pose must not matter.
+        let rewound = (v(-5.0, 1.0, 0.0), Quat::default());
+        let hit = w.body_cast_sphere(unit, rewound, v(-10.0, 1.0, 0.0), 0.0, v(20.0, 0.0, 0.0));
+        let (p, _) = hit.expect("ray hits the body at its REWOUND pose");
+        assert!((p.x + 6.0).abs() < 1e-3, "rewound near face at x=-6, got {p:?}");
+
+        // Radius is the shot's forgiveness: a ray 2.5 over the box top
+        // misses, a 0.8-sphere along the same line connects.
+        let graze = (v(5.0, 1.0, 0.0), Quat::default());
+        let (o, t) = (v(0.0, 2.5, 0.0), v(20.0, 0.0, 0.0));
+        assert!(w.body_cast_sphere(unit, graze, o, 0.0, t).is_none(), "0.5 over the top misses");
+        assert!(w.body_cast_sphere(unit, graze, o, 0.8, t).is_some(), "the pad connects it");
+
+        // Touch verb: a vertical capsule beside the unit's face
+        // overlaps it; the same capsule masked to category 1 does not.
+        let (p1, p2) = (v(3.5, 0.5, 0.0), v(3.5, 1.5, 0.0));
+        assert_eq!(w.overlap_capsule(p1, p2, 0.7, 2), vec![unit], "capsule reaches the face");
+        assert!(!w.overlap_capsule(p1, p2, 0.7, 1).contains(&unit), "mask excludes the unit");
+        assert!(w.overlap_capsule(p1, p2, 0.3, 2).is_empty(), "short reach misses");
+    }
+
+    /// The bulk readback is the per-body getters in one crossing: same
+    /// bits per row, and a destroyed body's row reads dead instead of
+    /// tripping an assert.
+    #[test]
+    fn batched_readback_matches_per_body() {
+        let (mut w, mut bodies) = drop_boxes(24);
+        for _ in 0..90 {
+            w.step(1.0 / 60.0, 4);
+        }
+        let gone = bodies[5];
+        w.destroy(gone);
+        let mut out = Poses::default();
+        assert_eq!(w.read_poses(&bodies, &mut out), 23, "one stale id in the list");
+        assert!(!out.awake[5] && out.pos[5] == Vec3::default(), "dead row reads as empty");
+        bodies.remove(5);
+        assert_eq!(w.read_poses(&bodies, &mut out), 23);
+        for (i, &b) in bodies.iter().enumerate() {
+            let (p, q) = w.pose(b);
+            assert_eq!((out.pos[i], out.rot[i]), (p, q), "row {i} pose");
+            assert_eq!(out.vel[i], w.velocity(b), "row {i} velocity");
+            assert_eq!(out.awake[i], w.awake(b), "row {i} awake");
+        }
+    }
+
+    /// Bulk write-in is the per-body setters in one crossing: a settled
+    /// pile driven by bulk rows evolves bit-identically to the same
+    /// rows written one at a time, and zero rows leave it asleep.
+    #[test]
+    fn bulk_writes_match_per_body_and_spare_sleepers() {
+        let settle = || {
+            let (mut w, bodies) = drop_boxes(40);
+            for _ in 0..600 {
+                w.step(1.0 / 60.0, 4);
+            }
+            (w, bodies)
+        };
+        let (mut w, bodies) = settle();
+        let asleep = bodies.iter().filter(|&&b| !w.awake(b)).count();
+        w.set_velocities(&bodies, &vec![Vec3::default(); bodies.len()]);
+        w.forces(&bodies, &vec![Vec3::default(); bodies.len()]);
+        assert_eq!(bodies.iter().filter(|&&b| !w.awake(b)).count(), asleep, "zero rows never wake");
+
+        let rows: Vec<Vec3> = (0..bodies.len()).map(|i| v((i as f32 * 0.7).sin(), 0.5, 1.0)).collect();
+        let run = |w: &mut World, bulk: bool| {
+            for _ in 0..60 {
+                if bulk {
+                    w.set_velocities(&bodies, &rows);
+                    w.forces(&bodies, &rows);
+                } else {
+                    for (&b, &r) in bodies.iter().zip(&rows) {
+                        w.set_velocity(b, r);
+                        w.force(b, r);
+                    }
+                }
+                w.step(1.0 / 60.0, 4);
+            }
+            bodies.iter().map(|&b| w.pose(b)).collect::<Vec<_>>()
+        };
+        let bulk = run(&mut w, true);
+        let (mut w2, _) = settle();
+        let single = run(&mut w2, false);
+        assert!(bulk == single, "bulk and per-body write-in must step identically");
+    }
+
+    /// The dirty-only stream: while the pile moves every awake body
+    /// reports its true pose; once it settles the stream runs dry, and
+    /// each sleeper announced its last pose with `fell_asleep`.
+    #[test]
+    fn move_events_track_awake_bodies_only() {
+        let (mut w, bodies) = drop_boxes(30);
+        w.step(1.0 / 60.0, 4);
+        let ev = w.move_events();
+        assert_eq!(ev.len(), bodies.len(), "a falling pile moves every box");
+        for e in ev {
+            assert_eq!(w.pose(e.body()), (e.pos, e.rot), "event pose is solver truth");
+        }
+        let mut fell = std::collections::HashSet::new();
+        for _ in 0..900 {
+            w.step(1.0 / 60.0, 4);
+            fell.extend(w.move_events().iter().filter(|e| e.fell_asleep).map(|e| e.body()));
+        }
+        let asleep: Vec<_> = bodies.iter().filter(|&&b| !w.awake(b)).collect();
+        assert!(asleep.len() > 20, "pile settles, asleep {}", asleep.len());
+        assert!(asleep.iter().all(|b| fell.contains(b)), "every sleeper reported falling asleep");
+        assert!(w.move_events().len() <= bodies.len() - asleep.len(), "sleepers cost zero rows");
+    }
+
+    /// Packed records ride along with the move events: each decodes to
+    /// its event's pose and the body's velocity within half a step, a
+    /// record is far smaller than the event, and a sleeper's record
+    /// carries the sleep bit.
+    #[test]
+    fn packed_states_decode_within_precision() {
+        let (mut w, _) = drop_boxes(30);
+        let q = StateQuantization::default();
+        w.set_state_quantization(Some(&q));
+        let mut slept = 0;
+        for step in 0..900 {
+            w.step(1.0 / 60.0, 4);
+            let (bytes, stride) = w.packed_states();
+            let ev = w.move_events();
+            assert!(stride > 0 && stride < 32, "stride {stride}");
+            assert_eq!(bytes.len(), ev.len() * stride);
+            for (e, rec) in ev.iter().zip(bytes.chunks(stride)) {
+                let s = w.unpack_state(rec);
+                assert_eq!(s.fell_asleep, e.fell_asleep);
+                slept += s.fell_asleep as usize;
+                if step % 30 != 0 {
+                    continue;
+                }
+                let half = q.position_resolution * 0.5 + 1e-4;
+                assert!((s.pos.x - e.pos.x).abs() <= half && (s.pos.y - e.pos.y).abs() <= half && (s.pos.z - e.pos.z).abs() <= half);
+                let dot = s.rot.x * e.rot.x + s.rot.y * e.rot.y + s.rot.z * e.rot.z + s.rot.w * e.rot.w;
+                assert!(dot.abs() > 0.9999, "rotation {dot}");
+                let v = w.velocity(e.body());
+                let half = q.velocity_resolution * 0.5 + 1e-4;
+                assert!((s.vel.x - v.x).abs() <= half && (s.vel.y - v.y).abs() <= half && (s.vel.z - v.z).abs() <= half);
+            }
+        }
+        assert!(slept > 20, "sleepers set the bit, {slept}");
+        w.set_state_quantization(None);
+        w.step(1.0 / 60.0, 4);
+        assert_eq!(w.packed_states().0.len(), 0);
+    }
+
+    /// Join-in-progress: the server sends a snapshot without the map's
+    /// static geometry, in pieces, while it keeps stepping; a client
+    /// that built the same map loads it and steps in lockstep.
+    #[test]
+    fn join_snapshot_loads_into_a_client_map() {
+        let chunks = [[v(0.0, 1.0, 0.0), v(1.0, 1.0, 1.0)], [v(0.0, 3.0, 0.0), v(0.5, 1.0, 0.5)]];
+        let map = |w: &mut World, prop: &Compound| {
+            w.body_box(STATIC, v(0.0, -0.5, 0.0), Quat::default(), v(40.0, 0.5, 40.0), 1.0, 0.6);
+            w.body_compound(v(6.0, 0.0, 0.0), prop);
+        };
+        let mut server = World::new(v(0.0, -9.81, 0.0));
+        let server_prop = Compound::boxes(&chunks, 0.5);
+        map(&mut server, &server_prop);
+        for i in 0..40 {
+            let pos = v((i % 8) as f32 * 1.1 - 4.0, 2.0 + (i / 8) as f32 * 1.5, (i % 5) as f32 * 0.9 - 2.0);
+            server.body_box(DYNAMIC, pos, Quat::default(), v(0.4, 0.4, 0.4), 1.0, 0.6);
+        }
+        for i in 0..10 {
+            server.body_capsule(DYNAMIC, v(6.0, 6.0 + i as f32, 0.2), 0.3, 0.2, 1.0, 0.5, false);
+            server.body_sphere(DYNAMIC, v(-6.0, 2.0 + i as f32, 0.0), 0.3, 1.0, 0.5);
+        }
+        for _ in 0..45 {
+            server.step(1.0 / 60.0, 4);
+        }
+
+        let full = server.snapshot_size(false);
+        let size = server.snapshot_size(true);
+        assert!(size < full, "statics left out: {size} vs {full}");
+        let mut one_shot = vec![0u8; size];
+        assert_eq!(server.save_snapshot(&mut one_shot[..size - 1], true), None, "too small a buffer");
+        assert_eq!(server.save_snapshot(&mut one_shot, true), Some(size));
+
+        let mut stream = server.begin_snapshot_stream(true);
+        let expected = server.hash_full();
+        server.step(1.0 / 60.0, 4);
+        let mut streamed = Vec::new();
+        let mut piece = [0u8; 1200];
+        loop {
+            let (n, remaining) = stream.read(&mut piece);
+            streamed.extend_from_slice(&piece[..n]);
+            if remaining == 0 {
+                break;
+            }
+        }
+        assert_eq!(streamed, one_shot, "the stream captured the tick it began on");
+
+        let mut client = World::new(v(0.0, -9.81, 0.0));
+        let client_prop = Compound::boxes(&chunks, 0.5);
+        map(&mut client, &client_prop);
+        assert!(client.load_snapshot(&streamed));
+        assert_eq!(client.hash_full(), expected);
+        client.step(1.0 / 60.0, 4);
+        for _ in 0..120 {
+            assert_eq!(client.hash_full(), server.hash_full());
+            assert_eq!(client.hash(), client.hash_full());
+            server.step(1.0 / 60.0, 4);
+            client.step(1.0 / 60.0, 4);
+        }
+
+        // A client without the map refuses it; the full snapshot needs no map
+        let mut empty = World::new(v(0.0, -9.81, 0.0));
+        assert!(!empty.load_snapshot(&streamed));
+        let mut bare = World::new(v(0.0, -9.81, 0.0));
+        let mut whole = vec![0u8; server.snapshot_size(false)];
+        let n = server.save_snapshot(&mut whole, false).unwrap();
+        assert!(bare.load_snapshot(&whole[..n]));
+        bare.step(1.0 / 60.0, 4);
+        server.step(1.0 / 60.0, 4);
+        assert_eq!(bare.hash_full(), server.hash_full());
+    }
+
+    /// The rollback contract: capture, wander off down a mispredicted
+    /// timeline (kicks, contact churn, sleep), restore, re-step — the
+    /// replay must match the straight run bit for bit. A spawn inside
+    /// the window breaks the contract and restore refuses.
+    #[test]
+    fn restore_replays_the_captured_timeline() {
+        let (mut w, bodies) = drop_boxes(64);
+        for _ in 0..40 {
+            w.step(1.0 / 60.0, 4);
+        }
+        let mut snap = Snapshot::new();
+        assert!(w.capture(&mut snap) > 0);
+        let run = |w: &mut World| {
+            let mut out = Vec::new();
+            for _ in 0..120 {
+                w.step(1.0 / 60.0, 4);
+                for &b in &bodies {
+                    let ((p, q), vel) = (w.pose(b), w.velocity(b));
+                    out.extend([p.x, p.y, p.z, q.x, q.y, q.z, q.w, vel.x, vel.y, vel.z].map(f32::to_bits));
+                }
+            }
+            out
+        };
+        let straight = run(&mut w);
+
+        assert!(w.restore(&snap));
+        w.set_velocities(&bodies, &vec![v(3.0, 6.0, -2.0); bodies.len()]);
+        for _ in 0..50 {
+            w.step(1.0 / 60.0, 4);
+        }
+        assert!(w.restore(&snap));
+        assert!(run(&mut w) == straight, "restore + re-step must reproduce the captured timeline");
+
+        let t = std::time::Instant::now();
+        for _ in 0..100 {
+            w.capture(&mut snap);
+            w.restore(&snap);
+        }
+        println!("capture+restore, 64 boxes: {:?} per round trip", t.elapsed() / 100);
+
+        w.body_box(DYNAMIC, v(0.0, 8.0, 0.0), Quat::default(), v(0.4, 0.4, 0.4), 1.0, 0.6);
+        assert!(!w.restore(&snap), "a spawn since the capture voids the snapshot");
+    }
+
+    /// Sleep packing under rollback: a capture of packed sets restores
+    /// after they woke, and one taken awake restores after they slept
+    /// and packed. Either way the re-run matches the straight run.
+    #[test]
+    fn restore_spans_sleep_packing() {
+        let field = || {
+            let mut w = World::new(v(0.0, -9.81, 0.0));
+            w.set_sleep_packing(true);
+            w.body_box(STATIC, v(0.0, -0.5, 0.0), Quat::default(), v(40.0, 0.5, 40.0), 1.0, 0.6);
+            let boxes: Vec<_> = (0..24)
+                .map(|i| {
+                    let pos = v((i % 6) as f32 * 3.0 - 7.5, 0.5, (i / 6) as f32 * 3.0 - 4.5);
+                    w.body_box(DYNAMIC, pos, Quat::default(), v(0.5, 0.5, 0.5), 1.0, 0.6)
+                })
+                .collect();
+            (w, boxes)
+        };
+        let run = |w: &mut World, steps: usize| -> Vec<u64> {
+            (0..steps)
+                .map(|_| {
+                    w.step(1.0 / 60.0, 4);
+                    w.hash_full()
+                })
+                .collect()
+        };
+        let mut snap = Snapshot::new();
+
+        // Captured packed, restored after six of them woke
+        let (mut w, boxes) = field();
+        run(&mut w, 300);
+        assert!(boxes.iter().all(|&b| !w.awake(b)), "the field sleeps");
+        assert!(w.capture(&mut snap) > 0);
+        let kick = |w: &mut World| {
+            for &b in boxes.iter().step_by(4) {
+                w.set_velocity(b, v(0.0, 3.0, 1.0));
+            }
+        };
+        kick(&mut w);
+        let straight = run(&mut w, 60);
+        assert!(w.restore(&snap));
+        kick(&mut w);
+        run(&mut w, 5);
+        assert!(w.restore(&snap));
+        kick(&mut w);
+        assert!(run(&mut w, 60) == straight, "packed capture replays");
+
+        // Captured awake, restored after the sets slept and packed
+        let (mut w, boxes) = field();
+        run(&mut w, 10);
+        assert!(w.capture(&mut snap) > 0);
+        let straight = run(&mut w, 300);
+        assert!(boxes.iter().all(|&b| !w.awake(b)), "the field sleeps");
+        assert!(w.restore(&snap));
+        assert!(run(&mut w, 300) == straight, "awake capture replays");
+    }
+
+    /// The in-place rollback and a snapshot reload are two copies of
+    /// the same state list. With sleep packing and a ray cache in play,
+    /// capture → step → restore → step must match save → step → load →
+    /// step, and a restored world must save the very image it had.
+    #[test]
+    fn restore_matches_a_snapshot_reload() {
+        let mut w = World::new(v(0.0, -9.81, 0.0));
+        w.set_sleep_packing(true);
+        w.body_box(STATIC, v(0.0, -0.5, 0.0), Quat::default(), v(40.0, 0.5, 40.0), 1.0, 0.6);
+        w.body_box(STATIC, v(10.0, 2.0, 0.0), Quat::default(), v(0.5, 2.0, 2.0), 1.0, 0.6);
+        let boxes: Vec<_> = (0..32)
+            .map(|i| {
+                let pos = v((i % 8) as f32 * 2.5 - 9.0, 0.5 + (i / 16) as f32 * 1.02, (i / 8 % 2) as f32 * 2.5 + 1.0);
+                w.body_box(DYNAMIC, pos, Quat::default(), v(0.5, 0.5, 0.5), 1.0, 0.6)
+            })
+            .collect();
+        let ball = w.body_box(DYNAMIC, v(-2.0, 0.5, 0.0), Quat::default(), v(0.4, 0.4, 0.4), 1.0, 0.6);
+        for _ in 0..300 {
+            w.step(1.0 / 60.0, 4);
+        }
+        assert!(boxes.iter().all(|&b| !w.awake(b)), "the boxes sleep packed");
+
+        let save = |w: &World| {
+            let mut buf = vec![0u8; w.snapshot_size(false)];
+            let n = w.save_snapshot(&mut buf, false).unwrap();
+            buf.truncate(n);
+            buf
+        };
+        // The ball rolls through the boxes across a cached line of sight
+        let mut cache = RayCache::new();
+        let (eye, look) = (v(-12.0, 0.5, 0.0), v(30.0, 0.0, 0.0));
+        let run = |w: &mut World, cache: &mut RayCache| -> Vec<(u64, Option<(Vec3, f32)>)> {
+            w.set_velocity(ball, v(6.0, 0.0, 2.0));
+            (0..120)
+                .map(|_| {
+                    w.step(1.0 / 60.0, 4);
+                    let hit = w.cast_ray_cached(cache, eye, look, !0);
+                    assert_eq!(hit, w.cast_ray(eye, look, !0));
+                    (w.hash_full(), hit)
+                })
+                .collect()
+        };
+        let mut snap = Snapshot::new();
+        assert!(w.capture(&mut snap) > 0);
+        let image = save(&w);
+        let straight = run(&mut w, &mut cache);
+
+        assert!(w.restore(&snap));
+        assert!(save(&w) == image, "a restore lands on the captured image");
+        assert!(run(&mut w, &mut cache) == straight, "restore replays");
+
+        assert!(w.load_snapshot(&image));
+        assert!(run(&mut w, &mut cache) == straight, "a reload replays the same");
+    }
+
+    /// The rollback ring: one keyframe plus a delta per tick. With most
+    /// of a pile asleep the deltas are a fraction of a full image, and
+    /// keyframe + delta expands to exactly the capture it encodes.
+    #[test]
+    fn deltas_are_small_and_expand_exactly() {
+        let (mut w, bodies) = drop_boxes(96);
+        for _ in 0..900 {
+            w.step(1.0 / 60.0, 4);
+        }
+        let awake = |w: &World| bodies.iter().filter(|&&b| w.awake(b)).count();
+        assert!(awake(&w) < 16, "pile mostly asleep, awake {}", awake(&w));
+
+        // A mover wanders through: a few awake rows per tick.
+        let mover = w.body_box(DYNAMIC, v(-20.0, 0.5, 0.0), Quat::default(), v(0.4, 0.4, 0.4), 1.0, 0.6);
+        let (mut key, mut full, mut expanded) = (Snapshot::new(), Snapshot::new(), Snapshot::new());
+        let full_len = w.capture(&mut key);
+        let mut ring: Vec<Snapshot> = Vec::new();
+        for _ in 0..10 {
+            w.set_velocity(mover, v(4.0, 0.0, 0.0));
+            w.step(1.0 / 60.0, 4);
+            w.capture(&mut full);
+            let mut d = Snapshot::new();
+            assert!(d.delta(&key, &full) > 0);
+            assert!(d.len() * 10 < full_len, "delta {} vs full {full_len}", d.len());
+            assert!(expanded.apply(&key, &d));
+            assert_eq!(expanded.len(), full.len());
+            ring.push(d);
+        }
+        assert!(!expanded.apply(&full, &ring[0]), "a delta only expands against its own keyframe");
+        assert!(!w.restore(&ring[0]), "deltas are not restorable as-is");
+
+        // Roll back to tick 4 from the ring and replay: same poses as
+        // the straight run.
+        let poses = |w: &World| {
+            bodies.iter().chain([&mover]).map(|&b| w.pose(b)).collect::<Vec<_>>()
+        };
+        let straight = poses(&w);
+        assert!(expanded.apply(&key, &ring[4]));
+        assert!(w.restore(&expanded));
+        for _ in 5..10 {
+            w.set_velocity(mover, v(4.0, 0.0, 0.0));
+            w.step(1.0 / 60.0, 4);
+        }
+        assert!(poses(&w) == straight, "ring rollback replays exactly");
+    }
+
+    /// Scoped rollback: a crate resting on the truck shares its island; rewinding that island puts both back while a
+    /// far-off box that kept falling is left where it is.
+    #[test]
+    fn island_restore_leaves_the_rest_alone() {
+        let mut w = World::new(v(0.0, -9.81, 0.0));
+        w.body_box(STATIC, v(0.0, -0.5, 0.0), Quat::default(), v(50.0, 0.5, 50.0), 1.0, 0.6);
+        let truck = w.body_box(DYNAMIC, v(0.0, 0.4, 0.0), Quat::default(), v(0.4, 0.4, 0.4), 1.0, 0.6);
+        let crate_ = w.body_box(DYNAMIC, v(0.0, 1.2, 0.0), Quat::default(), v(0.4, 0.4, 0.4), 1.0, 0.6);
+        let far = w.body_box(DYNAMIC, v(20.0, 10.0, 0.0), Quat::default(), v(0.4, 0.4, 0.4), 1.0, 0.6);
+        for _ in 0..20 {
+            w.step(1.0 / 60.0, 4);
+        }
+
+        let mut scope = Vec::new();
+        w.island_bodies(&[truck], &mut scope);
+        assert!(scope.contains(&truck) && scope.contains(&crate_), "touching boxes share an island");
+        assert!(!scope.contains(&far), "the falling box is its own island");
+
+        let mut rows = Vec::new();
+        w.capture_bodies(&scope, &mut rows);
+        let far_before = w.pose(far);
+        for _ in 0..30 {
+            w.set_velocity(truck, v(3.0, 0.0, 0.0));
+            w.step(1.0 / 60.0, 4);
+        }
+        let far_after = w.pose(far);
+        assert!(w.pose(crate_).0.x > 0.5, "the mispredicted push carried the crate");
+
+        w.restore_bodies(&scope, &rows);
+        for (&b, row) in scope.iter().zip(&rows) {
+            assert_eq!(w.pose(b), (row.pos, row.rot), "scoped bodies rewound");
+        }
+        assert!(far_after.0.y < far_before.0.y, "far box fell meanwhile");
+        assert_eq!(w.pose(far), far_after, "out-of-scope body untouched");
+    }
+
+    /// The running checksum tracks the full walk through every door
+    /// that moves or removes a body, and a one-body nudge shows up in
+    /// it the same tick.
+    #[test]
+    fn running_hash_matches_full_walk() {
+        let (mut w, bodies) = drop_boxes(40);
+        let (mut twin, _) = drop_boxes(40);
+        assert_eq!(w.hash(), w.hash_full());
+        let mut snap = Snapshot::new();
+        for tick in 0..240 {
+            match tick {
+                30 => w.destroy(bodies[3]),
+                60 => w.set_pose(bodies[7], v(9.0, 3.0, 9.0), Quat::default()),
+                90 => _ = w.capture(&mut snap),
+                120 => assert!(w.restore(&snap)),
+                _ => {}
+            }
+            w.step(1.0 / 60.0, 4);
+            assert_eq!(w.hash(), w.hash_full(), "tick {tick}");
+        }
+        for _ in 0..60 {
+            twin.step(1.0 / 60.0, 4);
+        }
+        let (mut other, others) = drop_boxes(40);
+        for _ in 0..60 {
+            other.step(1.0 / 60.0, 4);
+        }
+        assert_eq!(twin.hash(), other.hash(), "same run, same checksum");
+        other.set_velocity(others[0], v(0.0, 0.01, 0.0));
+        twin.step(1.0 / 60.0, 4);
+        other.step(1.0 / 60.0, 4);
+        assert_ne!(twin.hash(), other.hash(), "a nudge is a desync the same tick");
+    }
+
+    /// The built-in scheduler (FIFO claim cursor, spin-then-park
+    /// workers) runs a big pile to the same bytes as a serial world.
+    #[test]
+    fn threaded_world_matches_serial() {
+        let pile = |w: &mut World| {
+            w.body_box(STATIC, v(0.0, -0.5, 0.0), Quat::default(), v(50.0, 0.5, 50.0), 1.0, 0.6);
+            for i in 0..400 {
+                let (ix, iz, iy) = ((i % 10) as f32, ((i / 10) % 10) as f32, (i / 100) as f32);
+                w.body_box(DYNAMIC, v(ix * 0.9 - 4.5, 0.5 + iy * 0.9, iz * 0.9 - 4.5), Quat::default(), v(0.4, 0.4, 0.4), 1.0, 0.6);
+            }
+        };
+        let mut threaded = World::with_workers(v(0.0, -9.81, 0.0), 4);
+        let mut serial = World::new(v(0.0, -9.81, 0.0));
+        pile(&mut threaded);
+        pile(&mut serial);
+        let t = std::time::Instant::now();
+        for _ in 0..90 {
+            threaded.step(1.0 / 60.0, 4);
+        }
+        let threaded_time = t.elapsed();
+        let t = std::time::Instant::now();
+        for _ in 0..90 {
+            serial.step(1.0 / 60.0, 4);
+        }
+        println!("400-box pile, 90 steps: 4 workers {threaded_time:?}, serial {:?}", t.elapsed());
+        assert_eq!(threaded.hash_full(), serial.hash_full(), "worker count must not change the result");
+    }
+
+    /// A world pinned to one NUMA node's CPUs steps to the same bytes
+    /// as a serial world; off Linux, or without sysfs, it pins nothing.
+    #[test]
+    fn pinned_world_matches_serial() {
+        let pile = |w: &mut World| {
+            w.body_box(STATIC, v(0.0, -0.5, 0.0), Quat::default(), v(50.0, 0.5, 50.0), 1.0, 0.6);
+            for i in 0..200 {
+                let (ix, iz, iy) = ((i % 10) as f32, ((i / 10) % 10) as f32, (i / 100) as f32);
+                w.body_box(DYNAMIC, v(ix * 0.9 - 4.5, 0.5 + iy * 0.9, iz * 0.9 - 4.5), Quat::default(), v(0.4, 0.4, 0.4), 1.0, 0.6);
+            }
+        };
+        let (cpus, first) = numa_node_cpus(0).unwrap_or((1, 0));
+        assert_ne!(cpus & 1, 0, "a node's first CPU is bit 0");
+        let mut pinned = World::pinned(v(0.0, -9.81, 0.0), 4, cpus, first);
+        let mut serial = World::new(v(0.0, -9.81, 0.0));
+        pile(&mut pinned);
+        pile(&mut serial);
+        for _ in 0..60 {
+            pinned.step(1.0 / 60.0, 4);
+            serial.step(1.0 / 60.0, 4);
+        }
+        assert_eq!(pinned.hash_full(), serial.hash_full(), "CPU placement must not change the result");
+    }
+
+    /// The prediction contract between a 4-core client and a 32-core
+    /// server: one mixed scene (a pile, spheres shot fast enough for
+    /// continuous collision, a jointed cart, destroys mid-run, sleep)
+    /// steps to the same bytes and the same move event order on every
+    /// worker count, tree and grid broad-phase alike.
+    #[test]
+    fn any_worker_count_steps_identically() {
+        let scene = |w: &mut World| {
+            w.body_box(STATIC, v(0.0, -0.5, 0.0), Quat::default(), v(40.0, 0.5, 40.0), 1.0, 0.6);
+            let mut bodies = Vec::new();
+            for i in 0..400 {
+                let (ix, iz, iy) = ((i % 10) as f32, ((i / 10) % 10) as f32, (i / 100) as f32);
+                let p = v(ix * 0.9 - 4.5 + iy * 0.05, 0.5 + iy * 0.9, iz * 0.9 - 4.5);
+                bodies.push(if i % 4 == 0 {
+                    w.body_capsule(DYNAMIC, p, 0.2, 0.3, 1.0, 0.5, false)
+                } else {
+                    w.body_box(DYNAMIC, p, Quat::default(), v(0.4, 0.4, 0.4), 1.0, 0.6)
+                });
+            }
+            let chassis = w.body_box(DYNAMIC, v(12.0, 1.0, 0.0), Quat::default(), v(1.0, 0.3, 2.0), 1.0, 0.3);
+            for (x, z) in [(-1.2, -1.5), (1.2, -1.5), (-1.2, 1.5), (1.2, 1.5)] {
+                let wheel = w.body_sphere(DYNAMIC, v(12.0 + x, 0.5, z), 0.4, 1.0, 0.9);
+                w.wheel_joint(chassis, wheel, v(12.0 + x, 0.5, z), 5.0, 0.7, 50.0);
+            }
+            w.set_velocity(chassis, v(-3.0, 0.0, 0.0));
+            bodies
+        };
+        let run = |w: &mut World, bodies: &[BodyId]| {
+            let mut trace = Vec::new();
+            for step in 0..200 {
+                if step % 40 == 10 {
+                    let shot = w.body_sphere(DYNAMIC, v(-20.0, 1.0 + (step / 40) as f32, 0.3), 0.15, 4.0, 0.4);
+                    w.set_velocity(shot, v(120.0, 0.0, 0.0));
+                }
+                if step == 100 {
+                    bodies.iter().step_by(7).for_each(|&b| w.destroy(b));
+                }
+                w.step(1.0 / 60.0, 4);
+                let order = w.move_events().iter().fold(0u64, |h, e| h.wrapping_mul(31).wrapping_add(e.body().0));
+                trace.push((w.hash_full(), order));
+            }
+            trace
+        };
+        for grid in [false, true] {
+            let mut reference = None;
+            for workers in [1, 2, 3, 4, 6, 8, 16, 32] {
+                let mut w = if grid {
+                    World::with_grid(v(0.0, -9.81, 0.0), workers, 0.0)
+                } else {
+                    World::with_workers(v(0.0, -9.81, 0.0), workers)
+                };
+                let bodies = scene(&mut w);
+                let t = std::time::Instant::now();
+                let trace = run(&mut w, &bodies);
+                println!("mixed scene, 200 steps, grid {grid}: {workers} workers {:?}", t.elapsed());
+                match &reference {
+                    None => reference = Some(trace),
+                    Some(r) => {
+                        let first = r.iter().zip(&trace).position(|(a, b)| a != b);
+                        assert_eq!(first, None, "{workers} workers (grid {grid}) diverged from 1 worker at this step");
+                    }
+                }
+            }
+        }
+    }
+
+    /// Bouncing boxes start and stop touching all through the run, so the
+    /// workers' manifold caches fill, spill back and get freed into from
+    /// the main thread when bodies are destroyed. None of it shows in the
+    /// result.
+    #[test]
+    fn manifold_churn_on_workers_matches_serial() {
+        let rain = |w: &mut World| {
+            w.body_box(STATIC, v(0.0, -0.5, 0.0), Quat::default(), v(30.0, 0.5, 30.0), 1.0, 0.6);
+            (0..300)
+                .map(|i| {
+                    let p = v((i % 15) as f32 * 1.1 - 8.0, 1.0 + (i / 15) as f32 * 0.7, ((i * 7) % 15) as f32 * 1.1 - 8.0);
+                    w.body_box(DYNAMIC, p, Quat::default(), v(0.3, 0.3, 0.3), 1.0, 0.6)
+                })
+                .collect::<Vec<_>>()
+        };
+        let run = |w: &mut World, bodies: &[BodyId]| {
+            for step in 0..150 {
+                if step == 75 {
+                    bodies.iter().step_by(3).for_each(|&b| w.destroy(b));
+                }
+                w.step(1.0 / 60.0, 4);
+            }
+        };
+        let mut threaded = World::with_workers(v(0.0, -9.81, 0.0), 4);
+        let mut serial = World::new(v(0.0, -9.81, 0.0));
+        let threaded_bodies = rain(&mut threaded);
+        let serial_bodies = rain(&mut serial);
+        run(&mut threaded, &threaded_bodies);
+        run(&mut serial, &serial_bodies);
+        assert_eq!(threaded.hash_full(), serial.hash_full(), "worker count must not change the result");
+    }
+
+    /// Applied loads sit on the cold body record: a force pushes for
+    /// exactly one step, on the single and the batched path alike, and
+    /// the next step coasts.
+    #[test]
+    fn applied_force_lasts_one_step() {
+        let mut w = World::new(v(0.0, 0.0, 0.0));
+        let a = w.body_box(DYNAMIC, v(0.0, 0.0, 0.0), Quat::default(), v(0.5, 0.5, 0.5), 1.0, 0.6);
+        let b = w.body_box(DYNAMIC, v(5.0, 0.0, 0.0), Quat::default(), v(0.5, 0.5, 0.5), 1.0, 0.6);
+        w.force(a, v(10.0, 0.0, 0.0));
+        w.forces(&[b], &[v(10.0, 0.0, 0.0)]);
+        w.step(1.0 / 60.0, 4);
+        let (va, vb) = (w.velocity(a), w.velocity(b));
+        assert!(va.x > 0.0 && (va.x - vb.x).abs() < 1e-6, "{va:?} {vb:?}");
+        w.step(1.0 / 60.0, 4);
+        assert_eq!(w.velocity(a).x, va.x, "the force must not carry into the next step");
+        assert_eq!(w.velocity(b).x, vb.x);
+    }
+
+    /// The memory stats add up, grow with the world, and keep their peak.
+    #[test]
+    fn memory_stats_add_up_and_keep_the_peak() {
+        let mut w = World::new(v(0.0, -9.81, 0.0));
+        let empty = w.memory_stats();
+        w.body_box(STATIC, v(0.0, -0.5, 0.0), Quat::default(), v(20.0, 0.5, 20.0), 1.0, 0.6);
+        for i in 0..200 {
+            w.body_box(DYNAMIC, v((i % 10) as f32 - 5.0, 0.5 + (i / 10) as f32, 0.0), Quat::default(), v(0.4, 0.4, 0.4), 1.0, 0.6);
+        }
+        (0..30).for_each(|_| w.step(1.0 / 60.0, 4));
+        let s = w.memory_stats();
+        let parts = [s.bodies, s.shapes, s.sensors, s.contacts, s.joints, s.islands, s.constraint_graph, s.broad_phase_trees, s.pair_set, s.arenas, s.manifold_blocks, s.hulls, s.recording, s.other];
+        assert_eq!(parts.iter().sum::<u64>(), s.total);
+        assert!(s.bodies > empty.bodies && s.contacts > empty.contacts && s.manifold_blocks > 0, "{s:?}");
+        assert!(s.peak_arenas > 0 && s.peak_total >= s.total && s.total > empty.peak_total);
+    }
+
+    /// After a cull the compacted world holds far less, steps on, and
+    /// grows back; a small budget takes several calls to get there.
+    #[test]
+    fn compact_after_a_cull_gives_memory_back() {
+        let mut w = World::new(v(0.0, -9.81, 0.0));
+        w.body_box(STATIC, v(0.0, -0.5, 0.0), Quat::default(), v(40.0, 0.5, 40.0), 1.0, 0.6);
+        let boxes: Vec<_> = (0..1000)
+            .map(|i| w.body_box(DYNAMIC, v((i % 25) as f32 * 1.2 - 15.0, 0.5 + (i / 25) as f32 * 1.1, 0.0), Quat::default(), v(0.4, 0.4, 0.4), 1.0, 0.6))
+            .collect();
+        (0..30).for_each(|_| w.step(1.0 / 60.0, 4));
+        let peak = w.memory_stats();
+        boxes[20..].iter().for_each(|&b| w.destroy(b));
+        w.step(1.0 / 60.0, 4);
+        let mut calls = 1;
+        while !w.compact(4096) {
+            calls += 1;
+        }
+        let after = w.memory_stats();
+        assert!(calls > 1, "a 4 KB budget should split the pass");
+        assert!(after.bodies < peak.bodies / 4 && after.broad_phase_trees < peak.broad_phase_trees, "{peak:?} {after:?}");
+        (0..10).for_each(|_| w.step(1.0 / 60.0, 4));
+        let again: Vec<_> = (0..50).map(|i| w.body_box(DYNAMIC, v(i as f32 - 25.0, 3.0, 4.0), Quat::default(), v(0.4, 0.4, 0.4), 1.0, 0.6)).collect();
+        (0..10).for_each(|_| w.step(1.0 / 60.0, 4));
+        assert!(again.iter().all(|&b| w.pose(b).0.y < 3.0));
+    }
+
+    /// A batched wave gives the bodies single spawns would, lands
+    /// on a tree that already holds a wave, and the hogs stand on the floor.
+    #[test]
+    fn wave_spawn_matches_single_spawns() {
+        let wave = |z: f32| (0..300).map(|i| v((i % 20) as f32 * 1.1 - 11.0, 1.0, (i / 20) as f32 * 1.1 + z)).collect::<Vec<_>>();
+        let mut batched = World::new(v(0.0, -9.81, 0.0));
+        let mut single = World::new(v(0.0, -9.81, 0.0));
+        for w in [&mut batched, &mut single] {
+            w.body_box(STATIC, v(0.0, -0.5, 0.0), Quat::default(), v(60.0, 0.5, 60.0), 1.0, 0.6);
+        }
+        let first = batched.bodies_capsule(DYNAMIC, &wave(-20.0), 0.3, 0.3, 1.0, 0.6, true);
+        let singles: Vec<_> = wave(-20.0).into_iter().map(|p| single.body_capsule(DYNAMIC, p, 0.3, 0.3, 1.0, 0.6, true)).collect();
+        assert!(first.iter().zip(&singles).all(|(&a, &b)| batched.pose(a) == single.pose(b)));
+        assert_eq!(batched.hash_full(), single.hash_full());
+
+        (0..30).for_each(|_| batched.step(1.0 / 60.0, 4));
+        let second = batched.bodies_capsule(DYNAMIC, &wave(2.0), 0.3, 0.3, 1.0, 0.6, true);
+        (0..90).for_each(|_| batched.step(1.0 / 60.0, 4));
+        for &b in first.iter().chain(&second) {
+            let y = batched.pose(b).0.y;
+            assert!((y - 0.6).abs() < 0.05, "{y}");
+        }
+    }
+
+    /// An interned name lands on every body of a wave, batched or
+    /// recorded, and the recording carries the string for replay.
+    #[test]
+    fn interned_names_on_spawn_waves() {
+        let mut w = World::new(v(0.0, -9.81, 0.0));
+        let hog = w.intern_name("hog");
+        assert_eq!(w.intern_name("hog"), hog);
+        assert_eq!(w.intern_name(""), NameId::NONE);
+        let wave: Vec<_> = (0..20).map(|i| v(i as f32, 1.0, 0.0)).collect();
+        let batched = w.bodies_capsule_named(hog, DYNAMIC, &wave, 0.3, 0.3, 1.0, 0.6, true);
+        assert!(batched.iter().all(|&b| w.body_name(b) == "hog"));
+        let plain = w.bodies_capsule(DYNAMIC, &wave, 0.3, 0.3, 1.0, 0.6, true);
+        assert_eq!(w.body_name(plain[0]), "");
+
+        w.start_recording(0);
+        let recorded = w.bodies_capsule_named(hog, DYNAMIC, &wave, 0.3, 0.3, 1.0, 0.6, true);
+        w.step(1.0 / 60.0, 4);
+        let recording = w.stop_recording();
+        assert!(recorded.iter().all(|&b| w.body_name(b) == "hog"));
+        assert!(recording.windows(3).filter(|s| s == b"hog").count() >= recorded.len());
+        assert!(replay_is_valid(&recording));
+    }
+
+    /// Retired units turn inert and the riders on them drop to the floor;
+    /// the batch destroy then clears the corpses and the riders stay put.
+    #[test]
+    fn corpse_cleanup_in_batches() {
+        let mut w = World::new(v(0.0, -9.81, 0.0));
+        w.body_box(STATIC, v(0.0, -0.5, 0.0), Quat::default(), v(80.0, 0.5, 80.0), 1.0, 0.6);
+        let at = |i: i32, y: f32| v((i % 10) as f32 * 2.0 - 10.0, y, (i / 10) as f32 * 2.0 - 10.0);
+        let units: Vec<_> = (0..100).map(|i| w.body_box(DYNAMIC, at(i, 0.4), Quat::default(), v(0.4, 0.4, 0.4), 1.0, 0.6)).collect();
+        let riders: Vec<_> = (0..100).map(|i| w.body_box(DYNAMIC, at(i, 1.2), Quat::default(), v(0.4, 0.4, 0.4), 1.0, 0.6)).collect();
+        (0..60).for_each(|_| w.step(1.0 / 60.0, 4));
+        assert!(riders.iter().all(|&b| w.pose(b).0.y > 1.1));
+
+        w.retire(&units, KINEMATIC, 0, 0);
+        (0..90).for_each(|_| w.step(1.0 / 60.0, 4));
+        assert!(riders.iter().all(|&b| (w.pose(b).0.y - 0.4).abs() < 0.05), "riders fall through inert corpses");
+        assert!(units.iter().all(|&b| (w.pose(b).0.y - 0.4).abs() < 0.05), "corpses stay parked");
+
+        w.destroy_many(&units);
+        (0..30).for_each(|_| w.step(1.0 / 60.0, 4));
+        assert!(riders.iter().all(|&b| (w.pose(b).0.y - 0.4).abs() < 0.05));
+        w.destroy_many(&riders[..10]);
+        (0..10).for_each(|_| w.step(1.0 / 60.0, 4));
+    }
+
+    /// A settled horde falls asleep island by island in one step, the
+    /// neighbours' non-touching contacts going to the disabled set with
+    /// them; kicked awake in part it settles again. The batched sleep
+    /// gives the same bytes on any number of workers.
+    #[test]
+    fn horde_sleeps_in_one_batch() {
+        let horde = |w: &mut World| {
+            w.body_box(STATIC, v(0.0, -0.5, 0.0), Quat::default(), v(50.0, 0.5, 50.0), 1.0, 0.6);
+            (0..300)
+                .map(|i| {
+                    let p = v((i % 20) as f32 * 0.85 - 8.0, 0.4, (i / 20) as f32 * 0.85 - 6.0);
+                    w.body_box(DYNAMIC, p, Quat::default(), v(0.4, 0.4, 0.4), 1.0, 0.6)
+                })
+                .collect::<Vec<_>>()
+        };
+        let settle = |w: &mut World, bodies: &[BodyId]| {
+            let mut steps = 0;
+            while bodies.iter().any(|&b| w.awake(b)) {
+                w.step(1.0 / 60.0, 4);
+                steps += 1;
+                assert!(steps < 300, "the horde settles");
+            }
+            steps
+        };
+        let mut threaded = World::with_workers(v(0.0, -9.81, 0.0), 4);
+        let mut serial = World::new(v(0.0, -9.81, 0.0));
+        let threaded_bodies = horde(&mut threaded);
+        let serial_bodies = horde(&mut serial);
+
+        let steps = settle(&mut threaded, &threaded_bodies);
+        assert!(steps > 0);
+        assert_eq!(settle(&mut serial, &serial_bodies), steps);
+        assert_eq!(threaded.hash_full(), serial.hash_full(), "worker count must not change the sleep batch");
+
+        for (w, bodies) in [(&mut threaded, &threaded_bodies), (&mut serial, &serial_bodies)] {
+            for &b in bodies.iter().step_by(15) {
+                w.set_velocity(b, v(0.0, 3.0, 0.0));
+            }
+        }
+        let steps = settle(&mut threaded, &threaded_bodies);
+        assert!(steps > 0);
+        assert_eq!(settle(&mut serial, &serial_bodies), steps);
+        assert_eq!(threaded.hash_full(), serial.hash_full(), "worker count must not change the sleep batch");
+        for &b in &threaded_bodies {
+            let (p, _) = threaded.pose(b);
+            assert!(p.y > 0.3 && p.y < 0.5, "back on the ground: {p:?}");
+        }
+    }
+
+    /// A slab dropped across twelve sleeping stacks touches them all in
+    /// one step. Under a wake budget the stacks wake a few at a time,
+    /// and every one is awake soon after.
+    #[test]
+    fn wake_budget_spreads_a_pile_wake() {
+        let stacks = |w: &mut World| {
+            w.body_box(STATIC, v(0.0, -0.5, 0.0), Quat::default(), v(30.0, 0.5, 5.0), 1.0, 0.6);
+            let boxes = (0..36)
+                .map(|i| {
+                    let p = v((i / 3) as f32 * 1.5 - 8.25, 0.4 + (i % 3) as f32 * 0.8, 0.0);
+                    w.body_box(DYNAMIC, p, Quat::default(), v(0.4, 0.4, 0.4), 1.0, 0.6)
+                })
+                .collect::<Vec<_>>();
+            let mut steps = 0;
+            while boxes.iter().any(|&b| w.awake(b)) {
+                w.step(1.0 / 60.0, 4);
+                steps += 1;
+                assert!(steps < 300, "the stacks fall asleep");
+            }
+            w.body_box(DYNAMIC, v(0.0, 2.8, 0.0), Quat::default(), v(10.0, 0.2, 1.0), 1.0, 0.6);
+            boxes
+        };
+        let drop = |w: &mut World, boxes: &[BodyId]| {
+            let mut most = 0;
+            let mut steps = 0;
+            while boxes.iter().any(|&b| !w.awake(b)) {
+                w.step(1.0 / 60.0, 4);
+                most = most.max(w.wakes().0);
+                steps += 1;
+                assert!(steps < 60, "every stack wakes");
+            }
+            (most, steps)
+        };
+
+        let mut eager = World::new(v(0.0, -9.81, 0.0));
+        let boxes = stacks(&mut eager);
+        assert_eq!(drop(&mut eager, &boxes).0, 36, "one step wakes the whole pile");
+
+        let mut threaded = World::with_workers(v(0.0, -9.81, 0.0), 4);
+        let mut serial = World::new(v(0.0, -9.81, 0.0));
+        let threaded_boxes = stacks(&mut threaded);
+        let serial_boxes = stacks(&mut serial);
+        threaded.set_wake_budget(6);
+        serial.set_wake_budget(6);
+        let (most, steps) = drop(&mut threaded, &threaded_boxes);
+        assert!(most <= 6 && steps > 1, "{most} woken in a step over {steps} steps");
+        assert_eq!(drop(&mut serial, &serial_boxes), (most, steps));
+        assert_eq!(threaded.hash_full(), serial.hash_full(), "worker count must not change the wake order");
+    }
+
+    /// A flight recorder keeps a window of one to two keyframe intervals
+    /// that replays to the recorded state hashes. Doubling a long session
+    /// does not grow the window.
+    #[test]
+    fn flight_recorder_keeps_a_replayable_window() {
+        let session = |steps: usize| {
+            let mut w = World::with_workers(v(0.0, -9.81, 0.0), 4);
+            w.body_box(STATIC, v(0.0, -0.5, 0.0), Quat::default(), v(20.0, 0.5, 20.0), 1.0, 0.6);
+            let boxes = (0..24)
+                .map(|i| w.body_box(DYNAMIC, v((i % 6) as f32 * 1.2 - 3.0, 0.5 + (i / 6) as f32, 0.0), Quat::default(), v(0.4, 0.4, 0.4), 1.0, 0.6))
+                .collect::<Vec<_>>();
+            w.start_flight_recording(1 << 18, 30);
+            for s in 0..steps {
+                if s % 10 == 0 {
+                    w.set_velocity(boxes[s / 10 % boxes.len()], v(1.0, 2.0, 0.0));
+                }
+                w.step(1.0 / 60.0, 4);
+            }
+            w.stop_recording()
+        };
+
+        let short = session(45);
+        assert!(!short.is_empty() && replay_is_valid(&short), "a short session replays");
+        let long = session(1000);
+        let longer = session(2000);
+        assert!(replay_is_valid(&long) && replay_is_valid(&longer), "the windows replay");
+        assert!(longer.len() * 4 < long.len() * 5, "the window stays bounded: {} vs {}", longer.len(), long.len());
+    }
+
+    /// A crowd steered by velocity every step records mostly repeated
+    /// setters, which compress well and still replay.
+    #[test]
+    fn compressed_recordings_replay() {
+        let session = |compress: bool| {
+            let mut w = World::with_workers(v(0.0, -9.81, 0.0), 4);
+            w.body_box(STATIC, v(0.0, -0.5, 0.0), Quat::default(), v(20.0, 0.5, 20.0), 1.0, 0.6);
+            let boxes = (0..32)
+                .map(|i| w.body_box(DYNAMIC, v((i % 8) as f32 * 1.2 - 4.0, 0.4, (i / 8) as f32 * 1.2), Quat::default(), v(0.4, 0.4, 0.4), 1.0, 0.6))
+                .collect::<Vec<_>>();
+            w.start_flight_recording(1 << 20, 300);
+            for s in 0..240 {
+                for (i, &b) in boxes.iter().enumerate() {
+                    let t = s as f32 / 60.0 + i as f32;
+                    w.set_velocity(b, v(t.cos(), 0.0, t.sin()));
+                }
+                w.step(1.0 / 60.0, 4);
+            }
+            if compress { w.stop_recording_compressed() } else { w.stop_recording() }
+        };
+
+        let raw = session(false);
+        let packed = session(true);
+        assert!(replay_is_valid(&raw) && replay_is_valid(&packed), "both forms replay");
+        assert!(packed.len() * 2 < raw.len(), "compression pays: {} vs {}", packed.len(), raw.len());
+    }
+
+    /// A seek deep into a recording with embedded keyframes lands from
+    /// the one just before, without playing (and keyframing) the frames
+    /// before it, and the rest replays true. Seeking back works too.
+    #[test]
+    fn seeks_land_from_embedded_keyframes() {
+        let mut w = World::with_workers(v(0.0, -9.81, 0.0), 4);
+        w.body_box(STATIC, v(0.0, -0.5, 0.0), Quat::default(), v(20.0, 0.5, 20.0), 1.0, 0.6);
+        let boxes = (0..24)
+            .map(|i| w.body_box(DYNAMIC, v((i % 6) as f32 * 1.2 - 3.0, 0.5 + (i / 6) as f32, 0.0), Quat::default(), v(0.4, 0.4, 0.4), 1.0, 0.6))
+            .collect::<Vec<_>>();
+        w.start_recording(64);
+        for s in 0..600 {
+            if s % 10 == 0 {
+                w.set_velocity(boxes[s / 10 % boxes.len()], v(1.0, 3.0, 0.0));
+            }
+            w.step(1.0 / 60.0, 4);
+        }
+        let recording = w.stop_recording();
+        assert!(replay_is_valid(&recording));
+
+        let mut replay = Replay::new(&recording).unwrap();
+        assert_eq!(replay.frame_count(), 600);
+        replay.seek(580);
+        assert_eq!(replay.frame(), 580);
+        assert_eq!(replay.keyframe_bytes(), 0, "restored from frame 576, not played from 0");
+        while replay.step() {}
+        assert!(!replay.has_diverged(), "the frames after the seek replay true");
+        replay.seek(150);
+        assert_eq!(replay.frame(), 150);
+        while replay.step() {}
+        assert!(!replay.has_diverged());
+    }
+
+    /// A session that casts and overlaps a lot between steps checks out
+    /// the same whether its queries re-verify inline or across workers.
+    #[test]
+    fn recorded_queries_verify_in_parallel() {
+        let mut w = World::with_workers(v(0.0, -9.81, 0.0), 4);
+        w.body_box(STATIC, v(0.0, -0.5, 0.0), Quat::default(), v(20.0, 0.5, 20.0), 1.0, 0.6);
+        for i in 0..40 {
+            w.body_box(DYNAMIC, v((i % 8) as f32 * 1.2 - 4.0, 0.5 + (i / 8) as f32, 0.0), Quat::default(), v(0.4, 0.4, 0.4), 1.0, 0.6);
+        }
+        w.start_recording(0);
+        let mut hits = 0;
+        for s in 0..120 {
+            for r in 0..48 {
+                let x = r as f32 * 0.2 - 4.8 + s as f32 * 0.001;
+                hits += w.cast_ray(v(x, 8.0, 0.0), v(0.0, -10.0, 0.0), !0).is_some() as usize;
+                hits += w.overlap_capsule(v(x, 0.5, -1.0), v(x, 0.5, 1.0), 0.2, !0).len();
+            }
+            w.step(1.0 / 60.0, 4);
+        }
+        let recording = w.stop_recording();
+        assert!(hits > 1000, "the queries found the boxes: {hits}");
+        assert!(replay_is_valid(&recording));
+        assert!(replay_is_valid_with_workers(&recording, 4));
+    }
+
+    /// A timing replay skips the recorded queries but plays the same
+    /// load: every frame's bodies and contacts match the live step's,
+    /// and the replay world's profile reads a real step time.
+    #[test]
+    fn timing_replay_reproduces_the_recorded_load() {
+        let mut w = World::new(v(0.0, -9.81, 0.0));
+        w.body_box(STATIC, v(0.0, -0.5, 0.0), Quat::default(), v(20.0, 0.5, 20.0), 1.0, 0.6);
+        for i in 0..30 {
+            w.body_box(DYNAMIC, v((i % 6) as f32 * 1.2 - 3.0, 0.5 + (i / 6) as f32, 0.0), Quat::default(), v(0.4, 0.4, 0.4), 1.0, 0.6);
+        }
+        w.start_recording(0);
+        let mut live = Vec::new();
+        for s in 0..90 {
+            w.cast_ray(v(s as f32 * 0.05 - 2.0, 8.0, 0.0), v(0.0, -10.0, 0.0), !0);
+            w.step(1.0 / 60.0, 4);
+            let c = w.counters();
+            live.push((c[0], c[2]));
+        }
+        let recording = w.stop_recording();
+
+        let mut replay = Replay::new(&recording).unwrap();
+        replay.set_timing(true);
+        let (mut frame, mut timed) = (0, 0);
+        while replay.step() {
+            let c = replay.counters();
+            assert_eq!((c[0], c[2]), live[frame], "frame {frame}: bodies and contacts");
+            timed += (replay.profile()[0] > 0.0) as usize;
+            frame += 1;
+        }
+        assert_eq!(frame, 90);
+        assert!(timed > 0, "the replay world's profile reads the step");
+        assert!(!replay.has_diverged());
+    }
+
+    /// Boxes hop off a slab and land within a second. With revive on,
+    /// each landing picks up the contact the hop ended, threaded steps
+    /// match serial ones, and the boxes come to rest as they do without.
+    #[test]
+    fn hopping_boxes_revive_their_contacts() {
+        let hop = |w: &mut World| {
+            w.body_box(STATIC, v(0.0, -0.5, 0.0), Quat::default(), v(20.0, 0.5, 5.0), 1.0, 0.6);
+            let boxes = (0..10)
+                .map(|i| w.body_box(DYNAMIC, v(i as f32 * 1.5 - 7.0, 0.4, 0.0), Quat::default(), v(0.4, 0.4, 0.4), 1.0, 0.6))
+                .collect::<Vec<_>>();
+            let mut revived = 0;
+            for s in 0..300 {
+                if s % 60 == 20 && s < 200 {
+                    for &b in &boxes {
+                        w.set_velocity(b, v(0.0, 3.0, 0.0));
+                    }
+                }
+                w.step(1.0 / 60.0, 4);
+                revived += w.revived_contacts();
+            }
+            for &b in &boxes {
+                let (p, _) = w.pose(b);
+                assert!(p.y > 0.35 && p.y < 0.45, "at rest on the slab: {p:?}");
+            }
+            revived
+        };
+
+        let mut plain = World::new(v(0.0, -9.81, 0.0));
+        assert_eq!(hop(&mut plain), 0, "nothing revives by default");
+
+        let mut threaded = World::with_workers(v(0.0, -9.81, 0.0), 4);
+        let mut serial = World::new(v(0.0, -9.81, 0.0));
+        threaded.set_contact_revive(60);
+        serial.set_contact_revive(60);
+        let revived = hop(&mut threaded);
+        assert!(revived >= 30, "every landing revives: {revived}");
+        assert_eq!(hop(&mut serial), revived);
+        assert_eq!(threaded.hash_full(), serial.hash_full(), "worker count must not change revives");
+    }
+
+    /// Four sleeping rafts, one large enough to label its components
+    /// on every worker, each cut in two. Under a budget of four they
+    /// split in the same step; the halves are islands of their own, and
+    /// threaded steps match serial ones throughout.
+    #[test]
+    fn island_splits_share_a_step() {
+        let rafts = |w: &mut World| {
+            w.body_box(STATIC, v(0.0, -0.5, 0.0), Quat::default(), v(60.0, 0.5, 60.0), 1.0, 0.6);
+            let mut cuts = Vec::new();
+            let mut halves = Vec::new();
+            for (r, (n, x0)) in [(32, -40.0), (6, 0.0), (6, 10.0), (6, 20.0)].into_iter().enumerate() {
+                for i in 0..n * n {
+                    let (ix, iz) = (i % n, i / n);
+                    let p = v(x0 + ix as f32, 0.5, iz as f32 - 16.0);
+                    let b = w.body_box(DYNAMIC, p, Quat::default(), v(0.5, 0.5, 0.5), 1.0, 0.6);
+                    if ix == n / 2 {
+                        cuts.push(b);
+                    } else if i == 0 {
+                        halves.push((r, b));
+                    }
+                }
+            }
+            (cuts, halves)
+        };
+        let settle = |w: &mut World, probe: BodyId| {
+            let mut most = 0;
+            let mut steps = 0;
+            while w.awake(probe) {
+                w.step(1.0 / 60.0, 4);
+                most = most.max(w.split_islands());
+                steps += 1;
+                assert!(steps < 300, "the rafts sleep");
+            }
+            most
+        };
+
+        let mut threaded = World::with_workers(v(0.0, -9.81, 0.0), 4);
+        let mut serial = World::new(v(0.0, -9.81, 0.0));
+        let (cuts, halves) = rafts(&mut threaded);
+        let (serial_cuts, serial_halves) = rafts(&mut serial);
+        settle(&mut threaded, halves[0].1);
+        settle(&mut serial, serial_halves[0].1);
+        for (w, cuts) in [(&mut threaded, &cuts), (&mut serial, &serial_cuts)] {
+            w.set_island_split_budget(4);
+            for &b in cuts.iter() {
+                w.destroy(b);
+            }
+        }
+        assert_eq!(settle(&mut threaded, halves[0].1), 4, "the four rafts split together");
+        assert_eq!(settle(&mut serial, serial_halves[0].1), 4);
+        assert_eq!(threaded.hash_full(), serial.hash_full(), "worker count must not change the split");
+
+        let mut island = Vec::new();
+        for &(r, b) in &halves {
+            threaded.island_bodies(&[b], &mut island);
+            let n = if r == 0 { 32 } else { 6 };
+            assert_eq!(island.len(), n * (n / 2), "raft {r} keeps only its cut half");
+        }
+    }
+
+    /// A capture zone full of sleeping boxes is left alone while nothing
+    /// awake comes near it. A runner crossing it, one leaving it in a
+    /// single long step, and a box teleported out all still show up.
+    #[test]
+    fn sleeping_occupants_leave_a_sensor_alone() {
+        let mut w = World::new(v(0.0, -9.81, 0.0));
+        w.body_box(STATIC, v(0.0, -0.5, 0.0), Quat::default(), v(50.0, 0.5, 50.0), 1.0, 0.6);
+        let zone = w.sensor_box(v(0.0, 2.0, 0.0), v(5.0, 2.0, 5.0));
+        w.sensor_box(v(30.0, 2.0, 0.0), v(2.0, 2.0, 2.0));
+        let crowd = (0..6)
+            .map(|i| {
+                let b = w.body_box(DYNAMIC, v(i as f32 - 3.0, 0.4, -3.0), Quat::default(), v(0.4, 0.4, 0.4), 1.0, 0.6);
+                w.set_sensor_events(b, true);
+                b
+            })
+            .collect::<Vec<_>>();
+        let mut steps = 0;
+        while crowd.iter().any(|&b| w.awake(b)) {
+            w.step(1.0 / 60.0, 4);
+            steps += 1;
+            assert!(steps < 300, "the crowd sleeps");
+        }
+        w.step(1.0 / 60.0, 4);
+        assert_eq!(w.sensor_visitors(zone).len(), 6);
+        assert_eq!(w.skipped_sensors(), 2, "both zones are quiet");
+
+        let runner = w.body_sphere(KINEMATIC, v(-12.0, 1.0, 3.0), 0.5, 1.0, 0.6);
+        w.set_sensor_events(runner, true);
+        w.set_velocity(runner, v(6.0, 0.0, 0.0));
+        for _ in 0..240 {
+            w.step(1.0 / 60.0, 4);
+            let x = w.pose(runner).0.x;
+            let inside = w.sensor_visitors(zone).contains(&runner);
+            if x.abs() < 5.3 {
+                assert!(inside, "runner at {x} is in the zone");
+                assert_eq!(w.skipped_sensors(), 1);
+            } else if x.abs() > 5.7 {
+                assert!(!inside, "runner at {x} is out of the zone");
+            }
+            if x > -11.8 && x < -8.0 {
+                // The step that created the runner queried every sensor
+                assert_eq!(w.skipped_sensors(), 2);
+            }
+        }
+        assert!(crowd.iter().all(|&b| !w.awake(b)), "the runner never touched the crowd");
+
+        // Ten meters in one step, from the middle of the zone to clear of it
+        w.set_pose(runner, v(0.0, 1.0, 3.0), Quat::default());
+        w.set_velocity(runner, v(0.0, 0.0, 0.0));
+        w.step(1.0 / 60.0, 4);
+        assert!(w.sensor_visitors(zone).contains(&runner));
+        w.set_velocity(runner, v(600.0, 0.0, 0.0));
+        w.step(1.0 / 60.0, 4);
+        w.set_velocity(runner, v(0.0, 0.0, 0.0));
+        assert!(!w.sensor_visitors(zone).contains(&runner), "runner left at {:?}", w.pose(runner).0);
+
+        w.set_pose(crowd[0], v(-3.0, 0.4, 20.0), Quat::default());
+        w.step(1.0 / 60.0, 4);
+        let visitors = w.sensor_visitors(zone);
+        assert_eq!(visitors.len(), 5);
+        assert!(!visitors.contains(&crowd[0]), "the teleported box is gone");
+    }
+
+    /// Past a thousand dynamic boxes the tree rebuild splits into
+    /// subtrees sorted across the workers; the tree, and so every
+    /// step and query after it, comes out as a serial rebuild's.
+    #[test]
+    fn split_tree_rebuild_matches_serial() {
+        let crowd = |w: &mut World| {
+            w.body_box(STATIC, v(0.0, -0.5, 0.0), Quat::default(), v(60.0, 0.5, 60.0), 1.0, 0.6);
+            (0..1600)
+                .map(|i| {
+                    let (ix, iz, iy) = ((i % 40) as f32, ((i / 40) % 40) as f32, (i / 1600) as f32);
+                    w.body_box(DYNAMIC, v(ix * 1.2 - 24.0, 0.5 + iy, iz * 1.2 - 24.0), Quat::default(), v(0.4, 0.4, 0.4), 1.0, 0.6)
+                })
+                .collect::<Vec<_>>()
+        };
+        let mut threaded = World::with_workers(v(0.0, -9.81, 0.0), 4);
+        let mut serial = World::new(v(0.0, -9.81, 0.0));
+        let bodies = crowd(&mut threaded);
+        let serial_bodies = crowd(&mut serial);
+        for i in 0..40 {
+            // Keep the crowd milling so the dynamic tree rebuilds every step
+            for (w, bodies) in [(&mut threaded, &bodies), (&mut serial, &serial_bodies)] {
+                for (k, &b) in bodies.iter().enumerate().step_by(7) {
+                    w.set_velocity(b, v(((i + k) % 5) as f32 - 2.0, 0.0, ((i * 3 + k) % 5) as f32 - 2.0));
+                }
+                w.step(1.0 / 60.0, 4);
+            }
+        }
+        assert_eq!(threaded.hash_full(), serial.hash_full(), "worker count must not change the result");
+
+        let (p, _) = threaded.pose(bodies[820]);
+        let hit = threaded.cast_ray(v(p.x, 5.0, p.z), v(0.0, -10.0, 0.0), !0).expect("ray hits the crowd");
+        assert!(hit.0.y > 0.5, "{hit:?}");
+        assert_eq!(serial.cast_ray(v(p.x, 5.0, p.z), v(0.0, -10.0, 0.0), !0), Some(hit));
+    }
+
+    #[test]
+    fn nearest_matches_brute_force() {
+        let half = 0.4;
+        let centers: Vec<Vec3> = (0..300)
+            .map(|i| {
+                let f = i as f32;
+                v((f * 7.31).sin() * 20.0, half + (i % 3) as f32 * 2.0, (f * 3.17).cos() * 20.0)
+            })
+            .collect();
+        let scene = |w: &mut World| {
+            let ground = w.body_box(STATIC, v(0.0, -0.5, 0.0), Quat::default(), v(50.0, 0.5, 50.0), 1.0, 0.6);
+            let boxes: Vec<BodyId> = centers
+                .iter()
+                .map(|&c| w.body_box(DYNAMIC, c, Quat::default(), v(half, half, half), 1.0, 0.6))
+                .collect();
+            (ground, boxes)
+        };
+        let dist_to_box = |p: Vec3, c: Vec3, h: Vec3| {
+            let d = |a: f32, c: f32, h: f32| ((a - c).abs() - h).max(0.0);
+            let (x, y, z) = (d(p.x, c.x, h.x), d(p.y, c.y, h.y), d(p.z, c.z, h.z));
+            (x * x + y * y + z * z).sqrt()
+        };
+
+        let mut tree = World::new(v(0.0, -9.81, 0.0));
+        let mut grid = World::with_grid(v(0.0, -9.81, 0.0), 1, 1.0);
+        let worlds = [scene(&mut tree), scene(&mut grid)];
+        for p in [v(0.0, 3.0, 0.0), v(12.0, 1.0, -7.0), v(-25.0, 6.0, 18.0)] {
+            // Index 0 is the ground, then the boxes in spawn order
+            let mut brute: Vec<(usize, f32)> = std::iter::once((0, p.y))
+                .chain(centers.iter().enumerate().map(|(i, &c)| (i + 1, dist_to_box(p, c, v(half, half, half)))))
+                .collect();
+            brute.sort_by(|a, b| a.1.total_cmp(&b.1));
+
+            for (w, (ground, boxes)) in [&tree, &grid].into_iter().zip(&worlds) {
+                let index = |b: BodyId| if b == *ground { 0 } else { 1 + boxes.iter().position(|&x| x == b).unwrap() };
+                let near = w.nearest(p, f32::MAX, !0, 6);
+                assert_eq!(near.len(), 6);
+                for ((b, d), (i, bd)) in near.iter().zip(&brute) {
+                    assert_eq!(index(*b), *i, "{p:?}");
+                    assert!((d - bd).abs() < 1e-3, "{d} vs {bd}");
+                }
+
+                let ranged = w.nearest(p, 4.0, !0, 64);
+                assert_eq!(ranged.len(), brute.iter().filter(|b| b.1 < 4.0).count().min(64), "{p:?}");
+                assert!(ranged.windows(2).all(|r| r[0].1 <= r[1].1));
+            }
+        }
+    }
+
+    /// A 40-point debris hull takes the wide support path in GJK. A
+    /// point out along a vertex direction is closest to that vertex, so
+    /// the distance is exact.
+    #[test]
+    fn wide_support_measures_big_hulls() {
+        let golden = std::f32::consts::PI * (3.0 - 5.0f32.sqrt());
+        let points: Vec<Vec3> = (0..40)
+            .map(|i| {
+                let y = 1.0 - (i as f32 + 0.5) / 20.0;
+                let r = (1.0 - y * y).sqrt();
+                let a = golden * i as f32;
+                v(r * a.cos(), y, r * a.sin())
+            })
+            .collect();
+        let center = v(3.0, 5.0, -2.0);
+        let mut w = World::new(v(0.0, 0.0, 0.0));
+        let debris = w.body_hull(STATIC, center, Quat::default(), &points, 1.0, 0.6);
+        for p in points.iter().step_by(5) {
+            let q = v(center.x + 1.5 * p.x, center.y + 1.5 * p.y, center.z + 1.5 * p.z);
+            let near = w.nearest(q, 2.0, !0, 1);
+            assert_eq!(near.len(), 1);
+            assert_eq!(near[0].0, debris);
+            assert!((near[0].1 - 0.5).abs() < 1e-3, "{} at {q:?}", near[0].1);
+        }
+    }
+
+    #[test]
+    fn resting_contacts_skip_their_update() {
+        let (mut rested, bodies) = drop_boxes(48);
+        let (mut updated, updated_bodies) = drop_boxes(48);
+        updated.set_contact_rest_distance(0.0);
+        let (mut hits, mut touching) = (0, 0);
+        for _ in 0..90 {
+            rested.step(1.0 / 60.0, 4);
+            updated.step(1.0 / 60.0, 4);
+            let (recycled, skipped) = rested.contact_reuse();
+            hits += skipped;
+            touching += recycled + skipped;
+            assert_eq!(updated.contact_reuse().1, 0);
+        }
+        assert!(hits > 0, "settling stacks rest some contacts ({touching} reused)");
+
+        // The kept manifolds are off by less than the slop: the piles
+        // settle the same way
+        for (&a, &b) in bodies.iter().zip(&updated_bodies) {
+            let ((pa, _), (pb, _)) = (rested.pose(a), updated.pose(b));
+            let d = ((pa.x - pb.x).powi(2) + (pa.y - pb.y).powi(2) + (pa.z - pb.z).powi(2)).sqrt();
+            assert!(d < 0.05, "{pa:?} vs {pb:?}");
+        }
+    }
+
+    #[test]
+    fn reserved_tree_takes_a_spawn_wave_without_growing() {
+        let wave = |w: &mut World| {
+            w.body_box(STATIC, v(0.0, -0.5, 0.0), Quat::default(), v(40.0, 0.5, 40.0), 1.0, 0.6);
+            for i in 0..900 {
+                let (ix, iz, iy) = ((i % 30) as f32, ((i / 30) % 30) as f32, (i / 900) as f32);
+                w.body_box(DYNAMIC, v(ix * 1.2 - 18.0, 0.5 + iy, iz * 1.2 - 18.0), Quat::default(), v(0.4, 0.4, 0.4), 1.0, 0.6);
+            }
+        };
+        let mut reserved = World::new(v(0.0, -9.81, 0.0));
+        let mut grown = World::new(v(0.0, -9.81, 0.0));
+        reserved.reserve(1, 900);
+        let capacity = reserved.tree_capacity(DYNAMIC);
+        assert!(capacity >= 2 * 900 - 1, "{capacity}");
+        assert!(grown.tree_capacity(DYNAMIC) < capacity);
+
+        wave(&mut reserved);
+        wave(&mut grown);
+        for _ in 0..30 {
+            reserved.step(1.0 / 60.0, 4);
+            grown.step(1.0 / 60.0, 4);
+        }
+        assert_eq!(reserved.tree_capacity(DYNAMIC), capacity, "the wave fit in the reserve");
+        assert!(grown.tree_capacity(DYNAMIC) >= 2 * 900 - 1);
+        assert_eq!(reserved.hash_full(), grown.hash_full(), "reserving must not change the result");
+    }
+
+    #[test]
+    fn narrowed_scratch_reserve_keeps_the_step_off_the_heap() {
+        let pile = |w: &mut World| {
+            w.body_box(STATIC, v(0.0, -0.5, 0.0), Quat::default(), v(20.0, 0.5, 20.0), 1.0, 0.6);
+            for i in 0..200 {
+                let (ix, iz, iy) = ((i % 10) as f32, ((i / 10) % 10) as f32, (i / 100) as f32);
+                w.body_box(DYNAMIC, v(ix * 0.9 - 4.5, 0.5 + iy * 0.9, iz * 0.9 - 4.5), Quat::default(), v(0.4, 0.4, 0.4), 1.0, 0.6);
+            }
+        };
+        let mut starved = World::new(v(0.0, -9.81, 0.0));
+        pile(&mut starved);
+        starved.set_scratch_reserve(64, 64);
+        let mut heap = 0;
+        for _ in 0..60 {
+            starved.step(1.0 / 60.0, 4);
+            heap += starved.step_heap_count();
+        }
+        assert!(heap > 0, "a starved reserve spills to the heap");
+        assert_eq!(starved.step_heap_count(), 0, "and regrows to a steady state");
+        let (arena, world_arena) = starved.scratch_demand();
+        assert!(arena > 64 && world_arena > 64, "{arena} {world_arena}");
+
+        let mut sized = World::new(v(0.0, -9.81, 0.0));
+        pile(&mut sized);
+        sized.set_scratch_reserve(arena, world_arena);
+        for _ in 0..60 {
+            sized.step(1.0 / 60.0, 4);
+            assert_eq!(sized.step_heap_count(), 0, "the measured demand covers every step");
+        }
+        assert_eq!(sized.hash_full(), starved.hash_full(), "the reserve must not change the result");
+    }
+
+    /// The 8- and 16-wide contact solvers (where the CPU has AVX2 /
+    /// AVX-512) pack a color into fewer wide constraints than the
+    /// 4-wide one and must land on the same bytes — servers and clients
+    /// can differ in width.
+    #[test]
+    fn simd_widths_agree() {
+        let crowd = |w: &mut World| {
+            w.body_box(STATIC, v(0.0, -0.5, 0.0), Quat::default(), v(50.0, 0.5, 50.0), 1.0, 0.6);
+            for i in 0..300 {
+                let (ix, iz, iy) = ((i % 10) as f32, ((i / 10) % 10) as f32, (i / 100) as f32);
+                w.body_box(DYNAMIC, v(ix * 0.9 - 4.5, 0.5 + iy * 0.9, iz * 0.9 - 4.5), Quat::default(), v(0.4, 0.4, 0.4), 1.0, 0.6);
+            }
+        };
+        let mut hashes = Vec::new();
+        for cap in [4, 0, 16] {
+            let mut w = World::with_simd_width(v(0.0, -9.81, 0.0), cap);
+            crowd(&mut w);
+            let t = std::time::Instant::now();
+            for _ in 0..90 {
+                w.step(1.0 / 60.0, 4);
+            }
+            println!("300-box crowd, 90 steps, {} lanes: {:?}", w.simd_width(), t.elapsed());
+            hashes.push((w.simd_width(), w.hash_full()));
+        }
+        assert_eq!(hashes[0].0, 4);
+        for &(width, hash) in &hashes[1..] {
+            assert_eq!(hash, hashes[0].1, "{width} lanes must not change the result");
+        }
+    }
+
+    /// Wheel joints solve in the same wide lanes as contacts: a driven
+    /// fleet lands on the same bytes at every width, and still drives.
+    #[test]
+    fn wheel_joints_solve_wide() {
+        let fleet = |w: &mut World| {
+            w.body_box(STATIC, v(0.0, -0.5, 0.0), Quat::default(), v(80.0, 0.5, 80.0), 1.0, 0.8);
+            let mut trucks = Vec::new();
+            for i in 0..12 {
+                let x = i as f32 * 4.0 - 22.0;
+                let chassis = w.body_box(DYNAMIC, v(x, 1.05, 0.0), Quat::default(), v(0.9, 0.35, 1.6), 2.0, 0.3);
+                for (mx, mz) in [(-0.95, 1.15), (0.95, 1.15), (-0.95, -1.15), (0.95, -1.15)] {
+                    // Mounts are chassis-local
+                    let wheel = w.body_sphere(DYNAMIC, v(x + mx, 0.55, mz), 0.42, 1.5, 1.2);
+                    let joint = w.wheel_joint(chassis, wheel, v(mx, -0.25, mz), 4.0, 0.7, 400.0);
+                    w.wheel_spin(joint, -(12.0 + i as f32));
+                }
+                trucks.push(chassis);
+            }
+            trucks
+        };
+        let mut runs = Vec::new();
+        for cap in [4, 0, 16] {
+            let mut w = World::with_simd_width(v(0.0, -9.81, 0.0), cap);
+            let trucks = fleet(&mut w);
+            let t = std::time::Instant::now();
+            for _ in 0..120 {
+                w.step(1.0 / 60.0, 4);
+            }
+            println!("12 trucks, 120 steps, {} lanes: {:?}", w.simd_width(), t.elapsed());
+            let travel: Vec<f32> = trucks.iter().map(|&c| w.pose(c).0.z).collect();
+            runs.push((w.simd_width(), w.hash_full(), travel));
+        }
+        for (i, z) in runs[0].2.iter().enumerate() {
+            assert!(z.abs() > 3.0, "truck {i} should drive off its spawn, got z {z}");
+        }
+        for (width, hash, _) in &runs[1..] {
+            assert_eq!(*hash, runs[0].1, "{width} lanes must not change the result");
+        }
+    }
+
+    /// One by one, a truck's four wheel joints each correct the chassis
+    /// and undo part of the others. The vehicle solver takes them as one
+    /// block, so the wheels hold their mounts at half the substeps.
+    #[test]
+    fn vehicle_wheels_hold_at_fewer_substeps() {
+        // Mean distance of the wheel centers off their suspension lines
+        let drift = |vehicle: bool, substeps: i32| {
+            let mut w = World::new(v(0.0, -9.81, 0.0));
+            w.body_box(STATIC, v(0.0, -0.5, 0.0), Quat::default(), v(150.0, 0.5, 150.0), 1.0, 0.6);
+            w.body_box(STATIC, v(0.0, 0.06, 10.0), Quat::default(), v(6.0, 0.06, 0.35), 1.0, 0.5);
+            let chassis = w.body_box(DYNAMIC, v(0.0, 1.05, -20.0), Quat::default(), v(0.9, 0.35, 1.6), 2.0, 0.3);
+            let mounts = [v(-0.95, -0.25, 1.15), v(0.95, -0.25, 1.15), v(-0.95, -0.25, -1.15), v(0.95, -0.25, -1.15)];
+            let mut wheels = Vec::new();
+            for m in mounts {
+                let wheel = w.body_sphere(DYNAMIC, v(m.x, 0.55, -20.0 + m.z), 0.42, 1.5, 1.2);
+                let joint = if vehicle {
+                    w.vehicle_wheel_joint(chassis, wheel, m, 4.0, 0.7, 400.0)
+                } else {
+                    w.wheel_joint(chassis, wheel, m, 4.0, 0.7, 400.0)
+                };
+                w.wheel_spin(joint, -24.0);
+                wheels.push(wheel);
+            }
+            let mut sum = 0.0;
+            for i in 0..360 {
+                w.step(1.0 / 60.0, substeps);
+                if i < 60 {
+                    // Let it land first
+                    continue;
+                }
+                let (p, q) = w.pose(chassis);
+                for (m, &wheel) in mounts.iter().zip(&wheels) {
+                    // Wheel center into the chassis frame: rotate by the conjugate
+                    let c = w.pose(wheel).0;
+                    let d = [c.x - p.x, c.y - p.y, c.z - p.z];
+                    let u = [-q.x, -q.y, -q.z];
+                    let cross = |a: [f32; 3], b: [f32; 3]| {
+                        [a[1] * b[2] - a[2] * b[1], a[2] * b[0] - a[0] * b[2], a[0] * b[1] - a[1] * b[0]]
+                    };
+                    let t = cross(u, d);
+                    let t = cross(u, [t[0] + q.w * d[0], t[1] + q.w * d[1], t[2] + q.w * d[2]]);
+                    let local = [d[0] + 2.0 * t[0], d[2] + 2.0 * t[2]];
+                    sum += ((local[0] - m.x).powi(2) + (local[1] - m.z).powi(2)).sqrt();
+                }
+            }
+            let (p, _) = w.pose(chassis);
+            (sum / 1200.0, (p.x * p.x + (p.z + 20.0) * (p.z + 20.0)).sqrt())
+        };
+        let (loose4, _) = drift(false, 4);
+        let (loose1, _) = drift(false, 1);
+        let (block2, travel) = drift(true, 2);
+        let (block1, _) = drift(true, 1);
+        println!("wheel drift: joints {loose1:.5} @1 {loose4:.5} @4, vehicle {block1:.5} @1 {block2:.5} @2");
+        assert!(travel > 20.0, "the vehicle still drives, {travel} m");
+        assert!(block2 < 0.5 * loose4, "vehicle at 2 substeps {block2} vs joints at 4 {loose4}");
+        assert!(block1 < 0.5 * loose1, "vehicle at 1 substep {block1} vs joints {loose1}");
+    }
+
+    /// Hogs that ask for one sub-step ride a four sub-step world on a
+    /// stride of four: they land where a one sub-step world puts them,
+    /// while the stack beside them still takes all four.
+    #[test]
+    fn substep_hints_step_islands_on_their_own_stride() {
+        let run = |hinted: bool, substeps: i32| {
+            let mut w = World::new(v(0.0, -9.81, 0.0));
+            w.body_box(STATIC, v(0.0, -0.5, 0.0), Quat::default(), v(50.0, 0.5, 50.0), 1.0, 0.6);
+            let hogs: Vec<BodyId> = (0..6)
+                .map(|i| {
+                    let x = i as f32 * 3.0 - 8.0;
+                    let hog = w.body_box(DYNAMIC, v(x, 1.0 + 0.2 * i as f32, 6.0), Quat::default(), v(0.6, 0.4, 0.9), 1.0, 0.6);
+                    w.lock_rotation(hog);
+                    w.set_velocity(hog, v(1.5, 0.0, -0.5 * i as f32));
+                    if hinted {
+                        w.set_substep_hint(hog, 1);
+                    }
+                    hog
+                })
+                .collect();
+            let stack: Vec<BodyId> = (0..6)
+                .map(|i| w.body_box(DYNAMIC, v(0.0, 0.5 + i as f32, -4.0), Quat::default(), v(0.5, 0.5, 0.5), 1.0, 0.6))
+                .collect();
+            for _ in 0..180 {
+                w.step(1.0 / 60.0, substeps);
+            }
+            let hogs: Vec<Vec3> = hogs.iter().map(|&b| w.pose(b).0).collect();
+            (hogs, w.pose(stack[5]).0)
+        };
+        let (tiered_hogs, tiered_top) = run(true, 4);
+        let (single_hogs, _) = run(false, 1);
+        let (full_hogs, full_top) = run(false, 4);
+        assert!(tiered_hogs.iter().zip(&full_hogs).any(|(a, b)| a.y != b.y), "four sub-steps land elsewhere");
+        for (a, b) in tiered_hogs.iter().zip(&single_hogs) {
+            assert!((a.y - 0.4).abs() < 0.02, "hog rests on the ground at {}", a.y);
+            let d = ((a.x - b.x).powi(2) + (a.y - b.y).powi(2) + (a.z - b.z).powi(2)).sqrt();
+            assert!(d < 1e-4, "hog on a stride of four tracks one sub-step: {a:?} vs {b:?}");
+        }
+        let d = ((tiered_top.x - full_top.x).powi(2) + (tiered_top.y - full_top.y).powi(2)).sqrt();
+        assert!(d < 1e-4, "the stack keeps its four sub-steps: {tiered_top:?} vs {full_top:?}");
+        assert!((tiered_top.y - 5.5).abs() < 0.05, "the stack stands, top at {}", tiered_top.y);
+    }
+
+    #[test]
+    fn query_only_bodies_answer_queries_and_touch_nothing() {
+        const HITBOX: u64 = 1 << 2;
+        let mut w = World::new(v(0.0, -9.81, 0.0));
+        w.body_box(STATIC, v(0.0, -0.5, 0.0), Quat::default(), v(100.0, 0.5, 100.0), 1.0, 0.6);
+        // Filters that would match both ways: only the query-only flag
+        // keeps the falling box from landing on the hitbox
+        let hitbox = w.body_query_box(v(0.0, 1.5, 0.0), Quat::default(), v(1.0, 0.5, 1.0), HITBOX, !0);
+        let faller = w.body_box(DYNAMIC, v(0.0, 4.0, 0.0), Quat::default(), v(0.5, 0.5, 0.5), 1.0, 0.6);
+        for _ in 0..120 {
+            w.step(1.0 / 60.0, 4);
+        }
+        assert!((w.pose(faller).0.y - 0.5).abs() < 0.02, "fell through to the ground, at {}", w.pose(faller).0.y);
+        assert_eq!(w.overlap_capsule(v(0.0, 1.5, 0.0), v(0.0, 1.6, 0.0), 0.1, HITBOX), vec![hitbox]);
+
+        // Posed in a batch onto the sleeping faller: the tree answers at
+        // the new spot, the faller sleeps on, the step ignores it
+        assert!(!w.awake(faller));
+        let parts: Vec<BodyId> = (0..3)
+            .map(|i| w.body_query_box(v(20.0 + i as f32, 1.0, 0.0), Quat::default(), v(0.3, 0.3, 0.3), HITBOX, !0))
+            .collect();
+        let mut bodies = parts.clone();
+        bodies.push(hitbox);
+        let positions = [v(-3.0, 1.0, 0.0), v(-2.0, 1.0, 0.0), v(-1.0, 1.0, 0.0), v(0.0, 0.5, 0.0)];
+        w.set_query_poses(&bodies, &positions, &[Quat::default(); 4]);
+        assert!(w.overlap_capsule(v(0.0, 1.5, 0.0), v(0.0, 1.6, 0.0), 0.05, HITBOX).is_empty());
+        let (hit, _) = w.cast_ray(v(-5.0, 1.0, 0.0), v(10.0, 0.0, 0.0), HITBOX).expect("ray finds the first part");
+        assert!((hit.x + 3.3).abs() < 0.01, "hit at {hit:?}");
+        assert_eq!(w.pose(hitbox).0.y, 0.5);
+        for _ in 0..30 {
+            w.step(1.0 / 60.0, 4);
+        }
+        assert!(!w.awake(faller));
+        assert!((w.pose(faller).0.y - 0.5).abs() < 0.02);
+    }
+
+    #[test]
+    fn contact_events_come_only_for_opted_in_categories() {
+        const CRATE: u64 = 1 << 1;
+        const HOG: u64 = 1 << 2;
+        let mut w = World::new(v(0.0, -9.81, 0.0));
+        // Off the default category, which is every bit and so matches
+        let ground = w.body_box(STATIC, v(0.0, -0.5, 0.0), Quat::default(), v(100.0, 0.5, 100.0), 1.0, 0.6);
+        w.set_filter(ground, 1, !0);
+        let crate_box = w.body_box(DYNAMIC, v(0.0, 3.0, 0.0), Quat::default(), v(0.5, 0.5, 0.5), 1.0, 0.6);
+        w.set_filter(crate_box, CRATE, !0);
+        let hogs: Vec<BodyId> = (0..8)
+            .map(|i| w.body_box(DYNAMIC, v(3.0 + i as f32 * 0.9, 0.5 + (i % 2) as f32, 0.0), Quat::default(), v(0.4, 0.4, 0.4), 1.0, 0.6))
+            .collect();
+        for &h in &hogs {
+            w.set_filter(h, HOG, !0);
+        }
+
+        // Off by default: hogs landing on each other and the ground, and
+        // the crate, report nothing
+        for _ in 0..10 {
+            w.step(1.0 / 60.0, 4);
+            let e = w.contact_events();
+            assert!(e.begin.is_empty() && e.end.is_empty() && e.hit.is_empty());
+        }
+
+        w.set_contact_events(CRATE, CRATE);
+        let (mut begins, mut hits) = (0, 0);
+        for _ in 0..60 {
+            w.step(1.0 / 60.0, 4);
+            let e = w.contact_events();
+            for t in e.begin {
+                assert!([t.shape_a(), t.shape_b()].iter().any(|&s| w.shape_body(s) == Some(crate_box)));
+                begins += 1;
+            }
+            for h in e.hit {
+                assert!([h.shape_a(), h.shape_b()].iter().any(|&s| w.shape_body(s) == Some(crate_box)));
+                assert!(h.approach_speed > 1.0 && (h.point.y).abs() < 0.1, "hit {h:?}");
+                hits += 1;
+            }
+        }
+        assert_eq!((begins, hits), (1, 1), "the crate lands once, the hogs stay quiet");
+
+        // Lifted off the ground: the end event names it; destroyed, its
+        // shape maps to no body
+        w.set_pose(crate_box, v(0.0, 10.0, 0.0), Quat::default());
+        w.step(1.0 / 60.0, 4);
+        let end = w.contact_events().end;
+        assert_eq!(end.len(), 1);
+        let shape = if w.shape_body(end[0].shape_a()) == Some(crate_box) { end[0].shape_a() } else { end[0].shape_b() };
+        assert_eq!(w.shape_body(shape), Some(crate_box));
+        w.destroy(crate_box);
+        assert_eq!(w.shape_body(shape), None);
+    }
+
+    #[test]
+    fn body_impacts_sum_the_push_of_every_contact() {
+        const DT: f32 = 1.0 / 60.0;
+        let mut w = World::new(v(0.0, -9.81, 0.0));
+        w.body_box(STATIC, v(0.0, -0.5, 0.0), Quat::default(), v(100.0, 0.5, 100.0), 1.0, 0.6);
+        let light = w.body_box(DYNAMIC, v(0.0, 0.5, 0.0), Quat::default(), v(0.5, 0.5, 0.5), 1.0, 0.6);
+        let heavy = w.body_box(DYNAMIC, v(3.0, 0.5, 0.0), Quat::default(), v(0.5, 0.5, 0.5), 10.0, 0.6);
+        let quiet = w.body_box(DYNAMIC, v(6.0, 0.5, 0.0), Quat::default(), v(0.5, 0.5, 0.5), 1.0, 0.6);
+        w.step(DT, 4);
+        assert!(w.body_impacts().is_empty(), "off by default");
+
+        w.set_impacts(light, true);
+        w.set_impacts(heavy, true);
+        w.step(DT, 4);
+        let impacts = w.body_impacts();
+        assert_eq!(impacts.len(), 2);
+        assert!(impacts.iter().all(|i| i.body() != quiet));
+        // At rest the ground holds each box up, summed over its corners:
+        // ten times the mass, ten times the push
+        let push = |b| impacts.iter().find(|i| i.body() == b).unwrap().normal_impulse;
+        assert!(push(light) > 9.81 * DT && push(light) < 3.0 * 9.81 * DT, "{impacts:?}");
+        assert!((push(heavy) / push(light) - 10.0).abs() < 0.5, "{impacts:?}");
+
+        // A drop lands with its speed in the record
+        w.set_impacts(light, false);
+        w.set_pose(heavy, v(3.0, 5.0, 0.0), Quat::default());
+        let mut landing = None;
+        for _ in 0..120 {
+            w.step(DT, 4);
+            assert!(w.body_impacts().iter().all(|i| i.body() == heavy));
+            if let Some(i) = w.body_impacts().first() {
+                landing.get_or_insert(*i);
+            }
+        }
+        let landing = landing.expect("the heavy box lands");
+        assert!(landing.max_approach_speed > 5.0 && landing.normal_impulse > 10.0 * 5.0 * 0.5, "{landing:?}");
+    }
+
+    #[test]
+    fn cached_line_of_sight_walks_only_when_something_moves_near() {
+        let mut w = World::new(v(0.0, -9.81, 0.0));
+        w.body_box(STATIC, v(0.0, -0.5, 0.0), Quat::default(), v(100.0, 0.5, 100.0), 1.0, 0.6);
+        w.body_box(STATIC, v(10.0, 2.0, 0.0), Quat::default(), v(0.5, 2.0, 2.0), 1.0, 0.6);
+        let crowd: Vec<BodyId> = (0..4)
+            .map(|i| w.body_box(DYNAMIC, v(2.0 * i as f32, 0.5, 2.0), Quat::default(), v(0.5, 0.5, 0.5), 1.0, 0.6))
+            .collect();
+        for _ in 0..90 {
+            w.step(1.0 / 60.0, 4);
+        }
+        assert!(crowd.iter().all(|&b| !w.awake(b)));
+
+        // A still crowd beside the ray: one walk, then the cache answers,
+        // also for an eye that sways a little
+        let mut cache = RayCache::new();
+        let (eye, look) = (v(0.0, 1.0, 0.0), v(20.0, 0.0, 0.0));
+        for i in 0..30 {
+            let sway = v(0.0, 0.1 * (i % 3) as f32, 0.0);
+            let origin = v(eye.x, eye.y + sway.y, eye.z);
+            let cached = w.cast_ray_cached(&mut cache, origin, look, !0);
+            assert_eq!(cached, w.cast_ray(origin, look, !0));
+            assert!((cached.expect("the wall is in sight").0.x - 9.5).abs() < 1e-3);
+            w.step(1.0 / 60.0, 4);
+        }
+        assert_eq!(cache.walks(), 1);
+
+        // A body falling far off stamps other cells; one dropped onto the
+        // ray blocks it at once
+        w.body_box(DYNAMIC, v(0.0, 6.0, 40.0), Quat::default(), v(0.5, 0.5, 0.5), 1.0, 0.6);
+        for _ in 0..10 {
+            w.step(1.0 / 60.0, 4);
+            assert!(w.cast_ray_cached(&mut cache, eye, look, !0).is_some());
+        }
+        assert_eq!(cache.walks(), 1);
+        let blocker = w.body_box(STATIC, v(5.0, 1.0, 0.0), Quat::default(), v(0.5, 0.5, 0.5), 1.0, 0.6);
+        let (hit, _) = w.cast_ray_cached(&mut cache, eye, look, !0).expect("blocked");
+        assert!((hit.x - 4.5).abs() < 1e-3, "hit {hit:?}");
+        assert_eq!(cache.walks(), 2);
+
+        // Gone again: the stale shape is skipped without a walk; an eye
+        // that moved a meter gathers anew
+        w.destroy(blocker);
+        assert!((w.cast_ray_cached(&mut cache, eye, look, !0).unwrap().0.x - 9.5).abs() < 1e-3);
+        assert_eq!(cache.walks(), 2);
+        let moved = v(1.0, 1.0, 0.0);
+        assert_eq!(w.cast_ray_cached(&mut cache, moved, look, !0), w.cast_ray(moved, look, !0));
+        assert_eq!(cache.walks(), 3);
+    }
+
+    /// A rollback puts shapes back without moving them, so every ray
+    /// cache gathers again after a restore.
+    #[test]
+    fn restore_invalidates_ray_caches() {
+        let mut w = World::new(v(0.0, 0.0, 0.0));
+        let blocker = w.body_box(DYNAMIC, v(5.0, 1.0, 0.0), Quat::default(), v(0.5, 0.5, 0.5), 1.0, 0.6);
+        let (eye, look) = (v(0.0, 1.0, 0.0), v(20.0, 0.0, 0.0));
+        let mut snap = Snapshot::new();
+        assert!(w.capture(&mut snap) > 0);
+
+        w.set_pose(blocker, v(5.0, 1.0, 30.0), Quat::default());
+        w.step(1.0 / 60.0, 4);
+        let mut cache = RayCache::new();
+        assert_eq!(w.cast_ray_cached(&mut cache, eye, look, !0), None);
+
+        assert!(w.restore(&snap));
+        let hit = w.cast_ray(eye, look, !0);
+        assert!(hit.is_some(), "the blocker is back on the ray");
+        assert_eq!(w.cast_ray_cached(&mut cache, eye, look, !0), hit);
+        assert_eq!(cache.walks(), 2);
+    }
+
+    #[test]
+    fn history_casts_hit_bodies_where_they_were() {
+        let mut w = World::new(v(0.0, 0.0, 0.0));
+        w.enable_history(16);
+        let target = w.body_box(DYNAMIC, v(0.0, 0.0, 0.0), Quat::default(), v(0.5, 0.5, 0.5), 1.0, 0.6);
+        let doomed = w.body_box(DYNAMIC, v(0.0, 4.0, 0.0), Quat::default(), v(0.5, 0.5, 0.5), 1.0, 0.6);
+        w.body_box(DYNAMIC, v(0.0, 8.0, 0.0), Quat::default(), v(0.5, 0.5, 0.5), 1.0, 0.6);
+        w.set_history(target, true);
+        w.set_history(doomed, true);
+        let mut xs = Vec::new();
+        for tick in 0..30u32 {
+            w.set_velocity(target, v(6.0, 0.0, 0.0));
+            w.step(1.0 / 60.0, 4);
+            w.record_history(tick);
+            xs.push(w.pose(target).0.x);
+        }
+        let ray = |w: &World, tick: u32, y: f32, radius: f32| w.cast_at_tick(tick, v(-10.0, y, 0.0), radius, v(40.0, 0.0, 0.0), !0);
+
+        // A ray at a past tick meets the box where it stood then, not now
+        for tick in [15, 22, 29] {
+            let (body, p, _) = ray(&w, tick, 0.0, 0.0).expect("ray hits the rewound box");
+            assert_eq!(body, target);
+            assert!((p.x - (xs[tick as usize] - 0.5)).abs() < 1e-3, "tick {tick}: hit {p:?}, box at {}", xs[tick as usize]);
+        }
+        assert!(xs[29] - xs[15] > 1.0);
+        let (body, p, _) = ray(&w, 20, 0.7, 0.25).expect("sphere grazes the box top");
+        assert_eq!(body, target);
+        assert!(p.x < xs[20] + 0.5 && p.x > xs[20] - 0.75, "sphere hit {p:?}");
+        assert!(ray(&w, 10, 0.0, 0.0).is_none(), "tick 10 is older than the ring");
+        assert!(ray(&w, 20, 8.0, 0.0).is_none(), "a body without history is not rewound");
+
+        // Destroyed: never hit again. Opted out: castable until its
+        // poses leave the ring
+        w.destroy(doomed);
+        w.set_history(target, false);
+        assert!(ray(&w, 29, 4.0, 0.0).is_none());
+        for tick in 30..44u32 {
+            w.step(1.0 / 60.0, 4);
+            w.record_history(tick);
+        }
+        assert_eq!(ray(&w, 29, 0.0, 0.0).map(|h| h.0), Some(target));
+        for tick in 44..46u32 {
+            w.step(1.0 / 60.0, 4);
+            w.record_history(tick);
+        }
+        assert!(ray(&w, 29, 0.0, 0.0).is_none(), "the opted out box drained from the ring");
+        assert!(ray(&w, 45, 0.0, 0.0).is_none());
+    }
+
+    #[test]
+    fn step_periods_slice_far_islands_and_promote_touching_ones() {
+        // A falling box on a period of two lands where a world stepped
+        // at twice the time step puts it, moving on every other step
+        let drop = |sliced: bool| {
+            let mut w = World::new(v(0.0, -9.81, 0.0));
+            w.body_box(STATIC, v(0.0, -0.5, 0.0), Quat::default(), v(100.0, 0.5, 100.0), 1.0, 0.6);
+            let b = w.body_box(DYNAMIC, v(40.0, 3.0, 0.0), Quat::default(), v(0.5, 0.5, 0.5), 1.0, 0.6);
+            let stack: Vec<BodyId> = (0..4)
+                .map(|i| w.body_box(DYNAMIC, v(44.0, 0.5 + i as f32, 0.0), Quat::default(), v(0.5, 0.5, 0.5), 1.0, 0.6))
+                .collect();
+            let mut moves = 0;
+            if sliced {
+                assert_eq!(w.set_region_step_period(v(35.0, -1.0, -5.0), v(50.0, 10.0, 5.0), 2), 5);
+                for i in 0..120 {
+                    let y = w.pose(b).0.y;
+                    w.step(1.0 / 60.0, 4);
+                    moves += (i < 40 && w.pose(b).0.y != y) as usize;
+                }
+            } else {
+                for _ in 0..60 {
+                    w.step(1.0 / 30.0, 4);
+                }
+            }
+            (w.pose(b).0, w.pose(stack[3]).0, moves)
+        };
+        let (sliced, top, moves) = drop(true);
+        let (doubled, _, _) = drop(false);
+        assert!((sliced.y - doubled.y).abs() < 1e-4, "sliced {sliced:?} vs doubled step {doubled:?}");
+        assert!((sliced.y - 0.5).abs() < 0.02, "landed at {}", sliced.y);
+        assert_eq!(moves, 20, "a falling box moves on every other step");
+        assert!((top.y - 3.5).abs() < 0.05, "the sliced stack stands, top at {}", top.y);
+
+        // A full-rate hog shoving a sliced box takes it along every step
+        let mut w = World::new(v(0.0, -9.81, 0.0));
+        w.body_box(STATIC, v(0.0, -0.5, 0.0), Quat::default(), v(100.0, 0.5, 100.0), 1.0, 0.6);
+        let hog = w.body_box(DYNAMIC, v(0.0, 0.5, 0.0), Quat::default(), v(0.5, 0.5, 0.5), 4.0, 0.6);
+        let boxed = w.body_box(DYNAMIC, v(1.5, 0.5, 0.0), Quat::default(), v(0.5, 0.5, 0.5), 1.0, 0.6);
+        w.lock_rotation(hog);
+        w.set_step_period(boxed, 4);
+        let mut still = 0;
+        for i in 0..90 {
+            w.set_velocity(hog, v(2.0, 0.0, 0.0));
+            let x = w.pose(boxed).0.x;
+            w.step(1.0 / 60.0, 4);
+            if i > 30 {
+                still += (w.pose(boxed).0.x == x) as usize;
+            }
+        }
+        assert_eq!(still, 0, "the pushed box steps with the hog");
+        assert!(w.pose(boxed).0.x > w.pose(hog).0.x + 0.9, "the box stays ahead of the hog");
     }
 
-    /// Closest ray hit in the live world against shapes whose category
-    /// is in `mask` — `(hit point, fraction of the translation)`.
-    pub fn cast_ray(&self, origin: Vec3, translation: Vec3, mask: u64) -> Option<(Vec3, f32)> {
-        let (mut p, mut f) = (Vec3::default(), 0.0f32);
-        (unsafe { pmb3_world_cast_ray(self.0, origin, translation, mask, &mut p, &mut f) } != 0)
-            .then_some((p, f))
+    #[test]
+    fn crowd_lod_follows_viewer_distance_with_hysteresis() {
+        let mut w = World::new(v(0.0, -9.81, 0.0));
+        w.body_box(STATIC, v(0.0, -0.5, 0.0), Quat::default(), v(100.0, 0.5, 100.0), 1.0, 0.6);
+        let hogs: Vec<BodyId> = [0.0, 12.0, 60.0]
+            .iter()
+            .map(|&x| {
+                let hog = w.body_box(DYNAMIC, v(x, 0.4, 0.0), Quat::default(), v(0.6, 0.4, 0.9), 1.0, 0.6);
+                w.lock_rotation(hog);
+                hog
+            })
+            .collect();
+        for _ in 0..30 {
+            w.step(1.0 / 60.0, 4);
+        }
+        let mut levels = vec![LOD_FULL; 3];
+        let eye = [v(0.0, 2.0, 0.0)];
+        assert!(!w.awake(hogs[2]));
+        assert_eq!(w.update_lod(&hogs, &mut levels, &eye, 8.0, 30.0, 2.0), 2);
+        assert_eq!(levels, [LOD_FULL, LOD_REDUCED, LOD_REDUCED], "sleepers stop at reduced");
+
+        // The reduced hog slides without friction, the full one stops;
+        // the dead-reckoned one coasts on, level
+        let push = v(3.0, 0.0, 0.0);
+        w.set_velocities(&hogs, &[push, push, push]);
+        assert_eq!(w.update_lod(&hogs, &mut levels, &eye, 8.0, 30.0, 2.0), 1);
+        assert_eq!(levels, [LOD_FULL, LOD_REDUCED, LOD_DEAD_RECKONED]);
+        let start: Vec<Vec3> = hogs.iter().map(|&b| w.pose(b).0).collect();
+        for _ in 0..60 {
+            w.step(1.0 / 60.0, 4);
+        }
+        assert!(w.velocity(hogs[0]).x < 0.5, "full hog feels friction");
+        assert!((w.velocity(hogs[1]).x - 3.0).abs() < 0.05, "reduced hog slides");
+        let coast = w.pose(hogs[2]).0;
+        assert!((coast.x - start[2].x - 3.0).abs() < 1e-3 && (coast.y - start[2].y).abs() < 1e-5);
+
+        // Between an edge and its margin neither level flips
+        let eyes = [v(w.pose(hogs[0]).0.x, 0.4, 9.0), v(w.pose(hogs[1]).0.x, 0.4, -9.0)];
+        assert_eq!(w.update_lod(&hogs, &mut levels, &eyes, 8.0, 30.0, 2.0), 0);
+
+        // Walking up to the far hog refines it to a dynamic body again
+        let eye = [v(coast.x - 1.0, 0.4, 0.0)];
+        w.update_lod(&hogs, &mut levels, &eye, 8.0, 30.0, 2.0);
+        assert_eq!(levels[2], LOD_FULL);
+        w.set_velocity(hogs[2], v(0.0, 0.0, 0.0));
+        for _ in 0..60 {
+            w.step(1.0 / 60.0, 4);
+        }
+        assert!((w.pose(hogs[2]).0.y - 0.4).abs() < 0.02, "back on the ground as a dynamic body");
     }
 
-    /// Cast a sphere (`radius` 0 = a ray) at ONE body posed at an
-    /// arbitrary transform — the lag-comp verb: the caller supplies a
-    /// rewound pose, Box3D judges the same geometry that collides.
-    pub fn body_cast_sphere(
-        &self,
-        body: BodyId,
-        pose: (Vec3, Quat),
-        origin: Vec3,
-        radius: f32,
-        translation: Vec3,
-    ) -> Option<(Vec3, f32)> {
-        let (mut p, mut f) = (Vec3::default(), 0.0f32);
-        (unsafe {
-            pmb3_body_cast_sphere(body.0, pose.0, pose.1, origin, radius, translation, &mut p, &mut f)
-        } != 0)
-            .then_some((p, f))
+    /// pm's terrain is convex — box ground, wedge-hull ramps — so trucks
+    /// on a ramp stay on the wide solver; the scalar manifold loop only
+    /// ever sees overflow.
+    #[test]
+    fn ramp_contacts_stay_wide() {
+        let mut w = World::new(v(0.0, -9.81, 0.0));
+        w.body_box(STATIC, v(0.0, -0.5, 0.0), Quat::default(), v(50.0, 0.5, 50.0), 1.0, 0.6);
+        let wedge = [
+            v(-3.0, 0.0, -2.0),
+            v(3.0, 0.0, -2.0),
+            v(-3.0, 0.0, 2.0),
+            v(3.0, 0.0, 2.0),
+            v(3.0, 1.5, -2.0),
+            v(3.0, 1.5, 2.0),
+        ];
+        w.body_hull(STATIC, v(0.0, 0.0, 0.0), Quat::default(), &wedge, 1.0, 0.6);
+        for i in 0..12 {
+            let x = (i % 4) as f32 * 1.2 - 2.0;
+            let z = (i / 4) as f32 * 1.2 - 1.2;
+            w.body_box(DYNAMIC, v(x, 2.5, z), Quat::default(), v(0.4, 0.3, 0.5), 1.0, 0.6);
+        }
+        for _ in 0..60 {
+            w.step(1.0 / 60.0, 4);
+        }
+        let paths = w.solver_paths();
+        assert!(paths.wide >= 12, "every box touches ramp or ground: {paths:?}");
+        assert_eq!(paths.scalar, 0, "convex terrain never takes the scalar loop");
+    }
+
+    /// Capsules on a box take the closed-form box kernel; the same box
+    /// authored as a hull goes through GJK. Both grounds hold the
+    /// upright, lying and tilted capsules at the same heights.
+    #[test]
+    fn capsules_settle_alike_on_box_and_hull() {
+        let half = v(6.0, 0.5, 6.0);
+        let corners: Vec<Vec3> = (0..8)
+            .map(|i| {
+                let s = |b: usize| if i & b != 0 { 1.0 } else { -1.0 };
+                v(s(1) * half.x, s(2) * half.y - 0.5, s(4) * half.z)
+            })
+            .collect();
+        let lying = Quat { x: 0.0, y: 0.0, z: std::f32::consts::FRAC_1_SQRT_2, w: std::f32::consts::FRAC_1_SQRT_2 };
+        let (sin, cos) = 0.3f32.sin_cos();
+        let tilted = Quat { x: sin, y: 0.0, z: 0.0, w: cos };
+        let drop = |w: &mut World| -> Vec<BodyId> {
+            (0..9)
+                .map(|i| {
+                    let p = v((i % 3) as f32 * 2.5 - 2.5, 1.5, (i / 3) as f32 * 2.5 - 2.5);
+                    let c = w.body_capsule(DYNAMIC, p, 0.5, 0.3, 1.0, 0.6, false);
+                    match i % 3 {
+                        1 => w.set_pose(c, p, lying),
+                        2 => w.set_pose(c, p, tilted),
+                        _ => {}
+                    }
+                    c
+                })
+                .collect()
+        };
+
+        let mut boxed = World::new(v(0.0, -9.81, 0.0));
+        boxed.body_box(STATIC, v(0.0, -0.5, 0.0), Quat::default(), half, 1.0, 0.6);
+        let box_capsules = drop(&mut boxed);
+        let mut hulled = World::new(v(0.0, -9.81, 0.0));
+        hulled.body_hull(STATIC, v(0.0, 0.0, 0.0), Quat::default(), &corners, 1.0, 0.6);
+        let hull_capsules = drop(&mut hulled);
+        for _ in 0..120 {
+            boxed.step(1.0 / 60.0, 4);
+            hulled.step(1.0 / 60.0, 4);
+        }
+
+        for (&a, &b) in box_capsules.iter().zip(&hull_capsules) {
+            let ((pa, _), (pb, _)) = (boxed.pose(a), hulled.pose(b));
+            assert!((pa.y - pb.y).abs() < 0.02, "{pa:?} vs {pb:?}");
+            assert!(pa.y > 0.25 && pa.y < 0.85, "resting on the top face: {pa:?}");
+        }
+        // Lying capsules rest on two points at their radius
+        let (p, _) = boxed.pose(box_capsules[1]);
+        assert!((p.y - 0.3).abs() < 0.02, "{p:?}");
+    }
+
+    /// Boxes riding a rocking deck: the contact separations drift every
+    /// step, yet the cached faces stay the best locally and keep
+    /// answering nearly every hull pair query.
+    #[test]
+    fn rotating_hulls_keep_their_sat_cache() {
+        let mut w = World::new(v(0.0, -9.81, 0.0));
+        let deck = w.body_box(KINEMATIC, v(0.0, -0.5, 0.0), Quat::default(), v(8.0, 0.5, 8.0), 1.0, 0.9);
+        let boxes: Vec<BodyId> = (0..24)
+            .map(|i| {
+                let p = v((i % 6) as f32 * 1.5 - 3.75, 0.35, (i / 6) as f32 * 1.5 - 2.25);
+                w.body_box(DYNAMIC, p, Quat::default(), v(0.6, 0.3, 0.4), 1.0, 0.9)
+            })
+            .collect();
+        let (mut calls, mut hits) = (0, 0);
+        for i in 0..120 {
+            w.set_angular_velocity(deck, v(0.0, 0.0, if i % 60 < 30 { 0.3 } else { -0.3 }));
+            w.step(1.0 / 60.0, 4);
+            let (c, h) = w.sat_cache();
+            calls += c;
+            hits += h;
+        }
+        assert!(calls > 0 && hits * 100 >= calls * 94, "{hits} of {calls} cached");
+        for &b in &boxes {
+            let (p, _) = w.pose(b);
+            assert!(p.y > -0.5 && p.y < 2.0, "still riding the deck: {p:?}");
+        }
+    }
+
+    /// A volley of small boxes at a thin wall: every box is swept and
+    /// none passes. Under a budget the volley sweeps only its share, the
+    /// rest count as skipped, and the ranking still gives the same bytes
+    /// on any number of workers.
+    #[test]
+    fn continuous_budget_skips_the_rest() {
+        let volley = |w: &mut World, budget: usize| {
+            w.set_continuous_budget(budget);
+            w.body_box(STATIC, v(3.0, 0.0, 0.0), Quat::default(), v(0.05, 5.0, 5.0), 1.0, 0.6);
+            (0..64)
+                .map(|i| {
+                    let p = v(0.0, (i % 8) as f32 * 0.5 - 1.75, (i / 8) as f32 * 0.5 - 1.75);
+                    let b = w.body_box(DYNAMIC, p, Quat::default(), v(0.1, 0.1, 0.1), 1.0, 0.6);
+                    w.set_velocity(b, v(60.0 + (i % 5) as f32, 0.0, 0.0));
+                    b
+                })
+                .collect::<Vec<_>>()
+        };
+
+        let mut w = World::new(v(0.0, 0.0, 0.0));
+        let boxes = volley(&mut w, 0);
+        w.step(1.0 / 60.0, 4);
+        let c = w.continuous();
+        assert_eq!((c.fast, c.skipped, c.bullets), (64, 0, 0), "{c:?}");
+        let mut impacts = c.impacts;
+        for _ in 0..30 {
+            w.step(1.0 / 60.0, 4);
+            impacts += w.continuous().impacts;
+        }
+        assert!(impacts >= 64, "every box stopped at the wall: {impacts}");
+        for &b in &boxes {
+            let (p, _) = w.pose(b);
+            assert!(p.x < 3.0, "tunneled: {p:?}");
+        }
+
+        let mut threaded = World::with_workers(v(0.0, 0.0, 0.0), 4);
+        let mut serial = World::new(v(0.0, 0.0, 0.0));
+        volley(&mut threaded, 8);
+        volley(&mut serial, 8);
+        threaded.step(1.0 / 60.0, 4);
+        let c = threaded.continuous();
+        assert_eq!((c.fast, c.skipped), (64, 56), "{c:?}");
+        for _ in 0..30 {
+            threaded.step(1.0 / 60.0, 4);
+        }
+        for _ in 0..31 {
+            serial.step(1.0 / 60.0, 4);
+        }
+        assert_eq!(threaded.hash_full(), serial.hash_full(), "worker count must not change the budgeted sweeps");
+    }
+
+    /// Spheres shot diagonally past a block's corner: their swept boxes
+    /// overlap the block, so each one is a sweep candidate, but the swept
+    /// sphere clears it and no time of impact runs. Shot at the face
+    /// instead, every one reaches the solver and stops.
+    #[test]
+    fn swept_sphere_rejects_near_misses() {
+        let shoot = |w: &mut World, aim: f32| {
+            w.body_box(STATIC, v(0.0, 0.0, 0.0), Quat::default(), v(1.0, 1.0, 1.0), 1.0, 0.6);
+            (0..16)
+                .map(|i| {
+                    let b = w.body_sphere(DYNAMIC, v(-2.3, aim, (i as f32) * 0.12 - 0.9), 0.1, 1.0, 0.6);
+                    w.set_velocity(b, v(120.0, 120.0, 0.0));
+                    b
+                })
+                .collect::<Vec<_>>()
+        };
+
+        let mut w = World::new(v(0.0, 0.0, 0.0));
+        let spheres = shoot(&mut w, 0.3);
+        w.step(1.0 / 60.0, 4);
+        let c = w.continuous();
+        assert_eq!((c.fast, c.candidates, c.rejected, c.impacts), (16, 16, 16, 0), "{c:?}");
+        for &b in &spheres {
+            let (p, _) = w.pose(b);
+            assert!(p.x > -0.4 && p.y > 2.2, "flew on: {p:?}");
+        }
+
+        let mut w = World::new(v(0.0, 0.0, 0.0));
+        shoot(&mut w, -2.5);
+        w.step(1.0 / 60.0, 4);
+        let c = w.continuous();
+        assert_eq!((c.fast, c.candidates, c.rejected, c.impacts), (16, 16, 0, 16), "{c:?}");
+    }
+
+    /// Reordering the awake bodies (and each color's contacts with them)
+    /// only moves memory: a shuffled pile regrouped every step lands on
+    /// the same poses as one left in creation order.
+    #[test]
+    fn body_reorder_keeps_results() {
+        let pile = |reorder: usize| {
+            let mut w = World::new(v(0.0, -9.81, 0.0));
+            w.set_body_reorder_interval(reorder);
+            w.body_box(STATIC, v(0.0, -0.5, 0.0), Quat::default(), v(50.0, 0.5, 50.0), 1.0, 0.6);
+            for k in 0..200u32 {
+                let i = k * 37 % 200;
+                let (ix, iz, iy) = ((i % 10) as f32, ((i / 10) % 10) as f32, (i / 100) as f32);
+                w.body_box(DYNAMIC, v(ix * 0.9 - 4.5, 0.5 + iy * 0.9, iz * 0.9 - 4.5), Quat::default(), v(0.4, 0.4, 0.4), 1.0, 0.6);
+            }
+            for _ in 0..90 {
+                w.step(1.0 / 60.0, 4);
+            }
+            assert_eq!(w.hash(), w.hash_full());
+            w.hash_full()
+        };
+        assert_eq!(pile(0), pile(1));
+        assert_eq!(pile(0), pile(7));
+    }
+
+    /// The rebalanced coloring of a packed pile is flatter than the
+    /// greedy one, uses no more colors, overflows no more, and is as
+    /// reproducible.
+    #[test]
+    fn graph_balance_evens_colors() {
+        let pile = |interval: usize| {
+            let mut w = World::new(v(0.0, -9.81, 0.0));
+            w.set_graph_balance_interval(interval);
+            w.body_box(STATIC, v(0.0, -0.5, 0.0), Quat::default(), v(50.0, 0.5, 50.0), 1.0, 0.6);
+            for i in 0..400u32 {
+                let (ix, iz, iy) = ((i % 10) as f32, ((i / 10) % 10) as f32, (i / 100) as f32);
+                let s = 0.25 + 0.04 * (i * 7 % 5) as f32;
+                w.body_box(DYNAMIC, v(ix * 0.55 - 2.5, 0.5 + iy * 0.9, iz * 0.55 - 2.5), Quat::default(), v(s, s, s), 1.0, 0.6);
+            }
+            for _ in 0..60 {
+                w.step(1.0 / 60.0, 4);
+            }
+            assert_eq!(w.hash(), w.hash_full());
+            (w.color_counts(), w.solver_paths().overflow, w.hash_full())
+        };
+        let (greedy, greedy_overflow, _) = pile(0);
+        let (even, even_overflow, hash) = pile(1);
+        assert_eq!(pile(1).2, hash);
+        // The first 20 colors take dynamic pairs (B3_DYNAMIC_COLOR_COUNT).
+        let dynamic = |c: &[usize]| c[..20].to_vec();
+        let used = |c: &[usize]| dynamic(c).iter().filter(|&&n| n > 0).count();
+        let biggest = |c: &[usize]| *dynamic(c).iter().max().unwrap();
+        assert!(used(&even) <= used(&greedy), "{even:?} vs {greedy:?}");
+        assert!(biggest(&even) < biggest(&greedy), "{even:?} vs {greedy:?}");
+        assert!(even_overflow <= greedy_overflow);
+    }
+
+    /// Planks buried under more boxes than there are colors spill into
+    /// the overflow. Each stack is its own overflow group, the workers
+    /// split the groups, and the result still matches a serial world.
+    #[test]
+    fn overflow_groups_run_in_parallel() {
+        let stacks = |w: &mut World| {
+            w.body_box(STATIC, v(0.0, -0.5, 0.0), Quat::default(), v(50.0, 0.5, 50.0), 1.0, 0.6);
+            for p in 0..4 {
+                let x0 = p as f32 * 10.0 - 15.0;
+                w.body_box(DYNAMIC, v(x0, 0.3, 0.0), Quat::default(), v(3.0, 0.3, 3.0), 1.0, 0.6);
+                for i in 0..64 {
+                    let (ix, iz) = ((i % 8) as f32, (i / 8) as f32);
+                    w.body_box(DYNAMIC, v(x0 + ix * 0.7 - 2.45, 0.9, iz * 0.7 - 2.45), Quat::default(), v(0.25, 0.25, 0.25), 1.0, 0.6);
+                }
+            }
+        };
+        let mut threaded = World::with_workers(v(0.0, -9.81, 0.0), 4);
+        let mut serial = World::new(v(0.0, -9.81, 0.0));
+        stacks(&mut threaded);
+        stacks(&mut serial);
+        for _ in 0..20 {
+            threaded.step(1.0 / 60.0, 4);
+            serial.step(1.0 / 60.0, 4);
+        }
+        let paths = threaded.solver_paths();
+        assert!(paths.overflow > 0, "{paths:?}");
+        assert_eq!(paths.overflow_groups, 4, "one group per plank: {paths:?}");
+        assert_eq!(serial.solver_paths().overflow_groups, 4);
+        assert_eq!(threaded.hash_full(), serial.hash_full(), "split overflow must not change the result");
+    }
+
+    /// A batch of rays, walked a packet at a time and across workers,
+    /// lands exactly where the same rays cast one by one do.
+    #[test]
+    fn batched_rays_match_single_casts() {
+        for workers in [1, 4] {
+            let mut w = World::with_workers(v(0.0, -9.81, 0.0), workers);
+            w.body_box(STATIC, v(0.0, -0.5, 0.0), Quat::default(), v(50.0, 0.5, 50.0), 1.0, 0.6);
+            for i in 0..60 {
+                let (ix, iz) = ((i % 10) as f32, (i / 10) as f32);
+                w.body_box(DYNAMIC, v(ix * 2.3 - 10.0, 0.6 + ix * 0.1, iz * 2.7 - 8.0), Quat::default(), v(0.6, 0.6, 0.6), 1.0, 0.6);
+            }
+            w.step(1.0 / 60.0, 4);
+
+            // Three shooters' volleys, some rays into the sky
+            let (mut origins, mut translations) = (Vec::new(), Vec::new());
+            for s in 0..3 {
+                let o = v(s as f32 * 7.0 - 7.0, 1.5, -15.0);
+                for k in 0..70 {
+                    origins.push(o);
+                    translations.push(v((k % 10) as f32 * 1.7 - 8.0, (k / 10) as f32 * 0.4 - 1.2, 30.0));
+                }
+            }
+            let batch = w.cast_rays(&origins, &translations, !0);
+            let single: Vec<_> = origins.iter().zip(&translations).map(|(&o, &t)| w.cast_ray(o, t, !0)).collect();
+            assert_eq!(batch, single, "{workers} workers");
+            assert!(batch.iter().filter(|h| h.is_some()).count() > 100);
+            assert!(batch.iter().any(|h| h.is_none()));
+        }
+    }
+
+    /// The detailed profile stays empty until asked for, then has a row
+    /// per solver worker whose stage blocks add up.
+    #[test]
+    fn detailed_profile_splits_the_solver_by_worker() {
+        let mut w = World::with_workers(v(0.0, -9.81, 0.0), 4);
+        w.body_box(STATIC, v(0.0, -0.5, 0.0), Quat::default(), v(50.0, 0.5, 50.0), 1.0, 0.6);
+        for i in 0..200 {
+            let (ix, iz) = ((i % 10) as f32, (i / 10 % 10) as f32);
+            w.body_box(DYNAMIC, v(ix * 1.1 - 5.0, 0.5 + (i / 100) as f32 * 1.05, iz * 1.1 - 5.0), Quat::default(), v(0.5, 0.5, 0.5), 1.0, 0.6);
+        }
+        w.step(1.0 / 60.0, 4);
+        assert!(w.detailed_profile().is_empty());
+
+        w.set_detailed_profile(true);
+        w.step(1.0 / 60.0, 4);
+        let workers = w.detailed_profile();
+        assert_eq!(workers.len(), 4);
+        let solve = PROFILE_STAGES.iter().position(|&s| s == "solve").unwrap();
+        let blocks: usize = workers.iter().map(|p| p.stages[solve].blocks).sum();
+        assert!(workers[0].stages[solve].blocks > 0 && blocks >= workers[0].stages[solve].blocks);
+        assert!(workers.iter().flat_map(|p| p.stages.iter()).all(|s| s.busy_ms >= 0.0 && s.wait_ms >= 0.0));
+    }
+
+    #[test]
+    fn profile_and_counters_describe_the_last_step() {
+        let mut w = World::new(v(0.0, -9.81, 0.0));
+        w.body_box(STATIC, v(0.0, -0.5, 0.0), Quat::default(), v(50.0, 0.5, 50.0), 1.0, 0.6);
+        for i in 0..50 {
+            w.body_box(DYNAMIC, v((i % 10) as f32 * 1.1, 0.5, (i / 10) as f32 * 1.1), Quat::default(), v(0.5, 0.5, 0.5), 1.0, 0.6);
+        }
+        w.step(1.0 / 60.0, 4);
+        w.step(1.0 / 60.0, 4);
+        let (profile, counters) = (w.profile(), w.counters());
+        let at = |name| COUNTERS.iter().position(|&c| c == name).unwrap();
+        assert_eq!((counters[at("bodies")], counters[at("shapes")]), (51, 51));
+        assert!(counters[at("contacts")] >= 50, "every box rests on the ground");
+        let (step, solve) = (profile[0], profile[STEP_PROFILE.iter().position(|&s| s == "solve").unwrap()]);
+        assert!(step > 0.0 && solve > 0.0 && solve <= step, "{profile:?}");
+    }
+
+    /// A traced threaded step logs its stages, the solver sweeps and
+    /// the pool's tasks, each zone closed on the thread that opened it;
+    /// clearing the tracer stops the log.
+    #[test]
+    fn trace_zones_nest_on_each_thread() {
+        let mut w = World::with_workers(v(0.0, -9.81, 0.0), 4);
+        w.body_box(STATIC, v(0.0, -0.5, 0.0), Quat::default(), v(50.0, 0.5, 50.0), 1.0, 0.6);
+        for i in 0..400 {
+            w.body_box(DYNAMIC, v((i % 20) as f32 * 1.1, 0.5 + (i / 100) as f32, (i / 20 % 5) as f32 * 1.1), Quat::default(), v(0.5, 0.5, 0.5), 1.0, 0.6);
+        }
+        let log = std::sync::Arc::new(TraceLog::new());
+        w.set_tracer(Some(log.clone()));
+        for _ in 0..10 {
+            w.step(1.0 / 60.0, 4);
+        }
+        let events = log.drain();
+
+        let mut stacks = std::collections::HashMap::<u32, Vec<&str>>::new();
+        for e in &events {
+            let stack = stacks.entry(e.thread).or_default();
+            if e.begin {
+                stack.push(e.zone);
+            } else {
+                assert_eq!(stack.pop(), Some(e.zone), "zones nest on thread {}", e.thread);
+            }
+        }
+        assert!(stacks.values().all(|s| s.is_empty()), "every zone closed");
+        let began = |zone| events.iter().filter(|e| e.begin && e.zone == zone).count();
+        assert_eq!(began("step"), 10);
+        assert!(began("collide") > 10, "the stage and its parallel-for blocks");
+        // The stage, then one scheduler task per worker
+        assert_eq!((began("refit"), began("solve")), (10, 10 + 10 * 4));
+        assert!(began("warm start") >= 10 * 4, "a sweep per sub-step");
+
+        w.set_tracer(None);
+        w.step(1.0 / 60.0, 4);
+        assert!(log.drain().is_empty());
+        assert!(log.chrome_json().contains("traceEvents"));
+    }
+
+    /// The history keeps the last frames oldest first, and the hitch
+    /// snapshot loaded into a fresh world re-runs the slow step exactly.
+    #[test]
+    fn profile_history_keeps_the_last_frames_and_the_worst_hitch() {
+        let mut w = World::new(v(0.0, -9.81, 0.0));
+        w.body_box(STATIC, v(0.0, -0.5, 0.0), Quat::default(), v(20.0, 0.5, 20.0), 1.0, 0.6);
+        for i in 0..60 {
+            w.body_box(DYNAMIC, v((i % 6) as f32 * 1.1 - 3.0, 0.5 + (i / 12) as f32, (i / 6 % 2) as f32 * 1.1), Quat::default(), v(0.5, 0.5, 0.5), 1.0, 0.6);
+        }
+        assert_eq!(w.profile_summary().frames, 0);
+        w.keep_profile_history(16);
+        // Every step is over a threshold this low, so the slowest is kept
+        w.set_hitch_threshold(1e-6);
+        let mut hashes = Vec::new();
+        for _ in 0..20 {
+            w.step(1.0 / 60.0, 4);
+            hashes.push(w.hash_full());
+        }
+
+        let frames = w.profile_history();
+        assert_eq!(frames.len(), 16);
+        assert_eq!(frames.iter().map(|f| f.step).collect::<Vec<_>>(), (5..=20).collect::<Vec<_>>());
+        assert!(frames.iter().all(|f| f.counters[0] == 61 && f.profile[0] > 0.0));
+        let summary = w.profile_summary();
+        assert_eq!(summary.frames, 16);
+        let slowest = frames.iter().map(|f| f.profile[0]).fold(0.0, f32::max);
+        assert_eq!(summary.max[0], slowest);
+        assert!(summary.p50[0] <= summary.p95[0] && summary.p95[0] <= summary.p99[0] && summary.p99[0] <= summary.max[0]);
+
+        let hitch = w.hitch().expect("a step over the threshold");
+        assert!(hitch.profile[0] >= slowest, "the worst since arming, not only of the kept frames");
+        let mut again = World::new(v(0.0, -9.81, 0.0));
+        assert!(again.load_snapshot(&hitch.snapshot));
+        again.step(hitch.dt, hitch.substeps);
+        assert_eq!(again.hash_full(), hashes[hitch.step as usize - 1]);
+
+        w.set_hitch_threshold(0.0);
+        w.step(1.0 / 60.0, 4);
+        assert!(w.hitch().is_none());
+        w.keep_profile_history(0);
+        assert!(w.profile_history().is_empty());
+    }
+
+    /// Extra relax iterations stop once a settling pile converges, the
+    /// same on any worker count, and a join snapshot carries the setting.
+    #[test]
+    fn relax_iterations_stop_once_converged() {
+        let pile = |workers: usize, max: usize, tolerance: f32| {
+            let mut w = World::with_workers(v(0.0, -9.81, 0.0), workers);
+            w.set_relax_iterations(max, tolerance);
+            w.body_box(STATIC, v(0.0, -0.5, 0.0), Quat::default(), v(20.0, 0.5, 20.0), 1.0, 0.6);
+            for i in 0..120 {
+                w.body_box(DYNAMIC, v((i % 6) as f32 * 1.02 - 3.0, 0.5 + (i / 36) as f32 * 1.02, (i / 6 % 6) as f32 * 1.02 - 3.0), Quat::default(), v(0.5, 0.5, 0.5), 1.0, 0.6);
+            }
+            w
+        };
+        let relax = COUNTERS.iter().position(|&c| c == "relax_iterations").unwrap();
+
+        let mut fixed = pile(1, 1, 0.0);
+        let mut full = pile(1, 4, 0.0);
+        fixed.step(1.0 / 60.0, 4);
+        full.step(1.0 / 60.0, 4);
+        assert_eq!((fixed.counters()[relax], full.counters()[relax]), (4, 16));
+
+        let (mut serial, mut parallel) = (pile(1, 4, 0.01), pile(4, 4, 0.01));
+        let mut used = Vec::new();
+        for step in 0..30 {
+            serial.step(1.0 / 60.0, 4);
+            parallel.step(1.0 / 60.0, 4);
+            assert_eq!(serial.hash_full(), parallel.hash_full(), "step {step}");
+            used.push(serial.counters()[relax]);
+        }
+        // Then the pile sleeps and nothing is relaxed
+        assert!(used.iter().all(|&n| n == 0 || (4..=16).contains(&n)), "{used:?}");
+        assert!(used[..10].iter().any(|&n| n == 16), "the landing takes them all: {used:?}");
+        assert!(used[20..30].iter().all(|&n| n < 8), "settling takes under two a sub-step: {used:?}");
+
+        let mut snap = vec![0u8; serial.snapshot_size(false)];
+        let n = serial.save_snapshot(&mut snap, false).unwrap();
+        let mut joined = World::new(v(0.0, -9.81, 0.0));
+        assert!(joined.load_snapshot(&snap[..n]));
+        // A disturbance, so the tolerance decides again
+        let hit = |w: &mut World| {
+            w.body_box(DYNAMIC, v(0.0, 4.0, 0.0), Quat::default(), v(1.0, 1.0, 1.0), 8.0, 0.6);
+            for _ in 0..20 {
+                w.step(1.0 / 60.0, 4);
+            }
+            (w.hash_full(), w.counters()[relax])
+        };
+        assert_eq!(hit(&mut joined), hit(&mut serial));
+    }
+
+    /// The filter table lets groups pass through each other, pass
+    /// through but trip sensors, and slide on an overridden friction,
+    /// and a saved snapshot keeps all of it.
+    #[test]
+    fn filter_table_rules_and_group_materials() {
+        let mut w = World::new(v(0.0, -9.81, 0.0));
+        w.body_box(STATIC, v(0.0, -0.5, 0.0), Quat::default(), v(20.0, 0.5, 20.0), 1.0, 0.6);
+        let sensor = w.sensor_box(v(8.0, -4.0, 0.0), v(2.0, 2.0, 2.0));
+        // Debris ignores debris: the upper box falls through the lower one
+        let low = w.body_box(DYNAMIC, v(0.0, 0.5, 0.0), Quat::default(), v(0.5, 0.5, 0.5), 1.0, 0.6);
+        let high = w.body_box(DYNAMIC, v(0.0, 2.0, 0.0), Quat::default(), v(0.5, 0.5, 0.5), 1.0, 0.6);
+        w.set_filter_group(low, 1);
+        w.set_filter_group(high, 1);
+        w.set_filter_rule(1, 1, FILTER_IGNORE);
+        // Ghosts fall through the ground into the sensor below it
+        let ghost = w.body_box(DYNAMIC, v(8.0, 1.0, 0.0), Quat::default(), v(0.5, 0.5, 0.5), 1.0, 0.6);
+        w.set_sensor_events(ghost, true);
+        w.set_filter_group(ghost, 2);
+        w.set_filter_rule(0, 2, FILTER_SENSOR_ONLY);
+        // Ice slides where the same box with its own friction stops
+        let ice = w.body_box(DYNAMIC, v(-8.0, 0.5, -4.0), Quat::default(), v(0.5, 0.5, 0.5), 1.0, 0.6);
+        let rough = w.body_box(DYNAMIC, v(-8.0, 0.5, 4.0), Quat::default(), v(0.5, 0.5, 0.5), 1.0, 0.6);
+        w.set_filter_group(ice, 3);
+        w.set_group_material(3, Some(0.0), None);
+        w.set_velocity(ice, v(4.0, 0.0, 0.0));
+        w.set_velocity(rough, v(4.0, 0.0, 0.0));
+        // Grounded until the rule changes under it
+        let doomed = w.body_box(DYNAMIC, v(-8.0, 0.5, 0.0), Quat::default(), v(0.5, 0.5, 0.5), 1.0, 0.6);
+        w.set_filter_group(doomed, 4);
+
+        let mut sensed = false;
+        for _ in 0..60 {
+            w.step(1.0 / 60.0, 4);
+            sensed |= w.sensor_visitors(sensor).contains(&ghost);
+        }
+        assert!(sensed, "the ghost passes through the sensor");
+        assert!(w.pose(ghost).0.y < -2.0);
+        assert!((w.pose(low).0.y - 0.5).abs() < 0.05 && (w.pose(high).0.y - 0.5).abs() < 0.05);
+        assert!(w.velocity(ice).x > 3.9 && w.velocity(rough).x < 0.1, "{:?} {:?}", w.velocity(ice), w.velocity(rough));
+        assert!((w.pose(doomed).0.y - 0.5).abs() < 0.05);
+
+        w.set_filter_rule(0, 4, FILTER_IGNORE);
+        let mut snap = vec![0u8; w.snapshot_size(false)];
+        let n = w.save_snapshot(&mut snap, false).unwrap();
+        let mut joined = World::new(v(0.0, -9.81, 0.0));
+        assert!(joined.load_snapshot(&snap[..n]));
+        for step in 0..30 {
+            w.step(1.0 / 60.0, 4);
+            joined.step(1.0 / 60.0, 4);
+            assert_eq!(w.hash_full(), joined.hash_full(), "step {step}");
+        }
+        assert!(w.pose(doomed).0.y < -0.5, "the new rule drops it through the ground");
+    }
+
+    /// A material pair in the table replaces the mixed friction, a
+    /// snapshot keeps the table, and clearing the pair reaches the
+    /// touching contact without a new manifold.
+    #[test]
+    fn material_mix_replaces_the_shapes_friction() {
+        let mut w = World::new(v(0.0, -9.81, 0.0));
+        let ground = w.body_box(STATIC, v(0.0, -0.5, 0.0), Quat::default(), v(40.0, 0.5, 40.0), 1.0, 0.6);
+        let ice = w.body_box(DYNAMIC, v(-20.0, 0.5, -4.0), Quat::default(), v(0.5, 0.5, 0.5), 1.0, 0.6);
+        let rough = w.body_box(DYNAMIC, v(-20.0, 0.5, 4.0), Quat::default(), v(0.5, 0.5, 0.5), 1.0, 0.6);
+        w.set_material(ground, 1);
+        w.set_material(ice, 2);
+        w.set_material_mix(1, 2, Some(0.0), None);
+        w.set_velocity(ice, v(4.0, 0.0, 0.0));
+        w.set_velocity(rough, v(4.0, 0.0, 0.0));
+        for _ in 0..60 {
+            w.step(1.0 / 60.0, 4);
+        }
+        assert!(w.velocity(ice).x > 3.9 && w.velocity(rough).x < 0.1, "{:?} {:?}", w.velocity(ice), w.velocity(rough));
+
+        let mut snap = vec![0u8; w.snapshot_size(false)];
+        let n = w.save_snapshot(&mut snap, false).unwrap();
+        let mut joined = World::new(v(0.0, -9.81, 0.0));
+        assert!(joined.load_snapshot(&snap[..n]));
+        for step in 0..10 {
+            w.step(1.0 / 60.0, 4);
+            joined.step(1.0 / 60.0, 4);
+            assert_eq!(w.hash_full(), joined.hash_full(), "step {step}");
+        }
+        assert!(w.velocity(ice).x > 3.9);
+
+        w.set_material_mix(1, 2, None, None);
+        for _ in 0..60 {
+            w.step(1.0 / 60.0, 4);
+        }
+        assert!(w.velocity(ice).x < 0.1, "{:?}", w.velocity(ice));
+    }
+
+    /// A volley lands as the same blasts one at a time, on any worker
+    /// count, and wakes the settled pile it reaches.
+    #[test]
+    fn explosion_batch_matches_single_blasts() {
+        let blasts = [
+            Explosion { position: v(-2.0, 0.5, 0.0), radius: 2.0, falloff: 2.0, impulse_per_area: 6.0 },
+            Explosion { position: v(2.0, 0.5, 1.0), radius: 1.5, falloff: 3.0, impulse_per_area: 4.0 },
+            Explosion { position: v(0.0, 3.0, -1.0), radius: 1.0, falloff: 1.0, impulse_per_area: -2.0 },
+        ];
+        let settled = |workers: usize| {
+            let mut w = World::with_workers(v(0.0, -9.81, 0.0), workers);
+            w.body_box(STATIC, v(0.0, -0.5, 0.0), Quat::default(), v(20.0, 0.5, 20.0), 1.0, 0.6);
+            let boxes: Vec<_> = (0..100)
+                .map(|i| {
+                    let pos = v((i % 10) as f32 * 1.1 - 5.0, 0.5 + (i / 50) as f32 * 1.05, (i / 10 % 5) as f32 * 1.1 - 2.5);
+                    w.body_box(DYNAMIC, pos, Quat::default(), v(0.5, 0.5, 0.5), 1.0, 0.6)
+                })
+                .collect();
+            for _ in 0..300 {
+                w.step(1.0 / 60.0, 4);
+            }
+            assert!(boxes.iter().all(|&b| !w.awake(b)), "the pile sleeps first");
+            (w, boxes)
+        };
+
+        let (mut single, boxes) = settled(1);
+        for blast in &blasts {
+            single.explode(std::slice::from_ref(blast));
+        }
+        assert!(boxes.iter().any(|&b| single.awake(b) && single.velocity(b).y > 1.0), "something flies");
+        for workers in [1, 4] {
+            let (mut batch, _) = settled(workers);
+            batch.explode(&blasts);
+            assert_eq!(batch.hash_full(), single.hash_full(), "{workers} workers");
+        }
+    }
+
+    /// A pile far out keeps its contacts and rest through an origin
+    /// shift, on the trees, the grid and the parallel pass, and new
+    /// pairs form against the shifted broad-phase.
+    #[test]
+    fn origin_shift_keeps_the_pile_resting() {
+        let (fx, fz) = (3000.0, -3000.0);
+        for (workers, grid) in [(1, false), (4, false), (4, true)] {
+            let mut w = if grid { World::with_grid(v(0.0, -9.81, 0.0), workers, 2.0) } else { World::with_workers(v(0.0, -9.81, 0.0), workers) };
+            w.body_box(STATIC, v(fx, -0.5, fz), Quat::default(), v(20.0, 0.5, 20.0), 1.0, 0.6);
+            let boxes: Vec<_> = (0..300)
+                .map(|i| {
+                    let pos = v(fx + (i % 10) as f32 * 1.1 - 5.0, 0.5 + (i / 100) as f32 * 1.05, fz + (i / 10 % 10) as f32 * 1.1 - 5.0);
+                    w.body_box(DYNAMIC, pos, Quat::default(), v(0.5, 0.5, 0.5), 1.0, 0.6)
+                })
+                .collect();
+            for _ in 0..120 {
+                w.step(1.0 / 60.0, 4);
+            }
+            let contacts = w.counters()[2];
+            let before: Vec<_> = boxes.iter().map(|&b| w.pose(b).0).collect();
+
+            w.shift_origin(v(fx, 0.0, fz));
+            for (&b, &p) in boxes.iter().zip(&before) {
+                let q = w.pose(b).0;
+                let moved = (q.x - (p.x - fx)).abs().max((q.y - p.y).abs()).max((q.z - (p.z - fz)).abs());
+                assert!(moved < 1e-3, "{workers} workers, grid {grid}: {q:?} from {p:?}");
+            }
+            let hit = w.cast_ray(v(9.5, 10.0, 9.5), v(0.0, -20.0, 0.0), u64::MAX).expect("the ground moved with its tree");
+            assert!(hit.0.y.abs() < 1e-3, "{hit:?}");
+
+            w.step(1.0 / 60.0, 4);
+            assert_eq!(w.counters()[2], contacts, "{workers} workers, grid {grid}: the contacts carried over");
+            let (recycled, rested) = w.contact_reuse();
+            assert!(recycled + rested > 0, "the manifolds survive the shift");
+
+            let dropped = w.body_box(DYNAMIC, v(0.0, 6.0, 0.0), Quat::default(), v(0.5, 0.5, 0.5), 1.0, 0.6);
+            for _ in 0..180 {
+                w.step(1.0 / 60.0, 4);
+            }
+            assert!(w.pose(dropped).0.y > 3.0, "{workers} workers, grid {grid}: lands on the pile, not through it");
+            assert!(boxes.iter().all(|&b| w.pose(b).0.y > 0.4), "{workers} workers, grid {grid}: the pile stands");
+        }
+    }
+
+    /// Packing the manifolds of sleeping islands changes nothing a peer
+    /// can see: the steps, the snapshot bytes and a reload stay identical,
+    /// while compact hands the emptied manifold blocks back.
+    #[test]
+    fn sleep_packing_is_invisible_and_frees_the_manifolds() {
+        let field = |packed: bool| {
+            let mut w = World::with_workers(v(0.0, -9.81, 0.0), 4);
+            w.set_sleep_packing(packed);
+            w.body_box(STATIC, v(0.0, -0.5, 0.0), Quat::default(), v(60.0, 0.5, 60.0), 1.0, 0.6);
+            // Lone boxes and short stacks, each its own island
+            let boxes: Vec<_> = (0..900)
+                .map(|i| {
+                    let pos = v((i % 30) as f32 * 3.0 - 45.0, 0.5 + (i / 300) as f32 * 1.02, (i / 30 % 10) as f32 * 3.0 - 15.0);
+                    w.body_box(DYNAMIC, pos, Quat::default(), v(0.5, 0.5, 0.5), 1.0, 0.6)
+                })
+                .collect();
+            (w, boxes)
+        };
+        let ((mut packed, boxes), (mut plain, plain_boxes)) = (field(true), field(false));
+        for step in 0..240 {
+            packed.step(1.0 / 60.0, 4);
+            plain.step(1.0 / 60.0, 4);
+            assert_eq!(packed.hash_full(), plain.hash_full(), "step {step}");
+        }
+        assert!(plain_boxes.iter().all(|&b| !plain.awake(b)), "the field settles");
+
+        let save = |w: &World| {
+            let mut buf = vec![0u8; w.snapshot_size(false)];
+            let n = w.save_snapshot(&mut buf, false).unwrap();
+            buf.truncate(n);
+            buf
+        };
+        let image = save(&packed);
+        packed.set_sleep_packing(false);
+        assert!(save(&packed) == image, "packing never reaches a snapshot");
+        packed.set_sleep_packing(true);
+        assert!(save(&packed) == image);
+
+        while !packed.compact(0) {}
+        while !plain.compact(0) {}
+        let (a, b) = (packed.memory_stats(), plain.memory_stats());
+        assert!(a.manifold_blocks < b.manifold_blocks, "{a:?} vs {b:?}");
+        assert!(a.total < b.total, "{a:?} vs {b:?}");
+
+        // Wake a row, let it settle again, then reload the settled field
+        for (&a, &b) in boxes.iter().zip(&plain_boxes).step_by(7) {
+            packed.set_velocity(a, v(0.0, 2.0, 0.0));
+            plain.set_velocity(b, v(0.0, 2.0, 0.0));
+        }
+        for step in 0..240 {
+            packed.step(1.0 / 60.0, 4);
+            plain.step(1.0 / 60.0, 4);
+            assert_eq!(packed.hash_full(), plain.hash_full(), "rewake step {step}");
+        }
+        assert!(packed.load_snapshot(&image) && plain.load_snapshot(&image));
+        assert_eq!(packed.hash_full(), plain.hash_full());
+        for (&a, &b) in boxes.iter().zip(&plain_boxes).step_by(5) {
+            packed.set_velocity(a, v(1.0, 1.0, 0.0));
+            plain.set_velocity(b, v(1.0, 1.0, 0.0));
+        }
+        for step in 0..120 {
+            packed.step(1.0 / 60.0, 4);
+            plain.step(1.0 / 60.0, 4);
+            assert_eq!(packed.hash_full(), plain.hash_full(), "reload step {step}");
+        }
+    }
+
+    /// Wind set once wakes the resting boxes inside it and drags them
+    /// toward its flow, the light box sooner, while a box outside
+    /// sleeps on. A vortex turns its box sideways, and the replay of the
+    /// gusts steps the same.
+    #[test]
+    fn force_fields_drag_bodies_toward_the_flow() {
+        let mut w = World::new(v(0.0, 0.0, 0.0));
+        let cube = v(0.4, 0.4, 0.4);
+        let light = w.body_box(DYNAMIC, v(0.0, 0.0, 0.0), Quat::default(), cube, 1.0, 0.6);
+        let heavy = w.body_box(DYNAMIC, v(0.0, 0.0, 3.0), Quat::default(), cube, 8.0, 0.6);
+        let swirl = w.body_box(DYNAMIC, v(22.0, 0.0, 0.0), Quat::default(), cube, 1.0, 0.6);
+        let still = w.body_box(DYNAMIC, v(40.0, 0.0, 0.0), Quat::default(), cube, 1.0, 0.6);
+        for _ in 0..120 {
+            w.step(1.0 / 60.0, 4);
+        }
+        assert!(!w.awake(light) && !w.awake(still), "the boxes fell asleep");
+
+        w.start_recording(0);
+        let wind = ForceField {
+            kind: FIELD_DIRECTIONAL,
+            center: v(0.0, 0.0, 1.5),
+            extents: v(10.0, 2.0, 3.0),
+            direction: v(2.0, 0.0, 0.0),
+            speed: 5.0,
+            drag: 2.0,
+        };
+        let vortex = ForceField { kind: FIELD_VORTEX, center: v(20.0, 0.0, 0.0), extents: v(4.0, 4.0, 4.0), direction: v(0.0, 1.0, 0.0), speed: 3.0, drag: 2.0 };
+        w.set_force_fields(&[wind, vortex]);
+        assert!(w.awake(light) && w.awake(heavy) && w.awake(swirl) && !w.awake(still), "the fields woke their boxes");
+        for _ in 0..30 {
+            w.step(1.0 / 60.0, 4);
+        }
+        let (vl, vh) = (w.velocity(light), w.velocity(heavy));
+        assert!(vl.x > vh.x && vh.x > 0.5 && vl.x < 5.0, "light {vl:?} heavy {vh:?}");
+        assert!(vl.y.abs() < 1e-4 && vl.z.abs() < 1e-4, "wind along x only {vl:?}");
+        assert!(w.velocity(swirl).z < -0.5, "vortex swirl {:?}", w.velocity(swirl));
+        assert!(!w.awake(still) && w.velocity(still) == v(0.0, 0.0, 0.0));
+
+        // Calm: the boxes coast on
+        w.set_force_fields(&[]);
+        for _ in 0..10 {
+            w.step(1.0 / 60.0, 4);
+        }
+        assert!((w.velocity(light).x - vl.x).abs() < 1e-4, "no drag without fields");
+
+        let recording = w.stop_recording();
+        let mut replay = Replay::new(&recording).unwrap();
+        let mut frames = 0;
+        while replay.step() {
+            frames += 1;
+        }
+        assert_eq!(frames, 40);
+        assert!(!replay.has_diverged());
+    }
+
+    /// The overlay buffers hold every shape's wireframe once and come
+    /// out the same on any worker count. A plane through the middle
+    /// culls the far half, and a camera origin moves every vertex.
+    #[test]
+    fn debug_geometry_fills_one_buffer_per_primitive() {
+        let build = |workers: usize| {
+            let mut w = World::with_workers(v(0.0, -9.81, 0.0), workers);
+            w.body_box(STATIC, v(0.0, -0.5, 0.0), Quat::default(), v(20.0, 0.5, 20.0), 1.0, 0.6);
+            for i in 0..60 {
+                let pos = v((i % 20) as f32 - 9.5, 1.0 + (i / 20) as f32 * 1.5, 0.0);
+                match i % 3 {
+                    0 => w.body_box(DYNAMIC, pos, Quat::default(), v(0.4, 0.4, 0.4), 1.0, 0.6),
+                    1 => w.body_sphere(DYNAMIC, pos, 0.3, 1.0, 0.6),
+                    _ => w.body_capsule(DYNAMIC, pos, 0.3, 0.2, 1.0, 0.6, false),
+                };
+            }
+            w.step(1.0 / 60.0, 4);
+            w
+        };
+        let bounds = (v(-50.0, -50.0, -50.0), v(50.0, 50.0, 50.0));
+        let origin = v(0.0, 0.0, 0.0);
+        let (mut lines, mut triangles) = (Vec::new(), Vec::new());
+        let w = build(4);
+        assert_eq!(w.debug_geometry(origin, &[], bounds, true, &mut lines, &mut triangles), 61);
+        // Box edges, three circles, two rings with four sides and four arcs
+        assert_eq!(lines.len(), 24 + 20 * (24 + 96 + 136));
+        assert_eq!(triangles.len(), 21 * 36, "six quads per box");
+        assert!(lines.iter().chain(&triangles).all(|p| p.color & 0xFF_FFFF != 0));
+
+        let (mut serial_lines, mut serial_triangles) = (Vec::new(), Vec::new());
+        build(1).debug_geometry(origin, &[], bounds, true, &mut serial_lines, &mut serial_triangles);
+        assert!(lines == serial_lines && triangles == serial_triangles, "one worker writes the same");
+
+        let half = w.debug_geometry(origin, &[[1.0, 0.0, 0.0, 0.5]], bounds, false, &mut lines, &mut triangles);
+        assert_eq!(half, 31, "the ground and the columns at x > 0");
+        assert!(triangles.is_empty());
+
+        let camera = v(1.0, 2.0, 3.0);
+        let (mut moved, mut none) = (Vec::new(), Vec::new());
+        w.debug_geometry(camera, &[[1.0, 0.0, 0.0, -0.5]], bounds, false, &mut moved, &mut none);
+        assert_eq!(moved.len(), lines.len());
+        for (a, b) in lines.iter().zip(&moved) {
+            let d = v(a.position.x - b.position.x, a.position.y - b.position.y, a.position.z - b.position.z);
+            assert!((d.x - 1.0).abs() < 1e-5 && (d.y - 2.0).abs() < 1e-5 && (d.z - 3.0).abs() < 1e-5);
+        }
     }
 
-    /// Every body (category in `mask`) overlapping the capsule
-    /// `p1..p2` at `radius` — the touch/bite verb, live world.
-    pub fn overlap_capsule(&self, p1: Vec3, p2: Vec3, radius: f32, mask: u64) -> Vec<BodyId> {
-        let mut out = [0u64; 64];
-        let n = unsafe {
-            pmb3_world_overlap_capsule(self.0, p1, p2, radius, mask, out.as_mut_ptr(), 64)
+    /// Tuned block sizes leave the step bit-identical while the stages
+    /// try every level and settle on one.
+    #[test]
+    fn grain_tuning_keeps_the_step_identical() {
+        let pile = |tuned: bool| {
+            let mut w = World::with_workers(v(0.0, -9.81, 0.0), 4);
+            w.set_grain_tuning(tuned);
+            w.body_box(STATIC, v(0.0, -0.5, 0.0), Quat::default(), v(50.0, 0.5, 50.0), 1.0, 0.6);
+            for i in 0..800 {
+                let pos = v((i % 20) as f32 * 1.05 - 10.0, 0.5 + (i / 400) as f32 * 1.05 + (i % 7) as f32 * 0.02, (i / 20 % 20) as f32 * 1.05 - 10.0);
+                w.body_box(DYNAMIC, pos, Quat::default(), v(0.5, 0.5, 0.5), 1.0, 0.6);
+            }
+            // Sweeps through the pile so it never sleeps
+            let pusher = w.body_box(KINEMATIC, v(-12.0, 1.0, 0.0), Quat::default(), v(0.5, 1.0, 11.0), 1.0, 0.6);
+            (w, pusher)
         };
-        out[..n as usize].iter().map(|&b| BodyId(b)).collect()
+        let ((mut tuned, tuned_pusher), (mut fixed, fixed_pusher)) = (pile(true), pile(false));
+        for step in 0..300 {
+            let speed = if step / 150 % 2 == 0 { 3.0 } else { -3.0 };
+            tuned.set_velocity(tuned_pusher, v(speed, 0.0, 0.0));
+            fixed.set_velocity(fixed_pusher, v(speed, 0.0, 0.0));
+            tuned.step(1.0 / 60.0, 4);
+            fixed.step(1.0 / 60.0, 4);
+            assert_eq!(tuned.hash_full(), fixed.hash_full(), "step {step}");
+        }
+
+        let stages = tuned.grain_tuning();
+        assert!(fixed.grain_tuning().is_empty());
+        let stage = |name: &str| stages.iter().find(|s| s.name == name).unwrap_or_else(|| panic!("{name} tuned: {stages:?}"));
+        let collide = stage("collide");
+        assert!(!collide.exploring && collide.cost.iter().all(|&c| c > 0.0), "{collide:?}");
+        assert!((-2..=2).contains(&collide.level));
+        let solver = stage("solver");
+        assert!(!solver.exploring && solver.cost[..3].iter().all(|&c| c > 0.0) && solver.cost[3..] == [0.0, 0.0], "{solver:?}");
+        assert!((-2..=0).contains(&solver.level));
     }
-}
 
-impl Drop for World {
-    fn drop(&mut self) {
-        let _gate = WORLD_GATE.lock().unwrap();
-        unsafe { pmb3_world_destroy(self.0) }
+    /// Statics walked through the wide tree give the same bytes, hits
+    /// and overlaps as the binary tree, including after a static is
+    /// added mid-run and the wide tree goes stale.
+    #[test]
+    fn wide_static_tree_matches_binary() {
+        let run = |wide: bool| {
+            let mut w = World::with_workers(v(0.0, -9.81, 0.0), 2);
+            w.body_box(STATIC, v(0.0, -0.5, 0.0), Quat::default(), v(50.0, 0.5, 50.0), 1.0, 0.6);
+            for i in 0..400 {
+                let (ix, iz) = ((i % 20) as f32, (i / 20) as f32);
+                w.body_box(STATIC, v(ix * 1.3 - 13.0, 0.15, iz * 1.3 - 13.0), Quat::default(), v(0.2, 0.15, 0.2), 1.0, 0.6);
+            }
+            w.rebuild_static_tree();
+            w.set_wide_static_tree(wide);
+            for i in 0..80 {
+                let (ix, iz) = ((i % 10) as f32, (i / 10) as f32);
+                w.body_box(DYNAMIC, v(ix * 1.9 - 9.0, 1.0 + ix * 0.2, iz * 2.1 - 8.0), Quat::default(), v(0.5, 0.5, 0.5), 1.0, 0.6);
+            }
+            for step in 0..90 {
+                if step == 30 {
+                    w.body_box(STATIC, v(0.0, 1.0, 0.0), Quat::default(), v(3.0, 0.2, 3.0), 1.0, 0.6);
+                }
+                w.step(1.0 / 60.0, 4);
+            }
+            let rays: Vec<_> = (0..50)
+                .map(|k| w.cast_ray(v((k % 10) as f32 * 2.0 - 10.0, 5.0, (k / 10) as f32 * 3.0 - 7.0), v(0.3, -10.0, 0.2), !0))
+                .collect();
+            let overlaps: Vec<_> =
+                (0..10).map(|k| w.overlap_capsule(v(-14.0, 0.2, k as f32 * 1.3 - 13.0), v(14.0, 0.2, k as f32 * 1.3 - 13.0), 0.1, !0)).collect();
+            (w.hash_full(), rays, overlaps)
+        };
+        let (wide, binary) = (run(true), run(false));
+        assert!(wide.1.iter().all(|h| h.is_some()));
+        assert!(wide.2.iter().all(|o| o.len() > 10));
+        assert_eq!(wide, binary);
     }
-}
 
-pub const STATIC: i32 = 0;
-pub const KINEMATIC: i32 = 1;
-pub const DYNAMIC: i32 = 2;
+    /// Statics streamed in a chunk at a time get re-sorted a budget per
+    /// step to near a full rebuild's quality, and rolling back mid-way
+    /// re-sorts the same way.
+    #[test]
+    fn budgeted_static_rebuild_catches_up_with_full() {
+        let stream = |budget: usize| {
+            let mut w = World::new(v(0.0, -9.81, 0.0));
+            w.set_static_rebuild_budget(budget);
+            for i in 0..40 {
+                w.body_box(DYNAMIC, v((i % 8) as f32 * 1.5 - 6.0, 2.0 + (i / 8) as f32 * 1.2, 0.0), Quat::default(), v(0.5, 0.5, 0.5), 1.0, 0.6);
+            }
+            // Chunks along a road, each placed row by row
+            for chunk in 0..12 {
+                for k in 0..160 {
+                    let (x, z) = ((k % 16) as f32, (k / 16) as f32);
+                    w.body_box(STATIC, v(chunk as f32 * 16.0 + x - 20.0, 0.3, z - 5.0), Quat::default(), v(0.3, 0.3, 0.3), 1.0, 0.6);
+                }
+                for _ in 0..10 {
+                    w.step(1.0 / 60.0, 4);
+                }
+            }
+            w
+        };
 
-#[cfg(test)]
-mod tests {
-    use super::*;
+        let mut full = stream(0);
+        let inserted = full.static_tree().1;
+        full.rebuild_static_tree();
+        let rebuilt = full.static_tree().1;
+        assert!(rebuilt < inserted);
 
-    fn v(x: f32, y: f32, z: f32) -> Vec3 {
-        Vec3 { x, y, z }
+        let mut w = stream(256);
+        let mut snap = Snapshot::new();
+        assert!(w.capture(&mut snap) > 0);
+        let run = |w: &mut World| {
+            for _ in 0..40 {
+                w.step(1.0 / 60.0, 4);
+            }
+            (w.hash_full(), w.static_tree())
+        };
+        let straight = run(&mut w);
+        assert!(w.restore(&snap));
+        assert_eq!(run(&mut w), straight);
+        assert!(straight.1 .1 < inserted && straight.1 .1 < rebuilt * 1.1, "{inserted} -> {} vs {rebuilt}", straight.1 .1);
     }
 
-    /// Build the spike-1 scene: a ground slab and a rain of boxes.
-    fn drop_boxes(n: usize) -> (World, Vec<BodyId>) {
+    /// A plate dropped on a settled bed of studs touches every stud on
+    /// its first step, where a shared buffer of 16 pairs per moved
+    /// proxy used to drop most of them, and the workers' pairs merge
+    /// into the same contacts a serial step makes.
+    #[test]
+    fn wake_pairs_all_become_contacts() {
+        let run = |workers: usize| {
+            let mut w = World::with_workers(v(0.0, -9.81, 0.0), workers);
+            for i in 0..400 {
+                let (ix, iz) = ((i % 20) as f32, (i / 20) as f32);
+                w.body_box(STATIC, v(ix - 9.5, 0.3, iz - 9.5), Quat::default(), v(0.2, 0.2, 0.2), 1.0, 0.6);
+            }
+            w.step(1.0 / 60.0, 4);
+            w.body_box(DYNAMIC, v(0.0, 0.61, 0.0), Quat::default(), v(10.0, 0.1, 10.0), 1.0, 0.6);
+            for i in 0..8 {
+                w.body_box(DYNAMIC, v(i as f32 * 2.0 - 7.0, 1.12, 0.0), Quat::default(), v(0.4, 0.4, 0.4), 1.0, 0.6);
+            }
+            w.step(1.0 / 60.0, 4);
+            let paths = w.solver_paths();
+            for _ in 0..10 {
+                w.step(1.0 / 60.0, 4);
+            }
+            (paths.wide + paths.overflow, w.hash_full())
+        };
+        let serial = run(1);
+        assert!(serial.0 >= 400 + 8, "{} touching", serial.0);
+        assert_eq!(run(4), serial);
+    }
+
+    /// A spawn wave grows the pair set and destroying the wave shrinks
+    /// it back, where the old table kept its peak size forever.
+    #[test]
+    fn pair_set_shrinks_after_a_spawn_wave() {
         let mut w = World::new(v(0.0, -9.81, 0.0));
         w.body_box(STATIC, v(0.0, -0.5, 0.0), Quat::default(), v(50.0, 0.5, 50.0), 1.0, 0.6);
-        let bodies: Vec<BodyId> = (0..n)
+        let settled = w.pair_set().1;
+        let wave: Vec<BodyId> = (0..2000)
             .map(|i| {
-                // A loose grid with a deterministic jitter so stacks
-                // topple instead of balancing perfectly.
-                let (ix, iz) = ((i % 8) as f32, (i / 8) as f32);
-                w.body_box(
-                    DYNAMIC,
-                    v(
-                        ix * 1.1 - 4.0 + (i as f32 * 0.37).sin() * 0.05,
-                        2.0 + (i / 8) as f32 * 1.5,
-                        iz * 1.1 - 4.0 + (i as f32 * 0.61).cos() * 0.05,
-                    ),
-                    Quat::default(),
-                    v(0.4, 0.4, 0.4),
-                    1.0,
-                    0.6,
-                )
+                let (ix, iz) = ((i % 40) as f32, (i / 40) as f32);
+                w.body_box(DYNAMIC, v(ix * 0.9 - 18.0, 0.5 + (i % 3) as f32 * 0.9, iz * 0.9 - 22.0), Quat::default(), v(0.4, 0.4, 0.4), 1.0, 0.6)
             })
             .collect();
-        (w, bodies)
+        for _ in 0..30 {
+            w.step(1.0 / 60.0, 4);
+        }
+        let peak = w.pair_set();
+        assert!(peak.0 > 2000 && peak.1 > settled, "{peak:?}");
+
+        for &b in &wave[..1990] {
+            w.destroy(b);
+        }
+        w.step(1.0 / 60.0, 4);
+        let after = w.pair_set();
+        assert!(after.0 < 50 && after.1 < peak.1 / 8, "{peak:?} -> {after:?}");
     }
 
+    /// A grid broadphase world settles the same pile a tree world does,
+    /// threaded matches serial, snapshots rewind it, and queries still
+    /// find the dynamic bodies living in the grid.
     #[test]
-    fn boxes_fall_settle_and_sleep() {
-        let (mut w, bodies) = drop_boxes(50);
-        for _ in 0..600 {
-            w.step(1.0 / 60.0, 4);
+    fn grid_broadphase_world_matches_the_tree() {
+        let (mut tree, bodies) = drop_boxes(64);
+        let mut grids = [World::with_grid(v(0.0, -9.81, 0.0), 1, 1.0), World::with_grid(v(0.0, -9.81, 0.0), 4, 1.0)];
+        let mut crowd = Vec::new();
+        for g in &mut grids {
+            g.body_box(STATIC, v(0.0, -0.5, 0.0), Quat::default(), v(50.0, 0.5, 50.0), 1.0, 0.6);
+            crowd = bodies
+                .iter()
+                .map(|&b| {
+                    let (p, q) = tree.pose(b);
+                    g.body_box(DYNAMIC, p, q, v(0.4, 0.4, 0.4), 1.0, 0.6)
+                })
+                .collect();
         }
-        let mut asleep = 0;
-        for &b in &bodies {
-            let (p, _) = w.pose(b);
-            assert!(p.y > -0.01, "no box fell through the ground, y {}", p.y);
-            assert!(p.y < 10.0, "no box exploded upward, y {}", p.y);
-            assert!(w.velocity(b).y.abs() < 0.05, "settled, vy {}", w.velocity(b).y);
-            asleep += (!w.awake(b)) as u32;
+        let mut snap = Snapshot::new();
+        for i in 0..180 {
+            tree.step(1.0 / 60.0, 4);
+            for g in &mut grids {
+                g.step(1.0 / 60.0, 4);
+            }
+            if i == 60 {
+                grids[0].capture(&mut snap);
+            }
         }
-        // Island sleeping is the free-bandwidth win — most of a settled
-        // pile must actually be ASLEEP, not merely slow.
-        assert!(asleep >= 40, "sleeping engaged on a settled pile, asleep {asleep}/50");
+        assert_eq!(grids[0].hash(), grids[1].hash());
+
+        // Rewind and replay to the same bytes.
+        let end = grids[0].hash();
+        assert!(grids[0].restore(&snap));
+        for _ in 61..180 {
+            grids[0].step(1.0 / 60.0, 4);
+        }
+        assert_eq!(grids[0].hash(), end);
+
+        // Contact order differs from the tree's, the outcome does not.
+        let g = &grids[1];
+        let height = |w: &World, ids: &[BodyId]| ids.iter().map(|&b| w.pose(b).0.y).sum::<f32>() / ids.len() as f32;
+        assert!(crowd.iter().all(|&b| g.pose(b).0.y > 0.3), "a box fell through the floor");
+        let (hg, ht) = (height(g, &crowd), height(&tree, &bodies));
+        assert!((hg - ht).abs() < 0.25, "{hg} vs {ht}");
+
+        let (p, _) = g.pose(crowd[0]);
+        let above = v(p.x, p.y + 10.0, p.z);
+        let hit = g.cast_ray(above, v(0.0, -20.0, 0.0), !0).expect("ray hits the pile");
+        assert!(hit.0.y > 0.3);
+        let packet = g.cast_rays(&[above], &[v(0.0, -20.0, 0.0)], !0);
+        assert_eq!(packet[0].map(|h| h.1), Some(hit.1));
+        assert!(g.overlap_capsule(p, v(p.x, p.y + 0.1, p.z), 0.1, !0).contains(&crowd[0]));
     }
 
-    /// The query surface the collisions slice leans on: world ray
-    /// casts respect the category mask, per-body sphere casts judge
-    /// the body at a SUPPLIED transform (the lag-comp rewind), radius
-    /// grows the query, and the capsule overlap finds live bodies.
+    /// Box3D's stages as host jobs: a thread-per-job toy host runs the
+    /// step to the same bytes as a serial world.
     #[test]
-    fn casts_filter_rewind_and_pad() {
-        let mut w = World::new(v(0.0, -9.81, 0.0));
-        // Ground as category 1, a box "unit" at x=5 as category 2.
-        // NOTE the default category is ALL BITS (B3_DEFAULT_CATEGORY_BITS
-        // = u64::MAX) — anyone using masked queries must categorize
-        // every body explicitly, statics included.
-        let ground =
-            w.body_box(STATIC, v(0.0, -0.5, 0.0), Quat::default(), v(50.0, 0.5, 50.0), 1.0, 0.6);
-        w.set_filter(ground, 1, !0);
-        let unit = w.body_box(STATIC, v(5.0, 1.0, 0.0), Quat::default(), v(1.0, 1.0, 1.0), 1.0, 0.6);
-        w.set_filter(unit, 2, !0);
+    fn hosted_world_runs_on_the_host_pool() {
+        use std::collections::HashMap;
+        use std::sync::atomic::{AtomicU64, Ordering};
+        use std::sync::{Arc, Mutex};
 
-        // A flat ray down +x at y=1: masked to category 1 it passes the
-        // unit and flies off (no wall in range); masked to everything
-        // it stops on the unit's near face.
-        let (o, t) = (v(0.0, 1.0, 0.0), v(20.0, 0.0, 0.0));
-        assert!(w.cast_ray(o, t, 1).is_none(), "category mask must exclude the unit");
-        let (p, f) = w.cast_ray(o, t, !0).expect("unmasked ray hits the unit");
-        assert!((p.x - 4.0).abs() < 1e-3 && (f - 0.2).abs() < 1e-3, "near face at x=4, got {p:?}");
+        #[derive(Default)]
+        struct Threads {
+            next: AtomicU64,
+            running: Mutex<HashMap<u64, std::thread::JoinHandle<()>>>,
+            spawned: AtomicU64,
+        }
+        impl TaskHost for Threads {
+            fn spawn(&self, job: Job) -> u64 {
+                let ticket = self.next.fetch_add(1, Ordering::Relaxed);
+                self.spawned.fetch_add(1, Ordering::Relaxed);
+                self.running.lock().unwrap().insert(ticket, std::thread::spawn(move || job.run()));
+                ticket
+            }
+            fn wait(&self, ticket: u64) {
+                let handle = self.running.lock().unwrap().remove(&ticket);
+                handle.expect("each ticket waited once").join().unwrap();
+            }
+        }
 
-        // The lag-comp verb: cast at the body as if it were at x=-5
-        // (a rewound frame) — the live pose must not matter.
-        let rewound = (v(-5.0, 1.0, 0.0), Quat::default());
-        let hit = w.body_cast_sphere(unit, rewound, v(-10.0, 1.0, 0.0), 0.0, v(20.0, 0.0, 0.0));
-        let (p, _) = hit.expect("ray hits the body at its REWOUND pose");
-        assert!((p.x + 6.0).abs() < 1e-3, "rewound near face at x=-6, got {p:?}");
+        let host = Arc::new(Threads::default());
+        let mut hosted = World::hosted(v(0.0, -9.81, 0.0), 4, host.clone());
+        let (mut serial, _) = drop_boxes(48);
+        hosted.body_box(STATIC, v(0.0, -0.5, 0.0), Quat::default(), v(50.0, 0.5, 50.0), 1.0, 0.6);
+        // Same bodies, same creation order as the serial pile.
+        let (donor, bodies) = drop_boxes(48);
+        for &b in &bodies {
+            let (p, q) = donor.pose(b);
+            hosted.body_box(DYNAMIC, p, q, v(0.4, 0.4, 0.4), 1.0, 0.6);
+        }
+        for _ in 0..120 {
+            hosted.step(1.0 / 60.0, 4);
+            serial.step(1.0 / 60.0, 4);
+        }
+        assert!(host.spawned.load(Ordering::Relaxed) > 0, "stages went through the host");
+        assert!(host.running.lock().unwrap().is_empty(), "every job waited");
+        assert_eq!(hosted.hash_full(), serial.hash_full(), "host pool is invisible in the result");
+    }
 
-        // Radius is the shot's forgiveness: a ray 2.5 over the box top
-        // misses, a 0.8-sphere along the same line connects.
-        let graze = (v(5.0, 1.0, 0.0), Quat::default());
-        let (o, t) = (v(0.0, 2.5, 0.0), v(20.0, 0.0, 0.0));
-        assert!(w.body_cast_sphere(unit, graze, o, 0.0, t).is_none(), "0.5 over the top misses");
-        assert!(w.body_cast_sphere(unit, graze, o, 0.8, t).is_some(), "the pad connects it");
+    /// A batch of worlds stepped across the pool ends exactly where
+    /// stepping each alone ends.
+    #[test]
+    fn stepper_matches_serial_stepping() {
+        let mut pooled: Vec<World> = (0..6).map(|i| drop_boxes(12 + i).0).collect();
+        let mut serial: Vec<World> = (0..6).map(|i| drop_boxes(12 + i).0).collect();
+        let mut stepper = Stepper::new(3);
+        for _ in 0..120 {
+            let mut batch: Vec<&mut World> = pooled.iter_mut().collect();
+            stepper.step(&mut batch, 1.0 / 60.0, 4);
+            for w in &mut serial {
+                w.step(1.0 / 60.0, 4);
+            }
+        }
+        for (p, s) in pooled.iter().zip(&serial) {
+            assert_eq!(p.hash_full(), s.hash_full(), "pooled step is the serial step");
+        }
+    }
 
-        // Touch verb: a vertical capsule beside the unit's face
-        // overlaps it; the same capsule masked to category 1 does not.
-        let (p1, p2) = (v(3.5, 0.5, 0.0), v(3.5, 1.5, 0.0));
-        assert_eq!(w.overlap_capsule(p1, p2, 0.7, 2), vec![unit], "capsule reaches the face");
-        assert!(!w.overlap_capsule(p1, p2, 0.7, 1).contains(&unit), "mask excludes the unit");
-        assert!(w.overlap_capsule(p1, p2, 0.3, 2).is_empty(), "short reach misses");
+    /// Background stepping: host work runs while the batch steps, and
+    /// the worlds land exactly where a blocking step puts them.
+    #[test]
+    fn step_while_overlaps_host_work() {
+        let mut pooled: Vec<World> = (0..3).map(|i| drop_boxes(20 + i).0).collect();
+        let mut serial: Vec<World> = (0..3).map(|i| drop_boxes(20 + i).0).collect();
+        let mut stepper = Stepper::new(2);
+        let mut encoded = 0u64;
+        for tick in 0..90u64 {
+            let mut batch: Vec<&mut World> = pooled.iter_mut().collect();
+            encoded += stepper.step_while(&mut batch, 1.0 / 60.0, 4, || (0..1000u64).map(|i| i ^ tick).sum::<u64>());
+            for w in &mut serial {
+                w.step(1.0 / 60.0, 4);
+            }
+        }
+        assert!(encoded > 0);
+        for (p, s) in pooled.iter().zip(&serial) {
+            assert_eq!(p.hash_full(), s.hash_full(), "background step is the blocking step");
+        }
+        let mut lone = drop_boxes(20).0;
+        let mut inline = Stepper::new(0);
+        inline.step_while(&mut [&mut lone], 1.0 / 60.0, 4, || ());
+        assert_ne!(lone.hash_full(), drop_boxes(20).0.hash_full(), "no threads: still steps");
     }
 
     /// The property every future spike leans on: two identical runs
@@ -486,4 +6335,455 @@ mod tests {
             "two identical runs must be bit-identical"
         );
     }
+
+    /// A terrain chunk cooks to the same bytes on one thread and on
+    /// four (top-down split, subtrees and edge passes on the workers),
+    /// and a streamer can abandon a cook part way.
+    #[test]
+    fn terrain_cook_is_the_same_on_any_worker_count() {
+        // Every quad brings its own corners, so the weld has work to do
+        let n = 200;
+        let height = |i: usize, j: usize| (i as f32 * 0.3).sin() * (j as f32 * 0.2).cos();
+        let mut verts = Vec::new();
+        let mut indices = Vec::new();
+        for i in 0..n {
+            for j in 0..n {
+                let base = verts.len() as i32;
+                for (di, dj) in [(0, 0), (1, 0), (1, 1), (0, 1)] {
+                    let (x, z) = (i + di, j + dj);
+                    verts.push(Vec3 { x: x as f32, y: height(x, z), z: z as f32 });
+                }
+                indices.extend_from_slice(&[base, base + 2, base + 1, base, base + 3, base + 2]);
+            }
+        }
+
+        let serial = Mesh::cook(&verts, &indices, 0.01, 1).expect("serial cook");
+        let parallel = Mesh::cook(&verts, &indices, 0.01, 4).expect("parallel cook");
+        assert_eq!(serial.triangles(), 2 * n * n);
+        assert_eq!(serial.hash(), parallel.hash(), "worker count must not change the mesh");
+
+        let mut seen = Vec::new();
+        let abandoned = Mesh::cook_with_progress(&verts, &indices, 0.01, 4, &mut |f| {
+            seen.push(f);
+            f < 0.5
+        });
+        assert!(abandoned.is_none());
+        assert!(seen.windows(2).all(|w| w[0] < w[1]) && *seen.last().unwrap() >= 0.5);
+    }
+
+    /// Cooked bytes load back at another address unchanged, and a
+    /// truncated or corrupted file is refused instead of trusted.
+    #[test]
+    fn precooked_mesh_loads_in_place() {
+        let n = 16;
+        let mut verts = Vec::new();
+        let mut indices = Vec::new();
+        for i in 0..=n {
+            for j in 0..=n {
+                let y = ((i * 7 + j * 3) % 5) as f32 * 0.1;
+                verts.push(Vec3 { x: i as f32, y, z: j as f32 });
+            }
+        }
+        for i in 0..n {
+            for j in 0..n {
+                let a = (i * (n + 1) + j) as i32;
+                let b = a + n as i32 + 1;
+                indices.extend_from_slice(&[a, a + 1, b, b, a + 1, b + 1]);
+            }
+        }
+        let mesh = Mesh::cook(&verts, &indices, 0.0, 1).expect("cook");
+
+        // An 8-byte aligned copy somewhere else, as a file read or mmap gives
+        let bytes = mesh.bytes();
+        let mut words = vec![0u64; bytes.len().div_ceil(8)];
+        let file = unsafe { std::slice::from_raw_parts_mut(words.as_mut_ptr() as *mut u8, bytes.len()) };
+        file.copy_from_slice(bytes);
+
+        let view = MeshView::new(file, true).expect("view");
+        assert_eq!(view.hash(), mesh.hash());
+        assert_eq!(view.triangles(), 2 * n * n);
+
+        assert!(MeshView::new(&file[..file.len() - 8], false).is_none(), "truncated");
+        let last = file.len() - 1;
+        file[last] ^= 0x5a;
+        assert!(MeshView::new(file, false).is_some(), "layout alone still checks out");
+        assert!(MeshView::new(file, true).is_none(), "the hash catches the flipped byte");
+    }
+
+    /// Quantized nodes only loosen boxes, so every ray finds the same
+    /// triangle at the same fraction as on full-precision nodes, and the
+    /// quantized blob still loads in place.
+    #[test]
+    fn quantized_mesh_casts_match_full_precision() {
+        let n = 48;
+        let height = |i: usize, j: usize| (i as f32 * 0.37).sin() * 2.0 + (j as f32 * 0.21).cos() * 1.5;
+        let mut verts = Vec::new();
+        let mut indices = Vec::new();
+        for i in 0..=n {
+            for j in 0..=n {
+                verts.push(Vec3 { x: i as f32 * 0.5 - 500.0, y: height(i, j), z: j as f32 * 0.5 + 300.0 });
+            }
+        }
+        for i in 0..n {
+            for j in 0..n {
+                let a = (i * (n + 1) + j) as i32;
+                let b = a + n as i32 + 1;
+                indices.extend_from_slice(&[a, a + 1, b, b, a + 1, b + 1]);
+            }
+        }
+        let full = Mesh::cook(&verts, &indices, 0.0, 1).expect("cook");
+        let quantized = Mesh::cook_quantized(&verts, &indices, 0.0, 1).expect("quantized cook");
+        assert_eq!(quantized.triangles(), full.triangles());
+        assert!(quantized.bytes().len() < full.bytes().len());
+
+        let mut hits = 0;
+        for k in 0..400 {
+            let (u, v) = ((k % 20) as f32 * 1.213 + 0.31, (k / 20) as f32 * 1.187 + 0.29);
+            let origin = Vec3 { x: u - 500.0, y: 10.0, z: v + 300.0 };
+            let translation = Vec3 { x: (k % 7) as f32 - 3.0, y: -20.0, z: (k % 5) as f32 - 2.0 };
+            let expected = full.cast_ray(origin, translation);
+            assert_eq!(quantized.cast_ray(origin, translation), expected, "ray {k}");
+            hits += expected.is_some() as usize;
+        }
+        assert!(hits > 300);
+
+        let bytes = quantized.bytes();
+        let mut words = vec![0u64; bytes.len().div_ceil(8)];
+        let file = unsafe { std::slice::from_raw_parts_mut(words.as_mut_ptr() as *mut u8, bytes.len()) };
+        file.copy_from_slice(bytes);
+        assert_eq!(MeshView::new(file, true).expect("view").hash(), quantized.hash());
+    }
+
+    /// Long shallow rays across a height field hit where the same
+    /// terrain cooked as a mesh says, though most of their path is
+    /// skipped a tile at a time; a sphere never lands later than the
+    /// ray along its center.
+    #[test]
+    fn height_field_casts_skip_tiles_without_missing_hits() {
+        let (nx, nz) = (129, 97);
+        let scale = Vec3 { x: 1.5, y: 1.0, z: 2.0 };
+        let height = |i: usize, j: usize| (i as f32 * 0.11).sin() * 4.0 + (j as f32 * 0.07).cos() * 3.0;
+        let mut heights = Vec::new();
+        let mut verts = Vec::new();
+        for j in 0..nz {
+            for i in 0..nx {
+                heights.push(height(i, j));
+                verts.push(Vec3 { x: i as f32 * scale.x, y: height(i, j), z: j as f32 * scale.z });
+            }
+        }
+        let mut indices = Vec::new();
+        for j in 0..nz - 1 {
+            for i in 0..nx - 1 {
+                let a = (j * nx + i) as i32;
+                let b = a + nx as i32;
+                indices.extend_from_slice(&[a, b, a + 1, b + 1, a + 1, b]);
+            }
+        }
+        let field = HeightField::new(&heights, nx, nz, scale);
+        let mesh = Mesh::cook(&verts, &indices, 0.0, 1).expect("cook");
+
+        let mut hits = 0;
+        for k in 0..200 {
+            let origin = Vec3 { x: -10.0 + (k % 10) as f32 * 3.1, y: 9.0, z: -5.0 + (k / 10) as f32 * 9.7 };
+            let (dx, dy, dz) = ((k % 3) as f32 * 20.0, (k % 4) as f32, (k % 9) as f32 * 12.0);
+            let translation = Vec3 { x: 180.0 + dx, y: -12.0 - dy, z: 40.0 - dz };
+            let ray = field.cast(origin, translation, 0.0);
+            let expected = mesh.cast_ray(origin, translation);
+            assert_eq!(ray.is_some(), expected.is_some(), "ray {k}");
+            if let (Some((_, f)), Some((_, g))) = (ray, expected) {
+                assert!((f - g).abs() < 1e-3, "ray {k}: {f} vs {g}");
+                hits += 1;
+                let (_, s) = field.cast(origin, translation, 0.5).expect("sphere");
+                assert!(s <= f + 1e-4, "sphere {k}: {s} after {f}");
+            }
+        }
+        assert!(hits > 150);
+    }
+
+    /// Open terrain: a mover over a flat tile gets the one ground plane,
+    /// over a hill the per-triangle planes, and queries skip tiles below
+    /// the box yet still return every triangle of a tile they cover.
+    #[test]
+    fn height_field_tiles_cull_queries_and_flatten_mover_planes() {
+        let n = 33;
+        let scale = Vec3 { x: 1.0, y: 1.0, z: 1.0 };
+        let mut heights = vec![0.0f32; n * n];
+        for j in 0..8 {
+            for i in 0..8 {
+                heights[j * n + i] = 2.0 - ((i as f32 - 4.0).powi(2) + (j as f32 - 4.0).powi(2)) * 0.1;
+            }
+        }
+        let field = HeightField::new(&heights, n, n, scale);
+
+        let at = |x: f32, y: f32, z: f32| Vec3 { x, y, z };
+        assert!(field.mover_planes(at(20.3, 0.7, 20.6), at(20.3, 1.7, 20.6), 0.5).is_empty(), "hovering");
+        let flat = field.mover_planes(at(20.3, 0.4, 20.6), at(20.3, 1.4, 20.6), 0.5);
+        assert_eq!(flat.len(), 1);
+        assert_eq!(flat[0].0, at(0.0, 1.0, 0.0));
+        assert!((flat[0].1 - 0.1).abs() < 1e-4, "{}", flat[0].1);
+        assert!(field.mover_planes(at(4.2, 2.3, 3.9), at(4.2, 3.3, 3.9), 0.5).len() > 1, "hill");
+
+        assert!(field.query(at(18.0, 0.5, 18.0), at(22.0, 1.5, 22.0)).is_empty(), "box above flat ground");
+        let ground = field.query(at(18.5, -0.5, 18.5), at(21.5, 0.5, 21.5));
+        let cell = |i: usize, j: usize| j * (n - 1) + i;
+        let expected: Vec<usize> =
+            (18..22).flat_map(|j| (18..22).flat_map(move |i| [2 * cell(i, j), 2 * cell(i, j) + 1])).collect();
+        assert_eq!(ground, expected);
+    }
+
+    /// A ball rests on a paged tile, follows it down when the tile is
+    /// swapped for a lower one, and falls once the tile is evicted,
+    /// while a neighbor tile stays loaded throughout.
+    #[test]
+    fn terrain_tiles_page_in_swap_and_evict() {
+        let mut world = World::new(Vec3 { x: 0.0, y: -10.0, z: 0.0 });
+        let origin = Vec3 { x: -16.0, y: 0.0, z: -16.0 };
+        let mut terrain = Terrain::new(&mut world, origin, (16.0, 16.0), (2, 2), 0.6);
+        let flat = |y: f32| HeightField::new(&vec![y; 17 * 17], 17, 17, Vec3 { x: 1.0, y: 1.0, z: 1.0 });
+
+        assert!(terrain.set_tile(&mut world, 0, 0, Some(flat(0.0))).is_none());
+        assert!(terrain.set_tile(&mut world, 1, 1, Some(flat(0.0))).is_none());
+        assert_eq!(terrain.loaded(), 2);
+        assert_eq!(world.hash(), world.hash_full(), "page-in");
+
+        let ball = world.body_sphere(DYNAMIC, Vec3 { x: 8.3, y: 3.0, z: 8.7 }, 0.5, 1.0, 0.6);
+        let settle = |world: &mut World, steps: usize| {
+            for _ in 0..steps {
+                world.step(1.0 / 60.0, 4);
+            }
+            world.pose(ball).0.y
+        };
+        assert!((settle(&mut world, 120) - 0.5).abs() < 0.02);
+
+        assert!(terrain.set_tile(&mut world, 1, 1, Some(flat(-1.0))).is_some());
+        assert_eq!(terrain.loaded(), 2);
+        assert_eq!(world.hash(), world.hash_full(), "swap");
+        assert!((settle(&mut world, 120) + 0.5).abs() < 0.02);
+
+        assert!(terrain.set_tile(&mut world, 1, 1, None).is_some());
+        assert_eq!(terrain.loaded(), 1);
+        assert_eq!(world.hash(), world.hash_full(), "evict");
+        assert!(settle(&mut world, 60) < -3.0);
+        terrain.destroy(&mut world);
+        assert_eq!(world.hash(), world.hash_full(), "destroy");
+    }
+
+    /// Two worlds build the same ramp hull and both borrow the one
+    /// library copy, which lives on after its handle is dropped until
+    /// the last world lets go. The only test that touches the library.
+    #[test]
+    fn worlds_share_library_hulls() {
+        let ramp = [
+            Vec3 { x: 0.0, y: 0.0, z: 0.0 },
+            Vec3 { x: 4.0, y: 0.0, z: 0.0 },
+            Vec3 { x: 0.0, y: 0.0, z: 3.0 },
+            Vec3 { x: 4.0, y: 0.0, z: 3.0 },
+            Vec3 { x: 4.0, y: 1.5, z: 0.0 },
+            Vec3 { x: 4.0, y: 1.5, z: 3.0 },
+        ];
+        let shared = SharedHull::new(&ramp).expect("hull");
+        let (count, bytes) = shared_geometry();
+        assert_eq!(count, 1);
+        assert!(bytes > 0);
+        assert!(SharedHull::new(&ramp).is_some_and(|again| again.0 == shared.0), "equal content, one entry");
+
+        let mut worlds = [0, 1].map(|_| World::new(Vec3 { x: 0.0, y: -10.0, z: 0.0 }));
+        let mut ramps = Vec::new();
+        for w in &mut worlds {
+            ramps.push(w.body_hull(0, Vec3::default(), Quat::default(), &ramp, 1.0, 0.6));
+            w.step(1.0 / 60.0, 4);
+        }
+
+        drop(shared);
+        assert_eq!(shared_geometry().0, 1, "the worlds still hold it");
+        worlds[0].destroy(ramps[0]);
+        assert_eq!(shared_geometry().0, 1);
+        drop(worlds);
+        assert_eq!(shared_geometry(), (0, 0));
+    }
+
+    /// Spawning the same debris chunk twice builds its hull once; the
+    /// second spawn is a cache hit and lands like the first.
+    #[test]
+    fn repeated_hull_spawns_hit_the_cache() {
+        let chunk = [
+            Vec3 { x: -0.31, y: -0.22, z: -0.27 },
+            Vec3 { x: 0.33, y: -0.19, z: -0.29 },
+            Vec3 { x: 0.02, y: 0.37, z: -0.21 },
+            Vec3 { x: -0.28, y: -0.17, z: 0.35 },
+            Vec3 { x: 0.29, y: 0.11, z: 0.31 },
+            Vec3 { x: 0.07, y: -0.33, z: 0.13 },
+        ];
+        let mut world = World::new(Vec3 { x: 0.0, y: -10.0, z: 0.0 });
+        let (floor, half) = (Vec3 { x: 0.0, y: -0.5, z: 0.0 }, Vec3 { x: 20.0, y: 0.5, z: 20.0 });
+        world.body_box(STATIC, floor, Quat::default(), half, 1.0, 0.6);
+        let first = world.body_hull(DYNAMIC, Vec3 { x: -2.0, y: 1.0, z: 0.0 }, Quat::default(), &chunk, 1.0, 0.6);
+        let (count, hits) = hull_cache();
+        assert!(count > 0);
+        let second = world.body_hull(DYNAMIC, Vec3 { x: 2.0, y: 1.0, z: 0.0 }, Quat::default(), &chunk, 1.0, 0.6);
+        assert!(hull_cache().1 > hits, "the second spawn skips the build");
+
+        for _ in 0..120 {
+            world.step(1.0 / 60.0, 4);
+        }
+        let (a, b) = (world.pose(first).0, world.pose(second).0);
+        assert!((a.y - b.y).abs() < 1e-4, "same hull, same rest height: {} vs {}", a.y, b.y);
+    }
+
+    /// A two-chunk ledge holds a crate on each chunk. Shedding one chunk
+    /// drops its crate and leaves the other crate resting.
+    #[test]
+    fn compound_sheds_chunks_in_place() {
+        let v = |x, y, z| Vec3 { x, y, z };
+        let mut world = World::new(v(0.0, -10.0, 0.0));
+        let half = v(1.0, 0.25, 1.0);
+        let ledge = Compound::boxes(&[[v(-1.0, 0.0, 0.0), half], [v(1.0, 0.0, 0.0), half]], 0.6);
+        let prop = world.body_compound(v(0.0, 2.0, 0.0), &ledge);
+        let crate_half = v(0.3, 0.3, 0.3);
+        let left = world.body_box(DYNAMIC, v(-1.0, 2.6, 0.0), Quat::default(), crate_half, 1.0, 0.6);
+        let right = world.body_box(DYNAMIC, v(1.0, 2.6, 0.0), Quat::default(), crate_half, 1.0, 0.6);
+        for _ in 0..120 {
+            world.step(1.0 / 60.0, 4);
+        }
+        assert!(world.pose(left).0.y > 2.4 && world.pose(right).0.y > 2.4);
+
+        world.shed(prop, 0);
+        assert_eq!(ledge.standing(), 1);
+        for _ in 0..60 {
+            world.step(1.0 / 60.0, 4);
+        }
+        assert!(world.pose(left).0.y < 1.0, "the crate on the shed chunk falls: {}", world.pose(left).0.y);
+        assert!(world.pose(right).0.y > 2.4, "the other crate stays: {}", world.pose(right).0.y);
+
+        world.shed(prop, 0);
+        assert_eq!(ledge.standing(), 1, "shedding twice is a no-op");
+        drop(world);
+    }
+
+    /// Four threads querying in the query phase see what the same
+    /// queries saw one at a time before it, batches and cached rays
+    /// included. The world's first cached gathers happen in the phase.
+    #[test]
+    fn query_phase_serves_many_threads() {
+        let mut w = World::with_workers(v(0.0, -9.81, 0.0), 4);
+        w.body_box(STATIC, v(0.0, -0.5, 0.0), Quat::default(), v(20.0, 0.5, 20.0), 1.0, 0.6);
+        for i in 0..200 {
+            let pos = v((i % 20) as f32 * 1.1 - 11.0, 0.5 + (i / 100) as f32 * 1.05, (i / 20 % 5) as f32 * 1.1 - 2.75);
+            w.body_box(DYNAMIC, pos, Quat::default(), v(0.5, 0.5, 0.5), 1.0, 0.6);
+        }
+        for _ in 0..30 {
+            w.step(1.0 / 60.0, 4);
+        }
+
+        let origins: Vec<_> = (0..64).map(|i| v(i as f32 * 0.35 - 11.0, 8.0, (i % 8) as f32 - 4.0)).collect();
+        let translations = vec![v(0.0, -20.0, 0.0); origins.len()];
+        let single: Vec<_> = origins.iter().map(|&o| w.cast_ray(o, v(0.0, -20.0, 0.0), !0)).collect();
+        let batch = w.cast_rays(&origins, &translations, !0);
+        let near = w.nearest(v(0.0, 1.0, 0.0), 6.0, !0, 8);
+        let touching = w.overlap_capsule(v(-2.0, 0.5, 0.0), v(2.0, 0.5, 0.0), 0.5, !0);
+        assert!(single.iter().all(|h| h.is_some()) && near.len() == 8 && !touching.is_empty());
+
+        let q = w.queries();
+        std::thread::scope(|s| {
+            for _ in 0..4 {
+                s.spawn(|| {
+                    let mut caches: Vec<_> = origins.iter().map(|_| RayCache::new()).collect();
+                    for _ in 0..20 {
+                        let hits: Vec<_> = origins.iter().map(|&o| q.cast_ray(o, v(0.0, -20.0, 0.0), !0)).collect();
+                        assert_eq!(hits, single);
+                        let cached: Vec<_> =
+                            origins.iter().zip(&mut caches).map(|(&o, c)| q.cast_ray_cached(c, o, v(0.0, -20.0, 0.0), !0)).collect();
+                        assert_eq!(cached, single);
+                        assert_eq!(q.cast_rays(&origins, &translations, !0), batch);
+                        assert_eq!(q.nearest(v(0.0, 1.0, 0.0), 6.0, !0, 8), near);
+                        assert_eq!(q.overlap_capsule(v(-2.0, 0.5, 0.0), v(2.0, 0.5, 0.0), 0.5, !0), touching);
+                    }
+                });
+            }
+        });
+        drop(q);
+        w.step(1.0 / 60.0, 4);
+    }
+
+    /// Matches cloned from one arena step exactly as the arena does,
+    /// shed their own chunks, and outlive it.
+    #[test]
+    fn cloned_world_steps_like_its_template() {
+        let v = |x, y, z| Vec3 { x, y, z };
+        let mut arena = World::new(v(0.0, -10.0, 0.0));
+        arena.body_box(STATIC, v(0.0, -0.5, 0.0), Quat::default(), v(30.0, 0.5, 30.0), 1.0, 0.6);
+        let wedge = [v(-2.0, 0.0, -2.0), v(2.0, 0.0, -2.0), v(-2.0, 0.0, 2.0), v(2.0, 0.0, 2.0), v(-2.0, 1.5, -2.0), v(-2.0, 1.5, 2.0)];
+        arena.body_hull(STATIC, v(6.0, 0.0, 0.0), Quat::default(), &wedge, 1.0, 0.6);
+        let half = v(1.0, 0.25, 1.0);
+        let ledge = Compound::boxes(&[[v(-1.0, 0.0, 0.0), half], [v(1.0, 0.0, 0.0), half]], 0.6);
+        let prop = arena.body_compound(v(-6.0, 2.0, 0.0), &ledge);
+        let crate_half = v(0.3, 0.3, 0.3);
+        let left = arena.body_box(DYNAMIC, v(-7.0, 2.6, 0.0), Quat::default(), crate_half, 1.0, 0.6);
+        for i in 0..20 {
+            let pos = v(i as f32 * 0.9 - 9.0 + (i % 3) as f32 * 0.1, 3.0 + (i % 4) as f32, 4.0);
+            arena.body_box(DYNAMIC, pos, Quat::default(), crate_half, 1.0, 0.6);
+        }
+        arena.rebuild_static_tree();
+
+        let mut matches = [arena.clone_world(1), arena.clone_world(4)];
+        for step in 0..120 {
+            arena.step(1.0 / 60.0, 4);
+            for m in &mut matches {
+                m.step(1.0 / 60.0, 4);
+                assert_eq!(m.hash_full(), arena.hash_full(), "step {step}");
+            }
+        }
+
+        let shed = matches[0].rehome(prop);
+        matches[0].shed(shed, 0);
+        assert_eq!(ledge.standing(), 2, "the arena's ledge keeps its chunks");
+        drop(arena);
+        for _ in 0..60 {
+            for m in &mut matches {
+                m.step(1.0 / 60.0, 4);
+            }
+        }
+        let height = |m: &World| m.pose(m.rehome(left)).0.y;
+        assert!(height(&matches[0]) < 1.0, "the crate on the shed chunk falls: {}", height(&matches[0]));
+        assert!(height(&matches[1]) > 2.4, "the other match's crate stays: {}", height(&matches[1]));
+    }
+
+    /// A batch of capsules walking into a wall stop at it and slide
+    /// along it, the same as each one moved alone, on one thread or four.
+    #[test]
+    fn batched_movers_stop_at_walls_and_match_single_moves() {
+        let v = |x, y, z| Vec3 { x, y, z };
+        let build = |workers| {
+            let mut w = World::with_workers(v(0.0, -10.0, 0.0), workers);
+            w.body_box(STATIC, v(0.0, -0.5, 0.0), Quat::default(), v(50.0, 0.5, 50.0), 1.0, 0.6);
+            w.body_box(STATIC, v(5.0, 1.0, 0.0), Quat::default(), v(0.5, 1.0, 50.0), 1.0, 0.6);
+            w
+        };
+        let movers: Vec<Mover> = (0..64)
+            .map(|i| Mover {
+                pos: v(3.0, 0.0, i as f32 - 32.0),
+                c1: v(0.0, 0.5, 0.0),
+                c2: v(0.0, 1.5, 0.0),
+                radius: 0.4,
+                delta: v(2.0, 0.0, 1.0),
+                vel: v(6.0, 0.0, 3.0),
+            })
+            .collect();
+
+        let mut batch = Vec::new();
+        build(1).move_capsules(&movers, !0, &mut batch);
+        for (m, r) in movers.iter().zip(&batch) {
+            assert!(r.pos.x < 4.5 && r.pos.x > 4.0, "stopped at the wall: {:?}", r.pos);
+            assert!((r.pos.z - m.pos.z - 1.0).abs() < 1e-3, "slid along it: {:?}", r.pos);
+            assert!(r.vel.x.abs() < 1e-3 && (r.vel.z - 3.0).abs() < 1e-3 && r.planes == 1, "clipped by the wall: {:?}", r);
+        }
+
+        let mut threaded = Vec::new();
+        build(4).move_capsules(&movers, !0, &mut threaded);
+        assert_eq!(batch, threaded);
+        let mut single = Vec::new();
+        build(1).move_capsules(&movers[7..8], !0, &mut single);
+        assert_eq!(single[0], batch[7]);
+    }
 }
+
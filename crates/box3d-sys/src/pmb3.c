@@ -1,6 +1,7 @@
 // pmb3 — the pm-shaped seam over Box3D. pm code NEVER sees a b3* type:
-// this file is the only translation unit that includes box3d headers,
-// and it exposes a primitive-typed API (floats, out-pointers, packed
+// the shim's translation units (this file, its pmb3_*.c siblings, and
+// their shared pmb3.h) are the only ones that include box3d headers,
+// and they expose a primitive-typed API (floats, out-pointers, packed
 // u32/u64 ids) the Rust side declares by hand. Two reasons this is a
 // shim and not bindgen output:
 //   1. no libclang anywhere in the build (Linux, native Windows,
@@ -11,345 +12,1879 @@
 // sleep state. Capsules, filters, contacts, joints, the mover, and the
 // recording/keyframe machinery come with their spikes.
 
-#include "box3d/box3d.h"
-#include <stdint.h>
+#include "pmb3.h"
 
-typedef struct
-{
-	float x, y, z;
-} PmbVec3;
+#include "constraint_graph.h"
+#include "contact_solver.h"
+#include "hull_map.h"
+#include "shape.h"
+#include "table.h"
 
-typedef struct
-{
-	float x, y, z, w;
-} PmbQuat;
+#include <float.h>
+#include <string.h>
 
-// Ids pack the b3 handle structs into plain integers so Rust treats
-// them as opaque numbers: world = index1 | generation<<16; body =
-// index1 | world0<<32 | generation<<48.
-static b3WorldId pmb3_unpack_world( uint32_t w )
+uint32_t pmb3_world_create( float gx, float gy, float gz )
 {
-	b3WorldId id = { (uint16_t)( w & 0xFFFF ), (uint16_t)( w >> 16 ) };
-	return id;
+	b3WorldDef def = b3DefaultWorldDef();
+	def.gravity = ( b3Vec3 ){ gx, gy, gz };
+	b3WorldId id = b3CreateWorld( &def );
+	pmb3_hash_rebuild( b3GetWorldFromId( id ) );
+	return (uint32_t)id.index1 | ( (uint32_t)id.generation << 16 );
 }
 
-static uint64_t pmb3_pack_body( b3BodyId id )
+// Same world on Box3D's built-in scheduler: `workers` threads in all,
+// the stepping thread included. For one big world; a host packing many
+// small ones wants the stepper (pmb3_step.c) instead.
+uint32_t pmb3_world_create_threaded( float gx, float gy, float gz, int workers )
 {
-	return (uint64_t)(uint32_t)id.index1 | ( (uint64_t)id.world0 << 32 ) | ( (uint64_t)id.generation << 48 );
+	b3WorldDef def = b3DefaultWorldDef();
+	def.gravity = ( b3Vec3 ){ gx, gy, gz };
+	def.workerCount = (uint32_t)workers;
+	b3WorldId id = b3CreateWorld( &def );
+	pmb3_hash_rebuild( b3GetWorldFromId( id ) );
+	return (uint32_t)id.index1 | ( (uint32_t)id.generation << 16 );
 }
 
-static b3BodyId pmb3_unpack_body( uint64_t v )
+// Threaded world bound to CPU `base + i` for each set bit i of `cpus`:
+// its workers run there, and its memory is first touched there, so a
+// host packing matches per socket keeps each world on one NUMA node.
+uint32_t pmb3_world_create_pinned( float gx, float gy, float gz, int workers, uint64_t cpus, int base )
 {
-	b3BodyId id = { (int32_t)(uint32_t)( v & 0xFFFFFFFF ), (uint16_t)( ( v >> 32 ) & 0xFFFF ), (uint16_t)( v >> 48 ) };
-	return id;
+	b3WorldDef def = b3DefaultWorldDef();
+	def.gravity = ( b3Vec3 ){ gx, gy, gz };
+	def.workerCount = (uint32_t)workers;
+	def.affinityMask = cpus;
+	def.affinityBase = base;
+	b3WorldId id = b3CreateWorld( &def );
+	pmb3_hash_rebuild( b3GetWorldFromId( id ) );
+	return (uint32_t)id.index1 | ( (uint32_t)id.generation << 16 );
 }
 
-uint32_t pmb3_world_create( float gx, float gy, float gz )
+// Same world with its stages run as jobs on the HOST's task system
+// (b3WorldDef's enqueue/finish hooks, passed straight through) — no
+// Box3D threads competing with the host pool for the same cores.
+// `finish` must keep running other jobs while it waits; see
+// b3FinishTaskCallback.
+uint32_t pmb3_world_create_hosted( float gx, float gy, float gz, int workers, b3EnqueueTaskCallback* enqueue,
+								   b3FinishTaskCallback* finish, void* host )
 {
 	b3WorldDef def = b3DefaultWorldDef();
 	def.gravity = ( b3Vec3 ){ gx, gy, gz };
+	def.workerCount = (uint32_t)workers;
+	def.enqueueTask = enqueue;
+	def.finishTask = finish;
+	def.userTaskContext = host;
 	b3WorldId id = b3CreateWorld( &def );
+	pmb3_hash_rebuild( b3GetWorldFromId( id ) );
 	return (uint32_t)id.index1 | ( (uint32_t)id.generation << 16 );
 }
 
-void pmb3_world_destroy( uint32_t w )
+// Same world with the convex contact solver capped at `simdWidth`
+// lanes: 0 takes 8 with AVX2, 16 admits AVX-512 too, 4 pins the
+// SSE2/NEON build. The result does not depend on it; this exists to
+// prove that, and to rule the wide path out when chasing a bug.
+uint32_t pmb3_world_create_simd( float gx, float gy, float gz, int simdWidth )
 {
-	b3DestroyWorld( pmb3_unpack_world( w ) );
+	b3WorldDef def = b3DefaultWorldDef();
+	def.gravity = ( b3Vec3 ){ gx, gy, gz };
+	def.simdWidth = simdWidth;
+	b3WorldId id = b3CreateWorld( &def );
+	pmb3_hash_rebuild( b3GetWorldFromId( id ) );
+	return (uint32_t)id.index1 | ( (uint32_t)id.generation << 16 );
 }
 
-void pmb3_world_step( uint32_t w, float dt, int substeps )
+// A world whose dynamic proxies live in a uniform grid of `cellSize`
+// cells (0: 2 m) instead of a tree: cheaper for a dense crowd of
+// similar bodies, which otherwise churns the tree every step.
+uint32_t pmb3_world_create_grid( float gx, float gy, float gz, int workers, float cellSize )
 {
-	b3World_Step( pmb3_unpack_world( w ), dt, substeps );
+	b3WorldDef def = b3DefaultWorldDef();
+	def.gravity = ( b3Vec3 ){ gx, gy, gz };
+	def.workerCount = (uint32_t)workers;
+	def.dynamicBroadPhase = b3_gridBroadPhase;
+	def.gridCellSize = cellSize;
+	b3WorldId id = b3CreateWorld( &def );
+	pmb3_hash_rebuild( b3GetWorldFromId( id ) );
+	return (uint32_t)id.index1 | ( (uint32_t)id.generation << 16 );
 }
 
-// One creation door for spike 1: a box body. type: 0 = static,
-// 1 = kinematic, 2 = dynamic (matches b3BodyType by construction,
-// asserted below so an upstream enum shuffle is a compile error).
-_Static_assert( b3_staticBody == 0 && b3_kinematicBody == 1 && b3_dynamicBody == 2, "pmb3 type map" );
-
-uint64_t pmb3_body_box( uint32_t w, int type, PmbVec3 pos, PmbQuat rot, PmbVec3 half, float density, float friction )
+// Lanes the world's contact solver actually runs.
+int pmb3_world_simd_width( uint32_t w )
 {
-	b3BodyDef bd = b3DefaultBodyDef();
-	bd.type = (b3BodyType)type;
-	bd.position = ( b3Pos ){ pos.x, pos.y, pos.z };
-	bd.rotation = ( b3Quat ){ .v = { rot.x, rot.y, rot.z }, .s = rot.w };
-	b3BodyId body = b3CreateBody( pmb3_unpack_world( w ), &bd );
-	b3ShapeDef sd = b3DefaultShapeDef();
-	sd.density = density;
-	sd.baseMaterial.friction = friction;
-	b3BoxHull box = b3MakeBoxHull( half.x, half.y, half.z );
-	b3CreateHullShape( body, &sd, &box.base );
-	return pmb3_pack_body( body );
+	return b3GetWorldFromId( pmb3_unpack_world( w ) )->wideContactSolver->width;
 }
 
-// Upright capsule (axis = local y, hemisphere centers at ±half_h):
-// the hog shape. lock_upright freezes angular x/z so the critter
-// jostles and yaws but never tips — the character-crowd idiom.
-uint64_t pmb3_body_capsule( uint32_t w, int type, PmbVec3 pos, float half_h, float radius, float density,
-							float friction, int lock_upright )
+// Where the touching contacts go in the solver, as of the last step:
+// the wide (SIMD) convex path, the scalar manifold path for mesh and
+// height-field contacts, and the overflow color (scalar). pm builds
+// only convex shapes — ramps are hulls — so `scalar` stays 0 and
+// anything slow is overflow. `groups` is how many independent pieces
+// the overflow split into; the workers share those, so 1 means the
+// overflow ran on one thread.
+void pmb3_world_solver_paths( uint32_t w, int* wide, int* scalar, int* overflow, int* groups )
 {
-	b3BodyDef bd = b3DefaultBodyDef();
-	bd.type = (b3BodyType)type;
-	bd.position = ( b3Pos ){ pos.x, pos.y, pos.z };
-	if ( lock_upright )
+	b3World* world = b3GetWorldFromId( pmb3_unpack_world( w ) );
+	const b3GraphColor* colors = world->constraintGraph.colors;
+	*wide = 0;
+	*scalar = 0;
+	for ( int i = 0; i < B3_OVERFLOW_INDEX; ++i )
 	{
-		bd.motionLocks.angularX = true;
-		bd.motionLocks.angularZ = true;
+		*wide += colors[i].convexContacts.count;
+		*scalar += colors[i].contacts.count;
 	}
-	b3BodyId body = b3CreateBody( pmb3_unpack_world( w ), &bd );
-	b3ShapeDef sd = b3DefaultShapeDef();
-	sd.density = density;
-	sd.baseMaterial.friction = friction;
-	b3Capsule capsule = { { 0.0f, -half_h, 0.0f }, { 0.0f, half_h, 0.0f }, radius };
-	b3CreateCapsuleShape( body, &sd, &capsule );
-	return pmb3_pack_body( body );
+	*overflow = colors[B3_OVERFLOW_INDEX].contacts.count;
+	*groups = world->overflowGroupCount;
 }
 
-void pmb3_body_set_velocity( uint64_t body, PmbVec3 v )
+// Grow the broad-phase trees ahead of a spawn wave of this many shapes
+// so the wave bumps nodes out of reserved space instead of copying the
+// trees part way through.
+void pmb3_world_reserve( uint32_t w, int staticShapes, int dynamicShapes )
 {
-	b3Body_SetLinearVelocity( pmb3_unpack_body( body ), ( b3Vec3 ){ v.x, v.y, v.z } );
+	b3Capacity capacity = { 0 };
+	capacity.staticShapeCount = staticShapes;
+	capacity.dynamicShapeCount = dynamicShapes;
+	b3World_Reserve( pmb3_unpack_world( w ), &capacity );
 }
 
-void pmb3_body_force( uint64_t body, PmbVec3 f )
+// Node capacity of one broad-phase tree (b3BodyType order).
+int pmb3_world_tree_capacity( uint32_t w, int bodyType )
 {
-	b3Body_ApplyForceToCenter( pmb3_unpack_body( body ), ( b3Vec3 ){ f.x, f.y, f.z }, true );
+	return b3GetWorldFromId( pmb3_unpack_world( w ) )->broadPhase.trees[bodyType].nodeCapacity;
 }
 
-void pmb3_body_set_damping( uint64_t body, float linear )
+// Peak scratch demand since creation or the last reserve: bytes of the
+// busiest worker's contact arena and of the world arena.
+void pmb3_world_scratch_demand( uint32_t w, int* arenaBytes, int* worldArenaBytes )
 {
-	b3Body_SetLinearDamping( pmb3_unpack_body( body ), linear );
+	b3Capacity capacity = b3World_GetMaxCapacity( pmb3_unpack_world( w ) );
+	*arenaBytes = capacity.arenaBytes;
+	*worldArenaBytes = capacity.worldArenaBytes;
 }
 
-void pmb3_body_lock_rotation( uint64_t body )
+// Resize the step scratch to exactly these bytes (0 leaves one alone),
+// e.g. narrowed to the demand of a representative run.
+void pmb3_world_set_scratch_reserve( uint32_t w, int arenaBytes, int worldArenaBytes )
 {
-	b3MotionLocks locks = { false, false, false, true, true, true };
-	b3Body_SetMotionLocks( pmb3_unpack_body( body ), locks );
+	b3World_SetScratchReserve( pmb3_unpack_world( w ), arenaBytes, worldArenaBytes );
 }
 
-// Convex hull body from raw points (≤ 64, world/local space of the
-// body). The shape clones the hull data, so the temporary is freed
-// here. Ramps and any authored convex chunk come through this door.
-uint64_t pmb3_body_hull( uint32_t w, int type, PmbVec3 pos, PmbQuat rot, const PmbVec3* pts, int n, float density,
-						 float friction )
+// Heap allocations the last step's scratch allocators made.
+int pmb3_world_step_heap_count( uint32_t w )
 {
-	b3BodyDef bd = b3DefaultBodyDef();
-	bd.type = (b3BodyType)type;
-	bd.position = ( b3Pos ){ pos.x, pos.y, pos.z };
-	bd.rotation = ( b3Quat ){ .v = { rot.x, rot.y, rot.z }, .s = rot.w };
-	b3BodyId body = b3CreateBody( pmb3_unpack_world( w ), &bd );
-	b3ShapeDef sd = b3DefaultShapeDef();
-	sd.density = density;
-	sd.baseMaterial.friction = friction;
-	b3HullData* hull = b3CreateHull( (const b3Vec3*)pts, n, 64 );
-	if ( hull != NULL )
-	{
-		b3CreateHullShape( body, &sd, hull );
-		b3DestroyHull( hull );
-	}
-	return pmb3_pack_body( body );
+	return b3World_GetCounters( pmb3_unpack_world( w ) ).stepHeapCount;
 }
 
-void pmb3_body_destroy( uint64_t body )
+// Heap bytes the world holds by subsystem, with peaks; PmbMemoryStats on
+// the Rust side is b3MemoryStats field for field.
+void pmb3_world_memory_stats( uint32_t w, b3MemoryStats* out )
 {
-	b3DestroyBody( pmb3_unpack_body( body ) );
+	*out = b3World_GetMemoryStats( pmb3_unpack_world( w ) );
 }
 
-// Teleport (kinematic mirrors, respawn resets) — not for regular
-// motion, which should be velocities/forces.
-void pmb3_body_set_pose( uint64_t body, PmbVec3 pos, PmbQuat rot )
+// Give back memory a larger past left behind, about byteBudget bytes of
+// copying per call (0: all of it). True once a whole pass is done.
+bool pmb3_world_compact( uint32_t w, int byteBudget )
 {
-	b3Body_SetTransform( pmb3_unpack_body( body ), ( b3Pos ){ pos.x, pos.y, pos.z },
-						 ( b3Quat ){ .v = { rot.x, rot.y, rot.z }, .s = rot.w } );
+	return b3World_Compact( pmb3_unpack_world( w ), byteBudget );
 }
 
-uint64_t pmb3_body_sphere( uint32_t w, int type, PmbVec3 pos, float radius, float density, float friction )
+// Pack the manifolds of sleeping islands, unpacked on wake. Same results
+// either way, so it is host policy and peers need not agree on it.
+void pmb3_world_set_sleep_packing( uint32_t w, bool flag )
 {
-	b3BodyDef bd = b3DefaultBodyDef();
-	bd.type = (b3BodyType)type;
-	bd.position = ( b3Pos ){ pos.x, pos.y, pos.z };
-	b3BodyId body = b3CreateBody( pmb3_unpack_world( w ), &bd );
-	b3ShapeDef sd = b3DefaultShapeDef();
-	sd.density = density;
-	sd.baseMaterial.friction = friction;
-	b3Sphere sphere = { { 0.0f, 0.0f, 0.0f }, radius };
-	b3CreateSphereShape( body, &sd, &sphere );
-	return pmb3_pack_body( body );
+	b3World_EnableSleepPacking( pmb3_unpack_world( w ), flag );
 }
 
-void pmb3_body_set_angular_velocity( uint64_t body, PmbVec3 v )
+// Regroup the awake bodies by island and position every `interval`
+// steps (0: never) so the solver's gathers run mostly in order. The
+// schedule follows the step index, which snapshots carry, so rollback
+// reorders on the same steps and stays bit-exact.
+void pmb3_world_set_body_reorder( uint32_t w, int interval )
 {
-	b3Body_SetAngularVelocity( pmb3_unpack_body( body ), ( b3Vec3 ){ v.x, v.y, v.z } );
+	b3GetWorldFromId( pmb3_unpack_world( w ) )->bodyReorderInterval = b3MaxInt( interval, 0 );
 }
 
-void pmb3_body_angular_velocity( uint64_t body, PmbVec3* v )
+// Re-color the whole constraint graph every `interval` steps (0:
+// never): busiest bodies first, each dynamic pair into the smallest
+// color that fits. Evener colors, less overflow. Like the reorder it
+// follows the step index, and it changes solve order, so peers agree.
+void pmb3_world_set_graph_balance( uint32_t w, int interval )
 {
-	b3Vec3 a = b3Body_GetAngularVelocity( pmb3_unpack_body( body ) );
-	v->x = a.x;
-	v->y = a.y;
-	v->z = a.z;
+	b3GetWorldFromId( pmb3_unpack_world( w ) )->graphBalanceInterval = b3MaxInt( interval, 0 );
 }
 
-// Wheel joint for a y-up, +z-forward vehicle, axle on x. Box3D's
-// conventions (read from wheel_joint.c): suspension slides along joint
-// frame A's local X, the wheel spins about frame B's local Z — so
-// frame A rotates x̂→ŷ (about z by +90°) and frame B rotates ẑ→x̂
-// (about y by +90°). The shim bakes those quats so callers just hand
-// the chassis-space mount point. Returns a packed joint id; steering
-// stays fixed-forward here (the audition drives by spin + our forces).
-uint64_t pmb3_wheel_joint( uint32_t w, uint64_t chassis, uint64_t wheel, PmbVec3 mount, float hertz, float damping,
-						   float max_torque )
+// Motion under which a touching contact keeps last step's manifold
+// without an update (0: always update). Every peer must agree on it:
+// it changes the trajectory, within the linear slop.
+void pmb3_world_set_contact_rest( uint32_t w, float distance )
 {
-	const float s = 0.70710678f; // sin/cos 45° — the two 90° quats
-	b3WheelJointDef def = b3DefaultWheelJointDef();
-	def.base.bodyIdA = pmb3_unpack_body( chassis );
-	def.base.bodyIdB = pmb3_unpack_body( wheel );
-	def.base.localFrameA.p = ( b3Vec3 ){ mount.x, mount.y, mount.z };
-	def.base.localFrameA.q = ( b3Quat ){ .v = { 0.0f, 0.0f, s }, .s = s }; // x̂→ŷ
-	def.base.localFrameB.p = ( b3Vec3 ){ 0.0f, 0.0f, 0.0f };
-	def.base.localFrameB.q = ( b3Quat ){ .v = { 0.0f, s, 0.0f }, .s = s }; // ẑ→x̂
-	def.enableSuspensionSpring = true;
-	def.suspensionHertz = hertz;
-	def.suspensionDampingRatio = damping;
-	def.enableSpinMotor = true;
-	def.maxSpinTorque = max_torque;
-	def.spinSpeed = 0.0f;
-	b3JointId id = b3CreateWheelJoint( pmb3_unpack_world( w ), &def );
-	return (uint64_t)(uint32_t)id.index1 | ( (uint64_t)id.world0 << 32 ) | ( (uint64_t)id.generation << 48 );
+	b3GetWorldFromId( pmb3_unpack_world( w ) )->contactRestDistance = b3MaxFloat( distance, 0.0f );
 }
 
-void pmb3_wheel_spin( uint64_t joint, float speed )
+// Up to `max` relax iterations per sub-step, ending once a pass moved
+// no contact by more than `tolerance` m/s (0: run them all). Changes
+// the trajectory, so every peer must agree; snapshots carry it.
+void pmb3_world_set_relax( uint32_t w, int max, float tolerance )
 {
-	b3JointId id = { (int32_t)(uint32_t)( joint & 0xFFFFFFFF ), (uint16_t)( ( joint >> 32 ) & 0xFFFF ),
-					 (uint16_t)( joint >> 48 ) };
-	b3WheelJoint_SetSpinMotorSpeed( id, speed );
+	b3World_SetRelaxIterations( pmb3_unpack_world( w ), max, tolerance );
 }
 
-void pmb3_body_pose( uint64_t body, PmbVec3* pos, PmbQuat* rot )
+// Group x group rule of the filter table, both directions: 0 collide,
+// 1 sensor only (no contacts, sensors still see), 2 ignore.
+void pmb3_world_set_filter_rule( uint32_t w, int a, int b, int rule )
 {
-	b3BodyId id = pmb3_unpack_body( body );
-	b3Pos p = b3Body_GetPosition( id );
-	b3Quat q = b3Body_GetRotation( id );
-	pos->x = (float)p.x;
-	pos->y = (float)p.y;
-	pos->z = (float)p.z;
-	// b3Quat is {v: xyz, s: w} — pm's (x, y, z, w) order on the way out.
-	rot->x = q.v.x;
-	rot->y = q.v.y;
-	rot->z = q.v.z;
-	rot->w = q.s;
+	b3World_SetFilterRule( pmb3_unpack_world( w ), a, b, (b3FilterRule)rule );
 }
 
-void pmb3_body_velocity( uint64_t body, PmbVec3* vel )
+// Friction and restitution standing in for every shape of a filter
+// group; negative keeps the shape's own.
+void pmb3_world_set_group_material( uint32_t w, int group, float friction, float restitution )
 {
-	b3Vec3 v = b3Body_GetLinearVelocity( pmb3_unpack_body( body ) );
-	vel->x = v.x;
-	vel->y = v.y;
-	vel->z = v.z;
+	b3World_SetFilterGroupMaterial( pmb3_unpack_world( w ), group, friction, restitution );
 }
 
-int pmb3_body_awake( uint64_t body )
+// Friction and restitution for contacts between material ids a and b
+// (both < 16), replacing the mix of the shapes' values; negative hands
+// the pair back to the default mix.
+void pmb3_world_set_material_mix( uint32_t w, uint64_t a, uint64_t b, float friction, float restitution )
 {
-	return b3Body_IsAwake( pmb3_unpack_body( body ) ) ? 1 : 0;
+	b3World_SetMaterialMix( pmb3_unpack_world( w ), a, b, friction, restitution );
 }
 
-// --- queries + runtime shape tweaks (the collisions-on-the-solver
-// slice, 2026-07-23). Same seam rule: primitive types only.
+// Last step's contact update shortcuts: recycled (manifold shifted by
+// the relative motion) and rested (kept as is).
+void pmb3_world_contact_reuse( uint32_t w, int* recycled, int* rested )
+{
+	b3Counters counters = b3World_GetCounters( pmb3_unpack_world( w ) );
+	*recycled = counters.recycledContactCount;
+	*rested = counters.restedContactCount;
+}
 
-// Every shape a body owns (hitbox bodies are single-shape today; the
-// cap is defensive).
-#define PMB3_MAX_SHAPES 8
+// Last step's hull pair separating axis queries and how many of them
+// the cached feature answered.
+void pmb3_world_sat_cache( uint32_t w, int* calls, int* hits )
+{
+	b3Counters counters = b3World_GetCounters( pmb3_unpack_world( w ) );
+	*calls = counters.satCallCount;
+	*hits = counters.satCacheHitCount;
+}
 
-void pmb3_body_set_friction( uint64_t body, float mu )
+// Constraints per graph color, overflow last; `out` holds
+// B3_GRAPH_COLOR_COUNT. Returns that count.
+int pmb3_world_color_counts( uint32_t w, int* out )
 {
-	b3BodyId id = pmb3_unpack_body( body );
-	b3ShapeId shapes[PMB3_MAX_SHAPES];
-	int n = b3Body_GetShapes( id, shapes, PMB3_MAX_SHAPES );
-	for ( int i = 0; i < n; ++i )
+	const b3GraphColor* colors = b3GetWorldFromId( pmb3_unpack_world( w ) )->constraintGraph.colors;
+	for ( int i = 0; i < B3_GRAPH_COLOR_COUNT; ++i )
 	{
-		b3Shape_SetFriction( shapes[i], mu );
+		out[i] = colors[i].convexContacts.count + colors[i].contacts.count + colors[i].jointSims.count;
 	}
-	// New friction only reaches contacts made after the change; waking
-	// the body refreshes a sleeping stack's manifolds promptly.
-	b3Body_SetAwake( id, true );
+	return B3_GRAPH_COLOR_COUNT;
 }
 
-// Category/mask on every shape of a body (b3Filter semantics: contact
-// iff a.category & b.mask AND b.category & a.mask; queries use the
-// same test against a b3QueryFilter).
-void pmb3_body_set_filter( uint64_t body, uint64_t category, uint64_t mask )
+// Per-worker solver stage timing (b3DetailedProfile); off by default.
+void pmb3_world_set_detailed_profile( uint32_t w, bool on )
 {
-	b3BodyId id = pmb3_unpack_body( body );
-	b3ShapeId shapes[PMB3_MAX_SHAPES];
-	int n = b3Body_GetShapes( id, shapes, PMB3_MAX_SHAPES );
-	b3Filter filter = b3DefaultFilter();
-	filter.categoryBits = category;
-	filter.maskBits = mask;
-	for ( int i = 0; i < n; ++i )
+	b3World_EnableDetailedProfile( pmb3_unpack_world( w ), on );
+}
+
+// The last step's detailed profile, flattened worker-major: `busy`,
+// `wait` and `blocks` hold B3_MAX_WORKERS * b3_profileStageCount,
+// `spin` B3_MAX_WORKERS. Returns the worker count (0: not enabled).
+int pmb3_world_detailed_profile( uint32_t w, float* busy, float* wait, int* blocks, float* spin )
+{
+	b3DetailedProfile p = b3World_GetDetailedProfile( pmb3_unpack_world( w ) );
+	for ( int i = 0; i < p.workerCount; ++i )
 	{
-		b3Shape_SetFilter( shapes[i], filter, true );
+		for ( int j = 0; j < b3_profileStageCount; ++j )
+		{
+			int k = i * b3_profileStageCount + j;
+			busy[k] = p.stages[i][j].busy;
+			wait[k] = p.stages[i][j].wait;
+			blocks[k] = p.stages[i][j].blockCount;
+		}
+		spin[i] = p.spinWait[i];
 	}
+	return p.workerCount;
 }
 
-void pmb3_body_set_type( uint64_t body, int type )
+_Static_assert( B3_MAX_WORKERS == 32 && b3_profileStageCount == 15, "lib.rs sizes the detailed profile" );
+
+// Trace zones into lib.rs's Tracer; NULL callbacks stop them.
+void pmb3_world_set_trace( uint32_t w, b3TraceZoneCallback* begin, b3TraceZoneCallback* end, void* context )
 {
-	b3Body_SetType( pmb3_unpack_body( body ), (b3BodyType)type );
+	b3World_SetTraceCallbacks( pmb3_unpack_world( w ), begin, end, context );
 }
 
-// Closest hit in the live world against shapes whose category is in
-// `mask` (statics for bullet/wall clipping). Returns 0 on miss.
-int pmb3_world_cast_ray( uint32_t w, PmbVec3 origin, PmbVec3 translation, uint64_t mask, PmbVec3* point,
-						 float* frac )
+// The last step's b3Profile, every field in milliseconds in field
+// order; lib.rs STEP_PROFILE names them.
+void pmb3_world_profile( uint32_t w, float* out )
 {
-	b3QueryFilter filter = b3DefaultQueryFilter();
-	filter.categoryBits = ~0ull;
-	filter.maskBits = mask;
-	b3RayResult r = b3World_CastRayClosest( pmb3_unpack_world( w ), ( b3Pos ){ origin.x, origin.y, origin.z },
-											( b3Vec3 ){ translation.x, translation.y, translation.z }, filter );
-	if ( !r.hit )
-	{
-		return 0;
-	}
-	point->x = (float)r.point.x;
-	point->y = (float)r.point.y;
-	point->z = (float)r.point.z;
-	*frac = r.fraction;
-	return 1;
+	b3Profile p = b3World_GetProfile( pmb3_unpack_world( w ) );
+	memcpy( out, &p, sizeof( p ) );
 }
 
-// Cast a sphere (radius 0 = a ray) at ONE body posed at an arbitrary
-// transform — the lag-comp verb: the caller rewinds the pose, Box3D
-// judges the geometry. Returns 0 on miss.
-int pmb3_body_cast_sphere( uint64_t body, PmbVec3 tpos, PmbQuat trot, PmbVec3 origin, float radius,
-						   PmbVec3 translation, PmbVec3* point, float* frac )
+_Static_assert( sizeof( b3Profile ) == 24 * sizeof( float ), "lib.rs names every b3Profile field" );
+
+#define PMB3_COUNTER_COUNT 33
+
+// The scalar b3Counters in lib.rs COUNTERS order; the color and
+// manifold histograms stay out (pmb3_world_color_counts has the colors).
+// Returns the count.
+static int pmb3_pack_counters( const b3Counters* c, int* out )
 {
-	b3QueryFilter filter = b3DefaultQueryFilter();
-	filter.categoryBits = ~0ull;
-	filter.maskBits = ~0ull;
-	b3WorldTransform xf;
-	xf.p = ( b3Pos ){ tpos.x, tpos.y, tpos.z };
-	xf.q = ( b3Quat ){ .v = { trot.x, trot.y, trot.z }, .s = trot.w };
-	b3BodyCastResult r;
-	if ( radius > 0.0f )
-	{
-		b3Vec3 pt = { 0.0f, 0.0f, 0.0f };
-		b3ShapeProxy proxy = { &pt, 1, radius };
-		r = b3Body_CastShape( pmb3_unpack_body( body ), ( b3Pos ){ origin.x, origin.y, origin.z }, &proxy,
-							  ( b3Vec3 ){ translation.x, translation.y, translation.z }, filter, 1.0f, false, xf );
-	}
-	else
+	int values[] = {
+		c->bodyCount,
+		c->shapeCount,
+		c->contactCount,
+		c->jointCount,
+		c->islandCount,
+		c->stackUsed,
+		c->arenaCapacity,
+		c->staticTreeHeight,
+		c->treeHeight,
+		c->satCallCount,
+		c->satCacheHitCount,
+		c->byteCount,
+		c->taskCount,
+		c->awakeContactCount,
+		c->recycledContactCount,
+		c->restedContactCount,
+		c->overflowGroupCount,
+		c->continuousBodyCount,
+		c->continuousSkipCount,
+		c->bulletBodyCount,
+		c->timeOfImpactCount,
+		c->continuousCandidateCount,
+		c->continuousRejectCount,
+		c->wokenBodyCount,
+		c->deferredWakeCount,
+		c->revivedContactCount,
+		c->splitIslandCount,
+		c->skippedSensorCount,
+		c->stepHeapCount,
+		c->distanceIterations,
+		c->pushBackIterations,
+		c->rootIterations,
+		c->relaxIterationCount,
+	};
+	_Static_assert( sizeof( values ) / sizeof( values[0] ) == PMB3_COUNTER_COUNT, "lib.rs COUNTERS" );
+	memcpy( out, values, sizeof( values ) );
+	return PMB3_COUNTER_COUNT;
+}
+
+// The last step's counters; see pmb3_pack_counters.
+int pmb3_world_counters( uint32_t w, int* out )
+{
+	b3Counters c = b3World_GetCounters( pmb3_unpack_world( w ) );
+	return pmb3_pack_counters( &c, out );
+}
+
+// Keep the last `frames` steps' profile and counters (0: off).
+void pmb3_world_enable_profile_history( uint32_t w, int frames )
+{
+	b3World_EnableProfileHistory( pmb3_unpack_world( w ), frames );
+}
+
+// Up to `capacity` kept frames, oldest first: the step index, 24
+// profile floats and the counters each. Returns the frame count; with
+// 0 capacity, the count kept.
+int pmb3_world_profile_history( uint32_t w, uint64_t* steps, float* profiles, int* counters, int capacity )
+{
+	if ( capacity <= 0 )
 	{
-		r = b3Body_CastRay( pmb3_unpack_body( body ), ( b3Pos ){ origin.x, origin.y, origin.z },
-							( b3Vec3 ){ translation.x, translation.y, translation.z }, filter, 1.0f, xf );
+		return b3World_GetProfileHistory( pmb3_unpack_world( w ), NULL, 0 );
 	}
-	if ( !r.hit )
+	b3ProfileFrame* frames = b3Alloc( capacity * sizeof( b3ProfileFrame ) );
+	int n = b3World_GetProfileHistory( pmb3_unpack_world( w ), frames, capacity );
+	for ( int i = 0; i < n; ++i )
 	{
-		return 0;
+		steps[i] = frames[i].stepIndex;
+		memcpy( profiles + 24 * i, &frames[i].profile, sizeof( b3Profile ) );
+		pmb3_pack_counters( &frames[i].counters, counters + PMB3_COUNTER_COUNT * i );
 	}
-	point->x = (float)r.point.x;
-	point->y = (float)r.point.y;
-	point->z = (float)r.point.z;
-	*frac = r.fraction;
-	return 1;
+	b3Free( frames, capacity * sizeof( b3ProfileFrame ) );
+	return n;
+}
+
+// p50, p95, p99 and max of every b3Profile field over the kept frames,
+// 4 x 24 floats. Returns the frame count they cover.
+int pmb3_world_profile_summary( uint32_t w, float* out )
+{
+	b3ProfileSummary s = b3World_GetProfileSummary( pmb3_unpack_world( w ) );
+	memcpy( out, &s.p50, sizeof( b3Profile ) );
+	memcpy( out + 24, &s.p95, sizeof( b3Profile ) );
+	memcpy( out + 48, &s.p99, sizeof( b3Profile ) );
+	memcpy( out + 72, &s.max, sizeof( b3Profile ) );
+	return s.frameCount;
+}
+
+// Arm the hitch capture for steps slower than `ms` (0: off).
+void pmb3_world_set_hitch_threshold( uint32_t w, float ms )
+{
+	b3World_SetHitchThreshold( pmb3_unpack_world( w ), ms );
+}
+
+// The worst step over the threshold so far. Returns the size of its
+// pre-step snapshot, 0 with no hitch yet.
+int pmb3_world_hitch( uint32_t w, uint64_t* step, float* profile, float* dt, int* substeps )
+{
+	b3HitchInfo h = b3World_GetHitch( pmb3_unpack_world( w ) );
+	*step = h.stepIndex;
+	memcpy( profile, &h.profile, sizeof( b3Profile ) );
+	*dt = h.timeStep;
+	*substeps = h.subStepCount;
+	return h.snapshotSize;
+}
+
+int pmb3_world_copy_hitch( uint32_t w, uint8_t* buf, int cap )
+{
+	return b3World_CopyHitchSnapshot( pmb3_unpack_world( w ), buf, cap );
+}
+
+// Tune each partitioned stage's block size online; the step stays
+// bit-identical either way.
+void pmb3_world_set_grain_tuning( uint32_t w, bool on )
+{
+	b3World_EnableGrainTuning( pmb3_unpack_world( w ), on );
+}
+
+// Up to `cap` tuned stages: the name (a static string), level, whether
+// it is still exploring and 5 costs each. Returns the count.
+int pmb3_world_grain_tuning( uint32_t w, const char** names, int* levels, bool* exploring, float* costs, int cap )
+{
+	b3GrainInfo sites[16];
+	int n = b3World_GetGrainTuning( pmb3_unpack_world( w ), sites, b3MinInt( cap, 16 ) );
+	for ( int i = 0; i < n; ++i )
+	{
+		names[i] = sites[i].name;
+		levels[i] = sites[i].level;
+		exploring[i] = sites[i].exploring;
+		memcpy( costs + 5 * i, sites[i].cost, sizeof( sites[i].cost ) );
+	}
+	return n;
+}
+
+// Rebuild the static tree for query speed once statics are placed; this
+// also flattens it into the wide tree queries against statics walk.
+void pmb3_world_rebuild_static_tree( uint32_t w )
+{
+	b3World_RebuildStaticTree( pmb3_unpack_world( w ) );
+}
+
+// Re-sort up to `budget` boxes of the static tree per step where statics
+// created or moved since the last build degraded it (0: never). The
+// degraded marks live in the tree nodes, which snapshots carry, so
+// rollback re-sorts the same subtrees on the same steps.
+void pmb3_world_set_static_rebuild_budget( uint32_t w, int budget )
+{
+	b3GetWorldFromId( pmb3_unpack_world( w ) )->staticTreeRebuildBudget = b3MaxInt( budget, 0 );
+}
+
+// Sweep at most `budget` fast non-bullet bodies per step (0: all),
+// those that moved farthest for their size first; the rest keep their
+// end pose and lean on speculative contacts. The ranking breaks ties by
+// body order, so it is deterministic, but it changes trajectories:
+// every peer must agree on the budget.
+void pmb3_world_set_continuous_budget( uint32_t w, int budget )
+{
+	b3GetWorldFromId( pmb3_unpack_world( w ) )->continuousBodyBudget = b3MaxInt( budget, 0 );
+}
+
+// Sleeping bodies new contacts may wake per step, 0 for all. Over the
+// budget, the islands touched deepest wake first and the rest stay
+// asleep until a later step, so a truck ploughing into a sleeping pile
+// spreads the wake cost instead of paying it in one step. Changes
+// trajectories, so every peer must agree on the budget.
+void pmb3_world_set_wake_budget( uint32_t w, int budget )
+{
+	b3GetWorldFromId( pmb3_unpack_world( w ) )->wakeBodyBudget = b3MaxInt( budget, 0 );
+}
+
+// Last step's contact wakes: sleeping bodies woken and sleeping islands
+// held back by the budget.
+void pmb3_world_wakes( uint32_t w, int* woken, int* deferred )
+{
+	b3Counters counters = b3World_GetCounters( pmb3_unpack_world( w ) );
+	*woken = counters.wokenBodyCount;
+	*deferred = counters.deferredWakeCount;
+}
+
+// Steps a contact whose shapes drifted apart stays revivable, 0 to keep
+// none. Crowd edges that part and touch again within that window pick up
+// the old warm-start impulses instead of building them from zero. Changes
+// trajectories, so every peer must agree on it.
+void pmb3_world_set_contact_revive( uint32_t w, int steps )
+{
+	b3GetWorldFromId( pmb3_unpack_world( w ) )->contactReviveSteps = b3MaxInt( steps, 0 );
+}
+
+int pmb3_world_revived_contacts( uint32_t w )
+{
+	return b3World_GetCounters( pmb3_unpack_world( w ) ).revivedContactCount;
+}
+
+// Islands split per step when they keep bodies from sleeping, at
+// least 1. Splitting more at once lets a crowd that broke apart sleep
+// in fewer steps. Deterministic, but it changes when islands sleep, so
+// every peer must agree on it.
+void pmb3_world_set_island_split_budget( uint32_t w, int budget )
+{
+	b3GetWorldFromId( pmb3_unpack_world( w ) )->islandSplitBudget = b3MaxInt( budget, 1 );
+}
+
+// Islands split in the last step.
+int pmb3_world_split_islands( uint32_t w )
+{
+	return b3World_GetCounters( pmb3_unpack_world( w ) ).splitIslandCount;
+}
+
+// Last step's continuous collision: fast non-bullet bodies, how many
+// of them the budget skipped, fast bullets, sweeps that hit, static
+// shapes the sweeps met and how many of those the swept sphere test
+// turned away, and the milliseconds the non-bullet sweeps took.
+void pmb3_world_continuous( uint32_t w, int* fast, int* skipped, int* bullets, int* impacts, int* candidates, int* rejected,
+							float* ms )
+{
+	b3WorldId id = pmb3_unpack_world( w );
+	b3Counters counters = b3World_GetCounters( id );
+	*fast = counters.continuousBodyCount;
+	*skipped = counters.continuousSkipCount;
+	*bullets = counters.bulletBodyCount;
+	*impacts = counters.timeOfImpactCount;
+	*candidates = counters.continuousCandidateCount;
+	*rejected = counters.continuousRejectCount;
+	*ms = b3World_GetProfile( id ).continuous;
+}
+
+// Static tree height; `area_ratio` gets its internal node area over
+// the root's, the tree's query cost up to a constant.
+int pmb3_world_static_tree( uint32_t w, float* area_ratio )
+{
+	const b3DynamicTree* tree = b3GetWorldFromId( pmb3_unpack_world( w ) )->broadPhase.trees + b3_staticBody;
+	*area_ratio = b3DynamicTree_GetAreaRatio( tree );
+	return b3DynamicTree_GetHeight( tree );
+}
+
+// Contact pairs the broad-phase tracks; `capacity` gets its slot
+// count, which shrinks again after a spawn wave is gone.
+int pmb3_world_pair_set( uint32_t w, int* capacity )
+{
+	const b3HashSet* set = &b3GetWorldFromId( pmb3_unpack_world( w ) )->broadPhase.pairSet;
+	*capacity = (int)set->capacity;
+	return (int)set->count;
+}
+
+// Query statics through the wide tree (default) or the binary one.
+void pmb3_world_set_wide_static_tree( uint32_t w, bool on )
+{
+	b3World_EnableWideStaticTree( pmb3_unpack_world( w ), on );
+}
+
+void pmb3_world_destroy( uint32_t w )
+{
+	// Any attached recording is one this shim created
+	b3Recording* recording = b3GetWorldFromId( pmb3_unpack_world( w ) )->recording;
+	pmb3_hash_release( b3GetWorldFromId( pmb3_unpack_world( w ) ) );
+	b3DestroyWorld( pmb3_unpack_world( w ) );
+	b3DestroyRecording( recording );
+}
+
+// Leave a flight recorder running: ops go to a fixed ring with no lock
+// or allocation, and every keyframe_interval steps the world is
+// snapshotted into one of two alternating keyframes. A no-op while a
+// recording is already attached.
+void pmb3_world_start_flight_recording( uint32_t w, int ring_bytes, int keyframe_interval )
+{
+	b3WorldId id = pmb3_unpack_world( w );
+	if ( b3GetWorldFromId( id )->recording != NULL )
+	{
+		return;
+	}
+
+	b3World_StartRecording( id, b3CreateRingRecording( ring_bytes, keyframe_interval ) );
+}
+
+// Record the whole session from here, embedding a keyframe every
+// keyframe_interval steps (0: none) so a player can seek. A no-op while
+// a recording is already attached.
+void pmb3_world_start_recording( uint32_t w, int keyframe_interval )
+{
+	b3WorldId id = pmb3_unpack_world( w );
+	if ( b3GetWorldFromId( id )->recording != NULL )
+	{
+		return;
+	}
+
+	b3Recording* recording = b3CreateRecording( 0 );
+	b3Recording_SetKeyframeInterval( recording, keyframe_interval );
+	b3World_StartRecording( id, recording );
+}
+
+// Stop recording and hand over the replayable bytes, NULL if none was
+// running. Free it with pmb3_recording_destroy.
+void* pmb3_world_stop_recording( uint32_t w )
+{
+	b3WorldId id = pmb3_unpack_world( w );
+	b3Recording* recording = b3GetWorldFromId( id )->recording;
+	b3World_StopRecording( id );
+	return recording;
+}
+
+int pmb3_recording_bytes( const void* recording, const uint8_t** data )
+{
+	*data = b3Recording_GetData( recording );
+	return b3Recording_GetSize( recording );
+}
+
+int pmb3_recording_compress( void* recording )
+{
+	return b3Recording_Compress( recording ) ? 1 : 0;
+}
+
+void pmb3_recording_destroy( void* recording )
+{
+	b3DestroyRecording( recording );
+}
+
+int pmb3_validate_replay( const uint8_t* data, int size, int workers )
+{
+	return b3ValidateReplay( data, size, workers ) ? 1 : 0;
+}
+
+void* pmb3_replay_create( const uint8_t* data, int size )
+{
+	return b3RecPlayer_Create( data, size, 1 );
+}
+
+void pmb3_replay_destroy( void* player )
+{
+	b3RecPlayer_Destroy( player );
+}
+
+void pmb3_replay_seek( void* player, int frame )
+{
+	b3RecPlayer_SeekFrame( player, frame );
+}
+
+int pmb3_replay_step( void* player )
+{
+	return b3RecPlayer_StepFrame( player ) ? 1 : 0;
+}
+
+int pmb3_replay_frame( const void* player )
+{
+	return b3RecPlayer_GetFrame( player );
+}
+
+int pmb3_replay_frame_count( const void* player )
+{
+	return b3RecPlayer_GetFrameCount( player );
+}
+
+int pmb3_replay_diverged( const void* player )
+{
+	return b3RecPlayer_HasDiverged( player ) ? 1 : 0;
+}
+
+uint64_t pmb3_replay_keyframe_bytes( const void* player )
+{
+	return b3RecPlayer_GetKeyframeBytes( player );
+}
+
+void pmb3_replay_set_timing( void* player, int on )
+{
+	b3RecPlayer_SetTimingMode( player, on != 0 );
+}
+
+void pmb3_replay_set_workers( void* player, int count )
+{
+	b3RecPlayer_SetWorkerCount( player, count );
+}
+
+// The replay world as a packed id, for the profile and counter readers.
+// Changes when the player rebuilds its world (restart, deep backward seek).
+uint32_t pmb3_replay_world( const void* player )
+{
+	b3WorldId id = b3RecPlayer_GetWorldId( player );
+	return (uint32_t)id.index1 | ( (uint32_t)id.generation << 16 );
+}
+
+void pmb3_world_step( uint32_t w, float dt, int substeps )
+{
+	b3World_Step( pmb3_unpack_world( w ), dt, substeps );
+	pmb3_hash_moves( b3GetWorldFromId( pmb3_unpack_world( w ) ) );
+}
+
+// Every creation door returns through here: pack the id and fold the
+// new body into the world checksum.
+static uint64_t pmb3_created( b3BodyId body )
+{
+	uint64_t packed = pmb3_pack_body( body );
+	pmb3_hash_body( b3GetWorld( body.world0 ), packed );
+	return packed;
+}
+
+// One creation door for spike 1: a box body. type: 0 = static,
+// 1 = kinematic, 2 = dynamic (matches b3BodyType by construction,
+// asserted below so an upstream enum shuffle is a compile error).
+_Static_assert( b3_staticBody == 0 && b3_kinematicBody == 1 && b3_dynamicBody == 2, "pmb3 type map" );
+
+uint64_t pmb3_body_box( uint32_t w, int type, PmbVec3 pos, PmbQuat rot, PmbVec3 half, float density, float friction )
+{
+	b3BodyDef bd = b3DefaultBodyDef();
+	bd.type = (b3BodyType)type;
+	bd.position = ( b3Pos ){ pos.x, pos.y, pos.z };
+	bd.rotation = ( b3Quat ){ .v = { rot.x, rot.y, rot.z }, .s = rot.w };
+	b3BodyId body = b3CreateBody( pmb3_unpack_world( w ), &bd );
+	b3ShapeDef sd = b3DefaultShapeDef();
+	sd.density = density;
+	sd.baseMaterial.friction = friction;
+	b3BoxHull box = b3MakeBoxHull( half.x, half.y, half.z );
+	b3CreateHullShape( body, &sd, &box.base );
+	return pmb3_created( body );
+}
+
+// Upright capsule (axis = local y, hemisphere centers at ±half_h):
+// the hog shape. lock_upright freezes angular x/z so the critter
+// jostles and yaws but never tips — the character-crowd idiom.
+// name_id (0: none) comes from pmb3_world_intern_name, so naming every
+// hog costs no string hashing per spawn.
+uint64_t pmb3_body_capsule( uint32_t w, int type, PmbVec3 pos, float half_h, float radius, float density,
+							float friction, int lock_upright, uint32_t name_id )
+{
+	b3BodyDef bd = b3DefaultBodyDef();
+	bd.type = (b3BodyType)type;
+	bd.position = ( b3Pos ){ pos.x, pos.y, pos.z };
+	bd.nameId = name_id;
+	if ( lock_upright )
+	{
+		bd.motionLocks.angularX = true;
+		bd.motionLocks.angularZ = true;
+	}
+	b3BodyId body = b3CreateBody( pmb3_unpack_world( w ), &bd );
+	b3ShapeDef sd = b3DefaultShapeDef();
+	sd.density = density;
+	sd.baseMaterial.friction = friction;
+	b3Capsule capsule = { { 0.0f, -half_h, 0.0f }, { 0.0f, half_h, 0.0f }, radius };
+	b3CreateCapsuleShape( body, &sd, &capsule );
+	return pmb3_created( body );
+}
+
+// A wave of the same capsule at n positions through b3CreateBodies: one
+// tree build for the lot instead of n insertions. out receives n ids,
+// hashed in order as n pmb3_body_capsule calls would be.
+void pmb3_bodies_capsule( uint32_t w, int type, const PmbVec3* pos, int n, float half_h, float radius, float density,
+						  float friction, int lock_upright, uint32_t name_id, uint64_t* out )
+{
+	if ( n <= 0 )
+	{
+		return;
+	}
+
+	b3BodyDef bd = b3DefaultBodyDef();
+	bd.type = (b3BodyType)type;
+	bd.nameId = name_id;
+	if ( lock_upright )
+	{
+		bd.motionLocks.angularX = true;
+		bd.motionLocks.angularZ = true;
+	}
+	b3ShapeDef sd = b3DefaultShapeDef();
+	sd.density = density;
+	sd.baseMaterial.friction = friction;
+	b3ShapeGeometry geometry = { .type = b3_capsuleShape };
+	geometry.capsule = ( b3Capsule ){ { 0.0f, -half_h, 0.0f }, { 0.0f, half_h, 0.0f }, radius };
+
+	b3BodyDef* bodyDefs = b3Alloc( n * sizeof( b3BodyDef ) );
+	b3ShapeDef* shapeDefs = b3Alloc( n * sizeof( b3ShapeDef ) );
+	b3ShapeGeometry* geometries = b3Alloc( n * sizeof( b3ShapeGeometry ) );
+	b3BodyId* ids = b3Alloc( n * sizeof( b3BodyId ) );
+	for ( int i = 0; i < n; ++i )
+	{
+		bodyDefs[i] = bd;
+		bodyDefs[i].position = ( b3Pos ){ pos[i].x, pos[i].y, pos[i].z };
+		shapeDefs[i] = sd;
+		geometries[i] = geometry;
+	}
+
+	b3CreateBodies( pmb3_unpack_world( w ), bodyDefs, shapeDefs, geometries, n, ids );
+
+	for ( int i = 0; i < n; ++i )
+	{
+		out[i] = pmb3_created( ids[i] );
+	}
+
+	b3Free( bodyDefs, n * sizeof( b3BodyDef ) );
+	b3Free( shapeDefs, n * sizeof( b3ShapeDef ) );
+	b3Free( geometries, n * sizeof( b3ShapeGeometry ) );
+	b3Free( ids, n * sizeof( b3BodyId ) );
+}
+
+// Intern a body name once per world; 0 for an empty name.
+uint32_t pmb3_world_intern_name( uint32_t w, const char* name )
+{
+	return b3World_InternName( pmb3_unpack_world( w ), name );
+}
+
+// "" when unnamed. Materializes the interned string; debug tooling only.
+const char* pmb3_body_name( uint64_t body )
+{
+	return b3Body_GetName( pmb3_unpack_body( body ) );
+}
+
+void pmb3_body_set_velocity( uint64_t body, PmbVec3 v )
+{
+	b3Body_SetLinearVelocity( pmb3_unpack_body( body ), ( b3Vec3 ){ v.x, v.y, v.z } );
+}
+
+void pmb3_body_force( uint64_t body, PmbVec3 f )
+{
+	b3Body_ApplyForceToCenter( pmb3_unpack_body( body ), ( b3Vec3 ){ f.x, f.y, f.z }, true );
+}
+
+void pmb3_body_set_damping( uint64_t body, float linear )
+{
+	b3Body_SetLinearDamping( pmb3_unpack_body( body ), linear );
+}
+
+void pmb3_body_lock_rotation( uint64_t body )
+{
+	b3MotionLocks locks = { false, false, false, true, true, true };
+	b3Body_SetMotionLocks( pmb3_unpack_body( body ), locks );
+}
+
+void pmb3_body_set_substep_hint( uint64_t body, int hint )
+{
+	b3Body_SetSubStepHint( pmb3_unpack_body( body ), hint );
+}
+
+void pmb3_body_set_step_period( uint64_t body, int period )
+{
+	b3Body_SetStepPeriod( pmb3_unpack_body( body ), period );
+}
+
+// Put every dynamic body with a shape touching the box on a step
+// period: the region scheduler's door. Bodies are gathered first and
+// set after, so a recording sees the query and then the setters.
+b3DeclareArrayNative( b3BodyId );
+
+typedef struct
+{
+	b3Array( b3BodyId ) bodies;
+} PmbRegionCtx;
+
+static bool pmb3_region_cb( b3ShapeId shapeId, void* context )
+{
+	PmbRegionCtx* ctx = (PmbRegionCtx*)context;
+	b3BodyId body = b3Shape_GetBody( shapeId );
+	if ( b3Body_GetType( body ) == b3_dynamicBody )
+	{
+		b3Array_Push( ctx->bodies, body );
+	}
+	return true;
+}
+
+int pmb3_world_set_region_step_period( uint32_t w, PmbVec3 lower, PmbVec3 upper, int period )
+{
+	b3AABB box = { { lower.x, lower.y, lower.z }, { upper.x, upper.y, upper.z } };
+	PmbRegionCtx ctx = { 0 };
+	b3World_OverlapAABB( pmb3_unpack_world( w ), box, b3DefaultQueryFilter(), pmb3_region_cb, &ctx );
+
+	int changed = 0;
+	for ( int i = 0; i < ctx.bodies.count; ++i )
+	{
+		b3BodyId body = ctx.bodies.data[i];
+		if ( b3Body_GetStepPeriod( body ) != period )
+		{
+			b3Body_SetStepPeriod( body, period );
+			changed += 1;
+		}
+	}
+
+	b3Array_Destroy( ctx.bodies );
+	return changed;
+}
+
+// Convex hull body from raw points (≤ 64, world/local space of the
+// body). The shape clones the hull data, so the temporary is freed
+// here. Ramps and any authored convex chunk come through this door;
+// the hull cache skips the build for points seen before.
+uint64_t pmb3_body_hull( uint32_t w, int type, PmbVec3 pos, PmbQuat rot, const PmbVec3* pts, int n, float density,
+						 float friction )
+{
+	b3BodyDef bd = b3DefaultBodyDef();
+	bd.type = (b3BodyType)type;
+	bd.position = ( b3Pos ){ pos.x, pos.y, pos.z };
+	bd.rotation = ( b3Quat ){ .v = { rot.x, rot.y, rot.z }, .s = rot.w };
+	b3BodyId body = b3CreateBody( pmb3_unpack_world( w ), &bd );
+	b3ShapeDef sd = b3DefaultShapeDef();
+	sd.density = density;
+	sd.baseMaterial.friction = friction;
+	b3HullData* hull = b3CreateCachedHull( (const b3Vec3*)pts, n, 64 );
+	if ( hull != NULL )
+	{
+		b3CreateHullShape( body, &sd, hull );
+		b3DestroyHull( hull );
+	}
+	return pmb3_created( body );
+}
+
+// Terrain cooking, callable from any thread — streamed chunks cook on
+// loader threads while the world steps. workers > 1 gives the cook its
+// own scheduler; the mesh is the same for any worker count. progress
+// (may be NULL) returning false cancels and yields NULL. quantize stores
+// the BVH as 16-byte nodes.
+void* pmb3_mesh_cook( const PmbVec3* verts, int vertexCount, const int* indices, int triangleCount, float weld,
+					  bool quantize, int workers, b3MeshProgressFcn* progress, void* context )
+{
+	b3MeshDef def = { 0 };
+	def.vertices = (b3Vec3*)verts;
+	def.vertexCount = vertexCount;
+	def.indices = (int32_t*)indices;
+	def.triangleCount = triangleCount;
+	def.weldVertices = weld > 0.0f;
+	def.weldTolerance = weld;
+	def.identifyEdges = true;
+	def.quantizeNodes = quantize;
+	def.workerCount = (uint32_t)workers;
+	def.progressFcn = progress;
+	def.progressContext = context;
+	return b3CreateMesh( &def, NULL, 0 );
+}
+
+void pmb3_mesh_destroy( void* mesh )
+{
+	b3DestroyMesh( mesh );
+}
+
+uint32_t pmb3_mesh_hash( const void* mesh )
+{
+	return ( (const b3MeshData*)mesh )->hash;
+}
+
+int pmb3_mesh_triangle_count( const void* mesh )
+{
+	return ( (const b3MeshData*)mesh )->triangleCount;
+}
+
+// Ray against an unscaled mesh in its own frame. Returns the triangle hit
+// or -1.
+int pmb3_mesh_cast_ray( const void* mesh, PmbVec3 origin, PmbVec3 translation, float* frac )
+{
+	b3Mesh shape = { mesh, b3Vec3_one };
+	b3RayCastInput input = { { origin.x, origin.y, origin.z }, { translation.x, translation.y, translation.z }, 1.0f };
+	b3CastOutput output = b3RayCastMesh( &shape, &input );
+	if ( !output.hit )
+	{
+		return -1;
+	}
+	*frac = output.fraction;
+	return output.triangleIndex;
+}
+
+// A height field over countX * countZ grid points, row-major along x,
+// quantized over the range of the given heights.
+void* pmb3_height_field_create( const float* heights, int countX, int countZ, PmbVec3 scale )
+{
+	float lower = heights[0], upper = heights[0];
+	for ( int i = 1; i < countX * countZ; ++i )
+	{
+		lower = b3MinFloat( lower, heights[i] );
+		upper = b3MaxFloat( upper, heights[i] );
+	}
+
+	b3HeightFieldDef def = { 0 };
+	def.heights = (float*)heights;
+	def.scale = ( b3Vec3 ){ scale.x, scale.y, scale.z };
+	def.countX = countX;
+	def.countZ = countZ;
+	def.globalMinimumHeight = lower;
+	def.globalMaximumHeight = upper;
+	return b3CreateHeightField( &def );
+}
+
+void pmb3_height_field_destroy( void* heightField )
+{
+	b3DestroyHeightField( heightField );
+}
+
+// Sphere (radius 0 = ray) against a height field in its own frame — the
+// lag-comp hitscan path over terrain. Returns the triangle hit or -1.
+int pmb3_height_field_cast( const void* heightField, PmbVec3 origin, PmbVec3 translation, float radius, float* frac )
+{
+	b3Vec3 center = { origin.x, origin.y, origin.z };
+	b3ShapeCastInput input = { 0 };
+	input.proxy = ( b3ShapeProxy ){ &center, 1, radius };
+	input.translation = ( b3Vec3 ){ translation.x, translation.y, translation.z };
+	input.maxFraction = 1.0f;
+	b3CastOutput output = b3ShapeCastHeightField( heightField, &input );
+	if ( !output.hit )
+	{
+		return -1;
+	}
+	*frac = output.fraction;
+	return output.triangleIndex;
+}
+
+// Collision planes between a capsule mover and a height field, in the
+// height field's frame: normal xyz and offset per plane.
+int pmb3_height_field_mover( const void* heightField, PmbVec3 c1, PmbVec3 c2, float radius, float* out, int cap )
+{
+	b3Capsule mover = { { c1.x, c1.y, c1.z }, { c2.x, c2.y, c2.z }, radius };
+	b3PlaneResult planes[64];
+	int n = b3CollideMoverAndHeightField( planes, b3MinInt( cap, 64 ), heightField, &mover );
+	for ( int i = 0; i < n; ++i )
+	{
+		out[4 * i + 0] = planes[i].plane.normal.x;
+		out[4 * i + 1] = planes[i].plane.normal.y;
+		out[4 * i + 2] = planes[i].plane.normal.z;
+		out[4 * i + 3] = planes[i].plane.offset;
+	}
+	return n;
+}
+
+typedef struct PmbTriangleList
+{
+	int* out;
+	int count;
+	int cap;
+} PmbTriangleList;
+
+static bool pmb3_collect_triangle( b3Vec3 a, b3Vec3 b, b3Vec3 c, int triangleIndex, void* context )
+{
+	( void )a, ( void )b, ( void )c;
+	PmbTriangleList* list = context;
+	if ( list->count < list->cap )
+	{
+		list->out[list->count] = triangleIndex;
+	}
+	list->count += 1;
+	return true;
+}
+
+// Triangles of a height field under a local box. Returns the full count;
+// at most cap are written.
+int pmb3_height_field_query( const void* heightField, PmbVec3 lower, PmbVec3 upper, int* out, int cap )
+{
+	b3AABB bounds = { { lower.x, lower.y, lower.z }, { upper.x, upper.y, upper.z } };
+	PmbTriangleList list = { out, 0, cap };
+	b3QueryHeightField( heightField, bounds, pmb3_collect_triangle, &list );
+	return list.count;
+}
+
+// A terrain of countX * countZ height field tiles paged in and out
+// around the players. Load, replace or evict (NULL) with
+// pmb3_terrain_set_tile, which returns the tile's previous data. Evict
+// every tile before pmb3_terrain_destroy, so the checksum drops them.
+void* pmb3_terrain_create( uint32_t w, PmbVec3 origin, float widthX, float widthZ, int countX, int countZ,
+						   float friction )
+{
+	b3TerrainDef def = b3DefaultTerrainDef();
+	def.origin = ( b3Pos ){ origin.x, origin.y, origin.z };
+	def.tileWidthX = widthX;
+	def.tileWidthZ = widthZ;
+	def.tileCountX = countX;
+	def.tileCountZ = countZ;
+	def.shapeDef.baseMaterial.friction = friction;
+	return b3CreateTerrain( pmb3_unpack_world( w ), &def );
+}
+
+void pmb3_terrain_destroy( void* terrain )
+{
+	b3DestroyTerrain( terrain );
+}
+
+// A tile change is a creation or destruction door too: the tile's body
+// leaves the world checksum before and joins it after.
+const void* pmb3_terrain_set_tile( void* terrain, int x, int z, const void* heightField )
+{
+	b3BodyId before = b3Terrain_GetTileBody( terrain, x, z );
+	if ( B3_IS_NON_NULL( before ) )
+	{
+		pmb3_hash_drop( b3GetWorld( before.world0 ), pmb3_pack_body( before ) );
+	}
+	const void* previous = b3Terrain_SetTile( terrain, x, z, heightField );
+	b3BodyId after = b3Terrain_GetTileBody( terrain, x, z );
+	if ( B3_IS_NON_NULL( after ) )
+	{
+		pmb3_created( after );
+	}
+	return previous;
+}
+
+int pmb3_terrain_loaded( const void* terrain )
+{
+	return b3Terrain_GetLoadedTileCount( terrain );
+}
+
+// A cooked mesh is one relocatable blob: these bytes ARE the file, and
+// pmb3_mesh_view maps them back (a read-only mmap shared by every match
+// process) with no parse or copy. NULL if they are not a mesh.
+const void* pmb3_mesh_bytes( const void* mesh, int* count )
+{
+	*count = ( (const b3MeshData*)mesh )->byteCount;
+	return mesh;
+}
+
+const void* pmb3_mesh_view( const void* bytes, int count, bool verify )
+{
+	return b3ConvertBytesToMesh( bytes, count, verify );
+}
+
+// A hull in the process-wide geometry library. Every world's hull
+// shape built from the same points borrows this one copy, and the
+// library outlives the handle for as long as any world uses it.
+const void* pmb3_hull_share( const PmbVec3* pts, int n )
+{
+	b3HullData* hull = b3CreateCachedHull( (const b3Vec3*)pts, n, 64 );
+	if ( hull == NULL )
+	{
+		return NULL;
+	}
+
+	const void* shared = b3ShareGeometry( b3_hullShape, hull );
+	b3DestroyHull( hull );
+	return shared;
+}
+
+int pmb3_hull_cache_count( int* hits )
+{
+	return b3GetHullCacheCount( hits );
+}
+
+void pmb3_geometry_release( const void* shared )
+{
+	b3ReleaseGeometry( shared );
+}
+
+int pmb3_geometry_count( int* bytes )
+{
+	return b3GetSharedGeometryCount( bytes );
+}
+
+void pmb3_body_destroy( uint64_t body )
+{
+	pmb3_hash_drop( b3GetWorld( pmb3_unpack_body( body ).world0 ), body );
+	b3DestroyBody( pmb3_unpack_body( body ) );
+}
+
+// Corpse cleanup: n bodies of one world through b3DestroyBodies, each
+// dropped from the checksum first as pmb3_body_destroy does.
+void pmb3_bodies_destroy( const uint64_t* bodies, int n )
+{
+	if ( n <= 0 )
+	{
+		return;
+	}
+
+	b3BodyId* ids = b3Alloc( n * sizeof( b3BodyId ) );
+	for ( int i = 0; i < n; ++i )
+	{
+		ids[i] = pmb3_unpack_body( bodies[i] );
+		pmb3_hash_drop( b3GetWorld( ids[i].world0 ), bodies[i] );
+	}
+	b3DestroyBodies( ids, n );
+	b3Free( ids, n * sizeof( b3BodyId ) );
+}
+
+// Retire n dead units in one call: new type and the same category/mask
+// on every shape (pmb3_body_set_type + pmb3_body_set_filter on each),
+// with the proxies rebuilt as one batch.
+void pmb3_bodies_retire( const uint64_t* bodies, int n, int type, uint64_t category, uint64_t mask )
+{
+	if ( n <= 0 )
+	{
+		return;
+	}
+
+	b3Filter filter = b3DefaultFilter();
+	filter.categoryBits = category;
+	filter.maskBits = mask;
+	b3BodyId* ids = b3Alloc( n * sizeof( b3BodyId ) );
+	for ( int i = 0; i < n; ++i )
+	{
+		ids[i] = pmb3_unpack_body( bodies[i] );
+	}
+	b3RetireBodies( ids, n, (b3BodyType)type, filter );
+	b3Free( ids, n * sizeof( b3BodyId ) );
+}
+
+// Teleport (kinematic mirrors, respawn resets) — not for regular
+// motion, which should be velocities/forces.
+void pmb3_body_set_pose( uint64_t body, PmbVec3 pos, PmbQuat rot )
+{
+	b3Body_SetTransform( pmb3_unpack_body( body ), ( b3Pos ){ pos.x, pos.y, pos.z },
+						 ( b3Quat ){ .v = { rot.x, rot.y, rot.z }, .s = rot.w } );
+	pmb3_hash_body( b3GetWorld( pmb3_unpack_body( body ).world0 ), body );
+}
+
+// Cast-only hitbox: a query-only box (b3BodyDef::isQueryOnly) with its
+// filter set before the shape, so the proxy is built once. Contacts
+// and sensors never see it, casts and overlaps do, and it costs the
+// solver nothing per step.
+uint64_t pmb3_body_query_box( uint32_t w, PmbVec3 pos, PmbQuat rot, PmbVec3 half, uint64_t category, uint64_t mask )
+{
+	b3BodyDef bd = b3DefaultBodyDef();
+	bd.isQueryOnly = true;
+	bd.position = ( b3Pos ){ pos.x, pos.y, pos.z };
+	bd.rotation = ( b3Quat ){ .v = { rot.x, rot.y, rot.z }, .s = rot.w };
+	b3BodyId body = b3CreateBody( pmb3_unpack_world( w ), &bd );
+	b3ShapeDef sd = b3DefaultShapeDef();
+	sd.filter.categoryBits = category;
+	sd.filter.maskBits = mask;
+	sd.enableSensorEvents = false;
+	b3BoxHull box = b3MakeBoxHull( half.x, half.y, half.z );
+	b3CreateHullShape( body, &sd, &box.base );
+	return pmb3_created( body );
+}
+
+// The mirror door for query-only bodies: one call poses the lot, each
+// a tree leaf update at most (see b3SetQueryBodyTransforms).
+void pmb3_bodies_set_query_pose( const uint64_t* bodies, const PmbVec3* pos, const PmbQuat* rot, int n )
+{
+	if ( n <= 0 )
+	{
+		return;
+	}
+
+	b3BodyId* ids = b3Alloc( n * sizeof( b3BodyId ) );
+	b3Pos* positions = b3Alloc( n * sizeof( b3Pos ) );
+	b3Quat* rotations = b3Alloc( n * sizeof( b3Quat ) );
+	for ( int i = 0; i < n; ++i )
+	{
+		ids[i] = pmb3_unpack_body( bodies[i] );
+		positions[i] = ( b3Pos ){ pos[i].x, pos[i].y, pos[i].z };
+		rotations[i] = ( b3Quat ){ .v = { rot[i].x, rot[i].y, rot[i].z }, .s = rot[i].w };
+	}
+	b3SetQueryBodyTransforms( ids, positions, rotations, n );
+
+	b3World* world = b3GetWorld( ids[0].world0 );
+	for ( int i = 0; i < n; ++i )
+	{
+		pmb3_hash_body( world, bodies[i] );
+	}
+	b3Free( ids, n * sizeof( b3BodyId ) );
+	b3Free( positions, n * sizeof( b3Pos ) );
+	b3Free( rotations, n * sizeof( b3Quat ) );
+}
+
+uint64_t pmb3_body_sphere( uint32_t w, int type, PmbVec3 pos, float radius, float density, float friction )
+{
+	b3BodyDef bd = b3DefaultBodyDef();
+	bd.type = (b3BodyType)type;
+	bd.position = ( b3Pos ){ pos.x, pos.y, pos.z };
+	b3BodyId body = b3CreateBody( pmb3_unpack_world( w ), &bd );
+	b3ShapeDef sd = b3DefaultShapeDef();
+	sd.density = density;
+	sd.baseMaterial.friction = friction;
+	b3Sphere sphere = { { 0.0f, 0.0f, 0.0f }, radius };
+	b3CreateSphereShape( body, &sd, &sphere );
+	return pmb3_created( body );
+}
+
+void pmb3_body_set_angular_velocity( uint64_t body, PmbVec3 v )
+{
+	b3Body_SetAngularVelocity( pmb3_unpack_body( body ), ( b3Vec3 ){ v.x, v.y, v.z } );
+}
+
+void pmb3_body_angular_velocity( uint64_t body, PmbVec3* v )
+{
+	b3Vec3 a = b3Body_GetAngularVelocity( pmb3_unpack_body( body ) );
+	v->x = a.x;
+	v->y = a.y;
+	v->z = a.z;
+}
+
+// Wheel joint for a y-up, +z-forward vehicle, axle on x. Box3D's
+// conventions (read from wheel_joint.c): suspension slides along joint
+// frame A's local X, the wheel spins about frame B's local Z — so
+// frame A rotates x̂→ŷ (about z by +90°) and frame B rotates ẑ→x̂
+// (about y by +90°). The shim bakes those quats so callers just hand
+// the chassis-space mount point. Returns a packed joint id; steering
+// stays fixed-forward here (the audition drives by spin + our forces).
+static uint64_t pmb3_make_wheel_joint( uint32_t w, uint64_t chassis, uint64_t wheel, PmbVec3 mount, float hertz,
+									   float damping, float max_torque, bool vehicle )
+{
+	const float s = 0.70710678f; // sin/cos 45° — the two 90° quats
+	b3WheelJointDef def = b3DefaultWheelJointDef();
+	def.base.bodyIdA = pmb3_unpack_body( chassis );
+	def.base.bodyIdB = pmb3_unpack_body( wheel );
+	def.base.localFrameA.p = ( b3Vec3 ){ mount.x, mount.y, mount.z };
+	def.base.localFrameA.q = ( b3Quat ){ .v = { 0.0f, 0.0f, s }, .s = s }; // x̂→ŷ
+	def.base.localFrameB.p = ( b3Vec3 ){ 0.0f, 0.0f, 0.0f };
+	def.base.localFrameB.q = ( b3Quat ){ .v = { 0.0f, s, 0.0f }, .s = s }; // ẑ→x̂
+	def.enableSuspensionSpring = true;
+	def.suspensionHertz = hertz;
+	def.suspensionDampingRatio = damping;
+	def.enableSpinMotor = true;
+	def.maxSpinTorque = max_torque;
+	def.spinSpeed = 0.0f;
+	def.enableVehicleSolver = vehicle;
+	b3JointId id = b3CreateWheelJoint( pmb3_unpack_world( w ), &def );
+	return (uint64_t)(uint32_t)id.index1 | ( (uint64_t)id.world0 << 32 ) | ( (uint64_t)id.generation << 48 );
+}
+
+uint64_t pmb3_wheel_joint( uint32_t w, uint64_t chassis, uint64_t wheel, PmbVec3 mount, float hertz, float damping,
+						   float max_torque )
+{
+	return pmb3_make_wheel_joint( w, chassis, wheel, mount, hertz, damping, max_torque, false );
+}
+
+// The chassis's vehicle wheels are solved as one block (b3WheelJointDef::enableVehicleSolver).
+uint64_t pmb3_vehicle_wheel_joint( uint32_t w, uint64_t chassis, uint64_t wheel, PmbVec3 mount, float hertz,
+								   float damping, float max_torque )
+{
+	return pmb3_make_wheel_joint( w, chassis, wheel, mount, hertz, damping, max_torque, true );
+}
+
+void pmb3_wheel_spin( uint64_t joint, float speed )
+{
+	b3JointId id = { (int32_t)(uint32_t)( joint & 0xFFFFFFFF ), (uint16_t)( ( joint >> 32 ) & 0xFFFF ),
+					 (uint16_t)( joint >> 48 ) };
+	b3WheelJoint_SetSpinMotorSpeed( id, speed );
+}
+
+void pmb3_body_pose( uint64_t body, PmbVec3* pos, PmbQuat* rot )
+{
+	b3BodyId id = pmb3_unpack_body( body );
+	b3Pos p = b3Body_GetPosition( id );
+	b3Quat q = b3Body_GetRotation( id );
+	pos->x = (float)p.x;
+	pos->y = (float)p.y;
+	pos->z = (float)p.z;
+	// b3Quat is {v: xyz, s: w} — pm's (x, y, z, w) order on the way out.
+	rot->x = q.v.x;
+	rot->y = q.v.y;
+	rot->z = q.v.z;
+	rot->w = q.s;
+}
+
+void pmb3_body_velocity( uint64_t body, PmbVec3* vel )
+{
+	b3Vec3 v = b3Body_GetLinearVelocity( pmb3_unpack_body( body ) );
+	vel->x = v.x;
+	vel->y = v.y;
+	vel->z = v.z;
+}
+
+int pmb3_body_awake( uint64_t body )
+{
+	return b3Body_IsAwake( pmb3_unpack_body( body ) ) ? 1 : 0;
+}
+
+// --- queries + runtime shape tweaks (the collisions-on-the-solver
+// slice, 2026-07-23). Same seam rule: primitive types only.
+
+// Every shape a body owns (hitbox bodies are single-shape today; the
+// cap is defensive).
+#define PMB3_MAX_SHAPES 8
+
+void pmb3_body_set_friction( uint64_t body, float mu )
+{
+	b3BodyId id = pmb3_unpack_body( body );
+	b3ShapeId shapes[PMB3_MAX_SHAPES];
+	int n = b3Body_GetShapes( id, shapes, PMB3_MAX_SHAPES );
+	for ( int i = 0; i < n; ++i )
+	{
+		b3Shape_SetFriction( shapes[i], mu );
+	}
+	// Touching contacts take the new friction at once; waking lets a
+	// resting body slide under it.
+	b3Body_SetAwake( id, true );
+}
+
+// User material id on every shape of a body, the row its contacts use
+// in the world's material table (pmb3_world_set_material_mix).
+void pmb3_body_set_material( uint64_t body, uint64_t material )
+{
+	b3BodyId id = pmb3_unpack_body( body );
+	b3ShapeId shapes[PMB3_MAX_SHAPES];
+	int n = b3Body_GetShapes( id, shapes, PMB3_MAX_SHAPES );
+	for ( int i = 0; i < n; ++i )
+	{
+		b3SurfaceMaterial m = b3Shape_GetSurfaceMaterial( shapes[i] );
+		m.userMaterialId = material;
+		b3Shape_SetSurfaceMaterial( shapes[i], m );
+	}
+}
+
+// Category/mask on every shape of a body (b3Filter semantics: contact
+// iff a.category & b.mask AND b.category & a.mask; queries use the
+// same test against a b3QueryFilter).
+void pmb3_body_set_filter( uint64_t body, uint64_t category, uint64_t mask )
+{
+	b3BodyId id = pmb3_unpack_body( body );
+	b3ShapeId shapes[PMB3_MAX_SHAPES];
+	int n = b3Body_GetShapes( id, shapes, PMB3_MAX_SHAPES );
+	b3Filter filter = b3DefaultFilter();
+	filter.categoryBits = category;
+	filter.maskBits = mask;
+	for ( int i = 0; i < n; ++i )
+	{
+		b3Shape_SetFilter( shapes[i], filter, true );
+	}
+}
+
+// Filter group (0..31) on every shape of a body, a row of the world's
+// filter table. The table is checked with the category/mask bits.
+void pmb3_body_set_filter_group( uint64_t body, int group )
+{
+	b3BodyId id = pmb3_unpack_body( body );
+	b3ShapeId shapes[PMB3_MAX_SHAPES];
+	int n = b3Body_GetShapes( id, shapes, PMB3_MAX_SHAPES );
+	for ( int i = 0; i < n; ++i )
+	{
+		b3Shape_SetFilterGroup( shapes[i], group );
+	}
+}
+
+// A destructible prop: n boxes (center, half extents pairs in boxes)
+// baked into one compound. The compound is the caller's and must
+// outlive the body built from it; it is mutated as chunks shed, so
+// each world's prop needs its own.
+void* pmb3_compound_boxes( const PmbVec3* boxes, int n, float friction )
+{
+	b3CompoundHullDef* hullDefs = b3Alloc( n * sizeof( b3CompoundHullDef ) );
+	b3BoxHull* hulls = b3Alloc( n * sizeof( b3BoxHull ) );
+	b3SurfaceMaterial material = b3DefaultSurfaceMaterial();
+	material.friction = friction;
+	for ( int i = 0; i < n; ++i )
+	{
+		PmbVec3 c = boxes[2 * i];
+		PmbVec3 h = boxes[2 * i + 1];
+		hulls[i] = b3MakeBoxHull( h.x, h.y, h.z );
+		hullDefs[i] = ( b3CompoundHullDef ){
+			.hull = &hulls[i].base,
+			.transform = { .p = { c.x, c.y, c.z }, .q = b3Quat_identity },
+			.material = material,
+		};
+	}
+
+	b3CompoundDef def = { 0 };
+	def.hulls = hullDefs;
+	def.hullCount = n;
+	b3CompoundData* compound = b3CreateCompound( &def );
+	b3Free( hulls, n * sizeof( b3BoxHull ) );
+	b3Free( hullDefs, n * sizeof( b3CompoundHullDef ) );
+	return compound;
+}
+
+void pmb3_compound_destroy( void* compound )
+{
+	b3DestroyCompound( compound );
+}
+
+int pmb3_compound_standing( const void* compound )
+{
+	int count = 0;
+	int childCount = b3GetCompoundChildCount( compound );
+	for ( int i = 0; i < childCount; ++i )
+	{
+		count += b3IsCompoundChildEnabled( compound, i ) ? 1 : 0;
+	}
+	return count;
+}
+
+uint64_t pmb3_body_compound( uint32_t w, PmbVec3 pos, const void* compound )
+{
+	b3BodyDef bd = b3DefaultBodyDef();
+	bd.position = ( b3Pos ){ pos.x, pos.y, pos.z };
+	b3BodyId body = b3CreateBody( pmb3_unpack_world( w ), &bd );
+	b3ShapeDef sd = b3DefaultShapeDef();
+	b3CreateBakedCompoundShape( body, &sd, compound );
+	return pmb3_created( body );
+}
+
+// Knock chunk `child` off a compound body. Contacts on that chunk go
+// and what rested on it wakes; the rest of the prop is untouched.
+void pmb3_body_shed_child( uint64_t body, int child )
+{
+	b3ShapeId shapes[PMB3_MAX_SHAPES];
+	int n = b3Body_GetShapes( pmb3_unpack_body( body ), shapes, PMB3_MAX_SHAPES );
+	for ( int i = 0; i < n; ++i )
+	{
+		if ( b3Shape_GetType( shapes[i] ) == b3_compoundShape )
+		{
+			b3Shape_DisableCompoundChild( shapes[i], child );
+			return;
+		}
+	}
+}
+
+void pmb3_body_set_type( uint64_t body, int type )
+{
+	b3Body_SetType( pmb3_unpack_body( body ), (b3BodyType)type );
+}
+
+// A static box trigger volume: a sensor shape that sees the bodies with
+// sensor events on (pmb3_body_set_sensor_events) once a step has run.
+uint64_t pmb3_body_sensor_box( uint32_t w, PmbVec3 pos, PmbVec3 half )
+{
+	b3BodyDef bd = b3DefaultBodyDef();
+	bd.position = ( b3Pos ){ pos.x, pos.y, pos.z };
+	b3BodyId body = b3CreateBody( pmb3_unpack_world( w ), &bd );
+	b3ShapeDef sd = b3DefaultShapeDef();
+	sd.isSensor = true;
+	sd.enableSensorEvents = true;
+	b3BoxHull box = b3MakeBoxHull( half.x, half.y, half.z );
+	b3CreateHullShape( body, &sd, &box.base );
+	return pmb3_created( body );
+}
+
+void pmb3_body_set_sensor_events( uint64_t body, bool on )
+{
+	b3ShapeId shapes[PMB3_MAX_SHAPES];
+	int n = b3Body_GetShapes( pmb3_unpack_body( body ), shapes, PMB3_MAX_SHAPES );
+	for ( int i = 0; i < n; ++i )
+	{
+		b3Shape_EnableSensorEvents( shapes[i], on );
+	}
+}
+
+// Bodies inside a sensor body's first sensor shape as of the last step,
+// in shape order. A visitor destroyed since is left out.
+int pmb3_body_sensor_visitors( uint64_t body, uint64_t* out, int cap )
+{
+	b3ShapeId shapes[PMB3_MAX_SHAPES];
+	int n = b3Body_GetShapes( pmb3_unpack_body( body ), shapes, PMB3_MAX_SHAPES );
+	for ( int i = 0; i < n; ++i )
+	{
+		if ( b3Shape_IsSensor( shapes[i] ) == false )
+		{
+			continue;
+		}
+
+		b3ShapeId visitors[64];
+		int count = b3Shape_GetSensorData( shapes[i], visitors, b3MinInt( cap, 64 ) );
+		int m = 0;
+		for ( int j = 0; j < count; ++j )
+		{
+			if ( b3Shape_IsValid( visitors[j] ) )
+			{
+				out[m++] = pmb3_pack_body( b3Shape_GetBody( visitors[j] ) );
+			}
+		}
+		return m;
+	}
+	return 0;
+}
+
+// Static sensors the last step left alone because no awake shape came
+// near them.
+int pmb3_world_skipped_sensors( uint32_t w )
+{
+	return b3World_GetCounters( pmb3_unpack_world( w ) ).skippedSensorCount;
+}
+
+// Lock the world for reading: the casts, overlaps and nearest picks
+// below may then run on many threads at once, until end_queries.
+void pmb3_world_begin_queries( uint32_t w )
+{
+	b3World_BeginQueries( pmb3_unpack_world( w ) );
+}
+
+void pmb3_world_end_queries( uint32_t w )
+{
+	b3World_EndQueries( pmb3_unpack_world( w ) );
+}
+
+// Closest hit in the live world against shapes whose category is in
+// `mask` (statics for bullet/wall clipping). Returns 0 on miss.
+int pmb3_world_cast_ray( uint32_t w, PmbVec3 origin, PmbVec3 translation, uint64_t mask, PmbVec3* point,
+						 float* frac )
+{
+	b3QueryFilter filter = b3DefaultQueryFilter();
+	filter.categoryBits = ~0ull;
+	filter.maskBits = mask;
+	b3RayResult r = b3World_CastRayClosest( pmb3_unpack_world( w ), ( b3Pos ){ origin.x, origin.y, origin.z },
+											( b3Vec3 ){ translation.x, translation.y, translation.z }, filter );
+	if ( !r.hit )
+	{
+		return 0;
+	}
+	point->x = (float)r.point.x;
+	point->y = (float)r.point.y;
+	point->z = (float)r.point.z;
+	*frac = r.fraction;
+	return 1;
+}
+
+// One blast for pmb3_world_explode, laid out as the Rust Explosion.
+typedef struct PmbExplosion
+{
+	PmbVec3 position;
+	float radius;
+	float falloff;
+	float impulsePerArea;
+} PmbExplosion;
+
+// All n blasts in one b3World_ExplodeBatch against every category.
+void pmb3_world_explode( uint32_t w, const PmbExplosion* blasts, int n )
+{
+	b3ExplosionDef* defs = b3Alloc( n * sizeof( b3ExplosionDef ) );
+	for ( int i = 0; i < n; ++i )
+	{
+		defs[i] = b3DefaultExplosionDef();
+		defs[i].position = ( b3Pos ){ blasts[i].position.x, blasts[i].position.y, blasts[i].position.z };
+		defs[i].radius = blasts[i].radius;
+		defs[i].falloff = blasts[i].falloff;
+		defs[i].impulsePerArea = blasts[i].impulsePerArea;
+	}
+	b3World_ExplodeBatch( pmb3_unpack_world( w ), defs, n );
+	b3Free( defs, n * sizeof( b3ExplosionDef ) );
+}
+
+// One wind volume for pmb3_world_set_force_fields, laid out as the Rust ForceField.
+typedef struct PmbForceField
+{
+	int32_t kind;
+	PmbVec3 center;
+	PmbVec3 extents;
+	PmbVec3 direction;
+	float speed;
+	float drag;
+} PmbForceField;
+
+// Replace the force fields of world `w` with these n, none for n = 0.
+void pmb3_world_set_force_fields( uint32_t w, const PmbForceField* fields, int n )
+{
+	b3ForceFieldDef defs[B3_MAX_FORCE_FIELDS];
+	n = n < B3_MAX_FORCE_FIELDS ? n : B3_MAX_FORCE_FIELDS;
+	for ( int i = 0; i < n; ++i )
+	{
+		defs[i] = b3DefaultForceFieldDef();
+		defs[i].type = (b3ForceFieldType)fields[i].kind;
+		defs[i].center = ( b3Pos ){ fields[i].center.x, fields[i].center.y, fields[i].center.z };
+		defs[i].extents = ( b3Vec3 ){ fields[i].extents.x, fields[i].extents.y, fields[i].extents.z };
+		defs[i].direction = ( b3Vec3 ){ fields[i].direction.x, fields[i].direction.y, fields[i].direction.z };
+		defs[i].speed = fields[i].speed;
+		defs[i].drag = fields[i].drag;
+	}
+	b3World_SetForceFields( pmb3_unpack_world( w ), defs, n );
+}
+
+// Wireframes of the shapes of world `w` in the box lower..upper and in front of each plane, given
+// as (x, y, z, offset), relative to `origin`. counts gets the line and triangle vertices written,
+// then the ones needed. Returns the shapes written.
+int pmb3_world_debug_geometry( uint32_t w, PmbVec3 origin, const float* planes, int planeCount, PmbVec3 lower,
+							   PmbVec3 upper, bool faces, b3DebugVertex* lines, int lineCapacity,
+							   b3DebugVertex* triangles, int triangleCapacity, int* counts )
+{
+	b3DebugBufferDef def = b3DefaultDebugBufferDef();
+	def.origin = ( b3Pos ){ origin.x, origin.y, origin.z };
+	def.planeCount = planeCount < 6 ? planeCount : 6;
+	for ( int i = 0; i < def.planeCount; ++i )
+	{
+		def.planes[i] = ( b3Plane ){ { planes[4 * i], planes[4 * i + 1], planes[4 * i + 2] }, planes[4 * i + 3] };
+	}
+	def.bounds = ( b3AABB ){ { lower.x, lower.y, lower.z }, { upper.x, upper.y, upper.z } };
+	def.drawFaces = faces;
+	def.lineVertices = lines;
+	def.lineCapacity = lineCapacity;
+	def.triangleVertices = triangles;
+	def.triangleCapacity = triangleCapacity;
+
+	b3DebugBufferCounts c = b3World_DrawToBuffer( pmb3_unpack_world( w ), &def );
+	counts[0] = c.lineVertexCount;
+	counts[1] = c.triangleVertexCount;
+	counts[2] = c.requiredLineVertexCount;
+	counts[3] = c.requiredTriangleVertexCount;
+	return c.shapeCount;
+}
+
+// Rebase world `w` so `origin` becomes zero, for a player far out.
+void pmb3_world_shift_origin( uint32_t w, PmbVec3 origin )
+{
+	b3WorldId id = pmb3_unpack_world( w );
+	b3World_ShiftOrigin( id, ( b3Pos ){ origin.x, origin.y, origin.z } );
+	pmb3_hash_rebuild( b3GetWorldFromId( id ) );
+}
+
+// A line of sight kept between ticks: b3World_CastRayClosestCached's
+// cache plus a count of the calls that had to walk the trees.
+typedef struct PmbRayCache
+{
+	b3RayCache cache;
+	int walks;
+} PmbRayCache;
+
+PmbRayCache* pmb3_ray_cache_create( void )
+{
+	return b3AllocZeroed( sizeof( PmbRayCache ) );
+}
+
+void pmb3_ray_cache_destroy( PmbRayCache* c )
+{
+	b3Free( c, sizeof( PmbRayCache ) );
+}
+
+int pmb3_ray_cache_walks( const PmbRayCache* c )
+{
+	return c->walks;
+}
+
+// pmb3_world_cast_ray through a cache: the same hit, without a tree
+// walk while nothing moved near the ray and its ends stayed put.
+int pmb3_world_cast_ray_cached( uint32_t w, PmbRayCache* c, PmbVec3 origin, PmbVec3 translation, uint64_t mask,
+								PmbVec3* point, float* frac )
+{
+	b3QueryFilter filter = b3DefaultQueryFilter();
+	filter.categoryBits = ~0ull;
+	filter.maskBits = mask;
+	b3RayResult r = b3World_CastRayClosestCached( pmb3_unpack_world( w ), ( b3Pos ){ origin.x, origin.y, origin.z },
+												  ( b3Vec3 ){ translation.x, translation.y, translation.z }, filter,
+												  &c->cache );
+	c->walks += r.nodeVisits > 0;
+	if ( !r.hit )
+	{
+		return 0;
+	}
+	point->x = (float)r.point.x;
+	point->y = (float)r.point.y;
+	point->z = (float)r.point.z;
+	*frac = r.fraction;
+	return 1;
+}
+
+// pmb3_world_cast_ray for `n` rays at once — a volley, a tick's worth
+// of hitscan: b3World_CastRaysClosest walks the trees a packet of rays
+// at a time. `fracs[i]` is negative on a miss. Returns the hit count.
+int pmb3_world_cast_rays( uint32_t w, const PmbVec3* origins, const PmbVec3* translations, int n, uint64_t mask,
+						  PmbVec3* points, float* fracs )
+{
+	if ( n <= 0 )
+	{
+		return 0;
+	}
+
+	b3QueryFilter filter = b3DefaultQueryFilter();
+	filter.categoryBits = ~0ull;
+	filter.maskBits = mask;
+
+	b3Pos* bo = b3Alloc( n * sizeof( b3Pos ) );
+	b3Vec3* bt = b3Alloc( n * sizeof( b3Vec3 ) );
+	b3QueryFilter* bf = b3Alloc( n * sizeof( b3QueryFilter ) );
+	b3RayResult* br = b3Alloc( n * sizeof( b3RayResult ) );
+	for ( int i = 0; i < n; ++i )
+	{
+		bo[i] = ( b3Pos ){ origins[i].x, origins[i].y, origins[i].z };
+		bt[i] = ( b3Vec3 ){ translations[i].x, translations[i].y, translations[i].z };
+		bf[i] = filter;
+	}
+
+	b3World_CastRaysClosest( pmb3_unpack_world( w ), bo, bt, bf, n, br );
+
+	int hits = 0;
+	for ( int i = 0; i < n; ++i )
+	{
+		if ( br[i].hit )
+		{
+			points[i].x = (float)br[i].point.x;
+			points[i].y = (float)br[i].point.y;
+			points[i].z = (float)br[i].point.z;
+			fracs[i] = br[i].fraction;
+			hits += 1;
+		}
+		else
+		{
+			fracs[i] = -1.0f;
+		}
+	}
+
+	b3Free( br, n * sizeof( b3RayResult ) );
+	b3Free( bf, n * sizeof( b3QueryFilter ) );
+	b3Free( bt, n * sizeof( b3Vec3 ) );
+	b3Free( bo, n * sizeof( b3Pos ) );
+	return hits;
+}
+
+// Cast a sphere (radius 0 = a ray) at ONE body posed at an arbitrary
+// transform — the lag-comp verb: the caller rewinds the pose, Box3D
+// judges the geometry. Returns 0 on miss.
+int pmb3_body_cast_sphere( uint64_t body, PmbVec3 tpos, PmbQuat trot, PmbVec3 origin, float radius,
+						   PmbVec3 translation, PmbVec3* point, float* frac )
+{
+	b3QueryFilter filter = b3DefaultQueryFilter();
+	filter.categoryBits = ~0ull;
+	filter.maskBits = ~0ull;
+	b3WorldTransform xf;
+	xf.p = ( b3Pos ){ tpos.x, tpos.y, tpos.z };
+	xf.q = ( b3Quat ){ .v = { trot.x, trot.y, trot.z }, .s = trot.w };
+	b3BodyCastResult r;
+	if ( radius > 0.0f )
+	{
+		b3Vec3 pt = { 0.0f, 0.0f, 0.0f };
+		b3ShapeProxy proxy = { &pt, 1, radius };
+		r = b3Body_CastShape( pmb3_unpack_body( body ), ( b3Pos ){ origin.x, origin.y, origin.z }, &proxy,
+							  ( b3Vec3 ){ translation.x, translation.y, translation.z }, filter, 1.0f, false, xf );
+	}
+	else
+	{
+		r = b3Body_CastRay( pmb3_unpack_body( body ), ( b3Pos ){ origin.x, origin.y, origin.z },
+							( b3Vec3 ){ translation.x, translation.y, translation.z }, filter, 1.0f, xf );
+	}
+	if ( !r.hit )
+	{
+		return 0;
+	}
+	point->x = (float)r.point.x;
+	point->y = (float)r.point.y;
+	point->z = (float)r.point.z;
+	*frac = r.fraction;
+	return 1;
+}
+
+// Lag comp inside Box3D: the world keeps `depth` ticks of poses for
+// the bodies that opt in, recorded by the caller once per tick after
+// the step (tick = the game's clock). 0 drops the history.
+void pmb3_world_enable_history( uint32_t w, int depth )
+{
+	b3World_EnableHistory( pmb3_unpack_world( w ), depth );
+}
+
+void pmb3_world_record_history( uint32_t w, uint32_t tick )
+{
+	b3World_RecordHistory( pmb3_unpack_world( w ), tick );
+}
+
+void pmb3_body_enable_history( uint64_t body, int flag )
+{
+	b3Body_EnableHistory( pmb3_unpack_body( body ), flag != 0 );
+}
+
+// One sphere cast (radius 0 = a ray) at the history bodies as they
+// stood at `tick`: the rewound world in one tree walk, instead of the
+// caller casting at each candidate's rewound pose. Returns 0 on miss.
+int pmb3_world_cast_at_tick( uint32_t w, uint32_t tick, PmbVec3 origin, float radius, PmbVec3 translation, uint64_t mask,
+							 uint64_t* body, PmbVec3* point, float* frac )
+{
+	b3QueryFilter filter = b3DefaultQueryFilter();
+	filter.categoryBits = ~0ull;
+	filter.maskBits = mask;
+	b3Pos o = { origin.x, origin.y, origin.z };
+	b3Vec3 t = { translation.x, translation.y, translation.z };
+	b3RayResult r;
+	if ( radius > 0.0f )
+	{
+		b3Vec3 pt = { 0.0f, 0.0f, 0.0f };
+		b3ShapeProxy proxy = { &pt, 1, radius };
+		r = b3World_CastShapeAtTick( pmb3_unpack_world( w ), tick, o, &proxy, t, filter );
+	}
+	else
+	{
+		r = b3World_CastRayAtTick( pmb3_unpack_world( w ), tick, o, t, filter );
+	}
+	if ( !r.hit )
+	{
+		return 0;
+	}
+	*body = pmb3_pack_body( b3Shape_GetBody( r.shapeId ) );
+	point->x = (float)r.point.x;
+	point->y = (float)r.point.y;
+	point->z = (float)r.point.z;
+	*frac = r.fraction;
+	return 1;
 }
 
 // Overlap a capsule (p1..p2, radius) against the live world; bodies
@@ -389,3 +1924,628 @@ int pmb3_world_overlap_capsule( uint32_t w, PmbVec3 p1, PmbVec3 p2, float radius
 						  &ctx );
 	return ctx.n;
 }
+
+// The k bodies (category in `mask`) nearest `p` within `range`, nearest
+// first, each once. The AI target pick: a best-first walk bounded by the
+// k-th distance, not an overlap of the whole range sorted afterwards.
+int pmb3_world_query_nearest( uint32_t w, PmbVec3 p, float range, uint64_t mask, uint64_t* out, float* dist, int cap )
+{
+	b3QueryFilter filter = b3DefaultQueryFilter();
+	filter.categoryBits = ~0ull;
+	filter.maskBits = mask;
+	b3NearestResult results[64];
+	cap = b3MinInt( cap, 64 );
+	int n = b3World_QueryNearest( pmb3_unpack_world( w ), ( b3Pos ){ p.x, p.y, p.z }, range, filter, results, cap );
+	for ( int i = 0; i < n; ++i )
+	{
+		out[i] = pmb3_pack_body( results[i].bodyId );
+		dist[i] = results[i].distance;
+	}
+	return n;
+}
+
+// Capsule characters moved in one crossing (b3World_MoveCapsules): each
+// row is a capsule (c1, c2 relative to pos) wanting `delta` this tick.
+// Rows come back with the new pos, vel clipped by what was touched at
+// the end, and how many planes that was. Same layout as Rust's Mover
+// and MoverResult.
+typedef struct
+{
+	PmbVec3 pos;
+	PmbVec3 c1;
+	PmbVec3 c2;
+	float radius;
+	PmbVec3 delta;
+	PmbVec3 vel;
+} PmbMover;
+
+typedef struct
+{
+	PmbVec3 pos;
+	PmbVec3 vel;
+	int planes;
+} PmbMoverResult;
+
+void pmb3_world_move_capsules( uint32_t w, const PmbMover* movers, int n, uint64_t mask, PmbMoverResult* out )
+{
+	b3QueryFilter filter = b3DefaultQueryFilter();
+	filter.categoryBits = ~0ull;
+	filter.maskBits = mask;
+	b3MoverInput* inputs = b3Alloc( n * sizeof( b3MoverInput ) );
+	b3MoverOutput* outputs = b3Alloc( n * sizeof( b3MoverOutput ) );
+	for ( int i = 0; i < n; ++i )
+	{
+		const PmbMover* m = movers + i;
+		inputs[i] = ( b3MoverInput ){
+			.origin = { m->pos.x, m->pos.y, m->pos.z },
+			.capsule = { { m->c1.x, m->c1.y, m->c1.z }, { m->c2.x, m->c2.y, m->c2.z }, m->radius },
+			.translation = { m->delta.x, m->delta.y, m->delta.z },
+			.velocity = { m->vel.x, m->vel.y, m->vel.z },
+			.filter = filter,
+		};
+	}
+
+	b3World_MoveCapsules( pmb3_unpack_world( w ), inputs, outputs, n );
+
+	for ( int i = 0; i < n; ++i )
+	{
+		b3Vec3 t = outputs[i].translation;
+		b3Vec3 v = outputs[i].velocity;
+		out[i].pos = ( PmbVec3 ){ movers[i].pos.x + t.x, movers[i].pos.y + t.y, movers[i].pos.z + t.z };
+		out[i].vel = ( PmbVec3 ){ v.x, v.y, v.z };
+		out[i].planes = outputs[i].planeCount;
+	}
+
+	b3Free( outputs, n * sizeof( b3MoverOutput ) );
+	b3Free( inputs, n * sizeof( b3MoverInput ) );
+}
+
+// --- bulk doors (2026-10-14). Per-body calls each resolve the world,
+// validate the id, and hop world->bodies -> solver set -> sim; at a
+// horde's worth of bodies per tick the hops ARE the cost. These resolve
+// the world once and run one tight loop over caller-packed id arrays.
+
+// Pose (+ velocity, awake) for n bodies in one crossing. Any out array
+// may be NULL. Velocity is the awake set's body state (zero when
+// asleep, like b3Body_GetLinearVelocity); pose comes from the sim in
+// whichever set holds the body. Rows for dead ids read as identity /
+// zero / asleep. Returns how many ids were live. Walk order is the
+// caller's: awake sims pack into one array, so a spawn-ordered id list
+// reads them near-sequentially.
+int pmb3_bodies_read_poses( uint32_t w, const uint64_t* ids, int n, PmbVec3* pos, PmbQuat* rot, PmbVec3* vel,
+							uint8_t* awake )
+{
+	b3World* world = b3GetWorldFromId( pmb3_unpack_world( w ) );
+	b3SolverSet* sets = world->solverSets.data;
+	int live = 0;
+	for ( int i = 0; i < n; ++i )
+	{
+		b3Body* body = pmb3_body_in( world, ids[i] );
+		if ( body == NULL )
+		{
+			if ( pos != NULL )
+			{
+				pos[i] = ( PmbVec3 ){ 0.0f, 0.0f, 0.0f };
+			}
+			if ( rot != NULL )
+			{
+				rot[i] = ( PmbQuat ){ 0.0f, 0.0f, 0.0f, 1.0f };
+			}
+			if ( vel != NULL )
+			{
+				vel[i] = ( PmbVec3 ){ 0.0f, 0.0f, 0.0f };
+			}
+			if ( awake != NULL )
+			{
+				awake[i] = 0;
+			}
+			continue;
+		}
+
+		b3SolverSet* set = sets + body->setIndex;
+		const b3BodySim* sim = set->bodySims.data + body->localIndex;
+		bool isAwake = body->setIndex == b3_awakeSet;
+		if ( pos != NULL )
+		{
+			pos[i] = ( PmbVec3 ){ (float)sim->transform.p.x, (float)sim->transform.p.y, (float)sim->transform.p.z };
+		}
+		if ( rot != NULL )
+		{
+			const b3Quat q = sim->transform.q;
+			rot[i] = ( PmbQuat ){ q.v.x, q.v.y, q.v.z, q.s };
+		}
+		if ( vel != NULL )
+		{
+			b3Vec3 v = isAwake ? set->bodyStates.data[body->localIndex].linearVelocity : b3Vec3_zero;
+			vel[i] = ( PmbVec3 ){ v.x, v.y, v.z };
+		}
+		if ( awake != NULL )
+		{
+			awake[i] = isAwake ? 1 : 0;
+		}
+		live += 1;
+	}
+	return live;
+}
+
+// Wake every sleeping set that holds a body in the write list, each at
+// most once (waking moves the whole set into the awake set, so later
+// ids from the same set already read awake). `vs` rows that are exactly
+// zero don't wake — an idle brain writing "stand still" every tick must
+// not keep a settled horde's islands up.
+static void pmb3_wake_for_writes( b3World* world, const uint64_t* ids, const PmbVec3* vs, int n )
+{
+	world->locked = true;
+	for ( int i = 0; i < n; ++i )
+	{
+		b3Body* body = pmb3_body_in( world, ids[i] );
+		if ( body == NULL || body->setIndex < b3_firstSleepingSet )
+		{
+			continue;
+		}
+		if ( vs[i].x != 0.0f || vs[i].y != 0.0f || vs[i].z != 0.0f )
+		{
+			b3WakeSolverSet( world, body->setIndex );
+		}
+	}
+	world->locked = false;
+}
+
+// Hard-set linear velocity on n bodies (the horde AI's write-in): wake
+// pass first, then one loop writing straight into the awake set's body
+// states. Statics and still-asleep rows are skipped, as in
+// b3Body_SetLinearVelocity. While a recording is attached the rows go
+// through the public call so the op stream stays replayable.
+void pmb3_bodies_set_velocity( uint32_t w, const uint64_t* ids, const PmbVec3* vs, int n )
+{
+	b3WorldId wid = pmb3_unpack_world( w );
+	b3World* world = b3GetUnlockedWorldFromId( wid );
+	if ( world == NULL )
+	{
+		return;
+	}
+	if ( world->recording != NULL )
+	{
+		for ( int i = 0; i < n; ++i )
+		{
+			pmb3_body_set_velocity( ids[i], vs[i] );
+		}
+		return;
+	}
+
+	pmb3_wake_for_writes( world, ids, vs, n );
+	b3SolverSet* awakeSet = world->solverSets.data + b3_awakeSet;
+	for ( int i = 0; i < n; ++i )
+	{
+		b3Body* body = pmb3_body_in( world, ids[i] );
+		if ( body == NULL || body->setIndex != b3_awakeSet || body->type == b3_staticBody )
+		{
+			continue;
+		}
+		awakeSet->bodyStates.data[body->localIndex].linearVelocity = ( b3Vec3 ){ vs[i].x, vs[i].y, vs[i].z };
+	}
+}
+
+// Accumulate a center force on n bodies for the next step — same
+// shape as pmb3_bodies_set_velocity, writing the awake set's sims.
+void pmb3_bodies_force( uint32_t w, const uint64_t* ids, const PmbVec3* fs, int n )
+{
+	b3WorldId wid = pmb3_unpack_world( w );
+	b3World* world = b3GetUnlockedWorldFromId( wid );
+	if ( world == NULL )
+	{
+		return;
+	}
+	if ( world->recording != NULL )
+	{
+		for ( int i = 0; i < n; ++i )
+		{
+			pmb3_body_force( ids[i], fs[i] );
+		}
+		return;
+	}
+
+	pmb3_wake_for_writes( world, ids, fs, n );
+	b3SolverSet* awakeSet = world->solverSets.data + b3_awakeSet;
+	for ( int i = 0; i < n; ++i )
+	{
+		b3Body* body = pmb3_body_in( world, ids[i] );
+		if ( body == NULL || body->setIndex != b3_awakeSet )
+		{
+			continue;
+		}
+		b3BodySim* sim = awakeSet->bodySims.data + body->localIndex;
+		b3AccumulateBodyForce( body, sim, ( b3Vec3 ){ fs[i].x, fs[i].y, fs[i].z }, b3Vec3_zero );
+	}
+}
+
+// --- crowd level of detail. Each body carries a level in a caller-owned
+// row, picked from its distance to the nearest viewer:
+//   0 full — every sub-step, full contacts;
+//   1 reduced — one sub-step, contacts push apart only (no friction);
+//   2 dead-reckoned — kinematic, coasting on its velocity with the
+//     gravity-axis part dropped, touching nothing but dynamics.
+// A body coarsens once it is `margin` past a band edge and refines as
+// soon as it is back inside, so one walking along an edge doesn't flip
+// every tick. Transitions go through the public calls (they are rare,
+// and a recording sees them). Sleepers stop at reduced, and static,
+// disabled, and caller-kinematic rows are left alone.
+enum
+{
+	PMB3_LOD_FULL,
+	PMB3_LOD_REDUCED,
+	PMB3_LOD_DEAD_RECKONED,
+};
+
+static void pmb3_apply_lod( b3BodyId id, int level, b3Vec3 vertical )
+{
+	b3Body_SetSubStepHint( id, level == PMB3_LOD_FULL ? 0 : 1 );
+	b3Body_EnableSimplifiedContacts( id, level != PMB3_LOD_FULL );
+
+	b3BodyType type = level == PMB3_LOD_DEAD_RECKONED ? b3_kinematicBody : b3_dynamicBody;
+	if ( b3Body_GetType( id ) == type )
+	{
+		return;
+	}
+
+	b3Body_SetType( id, type );
+	if ( type == b3_kinematicBody )
+	{
+		b3Vec3 v = b3Body_GetLinearVelocity( id );
+		b3Body_SetLinearVelocity( id, b3MulSub( v, b3Dot( v, vertical ), vertical ) );
+		b3Body_SetAngularVelocity( id, b3Vec3_zero );
+	}
+}
+
+int pmb3_bodies_update_lod( uint32_t w, const uint64_t* ids, uint8_t* levels, int n, const PmbVec3* viewers,
+							int viewerCount, float nearDistance, float farDistance, float margin )
+{
+	b3WorldId wid = pmb3_unpack_world( w );
+	b3World* world = b3GetUnlockedWorldFromId( wid );
+	if ( world == NULL )
+	{
+		return 0;
+	}
+
+	// Squared band edges: coarsen past the outer, refine inside the inner
+	float nearOuter = nearDistance + margin, farOuter = farDistance + margin;
+	float outer[2] = { nearOuter * nearOuter, farOuter * farOuter };
+	float inner[2] = { nearDistance * nearDistance, farDistance * farDistance };
+	b3Vec3 gravity = b3World_GetGravity( wid );
+	b3Vec3 vertical = b3LengthSquared( gravity ) > 0.0f ? b3Normalize( gravity ) : b3Vec3_zero;
+
+	int changed = 0;
+	for ( int i = 0; i < n; ++i )
+	{
+		b3Body* body = pmb3_body_in( world, ids[i] );
+		int level = levels[i] > PMB3_LOD_DEAD_RECKONED ? PMB3_LOD_DEAD_RECKONED : levels[i];
+		if ( body == NULL || body->setIndex == b3_disabledSet || body->type == b3_staticBody ||
+			 ( body->type == b3_kinematicBody && level != PMB3_LOD_DEAD_RECKONED ) )
+		{
+			continue;
+		}
+
+		// Going kinematic wakes the body, and a sleeper has nothing to coast on
+		int coarsest = body->setIndex == b3_awakeSet || level == PMB3_LOD_DEAD_RECKONED ? PMB3_LOD_DEAD_RECKONED
+																						: PMB3_LOD_REDUCED;
+
+		b3Vec3 p = b3Body_GetPosition( pmb3_unpack_body( ids[i] ) );
+		float distance = FLT_MAX;
+		for ( int j = 0; j < viewerCount; ++j )
+		{
+			b3Vec3 d = { p.x - viewers[j].x, p.y - viewers[j].y, p.z - viewers[j].z };
+			distance = b3MinFloat( distance, b3LengthSquared( d ) );
+		}
+
+		int target = level;
+		while ( target < coarsest && distance > outer[target] )
+		{
+			target += 1;
+		}
+		while ( target > PMB3_LOD_FULL && distance < inner[target - 1] )
+		{
+			target -= 1;
+		}
+
+		if ( target != levels[i] )
+		{
+			levels[i] = (uint8_t)target;
+			pmb3_apply_lod( pmb3_unpack_body( ids[i] ), target, vertical );
+			changed += 1;
+		}
+	}
+	return changed;
+}
+
+// --- dirty-only pose stream. Box3D already records a move event for
+// every body the step actually moved (finalize writes them; sleeping
+// islands write nothing), so the replication walk can be the event
+// buffer itself, zero-copy. PmbMoveEvent is b3BodyMoveEvent's exact
+// layout with pm-side field types — asserted field by field so a pin
+// bump that reshapes the event is a compile error here, not a garbled
+// span on the Rust side. The body id bytes ARE the pm packing
+// (index1 | world0<<32 | generation<<48, little-endian) but sit 4-byte
+// aligned, hence the split words.
+typedef struct
+{
+	void* userData;
+	PmbVec3 pos;
+	PmbQuat rot;
+	uint32_t bodyLo, bodyHi;
+	bool fellAsleep;
+} PmbMoveEvent;
+
+_Static_assert( sizeof( PmbMoveEvent ) == sizeof( b3BodyMoveEvent ), "pmb3 move event size" );
+_Static_assert( offsetof( PmbMoveEvent, pos ) == offsetof( b3BodyMoveEvent, transform.p ), "pmb3 move event pos" );
+_Static_assert( offsetof( PmbMoveEvent, rot ) == offsetof( b3BodyMoveEvent, transform.q ), "pmb3 move event rot" );
+_Static_assert( offsetof( PmbMoveEvent, bodyLo ) == offsetof( b3BodyMoveEvent, bodyId ), "pmb3 move event id" );
+_Static_assert( offsetof( PmbMoveEvent, fellAsleep ) == offsetof( b3BodyMoveEvent, fellAsleep ), "pmb3 move event flag" );
+_Static_assert( sizeof( b3Pos ) == sizeof( PmbVec3 ), "pmb3 move events need float positions" );
+
+// The last step's move events as a borrowed span; valid until the next
+// step or body destroy.
+const PmbMoveEvent* pmb3_world_move_events( uint32_t w, int* count )
+{
+	b3BodyEvents events = b3World_GetBodyEvents( pmb3_unpack_world( w ) );
+	*count = events.moveCount;
+	return (const PmbMoveEvent*)events.moveEvents;
+}
+
+// --- contact events for damage and audio, zero-copy like the move
+// events: spans of Box3D's own begin/end/hit buffers, which a step
+// clears and refills in place. Shape ids are packed like body ids and
+// split the same way. The buffers only fill for contacts a shape or
+// world category opted into, see pmb3_world_set_contact_events.
+typedef struct
+{
+	uint32_t shapeA[2];
+	uint32_t shapeB[2];
+	uint32_t contact[3];
+} PmbContactTouch;
+
+typedef struct
+{
+	uint32_t shapeA[2];
+	uint32_t shapeB[2];
+	uint32_t contact[3];
+	PmbVec3 point;
+	PmbVec3 normal;
+	float approachSpeed;
+	uint64_t materialA;
+	uint64_t materialB;
+} PmbContactHit;
+
+_Static_assert( sizeof( PmbContactTouch ) == sizeof( b3ContactBeginTouchEvent ), "pmb3 begin event size" );
+_Static_assert( sizeof( PmbContactTouch ) == sizeof( b3ContactEndTouchEvent ), "pmb3 end event size" );
+_Static_assert( offsetof( PmbContactTouch, shapeB ) == offsetof( b3ContactBeginTouchEvent, shapeIdB ), "pmb3 begin event" );
+_Static_assert( offsetof( PmbContactTouch, shapeB ) == offsetof( b3ContactEndTouchEvent, shapeIdB ), "pmb3 end event" );
+_Static_assert( sizeof( PmbContactHit ) == sizeof( b3ContactHitEvent ), "pmb3 hit event size" );
+_Static_assert( offsetof( PmbContactHit, point ) == offsetof( b3ContactHitEvent, point ), "pmb3 hit event point" );
+_Static_assert( offsetof( PmbContactHit, approachSpeed ) == offsetof( b3ContactHitEvent, approachSpeed ),
+				"pmb3 hit event speed" );
+_Static_assert( offsetof( PmbContactHit, materialA ) == offsetof( b3ContactHitEvent, userMaterialIdA ),
+				"pmb3 hit event material" );
+
+// Begin/end touch and hit events for every contact with a shape in
+// `touch` / `hit` categories. 0 and 0 turn them off again.
+void pmb3_world_set_contact_events( uint32_t w, uint64_t touch, uint64_t hit )
+{
+	b3World_SetContactEventCategories( pmb3_unpack_world( w ), touch, hit );
+}
+
+// The last step's contact events as borrowed spans; valid until the
+// next step.
+void pmb3_world_contact_events( uint32_t w, const PmbContactTouch** begins, int* beginCount, const PmbContactTouch** ends,
+								int* endCount, const PmbContactHit** hits, int* hitCount )
+{
+	b3ContactEvents events = b3World_GetContactEvents( pmb3_unpack_world( w ) );
+	*begins = (const PmbContactTouch*)events.beginEvents;
+	*beginCount = events.beginCount;
+	*ends = (const PmbContactTouch*)events.endEvents;
+	*endCount = events.endCount;
+	*hits = (const PmbContactHit*)events.hitEvents;
+	*hitCount = events.hitCount;
+}
+
+// --- per-body impacts for damage: one record per opted-in body the
+// step pushed, the normal impulses of all its contacts summed in the
+// vendor's serial hit pass. Zero-copy like the events; the body id is
+// split like PmbMoveEvent's.
+typedef struct
+{
+	uint32_t body[2];
+	float normalImpulse;
+	float maxApproachSpeed;
+} PmbBodyImpact;
+
+_Static_assert( sizeof( PmbBodyImpact ) == sizeof( b3BodyImpact ), "pmb3 impact size" );
+_Static_assert( offsetof( PmbBodyImpact, normalImpulse ) == offsetof( b3BodyImpact, normalImpulse ), "pmb3 impact sum" );
+_Static_assert( offsetof( PmbBodyImpact, maxApproachSpeed ) == offsetof( b3BodyImpact, maxApproachSpeed ),
+				"pmb3 impact speed" );
+
+void pmb3_body_enable_impacts( uint64_t body, int flag )
+{
+	b3Body_EnableImpactAccumulation( pmb3_unpack_body( body ), flag != 0 );
+}
+
+// The last step's impacts as a borrowed span; valid until the next step.
+const PmbBodyImpact* pmb3_world_body_impacts( uint32_t w, int* count )
+{
+	b3BodyImpacts impacts = b3World_GetBodyImpacts( pmb3_unpack_world( w ) );
+	*count = impacts.count;
+	return (const PmbBodyImpact*)impacts.impacts;
+}
+
+// The body of a shape named by an event, 0 once the shape is gone.
+uint64_t pmb3_shape_body( uint64_t shape )
+{
+	b3ShapeId id = { (int32_t)(uint32_t)( shape & 0xFFFFFFFF ), (uint16_t)( ( shape >> 32 ) & 0xFFFF ), (uint16_t)( shape >> 48 ) };
+	return b3Shape_IsValid( id ) ? pmb3_pack_body( b3Shape_GetBody( id ) ) : 0;
+}
+
+// Quantized replication records, one per move event in the same order,
+// packed by finalize while the body is still in cache. A cell size of 0
+// turns packing off. Ships as is: the peer decodes with the same
+// quantization, so every peer must agree on it (it does not touch the
+// simulation, only the wire).
+void pmb3_world_set_state_quantization( uint32_t w, float cellSize, float positionResolution, float maxLinearSpeed,
+										float maxAngularSpeed, float velocityResolution, int rotationBits )
+{
+	b3StateQuantization q = { cellSize, positionResolution, maxLinearSpeed, maxAngularSpeed, velocityResolution, rotationBits };
+	b3World_SetStateQuantization( pmb3_unpack_world( w ), &q );
+}
+
+// The last step's records as a borrowed span, count records of stride
+// bytes; valid until the next step.
+const uint8_t* pmb3_world_packed_states( uint32_t w, int* stride, int* count )
+{
+	b3PackedBodyStates states = b3World_GetPackedBodyStates( pmb3_unpack_world( w ) );
+	*stride = states.stride;
+	*count = states.count;
+	return states.data;
+}
+
+// Decode one record with this world's quantization; returns the sleep bit.
+bool pmb3_world_unpack_state( uint32_t w, const uint8_t* record, PmbVec3* pos, PmbQuat* rot, PmbVec3* vel, PmbVec3* angVel )
+{
+	b3World* world = b3GetWorldFromId( pmb3_unpack_world( w ) );
+	b3PackedBodyState s = b3UnpackBodyState( &world->stateQuantization, record );
+	*pos = ( PmbVec3 ){ (float)s.position.x, (float)s.position.y, (float)s.position.z };
+	*rot = ( PmbQuat ){ s.rotation.v.x, s.rotation.v.y, s.rotation.v.z, s.rotation.s };
+	*vel = ( PmbVec3 ){ s.linearVelocity.x, s.linearVelocity.y, s.linearVelocity.z };
+	*angVel = ( PmbVec3 ){ s.angularVelocity.x, s.angularVelocity.y, s.angularVelocity.z };
+	return s.fellAsleep;
+}
+
+// Standalone snapshot for a joining client: a counting pass for the size,
+// then a write into the caller's buffer, 0 if it does not fit.
+int pmb3_world_snapshot_size( uint32_t w, bool exclude_static )
+{
+	return b3World_GetSnapshotSize( pmb3_unpack_world( w ), exclude_static );
+}
+
+int pmb3_world_save_snapshot( uint32_t w, uint8_t* buffer, int capacity, bool exclude_static )
+{
+	return b3World_SaveSnapshot( pmb3_unpack_world( w ), buffer, capacity, exclude_static );
+}
+
+// The running checksum is rebuilt from the loaded bodies.
+bool pmb3_world_load_snapshot( uint32_t w, const uint8_t* data, int size )
+{
+	b3WorldId id = pmb3_unpack_world( w );
+	if ( b3World_LoadSnapshot( id, data, size ) == false )
+	{
+		return false;
+	}
+	pmb3_hash_rebuild( b3GetWorldFromId( id ) );
+	return true;
+}
+
+// A copy of template world `w` on its own `workers`, sharing the
+// template's meshes. 0 if the template is mid-step.
+uint32_t pmb3_world_clone( uint32_t w, int workers )
+{
+	b3WorldDef def = b3DefaultWorldDef();
+	def.workerCount = (uint32_t)workers;
+	b3WorldId id = b3World_Clone( pmb3_unpack_world( w ), &def );
+	if ( B3_IS_NULL( id ) )
+	{
+		return 0;
+	}
+	pmb3_hash_rebuild( b3GetWorldFromId( id ) );
+	return (uint32_t)id.index1 | ( (uint32_t)id.generation << 16 );
+}
+
+void* pmb3_world_begin_snapshot_stream( uint32_t w, bool exclude_static )
+{
+	return b3World_BeginSnapshotStream( pmb3_unpack_world( w ), exclude_static );
+}
+
+int pmb3_snapshot_stream_read( void* stream, uint8_t* buffer, int capacity, int* remaining )
+{
+	int n = b3SnapshotStream_Read( stream, buffer, capacity );
+	*remaining = b3SnapshotStream_GetRemaining( stream );
+	return n;
+}
+
+int pmb3_snapshot_stream_size( const void* stream )
+{
+	return b3SnapshotStream_GetSize( stream );
+}
+
+void pmb3_snapshot_stream_destroy( void* stream )
+{
+	b3SnapshotStream_Destroy( stream );
+}
+
+// Table benchmarks (tests/tables.rs). Pair keys are shaped like the broad
+// phase's: each of `shapes` shapes pairs with its next `neighbours` ids,
+// as a packed crowd pairs with the bodies spawned beside it. A round
+// probes every candidate the way the pair query does, then retires every
+// tenth pair and adds it back, the churn of contacts ending and starting.
+// Returns the probe hits so the work cannot be optimized away.
+uint64_t pmb3_bench_pair_set( int shapes, int neighbours, int rounds )
+{
+	b3HashSet set = b3CreateSet( 16 );
+	for ( int i = 0; i < shapes; ++i )
+	{
+		for ( int j = 1; j <= neighbours; ++j )
+		{
+			b3AddKey( &set, b3ShapePairKey( i, i + j, 0 ) );
+		}
+	}
+
+	uint64_t hits = 0;
+	for ( int round = 0; round < rounds; ++round )
+	{
+		for ( int i = 0; i < shapes; ++i )
+		{
+			// The query also meets shapes that are not paired yet
+			for ( int j = 1; j <= neighbours + 2; ++j )
+			{
+				hits += b3ContainsKey( &set, b3ShapePairKey( i, i + j, 0 ) ) ? 1 : 0;
+			}
+		}
+
+		for ( int i = round % 10; i < shapes; i += 10 )
+		{
+			uint64_t key = b3ShapePairKey( i, i + 1, 0 );
+			b3RemoveKey( &set, key );
+			b3AddKey( &set, key );
+		}
+	}
+
+	b3DestroySet( &set );
+	return hits;
+}
+
+// `hulls` distinct boxes interned the way the world hull database does,
+// then `rounds` lookups of each. Returns the lookup hits.
+uint64_t pmb3_bench_hull_map( int hulls, int rounds )
+{
+	b3BoxHull* boxes = b3Alloc( hulls * sizeof( b3BoxHull ) );
+	for ( int i = 0; i < hulls; ++i )
+	{
+		boxes[i] = b3MakeBoxHull( 0.5f + 0.01f * i, 0.5f, 0.5f );
+	}
+
+	b3HullMap map;
+	b3HullMap_init( &map );
+	for ( int i = 0; i < hulls; ++i )
+	{
+		b3HullMap_insert( &map, &boxes[i].base, i );
+	}
+
+	uint64_t hits = 0;
+	for ( int round = 0; round < rounds; ++round )
+	{
+		for ( int i = 0; i < hulls; ++i )
+		{
+			hits += b3HullMap_is_end( b3HullMap_get( &map, &boxes[i].base ) ) ? 0 : 1;
+		}
+	}
+
+	b3HullMap_cleanup( &map );
+	b3Free( boxes, hulls * sizeof( b3BoxHull ) );
+	return hits;
+}
@@ -0,0 +1,79 @@
+// pmb3.h — what the shim's translation units share: the pm-side value
+// types, the id packing, and the internal-header reach-ins. NOT a
+// public header: Rust declares the shim by hand (see lib.rs), and
+// nothing outside src/ includes this.
+
+#pragma once
+
+#include "box3d/box3d.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// Internal headers — ONLY for the bulk doors, snapshots, and other
+// fast paths that walk solver sets directly instead of paying the
+// public API's per-body world lookup. A pin bump that reshuffles
+// b3Body/b3SolverSet breaks those sections alone (and loudly — they
+// are plain struct reads).
+#include "body.h"
+#include "physics_world.h"
+#include "solver_set.h"
+
+typedef struct
+{
+	float x, y, z;
+} PmbVec3;
+
+typedef struct
+{
+	float x, y, z, w;
+} PmbQuat;
+
+// Ids pack the b3 handle structs into plain integers so Rust treats
+// them as opaque numbers: world = index1 | generation<<16; body =
+// index1 | world0<<32 | generation<<48.
+static inline b3WorldId pmb3_unpack_world( uint32_t w )
+{
+	b3WorldId id = { (uint16_t)( w & 0xFFFF ), (uint16_t)( w >> 16 ) };
+	return id;
+}
+
+static inline uint64_t pmb3_pack_body( b3BodyId id )
+{
+	return (uint64_t)(uint32_t)id.index1 | ( (uint64_t)id.world0 << 32 ) | ( (uint64_t)id.generation << 48 );
+}
+
+static inline b3BodyId pmb3_unpack_body( uint64_t v )
+{
+	b3BodyId id = { (int32_t)(uint32_t)( v & 0xFFFFFFFF ), (uint16_t)( ( v >> 32 ) & 0xFFFF ), (uint16_t)( v >> 48 ) };
+	return id;
+}
+
+// Resolve a packed id inside an already-resolved world. NULL for a
+// stale id (slot freed or reused) or one from another world — bulk
+// doors skip those instead of asserting, so a despawn racing the id
+// list costs a zeroed row, not a crash.
+static inline b3Body* pmb3_body_in( b3World* world, uint64_t v )
+{
+	b3BodyId id = pmb3_unpack_body( v );
+	if ( id.world0 != world->worldId || id.index1 < 1 || id.index1 > world->bodies.count )
+	{
+		return NULL;
+	}
+	b3Body* body = world->bodies.data + ( id.index1 - 1 );
+	if ( body->id != id.index1 - 1 || body->generation != id.generation )
+	{
+		return NULL;
+	}
+	return body;
+}
+
+// pmb3.c: the single-world step door, shared by the batched stepper.
+void pmb3_world_step( uint32_t w, float dt, int substeps );
+
+// pmb3_hash.c: every door that changes a body's pose or existence
+// folds it into the running world checksum (see that file).
+void pmb3_hash_body( b3World* world, uint64_t body );
+void pmb3_hash_drop( b3World* world, uint64_t body );
+void pmb3_hash_moves( b3World* world );
+void pmb3_hash_rebuild( b3World* world );
+void pmb3_hash_release( b3World* world );
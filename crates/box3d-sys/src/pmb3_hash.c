@@ -0,0 +1,148 @@
+// pmb3_hash — an incrementally maintained world checksum (2026-10-14).
+// The server stamps every snapshot with it and clients compare, so it
+// has to be cheap enough to read EVERY tick: b3HashWorldState walks
+// every body, this is folded as the world changes and reading it is a
+// load.
+//
+// Definition: the XOR over every live body of an FNV-1a mix of (slot,
+// generation, pose bits). XOR makes each body's term replaceable in
+// O(1): fold the old term out, the new one in. The terms change only
+// through doors the shim owns — the step (its move events are exactly
+// the bodies the finalize pass moved), body creation and destruction,
+// teleports, rollback restores — and each door folds what it touched.
+// So the running value always equals pmb3_world_hash_full's walk; the
+// test asserts that.
+//
+// Pose only, by design: velocity divergence shows up in the pose one
+// tick later, and the move event carries the pose but not velocity.
+
+#include "pmb3.h"
+
+#include "recording.h"
+
+#include <string.h>
+
+typedef struct
+{
+	uint64_t hash;
+	// Term currently folded in per body slot (0 = nothing).
+	uint64_t* terms;
+	int capacity;
+} PmbWorldHash;
+
+// Indexed by b3World::worldId. Worlds are single-threaded and slots
+// are per world, so no locking.
+static PmbWorldHash pmb3_hashes[B3_MAX_WORLDS];
+
+static uint64_t pmb3_hash_term( int bodyId, uint16_t generation, b3Pos p, b3Quat q )
+{
+	uint64_t h = B3_SNAP_FNV_INIT;
+	h = ( h ^ (uint64_t)(uint32_t)bodyId ) * B3_SNAP_FNV_PRIME;
+	h = ( h ^ generation ) * B3_SNAP_FNV_PRIME;
+	h = b3FnvMixPosition( h, p );
+	float qs[4] = { q.v.x, q.v.y, q.v.z, q.s };
+	for ( int i = 0; i < 4; ++i )
+	{
+		uint32_t bits;
+		memcpy( &bits, qs + i, 4 );
+		h = ( h ^ bits ) * B3_SNAP_FNV_PRIME;
+	}
+	// Never 0, so an empty slot and a live body cannot alias.
+	return h | 1;
+}
+
+static void pmb3_hash_fold( b3World* world, int bodyId, uint64_t term )
+{
+	PmbWorldHash* wh = pmb3_hashes + world->worldId;
+	if ( bodyId >= wh->capacity )
+	{
+		int capacity = b3MaxInt( b3MaxInt( 2 * wh->capacity, bodyId + 1 ), 64 );
+		wh->terms = b3GrowAlloc( wh->terms, wh->capacity * sizeof( uint64_t ), capacity * sizeof( uint64_t ) );
+		memset( wh->terms + wh->capacity, 0, ( capacity - wh->capacity ) * sizeof( uint64_t ) );
+		wh->capacity = capacity;
+	}
+	wh->hash ^= wh->terms[bodyId] ^ term;
+	wh->terms[bodyId] = term;
+}
+
+static uint64_t pmb3_body_term( b3World* world, const b3Body* body )
+{
+	const b3BodySim* sim = world->solverSets.data[body->setIndex].bodySims.data + body->localIndex;
+	return pmb3_hash_term( body->id, body->generation, sim->transform.p, sim->transform.q );
+}
+
+void pmb3_hash_body( b3World* world, uint64_t body )
+{
+	b3Body* b = pmb3_body_in( world, body );
+	if ( b != NULL )
+	{
+		pmb3_hash_fold( world, b->id, pmb3_body_term( world, b ) );
+	}
+}
+
+void pmb3_hash_drop( b3World* world, uint64_t body )
+{
+	b3Body* b = pmb3_body_in( world, body );
+	if ( b != NULL )
+	{
+		pmb3_hash_fold( world, b->id, 0 );
+	}
+}
+
+void pmb3_hash_moves( b3World* world )
+{
+	for ( int i = 0; i < world->bodyMoveEvents.count; ++i )
+	{
+		const b3BodyMoveEvent* e = world->bodyMoveEvents.data + i;
+		int bodyId = e->bodyId.index1 - 1;
+		pmb3_hash_fold( world, bodyId, pmb3_hash_term( bodyId, e->bodyId.generation, e->transform.p, e->transform.q ) );
+	}
+}
+
+void pmb3_hash_rebuild( b3World* world )
+{
+	PmbWorldHash* wh = pmb3_hashes + world->worldId;
+	wh->hash = 0;
+	if ( wh->capacity > 0 )
+	{
+		memset( wh->terms, 0, wh->capacity * sizeof( uint64_t ) );
+	}
+	for ( int i = 0; i < world->bodies.count; ++i )
+	{
+		const b3Body* body = world->bodies.data + i;
+		if ( body->id == i )
+		{
+			pmb3_hash_fold( world, i, pmb3_body_term( world, body ) );
+		}
+	}
+}
+
+void pmb3_hash_release( b3World* world )
+{
+	PmbWorldHash* wh = pmb3_hashes + world->worldId;
+	b3Free( wh->terms, wh->capacity * sizeof( uint64_t ) );
+	*wh = ( PmbWorldHash ){ 0 };
+}
+
+uint64_t pmb3_world_hash( uint32_t w )
+{
+	b3World* world = b3GetWorldFromId( pmb3_unpack_world( w ) );
+	return pmb3_hashes[world->worldId].hash;
+}
+
+// The same value by a full walk — the check on the running one, and
+// what a peer without the fold history computes.
+uint64_t pmb3_world_hash_full( uint32_t w )
+{
+	b3World* world = b3GetWorldFromId( pmb3_unpack_world( w ) );
+	uint64_t hash = 0;
+	for ( int i = 0; i < world->bodies.count; ++i )
+	{
+		const b3Body* body = world->bodies.data + i;
+		if ( body->id == i )
+		{
+			hash ^= pmb3_body_term( world, body );
+		}
+	}
+	return hash;
+}
@@ -0,0 +1,998 @@
+// pmb3_snapshot — in-place rollback snapshots (2026-10-14). The client
+// world predicts by stepping; a misprediction restores the last acked
+// tick and re-steps. Upstream's b3SerializeWorld (world_snapshot.c) is
+// a RECORDING format: registry-interned geometry, a fresh shell world
+// on load. Rollback needs neither — it is the same world, the same
+// shapes, the same hull database, microseconds later — so this TU
+// copies only SIMULATION state, as raw array images, into a blob the
+// caller keeps and reuses, and restores by memcpy into the arrays the
+// world already owns (their capacity only ever grows, so steady-state
+// capture/restore allocates nothing but contact manifolds whose count
+// changed).
+//
+// THE CONTRACT: topology is frozen across a capture→restore window. No
+// body, shape, or joint may be created or destroyed in between (type
+// changes, filters, frictions, velocities, poses are all fine — they
+// are sim state and roll back with the rest). Restore checks a
+// topology stamp and refuses (returns 0, world untouched) when the
+// window was violated — or while a recording is attached — and the
+// caller re-captures after spawning.
+//
+// The state list mirrors b3SerializeWorld's field by field — when a
+// pin bump adds sim state there, it belongs here too. Both assert
+// B3_SNAP_WORLD_BYTES (world_snapshot.h), so a new world field fails
+// the build until it is, and both finish with b3FinishSnapshotLoad.
+// Host wiring (userData, debug shape handles) is never rolled back.
+
+#include "pmb3.h"
+
+#include "broad_phase.h"
+#include "constraint_graph.h"
+#include "contact.h"
+#include "core.h"
+#include "island.h"
+#include "joint.h"
+#include "platform.h"
+#include "recording.h"
+#include "sensor.h"
+#include "shape.h"
+#include "solver_set.h"
+#include "table.h"
+#include "world_snapshot.h"
+
+#include <string.h>
+
+// Coarse, FIXED section layout of a capture (see the marks in
+// pmb3_snapshot_capture). Deltas align base and full by section, so a
+// count change inside one section cannot shift the diff of the next.
+#define PMB3_SECTION_COUNT 15
+
+#if defined( B3_SNAP_WORLD_BYTES )
+_Static_assert( sizeof( b3World ) == B3_SNAP_WORLD_BYTES, "b3World changed, see B3_SNAP_WORLD_BYTES" );
+#endif
+
+typedef struct PmbSnapshot
+{
+	uint8_t* data;
+	int size;
+	int capacity;
+	uint32_t world;
+	uint64_t topology;
+
+	// Identifies one capture; a delta names its base by it.
+	int serial;
+	// Nonzero: data is a delta op stream against the capture baseSerial.
+	int baseSerial;
+	// Byte size of the full image (== size for a full snapshot).
+	int fullSize;
+	int sections[PMB3_SECTION_COUNT];
+	int sectionCount;
+} PmbSnapshot;
+
+static b3AtomicInt pmb3_snapshot_serials;
+
+PmbSnapshot* pmb3_snapshot_create( void )
+{
+	PmbSnapshot* s = b3AllocZeroed( sizeof( PmbSnapshot ) );
+	return s;
+}
+
+void pmb3_snapshot_destroy( PmbSnapshot* s )
+{
+	if ( s == NULL )
+	{
+		return;
+	}
+	b3Free( s->data, s->capacity );
+	b3Free( s, sizeof( PmbSnapshot ) );
+}
+
+int pmb3_snapshot_size( const PmbSnapshot* s )
+{
+	return s->size;
+}
+
+// --- writer: append-only into the reused blob
+
+static void pmb3_put( PmbSnapshot* s, const void* src, int n )
+{
+	if ( n <= 0 )
+	{
+		return;
+	}
+	if ( s->size + n > s->capacity )
+	{
+		int capacity = b3MaxInt( b3MaxInt( 2 * s->capacity, s->size + n ), 4096 );
+		s->data = b3GrowAlloc( s->data, s->capacity, capacity );
+		s->capacity = capacity;
+	}
+	memcpy( s->data + s->size, src, n );
+	s->size += n;
+}
+
+static void pmb3_section( PmbSnapshot* s )
+{
+	B3_ASSERT( s->sectionCount < PMB3_SECTION_COUNT );
+	s->sections[s->sectionCount++] = s->size;
+}
+
+static void pmb3_put_i32( PmbSnapshot* s, int v )
+{
+	pmb3_put( s, &v, sizeof( int ) );
+}
+
+#define PMB3_PUT_ARRAY( s, a )                                                                                                   \
+	do                                                                                                                           \
+	{                                                                                                                            \
+		pmb3_put_i32( s, ( a ).count );                                                                                          \
+		pmb3_put( s, ( a ).data, ( a ).count * (int)sizeof( *( a ).data ) );                                                    \
+	}                                                                                                                            \
+	while ( 0 )
+
+// --- reader: the blob is our own image of this very world, so reads
+// are asserted, not validated.
+
+typedef struct
+{
+	const uint8_t* p;
+	const uint8_t* end;
+} PmbReader;
+
+static const void* pmb3_get( PmbReader* r, int n )
+{
+	B3_ASSERT( r->p + n <= r->end );
+	const void* at = r->p;
+	r->p += n;
+	return at;
+}
+
+static int pmb3_get_i32( PmbReader* r )
+{
+	int v;
+	memcpy( &v, pmb3_get( r, sizeof( int ) ), sizeof( int ) );
+	return v;
+}
+
+#define PMB3_GET_BYTES( r, dst, n )                                                                                              \
+	do                                                                                                                           \
+	{                                                                                                                            \
+		int _n = ( n );                                                                                                          \
+		if ( _n > 0 )                                                                                                            \
+		{                                                                                                                        \
+			memcpy( ( dst ), pmb3_get( r, _n ), _n );                                                                            \
+		}                                                                                                                        \
+	}                                                                                                                            \
+	while ( 0 )
+
+// Restore an array image into an existing b3Array, reusing its storage.
+#define PMB3_GET_ARRAY( r, a )                                                                                                   \
+	do                                                                                                                           \
+	{                                                                                                                            \
+		int _count = pmb3_get_i32( r );                                                                                          \
+		b3Array_Resize( a, _count );                                                                                             \
+		PMB3_GET_BYTES( r, ( a ).data, _count * (int)sizeof( *( a ).data ) );                                                    \
+	}                                                                                                                            \
+	while ( 0 )
+
+// --- compound pieces
+
+static void pmb3_put_pool( PmbSnapshot* s, const b3IdPool* pool )
+{
+	pmb3_put_i32( s, pool->nextIndex );
+	PMB3_PUT_ARRAY( s, pool->freeArray );
+}
+
+static void pmb3_get_pool( PmbReader* r, b3IdPool* pool )
+{
+	pool->nextIndex = pmb3_get_i32( r );
+	PMB3_GET_ARRAY( r, pool->freeArray );
+}
+
+static void pmb3_put_bits( PmbSnapshot* s, const b3BitSet* bits )
+{
+	pmb3_put_i32( s, (int)bits->blockCount );
+	pmb3_put( s, bits->bits, (int)bits->blockCount * (int)sizeof( uint64_t ) );
+}
+
+static void pmb3_get_bits( PmbReader* r, b3BitSet* bits )
+{
+	uint32_t blockCount = (uint32_t)pmb3_get_i32( r );
+	if ( blockCount > bits->blockCapacity )
+	{
+		b3Free( bits->bits, bits->blockCapacity * sizeof( uint64_t ) );
+		bits->blockCapacity = blockCount;
+		bits->bits = b3Alloc( blockCount * sizeof( uint64_t ) );
+	}
+	PMB3_GET_BYTES( r, bits->bits, (int)blockCount * (int)sizeof( uint64_t ) );
+	// b3GrowBitSet copies the whole old capacity, so words past the
+	// restored count must read as cleared, not as a later timeline.
+	if ( bits->blockCapacity > blockCount )
+	{
+		memset( bits->bits + blockCount, 0, ( bits->blockCapacity - blockCount ) * sizeof( uint64_t ) );
+	}
+	bits->blockCount = blockCount;
+}
+
+static void pmb3_put_tree( PmbSnapshot* s, const b3DynamicTree* tree )
+{
+	pmb3_put( s, &tree->version, sizeof( uint64_t ) );
+	int scalars[6] = { tree->root, tree->nodeCount, tree->nodeCapacity, tree->proxyCount, tree->freeList, tree->nextNode };
+	pmb3_put( s, scalars, sizeof( scalars ) );
+	pmb3_put( s, tree->nodes, tree->nodeCapacity * (int)sizeof( b3TreeNode ) );
+}
+
+static void pmb3_get_tree( PmbReader* r, b3DynamicTree* tree )
+{
+	PMB3_GET_BYTES( r, &tree->version, (int)sizeof( uint64_t ) );
+	int scalars[6];
+	PMB3_GET_BYTES( r, scalars, (int)sizeof( scalars ) );
+	if ( scalars[2] != tree->nodeCapacity )
+	{
+		b3Free( tree->nodes, tree->nodeCapacity * sizeof( b3TreeNode ) );
+		tree->nodes = b3Alloc( scalars[2] * sizeof( b3TreeNode ) );
+	}
+	tree->root = scalars[0];
+	tree->nodeCount = scalars[1];
+	tree->nodeCapacity = scalars[2];
+	tree->proxyCount = scalars[3];
+	tree->freeList = scalars[4];
+	tree->nextNode = scalars[5];
+	// The rebuild scratch (leafIndices, ...) is per-rebuild and stays.
+	PMB3_GET_BYTES( r, tree->nodes, tree->nodeCapacity * (int)sizeof( b3TreeNode ) );
+}
+
+static void pmb3_put_set( PmbSnapshot* s, const b3HashSet* set )
+{
+	int scalars[3] = { (int)set->capacity, (int)set->count, (int)set->deletedCount };
+	pmb3_put( s, scalars, sizeof( scalars ) );
+	pmb3_put( s, set->keys, b3GetHashSetBytes( set ) );
+}
+
+static void pmb3_get_set( PmbReader* r, b3HashSet* set )
+{
+	int scalars[3];
+	PMB3_GET_BYTES( r, scalars, (int)sizeof( scalars ) );
+	if ( (uint32_t)scalars[0] != set->capacity )
+	{
+		// Probe order depends on capacity, so the table is restored at
+		// the captured size, not merely "big enough". The set shrinks
+		// after spikes, so sizes differ between ticks routinely.
+		b3ResetSet( set, (uint32_t)scalars[0] );
+	}
+	set->count = (uint32_t)scalars[1];
+	set->deletedCount = (uint32_t)scalars[2];
+	PMB3_GET_BYTES( r, set->keys, b3GetHashSetBytes( set ) );
+}
+
+// Identity of everything the contract freezes: which body/shape/joint
+// slots are live, at which generation, holding which shared geometry.
+// O(slots) integer mixing — noise next to the array copies it guards.
+static uint64_t pmb3_topology( b3World* world )
+{
+	uint64_t h = B3_SNAP_FNV_INIT;
+#define PMB3_MIX( x ) h = ( h ^ (uint64_t)( x ) ) * B3_SNAP_FNV_PRIME
+	PMB3_MIX( world->bodies.count );
+	for ( int i = 0; i < world->bodies.count; ++i )
+	{
+		const b3Body* body = world->bodies.data + i;
+		PMB3_MIX( body->id );
+		PMB3_MIX( body->generation );
+	}
+	PMB3_MIX( world->shapes.count );
+	for ( int i = 0; i < world->shapes.count; ++i )
+	{
+		const b3Shape* shape = world->shapes.data + i;
+		PMB3_MIX( shape->id );
+		PMB3_MIX( shape->generation );
+		PMB3_MIX( shape->type );
+		if ( shape->id != i )
+		{
+			continue;
+		}
+		// Shared geometry is restored by pointer, so it must be the same
+		// pointer (b3Shape_SetHull & co. count as topology).
+		switch ( shape->type )
+		{
+			case b3_hullShape:
+				PMB3_MIX( (uintptr_t)shape->hull );
+				break;
+			case b3_meshShape:
+				PMB3_MIX( (uintptr_t)shape->mesh.data );
+				break;
+			case b3_heightShape:
+				PMB3_MIX( (uintptr_t)shape->heightField );
+				break;
+			case b3_compoundShape:
+				PMB3_MIX( (uintptr_t)shape->compound );
+				break;
+			default:
+				break;
+		}
+	}
+	PMB3_MIX( world->joints.count );
+	for ( int i = 0; i < world->joints.count; ++i )
+	{
+		const b3Joint* joint = world->joints.data + i;
+		PMB3_MIX( joint->jointId );
+		PMB3_MIX( joint->generation );
+	}
+	PMB3_MIX( world->sensors.count );
+#undef PMB3_MIX
+	return h;
+}
+
+// --- capture
+
+int pmb3_snapshot_capture( uint32_t w, PmbSnapshot* s )
+{
+	b3World* world = b3GetUnlockedWorldFromId( pmb3_unpack_world( w ) );
+	if ( world == NULL )
+	{
+		return 0;
+	}
+
+	s->size = 0;
+	s->world = w;
+	s->topology = pmb3_topology( world );
+	s->serial = b3AtomicFetchAddInt( &pmb3_snapshot_serials, 1 ) + 1;
+	s->baseSerial = 0;
+	s->sectionCount = 0;
+
+	// World scalars the step advances (host settings are not rolled back).
+	pmb3_section( s );
+	pmb3_put( s, &world->stepIndex, sizeof( uint64_t ) );
+	PMB3_PUT_ARRAY( s, world->splitIslandIds );
+	pmb3_put( s, &world->inv_h, sizeof( float ) );
+	pmb3_put( s, &world->inv_dt, sizeof( float ) );
+	pmb3_put_i32( s, world->endEventArrayIndex );
+
+	// Pools that churn inside a step; body/shape/joint pools are topology.
+	pmb3_put_pool( s, &world->contactIdPool );
+	pmb3_put_pool( s, &world->islandIdPool );
+	pmb3_put_pool( s, &world->solverSetIdPool );
+
+	// Static, disabled and awake sets, then the sleeping ones in their
+	// own section so the awake set growing does not shift them.
+	pmb3_section( s );
+	pmb3_put_i32( s, world->solverSets.count );
+	for ( int i = 0; i < world->solverSets.count; ++i )
+	{
+		if ( i == b3_firstSleepingSet )
+		{
+			pmb3_section( s );
+		}
+		const b3SolverSet* set = world->solverSets.data + i;
+		pmb3_put_i32( s, set->setIndex );
+		PMB3_PUT_ARRAY( s, set->bodySims );
+		PMB3_PUT_ARRAY( s, set->bodyStates );
+		PMB3_PUT_ARRAY( s, set->jointSims );
+		PMB3_PUT_ARRAY( s, set->contactIndices );
+		PMB3_PUT_ARRAY( s, set->islandSims );
+	}
+	if ( world->solverSets.count <= b3_firstSleepingSet )
+	{
+		pmb3_section( s );
+	}
+
+	// Same-topology sparse arrays: raw images, counts implied.
+	pmb3_section( s );
+	pmb3_put( s, world->bodies.data, world->bodies.count * (int)sizeof( b3Body ) );
+	pmb3_section( s );
+	pmb3_put( s, world->shapes.data, world->shapes.count * (int)sizeof( b3Shape ) );
+	pmb3_section( s );
+	pmb3_put( s, world->joints.data, world->joints.count * (int)sizeof( b3Joint ) );
+
+	// Contacts: struct image, then each live contact's heap tail. Packed
+	// sleeping sets go in as if unpacked, as in b3SerContacts: a restore
+	// lands in whatever the sets became since, so it repacks them itself.
+	b3PackedRecords packed;
+	b3DecodePackedSets( world, &packed );
+
+	pmb3_section( s );
+	pmb3_put_i32( s, world->contacts.count );
+	int images = s->size;
+	pmb3_put( s, world->contacts.data, world->contacts.count * (int)sizeof( b3Contact ) );
+	pmb3_section( s );
+	for ( int i = 0; i < world->contacts.count; ++i )
+	{
+		const b3Contact* c = world->contacts.data + i;
+		if ( c->contactId != i )
+		{
+			continue;
+		}
+
+		const b3Manifold* manifolds = c->manifolds;
+		int manifoldCount = c->manifoldCount;
+		if ( c->flags & b3_simPackedManifolds )
+		{
+			int32_t header[2];
+			memcpy( header, packed.records[i], sizeof( header ) );
+			manifolds = (const b3Manifold*)( packed.records[i] + sizeof( header ) );
+			manifoldCount = header[1];
+
+			b3Contact image = *c;
+			image.flags &= ~b3_simPackedManifolds;
+			image.manifoldCount = manifoldCount;
+			memcpy( s->data + images + i * (int)sizeof( b3Contact ), &image, sizeof( b3Contact ) );
+		}
+
+		pmb3_put( s, manifolds, manifoldCount * (int)sizeof( b3Manifold ) );
+		if ( c->flags & b3_simMeshContact )
+		{
+			PMB3_PUT_ARRAY( s, c->meshContact.triangleCache );
+		}
+	}
+	b3FreePackedRecords( world, &packed );
+
+	pmb3_section( s );
+	for ( int i = 0; i < world->sensors.count; ++i )
+	{
+		const b3Sensor* sensor = world->sensors.data + i;
+		PMB3_PUT_ARRAY( s, sensor->hits );
+		PMB3_PUT_ARRAY( s, sensor->overlaps1 );
+		PMB3_PUT_ARRAY( s, sensor->overlaps2 );
+	}
+
+	pmb3_section( s );
+	pmb3_put_i32( s, world->islands.count );
+	for ( int i = 0; i < world->islands.count; ++i )
+	{
+		const b3Island* island = world->islands.data + i;
+		int scalars[4] = { island->setIndex, island->localIndex, island->islandId, island->constraintRemoveCount };
+		pmb3_put( s, scalars, sizeof( scalars ) );
+		PMB3_PUT_ARRAY( s, island->bodies );
+		PMB3_PUT_ARRAY( s, island->contacts );
+		PMB3_PUT_ARRAY( s, island->joints );
+	}
+
+	b3BroadPhase* bp = &world->broadPhase;
+	for ( int t = 0; t < b3_bodyTypeCount; ++t )
+	{
+		pmb3_section( s );
+		pmb3_put_tree( s, bp->trees + t );
+		pmb3_put_bits( s, bp->movedProxies + t );
+	}
+	pmb3_section( s );
+	PMB3_PUT_ARRAY( s, bp->moveArray );
+	pmb3_put_set( s, &bp->pairSet );
+	if ( bp->useDynamicGrid )
+	{
+		// Restores go back into the same world, so the grid's cell size is already right
+		const b3ProxyGrid* grid = &bp->dynamicGrid;
+		pmb3_put_i32( s, grid->proxyCount );
+		PMB3_PUT_ARRAY( s, grid->proxies );
+		pmb3_put_pool( s, &grid->proxyPool );
+		PMB3_PUT_ARRAY( s, grid->entries );
+		pmb3_put_pool( s, &grid->entryPool );
+		PMB3_PUT_ARRAY( s, grid->buckets );
+		PMB3_PUT_ARRAY( s, grid->oversized );
+	}
+
+	pmb3_section( s );
+	for ( int c = 0; c < B3_GRAPH_COLOR_COUNT; ++c )
+	{
+		const b3GraphColor* color = world->constraintGraph.colors + c;
+		if ( c != B3_OVERFLOW_INDEX )
+		{
+			pmb3_put_bits( s, &color->bodySet );
+		}
+		PMB3_PUT_ARRAY( s, color->jointSims );
+		PMB3_PUT_ARRAY( s, color->convexContacts );
+		PMB3_PUT_ARRAY( s, color->contacts );
+	}
+
+	B3_ASSERT( s->sectionCount == PMB3_SECTION_COUNT );
+	s->fullSize = s->size;
+	return s->size;
+}
+
+// --- restore
+
+static void pmb3_get_contacts( PmbReader* r, b3World* world )
+{
+	int count = pmb3_get_i32( r );
+	int oldCount = world->contacts.count;
+
+	// Slots past the restored count lose their heap outright.
+	for ( int i = count; i < oldCount; ++i )
+	{
+		b3Contact* c = world->contacts.data + i;
+		if ( c->contactId == i )
+		{
+			b3FreeManifolds( world, B3_NULL_INDEX, c->manifolds, c->manifoldCount );
+			if ( c->flags & b3_simMeshContact )
+			{
+				b3Array_Destroy( c->meshContact.triangleCache );
+			}
+		}
+	}
+
+	b3Array_Resize( world->contacts, count );
+	const b3Contact* images = pmb3_get( r, count * (int)sizeof( b3Contact ) );
+
+	for ( int i = 0; i < count; ++i )
+	{
+		b3Contact* dst = world->contacts.data + i;
+
+		// What this slot owns now, before the image lands on it.
+		bool oldLive = i < oldCount && dst->contactId == i;
+		b3Manifold* oldManifolds = oldLive ? dst->manifolds : NULL;
+		int oldManifoldCount = oldLive ? dst->manifoldCount : 0;
+		b3Array( b3TriangleCache ) oldCache = { 0 };
+		if ( oldLive && ( dst->flags & b3_simMeshContact ) )
+		{
+			oldCache = dst->meshContact.triangleCache;
+		}
+
+		memcpy( dst, images + i, sizeof( b3Contact ) );
+		bool live = dst->contactId == i;
+		int manifoldCount = live ? dst->manifoldCount : 0;
+
+		// A contact that kept its manifold count keeps its block.
+		if ( manifoldCount != oldManifoldCount )
+		{
+			b3FreeManifolds( world, B3_NULL_INDEX, oldManifolds, oldManifoldCount );
+			oldManifolds = b3AllocateManifolds( world, B3_NULL_INDEX, manifoldCount );
+		}
+		dst->manifolds = oldManifolds;
+		PMB3_GET_BYTES( r, dst->manifolds, manifoldCount * (int)sizeof( b3Manifold ) );
+
+		if ( live && ( dst->flags & b3_simMeshContact ) )
+		{
+			dst->meshContact.triangleCache = oldCache;
+			PMB3_GET_ARRAY( r, dst->meshContact.triangleCache );
+		}
+		else
+		{
+			b3Array_Destroy( oldCache );
+		}
+	}
+}
+
+int pmb3_snapshot_restore( uint32_t w, const PmbSnapshot* s )
+{
+	b3World* world = b3GetUnlockedWorldFromId( pmb3_unpack_world( w ) );
+	// A recording cannot express a rewind; refuse rather than desync it.
+	if ( world == NULL || world->recording != NULL || s->size == 0 || s->baseSerial != 0 || s->world != w ||
+		 s->topology != pmb3_topology( world ) )
+	{
+		return 0;
+	}
+
+	PmbReader reader = { s->data, s->data + s->size };
+	PmbReader* r = &reader;
+
+	PMB3_GET_BYTES( r, &world->stepIndex, (int)sizeof( uint64_t ) );
+	PMB3_GET_ARRAY( r, world->splitIslandIds );
+	PMB3_GET_BYTES( r, &world->inv_h, (int)sizeof( float ) );
+	PMB3_GET_BYTES( r, &world->inv_dt, (int)sizeof( float ) );
+	world->endEventArrayIndex = pmb3_get_i32( r );
+
+	pmb3_get_pool( r, &world->contactIdPool );
+	pmb3_get_pool( r, &world->islandIdPool );
+	pmb3_get_pool( r, &world->solverSetIdPool );
+
+	{
+		int count = pmb3_get_i32( r );
+		int oldCount = world->solverSets.count;
+		for ( int i = count; i < oldCount; ++i )
+		{
+			b3SolverSet* set = world->solverSets.data + i;
+			b3Array_Destroy( set->bodySims );
+			b3Array_Destroy( set->bodyStates );
+			b3Array_Destroy( set->jointSims );
+			b3Array_Destroy( set->contactIndices );
+			b3Array_Destroy( set->islandSims );
+		}
+		b3Array_Resize( world->solverSets, count );
+		if ( count > oldCount )
+		{
+			memset( world->solverSets.data + oldCount, 0, ( count - oldCount ) * sizeof( b3SolverSet ) );
+		}
+		for ( int i = 0; i < count; ++i )
+		{
+			b3SolverSet* set = world->solverSets.data + i;
+			set->setIndex = pmb3_get_i32( r );
+			PMB3_GET_ARRAY( r, set->bodySims );
+			PMB3_GET_ARRAY( r, set->bodyStates );
+			PMB3_GET_ARRAY( r, set->jointSims );
+			PMB3_GET_ARRAY( r, set->contactIndices );
+			PMB3_GET_ARRAY( r, set->islandSims );
+		}
+	}
+
+	{
+		const b3Body* images = pmb3_get( r, world->bodies.count * (int)sizeof( b3Body ) );
+		for ( int i = 0; i < world->bodies.count; ++i )
+		{
+			b3Body* dst = world->bodies.data + i;
+			void* userData = dst->userData;
+			*dst = images[i];
+			dst->userData = userData;
+		}
+	}
+
+	{
+		const b3Shape* images = pmb3_get( r, world->shapes.count * (int)sizeof( b3Shape ) );
+		for ( int i = 0; i < world->shapes.count; ++i )
+		{
+			b3Shape* dst = world->shapes.data + i;
+			void* userData = dst->userData;
+			void* userShape = dst->userShape;
+			b3SurfaceMaterial* materials = dst->materials;
+			*dst = images[i];
+			dst->userData = userData;
+			dst->userShape = userShape;
+			dst->materials = materials;
+		}
+	}
+
+	{
+		const b3Joint* images = pmb3_get( r, world->joints.count * (int)sizeof( b3Joint ) );
+		for ( int i = 0; i < world->joints.count; ++i )
+		{
+			b3Joint* dst = world->joints.data + i;
+			void* userData = dst->userData;
+			*dst = images[i];
+			dst->userData = userData;
+		}
+	}
+
+	// The packed blocks belong to the abandoned timeline; the images are unpacked.
+	b3DropPackedSets( world );
+	pmb3_get_contacts( r, world );
+
+	for ( int i = 0; i < world->sensors.count; ++i )
+	{
+		b3Sensor* sensor = world->sensors.data + i;
+		PMB3_GET_ARRAY( r, sensor->hits );
+		PMB3_GET_ARRAY( r, sensor->overlaps1 );
+		PMB3_GET_ARRAY( r, sensor->overlaps2 );
+	}
+
+	{
+		int count = pmb3_get_i32( r );
+		int oldCount = world->islands.count;
+		for ( int i = count; i < oldCount; ++i )
+		{
+			b3Island* island = world->islands.data + i;
+			b3Array_Destroy( island->bodies );
+			b3Array_Destroy( island->contacts );
+			b3Array_Destroy( island->joints );
+		}
+		b3Array_Resize( world->islands, count );
+		if ( count > oldCount )
+		{
+			memset( world->islands.data + oldCount, 0, ( count - oldCount ) * sizeof( b3Island ) );
+		}
+		for ( int i = 0; i < count; ++i )
+		{
+			b3Island* island = world->islands.data + i;
+			int scalars[4];
+			PMB3_GET_BYTES( r, scalars, (int)sizeof( scalars ) );
+			island->setIndex = scalars[0];
+			island->localIndex = scalars[1];
+			island->islandId = scalars[2];
+			island->constraintRemoveCount = scalars[3];
+			PMB3_GET_ARRAY( r, island->bodies );
+			PMB3_GET_ARRAY( r, island->contacts );
+			PMB3_GET_ARRAY( r, island->joints );
+		}
+	}
+
+	b3BroadPhase* bp = &world->broadPhase;
+	for ( int t = 0; t < b3_bodyTypeCount; ++t )
+	{
+		pmb3_get_tree( r, bp->trees + t );
+		pmb3_get_bits( r, bp->movedProxies + t );
+	}
+	PMB3_GET_ARRAY( r, bp->moveArray );
+	pmb3_get_set( r, &bp->pairSet );
+	if ( bp->useDynamicGrid )
+	{
+		b3ProxyGrid* grid = &bp->dynamicGrid;
+		grid->proxyCount = pmb3_get_i32( r );
+		PMB3_GET_ARRAY( r, grid->proxies );
+		pmb3_get_pool( r, &grid->proxyPool );
+		PMB3_GET_ARRAY( r, grid->entries );
+		pmb3_get_pool( r, &grid->entryPool );
+		PMB3_GET_ARRAY( r, grid->buckets );
+		PMB3_GET_ARRAY( r, grid->oversized );
+	}
+
+	for ( int c = 0; c < B3_GRAPH_COLOR_COUNT; ++c )
+	{
+		b3GraphColor* color = world->constraintGraph.colors + c;
+		if ( c != B3_OVERFLOW_INDEX )
+		{
+			pmb3_get_bits( r, &color->bodySet );
+		}
+		PMB3_GET_ARRAY( r, color->jointSims );
+		PMB3_GET_ARRAY( r, color->convexContacts );
+		PMB3_GET_ARRAY( r, color->contacts );
+	}
+
+	B3_ASSERT( r->p == r->end );
+
+	// Stale caches, sleep packing and the abandoned timeline's events,
+	// exactly as after a snapshot load.
+	b3FinishSnapshotLoad( world );
+	pmb3_hash_rebuild( world );
+
+	b3ValidateSolverSets( world );
+	b3ValidateContacts( world );
+	return 1;
+}
+
+// --- deltas (2026-10-14). A rollback ring of full images is mostly
+// copies of the same statics, sleeping sets and static tree. A delta
+// stores one capture as an op stream against a keyframe capture:
+// n > 0 is n literal bytes that follow, n < 0 copies -n bytes from the
+// base at the offset that follows. Sections are compared block by
+// block at equal offsets, so cost is a memcmp over the image and the
+// delta's size is what actually moved.
+
+#define PMB3_DELTA_BLOCK 64
+
+typedef struct
+{
+	PmbSnapshot* out;
+	// The open op: a literal run at lit, or a copy run at copyAt.
+	const uint8_t* lit;
+	int litCount;
+	int copyAt;
+	int copyCount;
+} PmbDeltaWriter;
+
+static void pmb3_delta_flush( PmbDeltaWriter* d )
+{
+	if ( d->litCount > 0 )
+	{
+		pmb3_put_i32( d->out, d->litCount );
+		pmb3_put( d->out, d->lit, d->litCount );
+		d->litCount = 0;
+	}
+	if ( d->copyCount > 0 )
+	{
+		pmb3_put_i32( d->out, -d->copyCount );
+		pmb3_put_i32( d->out, d->copyAt );
+		d->copyCount = 0;
+	}
+}
+
+static void pmb3_delta_literal( PmbDeltaWriter* d, const uint8_t* p, int n )
+{
+	if ( d->copyCount > 0 || ( d->litCount > 0 && d->lit + d->litCount != p ) )
+	{
+		pmb3_delta_flush( d );
+	}
+	if ( d->litCount == 0 )
+	{
+		d->lit = p;
+	}
+	d->litCount += n;
+}
+
+static void pmb3_delta_copy( PmbDeltaWriter* d, int at, int n )
+{
+	if ( d->litCount > 0 || ( d->copyCount > 0 && d->copyAt + d->copyCount != at ) )
+	{
+		pmb3_delta_flush( d );
+	}
+	if ( d->copyCount == 0 )
+	{
+		d->copyAt = at;
+	}
+	d->copyCount += n;
+}
+
+static int pmb3_section_end( const PmbSnapshot* s, int i )
+{
+	return i + 1 < s->sectionCount ? s->sections[i + 1] : s->fullSize;
+}
+
+int pmb3_snapshot_delta( const PmbSnapshot* base, const PmbSnapshot* full, PmbSnapshot* delta )
+{
+	if ( base->baseSerial != 0 || full->baseSerial != 0 || base->size == 0 || full->size == 0 || base->world != full->world ||
+		 base->topology != full->topology )
+	{
+		delta->size = 0;
+		return 0;
+	}
+
+	delta->size = 0;
+	delta->world = full->world;
+	delta->topology = full->topology;
+	delta->serial = full->serial;
+	delta->baseSerial = base->serial;
+	delta->fullSize = full->size;
+	delta->sectionCount = full->sectionCount;
+	memcpy( delta->sections, full->sections, sizeof( full->sections ) );
+
+	PmbDeltaWriter d = { delta };
+	for ( int i = 0; i < full->sectionCount; ++i )
+	{
+		const uint8_t* f = full->data + full->sections[i];
+		int fn = pmb3_section_end( full, i ) - full->sections[i];
+		int bo = base->sections[i];
+		int bn = pmb3_section_end( base, i ) - bo;
+		int common = b3MinInt( fn, bn );
+
+		int k = 0;
+		for ( ; k + PMB3_DELTA_BLOCK <= common; k += PMB3_DELTA_BLOCK )
+		{
+			if ( memcmp( f + k, base->data + bo + k, PMB3_DELTA_BLOCK ) == 0 )
+			{
+				pmb3_delta_copy( &d, bo + k, PMB3_DELTA_BLOCK );
+			}
+			else
+			{
+				pmb3_delta_literal( &d, f + k, PMB3_DELTA_BLOCK );
+			}
+		}
+		if ( k < fn )
+		{
+			pmb3_delta_literal( &d, f + k, fn - k );
+		}
+	}
+	pmb3_delta_flush( &d );
+	return delta->size;
+}
+
+int pmb3_snapshot_apply( const PmbSnapshot* base, const PmbSnapshot* delta, PmbSnapshot* out )
+{
+	if ( delta->baseSerial == 0 || delta->baseSerial != base->serial || base->baseSerial != 0 )
+	{
+		return 0;
+	}
+
+	out->size = 0;
+	PmbReader reader = { delta->data, delta->data + delta->size };
+	while ( reader.p < reader.end )
+	{
+		int n = pmb3_get_i32( &reader );
+		if ( n > 0 )
+		{
+			pmb3_put( out, pmb3_get( &reader, n ), n );
+		}
+		else
+		{
+			int at = pmb3_get_i32( &reader );
+			B3_ASSERT( at - n <= base->size );
+			pmb3_put( out, base->data + at, -n );
+		}
+	}
+	B3_ASSERT( out->size == delta->fullSize );
+
+	out->world = delta->world;
+	out->topology = delta->topology;
+	out->serial = delta->serial;
+	out->baseSerial = 0;
+	out->fullSize = out->size;
+	out->sectionCount = delta->sectionCount;
+	memcpy( out->sections, delta->sections, sizeof( delta->sections ) );
+	return 1;
+}
+
+// --- island-scoped rollback (2026-10-14). A misprediction is nearly
+// always the client's own truck and whatever it touched, which is its
+// island. Rewinding just those bodies cannot reuse the in-place image
+// above: their sims sit at set-local indices, in graph colors and in
+// contacts shared with the untouched rest, all of which the full
+// restore gets right only by restoring everything. So the scoped door
+// is per-body state through the engine's own setters (which keep the
+// broadphase, wake and set bookkeeping honest). Contacts re-form and
+// re-warm next step — close, not bit-exact; the full restore is the
+// exact tool.
+
+typedef struct
+{
+	PmbVec3 pos;
+	PmbQuat rot;
+	PmbVec3 v;
+	PmbVec3 w;
+} PmbBodyState;
+
+// Every body sharing an island with one of `seeds` (a seed with no
+// island — static, or never constrained — stands for itself). Writes
+// at most `cap` ids, returns how many there are; call again with a
+// bigger buffer if that exceeds cap.
+int pmb3_island_bodies( uint32_t w, const uint64_t* seeds, int n, uint64_t* out, int cap )
+{
+	b3World* world = b3GetWorldFromId( pmb3_unpack_world( w ) );
+	int count = 0;
+	for ( int i = 0; i < n; ++i )
+	{
+		b3Body* seed = pmb3_body_in( world, seeds[i] );
+		if ( seed == NULL )
+		{
+			continue;
+		}
+
+		// Seeds are a handful, so dedupe islands against earlier seeds.
+		bool seen = false;
+		for ( int j = 0; j < i && seed->islandId != B3_NULL_INDEX; ++j )
+		{
+			b3Body* other = pmb3_body_in( world, seeds[j] );
+			seen = seen || ( other != NULL && other->islandId == seed->islandId );
+		}
+		if ( seen )
+		{
+			continue;
+		}
+
+		if ( seed->islandId == B3_NULL_INDEX )
+		{
+			if ( count < cap )
+			{
+				out[count] = seeds[i];
+			}
+			count += 1;
+			continue;
+		}
+
+		const b3Island* island = world->islands.data + seed->islandId;
+		for ( int k = 0; k < island->bodies.count; ++k )
+		{
+			const b3Body* body = world->bodies.data + island->bodies.data[k];
+			if ( count < cap )
+			{
+				b3BodyId id = { body->id + 1, world->worldId, body->generation };
+				out[count] = pmb3_pack_body( id );
+			}
+			count += 1;
+		}
+	}
+	return count;
+}
+
+void pmb3_bodies_capture( uint32_t w, const uint64_t* ids, int n, PmbBodyState* out )
+{
+	b3World* world = b3GetWorldFromId( pmb3_unpack_world( w ) );
+	for ( int i = 0; i < n; ++i )
+	{
+		PmbBodyState* row = out + i;
+		b3Body* body = pmb3_body_in( world, ids[i] );
+		if ( body == NULL )
+		{
+			*row = ( PmbBodyState ){ .rot = { 0.0f, 0.0f, 0.0f, 1.0f } };
+			continue;
+		}
+		b3SolverSet* set = world->solverSets.data + body->setIndex;
+		const b3Transform xf = set->bodySims.data[body->localIndex].transform;
+		row->pos = ( PmbVec3 ){ (float)xf.p.x, (float)xf.p.y, (float)xf.p.z };
+		row->rot = ( PmbQuat ){ xf.q.v.x, xf.q.v.y, xf.q.v.z, xf.q.s };
+		b3Vec3 v = b3Vec3_zero, a = b3Vec3_zero;
+		if ( body->setIndex == b3_awakeSet )
+		{
+			const b3BodyState* state = set->bodyStates.data + body->localIndex;
+			v = state->linearVelocity;
+			a = state->angularVelocity;
+		}
+		row->v = ( PmbVec3 ){ v.x, v.y, v.z };
+		row->w = ( PmbVec3 ){ a.x, a.y, a.z };
+	}
+}
+
+// Put each body back (pose and both velocities). Statics and stale ids
+// are skipped. Every restored dynamic wakes, which is what re-running
+// reconciliation on it wants anyway.
+void pmb3_bodies_restore( uint32_t w, const uint64_t* ids, int n, const PmbBodyState* rows )
+{
+	b3World* world = b3GetWorldFromId( pmb3_unpack_world( w ) );
+	for ( int i = 0; i < n; ++i )
+	{
+		b3Body* body = pmb3_body_in( world, ids[i] );
+		if ( body == NULL || body->type == b3_staticBody )
+		{
+			continue;
+		}
+		const PmbBodyState* row = rows + i;
+		b3BodyId id = pmb3_unpack_body( ids[i] );
+		b3Body_SetTransform( id, ( b3Pos ){ row->pos.x, row->pos.y, row->pos.z },
+							 ( b3Quat ){ .v = { row->rot.x, row->rot.y, row->rot.z }, .s = row->rot.w } );
+		b3Body_SetLinearVelocity( id, ( b3Vec3 ){ row->v.x, row->v.y, row->v.z } );
+		b3Body_SetAngularVelocity( id, ( b3Vec3 ){ row->w.x, row->w.y, row->w.z } );
+		pmb3_hash_body( world, ids[i] );
+	}
+}
@@ -0,0 +1,179 @@
+// pmb3_step — stepping many worlds at once (2026-10-14). A host runs a
+// world per match plus scratch worlds for rollback; each is small and
+// steps single-threaded (pm worlds are created serial), so the win is
+// not threads INSIDE a world — whose per-stage wake/join latency is
+// the whole cost at this size — but whole worlds spread across cores,
+// one wake per batch. Distinct worlds share no mutable engine state
+// (b3_worlds slots are per world; the globals are atomics), so this
+// needs no engine change. The same pool runs a batch in the
+// BACKGROUND (begin/wait), so a server encodes replication for tick N
+// while tick N+1 steps.
+
+#include "pmb3.h"
+
+#include "core.h"
+#include "platform.h"
+
+#include <stdio.h>
+
+typedef struct PmbStepper
+{
+	b3Thread* threads[B3_MAX_WORKERS];
+	int threadCount;
+	b3Semaphore* wake;
+	b3AtomicInt shutdown;
+
+	// The batch in flight. Written only while active == 0 and no
+	// worker is busy, so a worker that saw active == 1 reads a whole
+	// batch.
+	const uint32_t* worlds;
+	int count;
+	float dt;
+	int substeps;
+	b3AtomicInt active;
+	b3AtomicInt next;
+	b3AtomicInt done;
+	b3AtomicInt busy;
+} PmbStepper;
+
+void pmb3_worlds_step_wait( PmbStepper* s );
+
+static void pmb3_stepper_drain( PmbStepper* s )
+{
+	int i;
+	while ( ( i = b3AtomicFetchAddInt( &s->next, 1 ) ) < s->count )
+	{
+		pmb3_world_step( s->worlds[i], s->dt, s->substeps );
+		b3AtomicFetchAddInt( &s->done, 1 );
+	}
+}
+
+static void pmb3_stepper_main( void* context )
+{
+	PmbStepper* s = context;
+	while ( true )
+	{
+		b3WaitSemaphore( s->wake );
+		if ( b3AtomicLoadInt( &s->shutdown ) != 0 )
+		{
+			break;
+		}
+		// busy before active: either the caller sees us busy and waits,
+		// or we see the batch already closed.
+		b3AtomicFetchAddInt( &s->busy, 1 );
+		if ( b3AtomicLoadInt( &s->active ) != 0 )
+		{
+			pmb3_stepper_drain( s );
+		}
+		b3AtomicFetchAddInt( &s->busy, -1 );
+	}
+}
+
+// threads: background threads; the caller of pmb3_worlds_step is one
+// more worker.
+PmbStepper* pmb3_stepper_create( int threads )
+{
+	PmbStepper* s = b3AllocZeroed( sizeof( PmbStepper ) );
+	s->threadCount = b3ClampInt( threads, 0, B3_MAX_WORKERS );
+	s->wake = b3CreateSemaphore( 0 );
+	for ( int i = 0; i < s->threadCount; ++i )
+	{
+		char name[16];
+		snprintf( name, sizeof( name ), "pmb3_step_%02d", i );
+		s->threads[i] = b3CreateThread( pmb3_stepper_main, s, name );
+	}
+	return s;
+}
+
+void pmb3_stepper_destroy( PmbStepper* s )
+{
+	if ( s == NULL )
+	{
+		return;
+	}
+	pmb3_worlds_step_wait( s );
+	b3AtomicStoreInt( &s->shutdown, 1 );
+	for ( int i = 0; i < s->threadCount; ++i )
+	{
+		b3SignalSemaphore( s->wake );
+	}
+	for ( int i = 0; i < s->threadCount; ++i )
+	{
+		b3JoinThread( s->threads[i] );
+	}
+	b3DestroySemaphore( s->wake );
+	b3Free( s, sizeof( PmbStepper ) );
+}
+
+// Launch a step of every world in `ws` (distinct worlds, each exactly
+// as pmb3_world_step would) on the background threads and return at
+// once; pmb3_worlds_step_wait joins it. Until then `ws` must stay
+// alive and the worlds are the step's: no query of ANY kind on them
+// is legal mid-step (the step rewrites the broadphase and the body
+// arrays in place). Other worlds and host data are fair game — that
+// is the point. With no background threads the step runs here.
+void pmb3_worlds_step_begin( PmbStepper* s, const uint32_t* ws, int n, float dt, int substeps )
+{
+	s->worlds = ws;
+	s->count = n;
+	s->dt = dt;
+	s->substeps = substeps;
+	b3AtomicStoreInt( &s->next, 0 );
+	b3AtomicStoreInt( &s->done, 0 );
+	b3AtomicStoreInt( &s->active, 1 );
+
+	int helpers = b3MinInt( s->threadCount, n );
+	for ( int i = 0; i < helpers; ++i )
+	{
+		b3SignalSemaphore( s->wake );
+	}
+	if ( helpers == 0 )
+	{
+		pmb3_stepper_drain( s );
+	}
+}
+
+// Join the step pmb3_worlds_step_begin launched, helping with any
+// world no thread has claimed yet.
+void pmb3_worlds_step_wait( PmbStepper* s )
+{
+	if ( b3AtomicLoadInt( &s->active ) == 0 )
+	{
+		return;
+	}
+
+	pmb3_stepper_drain( s );
+	while ( b3AtomicLoadInt( &s->done ) < s->count )
+	{
+		b3Yield();
+	}
+
+	b3AtomicStoreInt( &s->active, 0 );
+	while ( b3AtomicLoadInt( &s->busy ) != 0 )
+	{
+		b3Yield();
+	}
+}
+
+// Step every world in `ws` and return when all are done, the caller
+// working alongside the pool. Each world's result is bit-identical to
+// stepping it alone.
+void pmb3_worlds_step( PmbStepper* s, const uint32_t* ws, int n, float dt, int substeps )
+{
+	s->worlds = ws;
+	s->count = n;
+	s->dt = dt;
+	s->substeps = substeps;
+	b3AtomicStoreInt( &s->next, 0 );
+	b3AtomicStoreInt( &s->done, 0 );
+	b3AtomicStoreInt( &s->active, 1 );
+
+	// No point waking more helpers than there are other worlds.
+	int helpers = b3MinInt( s->threadCount, n - 1 );
+	for ( int i = 0; i < helpers; ++i )
+	{
+		b3SignalSemaphore( s->wake );
+	}
+
+	pmb3_worlds_step_wait( s );
+}
@@ -0,0 +1,93 @@
+//! The cross-target determinism gate. Client-side prediction only
+//! reconciles cheaply if a Windows client steps exactly like the Linux
+//! server, so one recording is checked in (`tests/data/determinism.b3rec`)
+//! and every target replays it: each frame's recorded state hash
+//! (positions mixed at full width, `b3FnvMixPosition`) must come out
+//! again, on one worker and on several. A target that rounds one
+//! contact differently fails here with the first frame that diverged.
+//!
+//! The recording is the scene below. After a change that is MEANT to
+//! move trajectories (or a breaking format bump), re-record it on any
+//! target with `PM_BLESS_DETERMINISM=1 cargo test -p box3d-sys --test
+//! determinism` and commit the new file. Build with
+//! `--features strict-determinism` to also pin the contact solver
+//! width; the player notes a strict/non-strict mismatch.
+
+use box3d_sys::*;
+
+fn v(x: f32, y: f32, z: f32) -> Vec3 {
+    Vec3 { x, y, z }
+}
+
+const DT: f32 = 1.0 / 60.0;
+const SUBSTEPS: i32 = 4;
+const FRAMES: usize = 240;
+
+fn golden_path() -> std::path::PathBuf {
+    std::path::Path::new(env!("CARGO_MANIFEST_DIR")).join("tests/data/determinism.b3rec")
+}
+
+/// A tumbling pile of boxes and capsules on a tilted slab, kicked
+/// twice and probed with rays: contacts, friction, rolling, sleep and
+/// recorded queries all feed the hashes. No transcendental calls in the
+/// setup, so the scene itself is built identically everywhere.
+fn record_scene() -> Vec<u8> {
+    let mut w = World::with_workers(v(0.0, -9.81, 0.0), 4);
+    w.start_recording(0);
+    w.body_box(STATIC, v(0.0, -0.5, 0.0), Quat::default(), v(30.0, 0.5, 30.0), 1.0, 0.6);
+    let tilt = Quat { x: 0.0, y: 0.0, z: 0.0871557, w: 0.9961947 };
+    w.body_box(STATIC, v(6.0, 1.0, 0.0), tilt, v(4.0, 0.25, 3.0), 1.0, 0.4);
+    let mut bodies = Vec::new();
+    for i in 0..48 {
+        let (ix, iy, iz) = ((i % 4) as f32, (i / 16) as f32, ((i / 4) % 4) as f32);
+        let jitter = (i % 7) as f32 * 0.013;
+        let pos = v(ix * 0.95 - 1.5 + jitter, 1.0 + iy * 1.1 + ix * 0.05, iz * 0.95 - 1.5 - jitter);
+        let body = if i % 3 == 0 {
+            w.body_capsule(DYNAMIC, pos, 0.25, 0.3, 1.2, 0.5, false)
+        } else {
+            let spin = Quat { x: 0.0, y: 0.2588190 * (i % 2) as f32, z: 0.0, w: 1.0 - 0.0340742 * (i % 2) as f32 };
+            w.body_box(DYNAMIC, pos, spin, v(0.4, 0.3, 0.35), 1.0, 0.6)
+        };
+        bodies.push(body);
+    }
+    for frame in 0..FRAMES {
+        if frame == 60 || frame == 150 {
+            for (k, &b) in bodies.iter().enumerate().step_by(5) {
+                w.set_velocity(b, v(4.0 - k as f32 * 0.1, 3.0, 1.5));
+            }
+        }
+        if frame % 20 == 0 {
+            w.cast_ray(v(-8.0, 0.6, -0.2), v(16.0, 0.0, 0.0), u64::MAX);
+        }
+        w.step(DT, SUBSTEPS);
+    }
+    w.stop_recording_compressed()
+}
+
+/// Steps through `recording` and returns the first frame that missed
+/// its recorded hash.
+fn first_divergence(recording: &[u8]) -> Option<usize> {
+    let mut replay = Replay::new(recording).expect("the golden recording loads on this target");
+    assert_eq!(replay.frame_count(), FRAMES, "golden recording length");
+    while replay.step() {
+        if replay.has_diverged() {
+            return Some(replay.frame());
+        }
+    }
+    None
+}
+
+#[test]
+fn golden_recording_replays_bit_for_bit() {
+    let path = golden_path();
+    if std::env::var_os("PM_BLESS_DETERMINISM").is_some() {
+        let recording = record_scene();
+        assert!(replay_is_valid(&recording), "a fresh recording replays on the target that made it");
+        std::fs::create_dir_all(path.parent().unwrap()).unwrap();
+        std::fs::write(&path, &recording).unwrap();
+        println!("blessed {} ({} bytes)", path.display(), recording.len());
+    }
+    let golden = std::fs::read(&path).expect("tests/data/determinism.b3rec; bless it with PM_BLESS_DETERMINISM=1");
+    assert_eq!(first_divergence(&golden), None, "this target diverged from the golden recording");
+    assert!(replay_is_valid_with_workers(&golden, 4), "worker count changes nothing");
+}
@@ -3,10 +3,10 @@
 //!
 //! 1. Budget — 300 wandering, mutually-colliding hog capsules: what
 //!    does a step cost awake, and does island sleeping actually zero
-//!    the bill when the horde settles? Run `cargo test -p box3d-sys
-//!    --release --test horde -- --nocapture` for the real numbers
-//!    (assertions here are generous debug-safe ceilings; the printed
-//!    µs/step is the datum the plan wants).
+//!    the bill when the horde settles? The assertions here are
+//!    generous debug-safe ceilings; the measured numbers, with stage
+//!    times and counters, come from `cargo bench -p box3d-sys --bench
+//!    scenarios` (settled_horde, awake_horde, truck_plow).
 //! 2. The Connor qualifier "mass you can feel" — is a packed crowd
 //!    physically load-bearing? A force-driven truck must measurably
 //!    LOSE SPEED plowing through 200 packed hogs, and the hogs must
@@ -0,0 +1,28 @@
+//! Hash table workloads: the broad-phase pair set and the hull map.
+//! Run `cargo test -p box3d-sys --release --test tables -- --nocapture`
+//! for the ns/op; the assertions only check the tables answered right.
+
+use box3d_sys::*;
+use std::time::Instant;
+
+/// A crowd's pair set: 20k shapes with 8 partners each, probed as the
+/// pair query probes it (hits and misses) with contacts churning.
+#[test]
+fn pair_set_crowd() {
+    let (shapes, neighbours, rounds) = (20_000, 8, 20);
+    let t = Instant::now();
+    let hits = bench_pair_set(shapes, neighbours, rounds);
+    let probes = shapes * (neighbours + 2) * rounds;
+    println!("pair set, {} pairs: {:.1} ns/probe", shapes * neighbours, t.elapsed().as_nanos() as f64 / probes as f64);
+    assert_eq!(hits, (shapes * neighbours * rounds) as u64);
+}
+
+/// The hull database under a map of authored chunks.
+#[test]
+fn hull_map_chunks() {
+    let (hulls, rounds) = (2_000, 200);
+    let t = Instant::now();
+    let hits = bench_hull_map(hulls, rounds);
+    println!("hull map, {hulls} hulls: {:.1} ns/lookup", t.elapsed().as_nanos() as f64 / (hulls * rounds) as f64);
+    assert_eq!(hits, (hulls * rounds) as u64);
+}